@@ -23,12 +23,17 @@ Below 10 reduction Operators are covered:
 
 ['max', 'max_axis', 'mean', 'min', 'min_axis', 'nanprod', 'nansum', 'prod', 'sum', 'sum_axis']
 
+In addition, sum, mean, max and norm are benchmarked over the innermost and the outermost
+axis of large activations, the two layouts with specialized CPU kernels.
+
 """
 
 import mxnet as mx
 
 from benchmark.opperf.utils.op_registry_utils import get_all_reduction_operators
-from benchmark.opperf.utils.benchmark_utils import run_op_benchmarks
+from benchmark.opperf.utils.benchmark_utils import run_op_benchmarks, run_performance_test
+from benchmark.opperf.utils.common_utils import merge_map_list
+from benchmark.opperf.rules.default_params import MX_OP_MODULE
 
 
 def run_mx_reduction_operators_benchmarks(ctx=mx.cpu(), dtype='float32', profiler='native', int64_tensor='off', warmup=25, runs=100):
@@ -60,3 +65,46 @@ def run_mx_reduction_operators_benchmarks(ctx=mx.cpu(), dtype='float32', profile
     # Run benchmarks
     mx_reduction_op_results = run_op_benchmarks(mx_reduction_broadcast_ops, dtype, ctx, profiler, int64_tensor, warmup, runs)
     return mx_reduction_op_results
+
+
+def run_mx_reduction_axis_benchmarks(ctx=mx.cpu(), dtype='float32', profiler='native', int64_tensor='off', warmup=25, runs=100):
+    """Runs benchmarks of sum, mean, max and norm over the innermost axis, the outermost axis and
+    all axes of large activations.
+
+    Parameters
+    ----------
+    ctx: mx.ctx
+        Context to run benchmarks
+    dtype: str, default 'float32'
+        Precision to use for benchmarks
+    profiler: str, default 'native'
+        Type of Profiler to use (native/python)
+    int64_tensor: str, default 'off'
+        Input tensor size to use for tests (if on, dimensions >= 2**32)
+    warmup: int, default 25
+        Number of times to run for warmup
+    runs: int, default 100
+        Number of runs to capture benchmark results
+
+    Returns
+    -------
+    Dictionary of results. Key -> Name of the operator, Value -> Benchmark results.
+
+    """
+    if int64_tensor == 'on':
+        shapes = [(2**16, 2**16)]
+    else:
+        shapes = [(1024, 4096), (32, 128, 1024)]
+    inputs = []
+    for shape in shapes:
+        inputs += [{"data": shape, "axis": -1},
+                   {"data": shape, "axis": 0},
+                   {"data": shape}]
+
+    results = []
+    for op in ["sum", "mean", "max", "norm"]:
+        results += run_performance_test([getattr(MX_OP_MODULE, op)], run_backward=False,
+                                        dtype=dtype, ctx=ctx,
+                                        inputs=inputs,
+                                        warmup=warmup, runs=runs, profiler=profiler)
+    return merge_map_list(results)
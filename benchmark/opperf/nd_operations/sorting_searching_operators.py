@@ -16,8 +16,10 @@
 # under the License.
 
 import mxnet as mx
-from benchmark.opperf.utils.benchmark_utils import run_op_benchmarks
+from benchmark.opperf.utils.benchmark_utils import run_op_benchmarks, run_performance_test
+from benchmark.opperf.utils.common_utils import merge_map_list
 from benchmark.opperf.utils.op_registry_utils import get_all_sorting_searching_operators
+from benchmark.opperf.rules.default_params import MX_OP_MODULE
 
 
 """ Performance benchmark tests for MXNet NDArray Sorting and Searching Operations
@@ -58,3 +60,45 @@ def run_sorting_searching_operators_benchmarks(ctx=mx.cpu(), dtype='float32', pr
     # Run benchmarks
     mx_sort_search_op_results = run_op_benchmarks(mx_sort_search_ops, dtype, ctx, profiler, int64_tensor, warmup, runs)
     return mx_sort_search_op_results
+
+
+def run_topk_sweep_benchmarks(ctx=mx.cpu(), dtype='float32', profiler='native', warmup=10, runs=50,
+                              row_lengths=(1000, 100000, 1000000), ks=(1, 10, 100, 1000),
+                              num_rows=(1, 64)):
+    """Runs benchmarks of topk over a sweep of k, row length and number of rows, and of sort
+    over the same rows, to compare partial selection against full sorts.
+
+    Parameters
+    ----------
+    ctx: mx.ctx
+        Context to run benchmarks
+    dtype: str, default 'float32'
+        Precision to use for benchmarks
+    profiler: str, default 'native'
+        Type of Profiler to use (native/python)
+    warmup: int, default 10
+        Number of times to run for warmup
+    runs: int, default 50
+        Number of runs to capture benchmark results
+    row_lengths: tuple of int
+        Lengths of the sorted rows
+    ks: tuple of int
+        Number of selected elements per row, the values larger than the row length are skipped
+    num_rows: tuple of int
+        Number of rows
+
+    Returns
+    -------
+    Dictionary of results. Key -> Name of the operator, Value -> Benchmark results.
+
+    """
+    topk_inputs = [{"data": (rows, length), "k": k, "ret_typ": "both"}
+                   for rows in num_rows for length in row_lengths for k in ks if k <= length]
+    sort_inputs = [{"data": (rows, length)} for rows in num_rows for length in row_lengths]
+    topk_res = run_performance_test([getattr(MX_OP_MODULE, "topk")], run_backward=False,
+                                    dtype=dtype, ctx=ctx, inputs=topk_inputs,
+                                    warmup=warmup, runs=runs, profiler=profiler)
+    sort_res = run_performance_test([getattr(MX_OP_MODULE, "sort")], run_backward=False,
+                                    dtype=dtype, ctx=ctx, inputs=sort_inputs,
+                                    warmup=warmup, runs=runs, profiler=profiler)
+    return merge_map_list(topk_res + sort_res)
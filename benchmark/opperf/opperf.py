@@ -33,7 +33,8 @@ from benchmark.opperf.nd_operations.binary_operators import run_mx_binary_broadc
     run_mx_binary_element_wise_operators_benchmarks, run_mx_binary_misc_operators_benchmarks
 from benchmark.opperf.nd_operations.gemm_operators import run_gemm_operators_benchmarks
 from benchmark.opperf.nd_operations.random_sampling_operators import run_mx_random_sampling_operators_benchmarks
-from benchmark.opperf.nd_operations.reduction_operators import run_mx_reduction_operators_benchmarks
+from benchmark.opperf.nd_operations.reduction_operators import run_mx_reduction_operators_benchmarks, \
+    run_mx_reduction_axis_benchmarks
 from benchmark.opperf.nd_operations.sorting_searching_operators import run_sorting_searching_operators_benchmarks
 from benchmark.opperf.nd_operations.nn_activation_operators import run_activation_operators_benchmarks
 from benchmark.opperf.nd_operations.nn_conv_operators import run_pooling_operators_benchmarks, \
@@ -85,6 +86,7 @@ def run_all_mxnet_operator_benchmarks(ctx=mx.cpu(), dtype='float32', profiler='n
 
     # Run all Reduction operations benchmarks with default input values
     mxnet_operator_benchmark_results.append(run_mx_reduction_operators_benchmarks(ctx=ctx, dtype=dtype, profiler=profiler, int64_tensor=int64_tensor, warmup=warmup, runs=runs))
+    mxnet_operator_benchmark_results.append(run_mx_reduction_axis_benchmarks(ctx=ctx, dtype=dtype, profiler=profiler, int64_tensor=int64_tensor, warmup=warmup, runs=runs))
 
     # Run all Sorting and Searching operations benchmarks with default input values
     mxnet_operator_benchmark_results.append(run_sorting_searching_operators_benchmarks(ctx=ctx, dtype=dtype, profiler=profiler, int64_tensor=int64_tensor, warmup=warmup, runs=runs))
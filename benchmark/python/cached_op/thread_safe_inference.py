@@ -0,0 +1,80 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""Inference throughput of a thread-safe CachedOp shared by several threads.
+
+Each thread runs forwards of its own requests over the shared parameters and
+waits for their outputs. With num_states=0 the calls are serialized on a single
+execution state, with num_states=N each call checks out one of N pooled states.
+"""
+import argparse
+import threading
+import time
+
+import mxnet as mx
+
+
+def build_mlp(num_layers, hidden):
+    net = mx.sym.Variable('data')
+    for i in range(num_layers):
+        net = mx.sym.FullyConnected(net, num_hidden=hidden, name='fc%d' % i)
+        net = mx.sym.relu(net)
+    return net
+
+
+def run(sym, params, data_shape, num_threads, num_states, repeat):
+    flags = [('data_indices', '[0]'),
+             ('param_indices', str(list(range(1, len(params) + 1)))),
+             ('static_alloc', True), ('static_shape', True),
+             ('num_states', num_states)]
+    op = mx.nd.CachedOp(sym, flags, thread_safe=True)
+    datas = [mx.nd.random.uniform(shape=data_shape) for _ in range(num_threads)]
+    op(datas[0], *params).wait_to_read()
+
+    def worker(i):
+        for _ in range(repeat):
+            op(datas[i], *params).wait_to_read()
+
+    threads = [threading.Thread(target=worker, args=(i,)) for i in range(num_threads)]
+    start = time.time()
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    return num_threads * repeat / (time.time() - start)
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--threads', type=str, default='1,2,4,8',
+                        help='comma separated numbers of threads')
+    parser.add_argument('--batch-size', type=int, default=8)
+    parser.add_argument('--hidden', type=int, default=1024)
+    parser.add_argument('--num-layers', type=int, default=4)
+    parser.add_argument('--repeat', type=int, default=200)
+    args = parser.parse_args()
+
+    sym = build_mlp(args.num_layers, args.hidden)
+    arg_shapes, _, _ = sym.infer_shape(data=(args.batch_size, args.hidden))
+    params = [mx.nd.random.uniform(shape=shape) for shape in arg_shapes[1:]]
+    data_shape = (args.batch_size, args.hidden)
+
+    print('{:>8} {:>20} {:>20}'.format('threads', 'single state (req/s)', 'pooled (req/s)'))
+    for num_threads in [int(t) for t in args.threads.split(',')]:
+        serialized = run(sym, params, data_shape, num_threads, 0, args.repeat)
+        pooled = run(sym, params, data_shape, num_threads, num_threads, args.repeat)
+        print('{:>8} {:>20.1f} {:>20.1f}'.format(num_threads, serialized, pooled))
@@ -0,0 +1,75 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""Per operator overhead of imperative calls on small arrays.
+
+Each configuration of the dispatch cache (MXNET_IMPERATIVE_DISPATCH_CACHE_SIZE),
+of inline execution (MXNET_IMPERATIVE_INLINE_MAX_SIZE) and of the engine runs in a
+fresh process since these settings are read when the library starts.
+"""
+import argparse
+import os
+import subprocess
+import sys
+import time
+
+CONFIGS = [
+    ('no dispatch cache', {'MXNET_IMPERATIVE_DISPATCH_CACHE_SIZE': '0'}),
+    ('dispatch cache', {}),
+    ('dispatch cache + inline', {'MXNET_IMPERATIVE_INLINE_MAX_SIZE': '65536'}),
+    ('NaiveEngine', {'MXNET_ENGINE_TYPE': 'NaiveEngine'}),
+]
+
+
+def run_workload(size, repeat):
+    import mxnet as mx
+    a = mx.nd.random.uniform(shape=(size,))
+    b = mx.nd.random.uniform(shape=(size,))
+    workloads = [
+        ('add', lambda: mx.nd.add(a, b)),
+        ('multiply scalar', lambda: a * 2),
+        ('relu', lambda: mx.nd.relu(a)),
+        ('sum', lambda: mx.nd.sum(a)),
+        ('reshape', lambda: mx.nd.reshape(a, shape=(-1, 1))),
+        ('add chain', lambda: ((a + b) * a - b) / 2),
+    ]
+    for name, func in workloads:
+        func()
+        mx.nd.waitall()
+        start = time.time()
+        for _ in range(repeat):
+            func()
+        mx.nd.waitall()
+        print('  {:>16}: {:8.2f} us'.format(name, (time.time() - start) / repeat * 1e6))
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--size', type=int, default=16, help='number of elements of the arrays')
+    parser.add_argument('--repeat', type=int, default=10000)
+    parser.add_argument('--worker', action='store_true', help=argparse.SUPPRESS)
+    args = parser.parse_args()
+    if args.worker:
+        run_workload(args.size, args.repeat)
+        sys.exit(0)
+
+    for name, config in CONFIGS:
+        print(name)
+        sys.stdout.flush()
+        subprocess.check_call([sys.executable, __file__, '--worker',
+                               '--size', str(args.size), '--repeat', str(args.repeat)],
+                              env=dict(os.environ, **config))
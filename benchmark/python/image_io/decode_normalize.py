@@ -0,0 +1,94 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""Images per second and core of ImageRecordIter decoding JPEG images into
+normalized batches, at full size versus at a reduced DCT scale
+(scaled_decode), for the output dtypes.
+
+The iterator runs with one preprocessing thread, so the numbers are the
+throughput of one core. Without --rec a record file of random images of
+--image-size pixels is written to a temporary directory.
+"""
+import argparse
+import os
+import tempfile
+import time
+
+import numpy as np
+import mxnet as mx
+
+
+def write_rec(path, num_images, image_size):
+    record = mx.recordio.MXRecordIO(path, 'w')
+    rng = np.random.RandomState(0)
+    for i in range(num_images):
+        # smooth images compress like photos, unlike white noise
+        small = rng.randint(0, 256, size=(image_size // 16, image_size // 16, 3))
+        img = np.kron(small, np.ones((16, 16, 1))).astype(np.uint8)
+        header = mx.recordio.IRHeader(0, float(i % 10), i, 0)
+        record.write(mx.recordio.pack_img(header, img, quality=90, img_fmt='.jpg'))
+    record.close()
+
+
+def run(rec, dtype, scaled_decode, resize, crop, batch_size, num_batches):
+    it = mx.io.ImageRecordIter(path_imgrec=rec, data_shape=(3, crop, crop),
+                               batch_size=batch_size, resize=resize, dtype=dtype,
+                               mean_r=123.68, mean_g=116.28, mean_b=103.53,
+                               std_r=58.395, std_g=57.12, std_b=57.375,
+                               scaled_decode=scaled_decode, preprocess_threads=1,
+                               prefetch_buffer=1, round_batch=True)
+    # the first batch warms up the decoder and the buffers
+    it.next()
+    start = time.time()
+    for _ in range(num_batches):
+        try:
+            batch = it.next()
+        except StopIteration:
+            it.reset()
+            batch = it.next()
+        batch.data[0].wait_to_read()
+    return batch_size * num_batches / (time.time() - start)
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--rec', type=str, default='',
+                        help='record file of JPEG images, generated if empty')
+    parser.add_argument('--num-images', type=int, default=512)
+    parser.add_argument('--image-size', type=int, default=512)
+    parser.add_argument('--resize', type=int, default=256,
+                        help='shorter edge after decoding')
+    parser.add_argument('--crop', type=int, default=224)
+    parser.add_argument('--dtypes', type=str, default='uint8,float32,float16',
+                        help='comma separated output dtypes')
+    parser.add_argument('--batch-size', type=int, default=32)
+    parser.add_argument('--num-batches', type=int, default=20)
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as tmp:
+        rec = args.rec
+        if not rec:
+            rec = os.path.join(tmp, 'images.rec')
+            write_rec(rec, args.num_images, args.image_size)
+        print('{:>8} {:>22} {:>22}'.format('dtype', 'full size (img/s)',
+                                           'scaled decode (img/s)'))
+        for dtype in args.dtypes.split(','):
+            full = run(rec, dtype, False, args.resize, args.crop,
+                       args.batch_size, args.num_batches)
+            scaled = run(rec, dtype, True, args.resize, args.crop,
+                         args.batch_size, args.num_batches)
+            print('{:>8} {:>22.1f} {:>22.1f}'.format(dtype, full, scaled))
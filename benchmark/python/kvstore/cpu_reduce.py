@@ -0,0 +1,69 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""Throughput of the reduction of gradients by the local kvstore on CPU.
+
+Gradients of 1KB to 1GB on several contexts are pushed and pulled, as data
+parallel training on one machine does. The contexts are GPUs when available,
+CPUs otherwise.
+"""
+import argparse
+import time
+import mxnet as mx
+
+
+def measure(kv, key, grads, outs, repeat):
+    kv.push(key, grads)
+    kv.pull(key, out=outs)
+    mx.nd.waitall()
+    start = time.time()
+    for _ in range(repeat):
+        kv.push(key, grads)
+        kv.pull(key, out=outs)
+    mx.nd.waitall()
+    return (time.time() - start) / repeat
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--num-devices', type=int, default=4)
+    parser.add_argument('--min-size', type=int, default=1 << 10, help='smallest gradient in bytes')
+    parser.add_argument('--max-size', type=int, default=1 << 30, help='largest gradient in bytes')
+    parser.add_argument('--repeat', type=int, default=10)
+    parser.add_argument('--gpu', action='store_true', help='put the gradients on GPUs')
+    args = parser.parse_args()
+
+    if args.gpu:
+        ctxs = [mx.gpu(i % mx.context.num_gpus()) for i in range(args.num_devices)]
+    else:
+        ctxs = [mx.cpu(i) for i in range(args.num_devices)]
+    kv = mx.kv.create('local')
+    print('{:>12}{:>12}{:>16}'.format('size', 'time(ms)', 'reduce(GB/s)'))
+    size = args.min_size
+    key = 0
+    while size <= args.max_size:
+        shape = (size // 4,)
+        kv.init(key, mx.nd.zeros(shape))
+        grads = [mx.nd.ones(shape, ctx=c) for c in ctxs]
+        outs = [mx.nd.empty(shape, ctx=c) for c in ctxs]
+        cost = measure(kv, key, grads, outs, max(1, args.repeat * (1 << 20) // size))
+        # every gradient is read once by the reduction
+        print('{:>12}{:>12.3f}{:>16.2f}'.format(size, cost * 1e3,
+                                                 size * len(ctxs) / cost / 1e9))
+        del grads, outs
+        size *= 4
+        key += 1
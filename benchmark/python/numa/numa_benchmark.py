@@ -0,0 +1,93 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""GEMM and elementwise throughput with and without MXNET_CPU_NUMA_AWARE.
+
+Every NUMA node gets its own context mx.cpu(i) running the same workload
+concurrently, as one inference replica per socket would. Each mode runs in a
+fresh process since the placement is chosen when the library starts.
+"""
+import argparse
+import glob
+import os
+import subprocess
+import sys
+import time
+
+
+def num_numa_nodes():
+    return max(1, len(glob.glob('/sys/devices/system/node/node[0-9]*')))
+
+
+def measure_cost(repeat, func, *args):
+    """Measure the time cost of running a function"""
+    import mxnet as mx
+    func(*args)
+    mx.nd.waitall()
+    start = time.time()
+    for _ in range(repeat):
+        func(*args)
+    mx.nd.waitall()
+    return (time.time() - start) / repeat
+
+
+def run_workload(num_contexts, gemm_size, elemwise_size, repeat):
+    import mxnet as mx
+    ctxs = [mx.cpu(i) for i in range(num_contexts)]
+    a = [mx.nd.random.uniform(shape=(gemm_size, gemm_size), ctx=c) for c in ctxs]
+    x = [mx.nd.random.uniform(shape=(elemwise_size,), ctx=c) for c in ctxs]
+    y = [mx.nd.random.uniform(shape=(elemwise_size,), ctx=c) for c in ctxs]
+
+    def gemm():
+        for m in a:
+            mx.nd.dot(m, m)
+
+    def elemwise():
+        for u, v in zip(x, y):
+            u * 2 + v
+
+    gemm_time = measure_cost(repeat, gemm)
+    elemwise_time = measure_cost(repeat, elemwise)
+    gflops = num_contexts * 2 * gemm_size ** 3 / gemm_time / 1e9
+    # two reads and one write of float32 for each of the two operators
+    gbytes = num_contexts * 2 * 3 * 4 * elemwise_size / elemwise_time / 1e9
+    print('  GEMM {}x{}: {:.1f} GFLOP/s, elementwise {}: {:.1f} GB/s'.format(
+        gemm_size, gemm_size, gflops, elemwise_size, gbytes))
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--gemm-size', type=int, default=2048)
+    parser.add_argument('--elemwise-size', type=int, default=1 << 26)
+    parser.add_argument('--repeat', type=int, default=10)
+    parser.add_argument('--worker', action='store_true', help=argparse.SUPPRESS)
+    args = parser.parse_args()
+    nodes = num_numa_nodes()
+    if args.worker:
+        run_workload(nodes, args.gemm_size, args.elemwise_size, args.repeat)
+        sys.exit(0)
+
+    print('{} NUMA node(s), one context per node'.format(nodes))
+    for numa_aware in ['0', '1']:
+        print('MXNET_CPU_NUMA_AWARE={}'.format(numa_aware))
+        env = dict(os.environ, MXNET_CPU_NUMA_AWARE=numa_aware,
+                   MXNET_CPU_WORKER_NTHREADS=os.environ.get('MXNET_CPU_WORKER_NTHREADS', '1'))
+        sys.stdout.flush()
+        subprocess.check_call([sys.executable, __file__, '--worker',
+                               '--gemm-size', str(args.gemm_size),
+                               '--elemwise-size', str(args.elemwise_size),
+                               '--repeat', str(args.repeat)], env=env)
@@ -0,0 +1,110 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""Optimizer step time on CPU of the multi-tensor updates on the parameters of
+a BERT encoder, with one multi-tensor op for all the parameters versus one op
+per parameter.
+
+The parameter list mixes one large embedding matrix with hundreds of small
+biases and layer norm parameters, so the step time shows how well the updates
+spread skewed tensor sizes over the threads.
+"""
+import argparse
+import time
+
+import numpy as np
+import mxnet as mx
+
+
+def bert_shapes(num_layers, units, hidden_size, vocab_size, max_length):
+    shapes = [(vocab_size, units), (max_length, units), (2, units), (units,), (units,)]
+    for _ in range(num_layers):
+        shapes += [(3 * units, units), (3 * units,), (units, units), (units,),
+                   (units,), (units,),
+                   (hidden_size, units), (hidden_size,), (units, hidden_size), (units,),
+                   (units,), (units,)]
+    shapes += [(units, units), (units,)]
+    return shapes
+
+
+def multi_tensor_update(op, multi_precision, weights, grads, states, weights32):
+    n = len(weights)
+    lrs, wds = [1e-3] * n, [1e-2] * n
+    arrays = [weights, grads] + states + ([weights32] if multi_precision else [])
+    mp = 'mp_' if multi_precision else ''
+    if op in ('sgd', 'sgd_mom'):
+        flat = [a for group in zip(*arrays) for a in group]
+        kwargs = {'momentum': 0.9} if op == 'sgd_mom' else {}
+        getattr(mx.nd, 'multi_{}{}_update'.format(mp, op))(
+            *flat, out=weights, num_weights=n, lrs=lrs, wds=wds, **kwargs)
+    elif op == 'adamw':
+        getattr(mx.nd.contrib, 'multi_{}adamw_update'.format(mp))(
+            *arrays, 1.0, lrs=lrs, wds=wds, etas=[1.0] * n, out=weights)
+    else:
+        getattr(mx.nd.contrib, 'multi_{}lamb_update'.format(mp))(
+            *arrays, step_count=[1] * n, lrs=lrs, wds=wds, out=weights)
+
+
+def run(op, multi_precision, shapes, per_parameter, repeat):
+    dtype = 'float16' if multi_precision else 'float32'
+    num_states = {'sgd': 0, 'sgd_mom': 1, 'adamw': 2, 'lamb': 2}[op]
+    weights32 = [mx.nd.random.uniform(shape=s) for s in shapes]
+    weights = [w.astype(dtype) for w in weights32]
+    grads = [mx.nd.random.uniform(shape=s, dtype=dtype) for s in shapes]
+    states = [[mx.nd.zeros(s) for s in shapes] for _ in range(num_states)]
+
+    def step():
+        if per_parameter:
+            for i in range(len(shapes)):
+                multi_tensor_update(op, multi_precision, weights[i:i + 1], grads[i:i + 1],
+                                    [state[i:i + 1] for state in states], weights32[i:i + 1])
+        else:
+            multi_tensor_update(op, multi_precision, weights, grads, states, weights32)
+
+    step()
+    mx.nd.waitall()
+    start = time.time()
+    for _ in range(repeat):
+        step()
+    mx.nd.waitall()
+    return (time.time() - start) / repeat * 1000
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--ops', type=str, default='sgd,sgd_mom,adamw,lamb',
+                        help='comma separated optimizer updates')
+    parser.add_argument('--num-layers', type=int, default=12)
+    parser.add_argument('--units', type=int, default=768)
+    parser.add_argument('--hidden-size', type=int, default=3072)
+    parser.add_argument('--vocab-size', type=int, default=30522)
+    parser.add_argument('--max-length', type=int, default=512)
+    parser.add_argument('--repeat', type=int, default=10)
+    args = parser.parse_args()
+
+    shapes = bert_shapes(args.num_layers, args.units, args.hidden_size,
+                         args.vocab_size, args.max_length)
+    num_elements = sum(int(np.prod(s)) for s in shapes)
+    print('{} parameters, {:.1f}M elements'.format(len(shapes), num_elements / 1e6))
+    print('{:>8} {:>6} {:>20} {:>20}'.format('op', 'mp', 'per parameter (ms)',
+                                             'multi-tensor (ms)'))
+    for op in args.ops.split(','):
+        for multi_precision in [False, True]:
+            single = run(op, multi_precision, shapes, True, args.repeat)
+            fused = run(op, multi_precision, shapes, False, args.repeat)
+            print('{:>8} {:>6} {:>20.2f} {:>20.2f}'.format(op, str(multi_precision),
+                                                           single, fused))
@@ -852,6 +852,7 @@ unittest_cpp() {
     set -ex
     export DMLC_LOG_STACK_TRACE_DEPTH=100
     build/tests/mxnet_unit_tests
+    build/tests/mxnet_storage_thread_cache_tests
 }
 
 unittest_centos7_cpu() {
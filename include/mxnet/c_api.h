@@ -71,6 +71,8 @@ typedef const void *FunctionHandle;
 typedef void *AtomicSymbolCreator;
 /*! \brief handle to cached operator */
 typedef void *CachedOpHandle;
+/*! \brief handle to a batcher of requests to a cached operator */
+typedef void *CachedOpBatcherHandle;
 /*! \brief handle to a symbol that can be bind as operator */
 typedef void *SymbolHandle;
 /*! \brief handle to a AtomicSymbol */
@@ -1354,6 +1356,98 @@ MXNET_DLL int MXInvokeCachedOp(CachedOpHandle handle,
                                NDArrayHandle **outputs,
                                const int** out_stypes);
 
+/*!
+ * \brief run inference and memory planning of a cached op ahead of time for the
+ *  shapes, types and storage types of the given inputs, whose content is not read
+ * \param handle the handle to the cached op
+ * \param num_inputs number of input NDArrays
+ * \param inputs input NDArrays
+ * \param default_dev_type the default context type
+ * \param default_dev_id the default context device id
+ * \param for_training whether to plan the graph used when recording for autograd
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXCachedOpWarmup(CachedOpHandle handle,
+                               int num_inputs,
+                               NDArrayHandle *inputs,
+                               int default_dev_type,
+                               int default_dev_id,
+                               bool for_training);
+
+/*!
+ * \brief get the counters of the plan caches of a cached op
+ * \param handle the handle to the cached op
+ * \param hits forward and backward calls which reused the inferred attributes and plans
+ * \param misses forward and backward calls which ran inference and memory planning
+ * \param compile_time_us time spent in inference and memory planning on misses
+ * \param memory_bytes memory planned by the cached input signatures
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXCachedOpGetPlanCacheStats(CachedOpHandle handle,
+                                          uint64_t *hits,
+                                          uint64_t *misses,
+                                          uint64_t *compile_time_us,
+                                          int64_t *memory_bytes);
+
+/*!
+ * \brief create a batcher which coalesces single-sample requests from many
+ *  threads into batched forwards of a cached op
+ * \param handle the cached op
+ * \param num_inputs number of inputs of the cached op
+ * \param inputs inputs of the cached op, NULL for the data inputs which are batched
+ * \param dev_type device type of the batches
+ * \param dev_id device id of the batches
+ * \param num_flags number of flags
+ * \param keys keys of the flags: max_batch_size, max_latency_us and batch_sizes
+ * \param vals values of the flags
+ * \param out the batcher
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXCreateCachedOpBatcher(CachedOpHandle handle,
+                                      int num_inputs,
+                                      NDArrayHandle *inputs,
+                                      int dev_type,
+                                      int dev_id,
+                                      int num_flags,
+                                      const char** keys,
+                                      const char** vals,
+                                      CachedOpBatcherHandle *out);
+/*!
+ * \brief free a batcher after running its queued requests
+ */
+MXNET_DLL int MXFreeCachedOpBatcher(CachedOpBatcherHandle handle);
+/*!
+ * \brief submit a request to a batcher and wait for its outputs, may be called
+ *  from many threads at the same time
+ * \param handle the batcher
+ * \param num_data number of data inputs
+ * \param data one sample of every data input, without the batch axis
+ * \param num_outputs number of outputs
+ * \param outputs rows of the outputs for the request, views of the batch outputs
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXCachedOpBatcherInvoke(CachedOpBatcherHandle handle,
+                                      int num_data,
+                                      NDArrayHandle *data,
+                                      int *num_outputs,
+                                      NDArrayHandle **outputs);
+/*!
+ * \brief get the counters of a batcher
+ * \param handle the batcher
+ * \param num_requests number of requests run
+ * \param num_batches number of batches run
+ * \param num_padded number of padding rows added to the batches
+ * \param latency_us total time of the requests from submission to outputs ready
+ * \param busy_us time spent running batches
+ * \return 0 when success, -1 when failure happens
+ */
+MXNET_DLL int MXCachedOpBatcherGetStats(CachedOpBatcherHandle handle,
+                                        uint64_t *num_requests,
+                                        uint64_t *num_batches,
+                                        uint64_t *num_padded,
+                                        uint64_t *latency_us,
+                                        uint64_t *busy_us);
+
 /*!
  * \brief cached op set monitor callback
  */
@@ -273,6 +273,28 @@ class MXNET_API Engine {
       }, exec_ctx, const_vars, mutable_vars, prop, priority, opr_name);
   }
 
+  /*!
+   * \brief Execute a synchronous operation on the calling thread, if no
+   *  operation pushed to the engine is pending on any of its variables.
+   *
+   *  When executed, the operation behaves as if it was pushed with PushSync and
+   *  waited for. Operations pushed meanwhile by other threads wait for it, and
+   *  its exceptions are rethrown when waiting for the variables it mutates.
+   *  Engines that cannot tell whether the variables are idle never execute.
+   *
+   * \param exec_fn Execution function that executes the operation.
+   * \param exec_ctx Execution context.
+   * \param const_vars The variables that current operation will use but not
+   *                   mutate.
+   * \param mutable_vars The variables that current operation will mutate.
+   * \return Whether the operation was executed. If not, the caller should push it.
+   */
+  virtual bool TryRunInline(SyncFn exec_fn, Context exec_ctx,
+                            std::vector<VarHandle> const& const_vars,
+                            std::vector<VarHandle> const& mutable_vars) {
+    return false;
+  }
+
   /*!
    * \brief factory function to create OnComplete callback.
    * \param callback th static callback function.
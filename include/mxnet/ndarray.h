@@ -76,6 +76,10 @@ enum NDArrayFormatErr {
 
 class MKLDNNMemory;
 
+namespace common {
+class MappedFile;
+}  // namespace common
+
 /*!
  * \brief ndarray interface
  */
@@ -842,8 +846,28 @@ class NDArray {
   static void Load(dmlc::Stream* fi,
                    std::vector<NDArray>* data,
                    std::vector<std::string>* keys);
+  /*!
+   * \brief Load list of ndarray from a local file by memory mapping it.
+   *  Dense arrays alias the pages of the file instead of being copied, when their
+   *  data is suitably aligned. The mapping is private, so that modifying an
+   *  array copies the touched pages and never changes the file.
+   * \param fname The name of the local file.
+   * \param data the NDArrays to be loaded
+   * \param keys the name of the NDArray, if saved in the file.
+   */
+  static void LoadMapped(const std::string& fname,
+                         std::vector<NDArray>* data,
+                         std::vector<std::string>* keys);
 
  private:
+  /*!
+   * \brief load the content from binary stream
+   * \param strm the input stream. If mapping is not null, it must be a
+   *  dmlc::SeekStream whose position 0 is the start of the mapping.
+   * \param mapping the memory mapped file, which the loaded data may alias
+   * \return whether the load is successful
+   */
+  bool Load(dmlc::Stream *strm, const std::shared_ptr<common::MappedFile> &mapping);
   friend class Imperative;
   /*! \brief the real data chunk that backs NDArray */
   // shandle is used to store the actual values in the NDArray
@@ -267,5 +267,27 @@ class ResourceManager {
    */
   static ResourceManager *Get();
 };
+
+/*!
+ * \brief Execution of an operator on the current thread.
+ *  With MXNET_CPU_TEMP_ARENA set, the CPU temp space which is requested in
+ *  the scope is taken from a stack-like arena of the thread instead of the
+ *  shared temp space copies, and goes back to the arena when the scope ends.
+ *  The engines open a scope around the execution of every operator.
+ */
+class TempSpaceScope {
+ public:
+  /*!
+   * \param use_arena whether the temp space of the operator may be taken from
+   *  the arena. Must be false if the operator can still use its temp space
+   *  after the scope ends, e.g. if it completes asynchronously.
+   */
+  explicit TempSpaceScope(bool use_arena);
+  ~TempSpaceScope();
+
+ private:
+  /*! \brief whether the scope was entered in the arena */
+  bool entered_;
+};
 }  // namespace mxnet
 #endif  // MXNET_RESOURCE_H_
@@ -24,7 +24,7 @@ import ctypes
 
 from ..base import _LIB
 from ..base import c_str_array, c_handle_array
-from ..base import NDArrayHandle, CachedOpHandle, SymbolHandle
+from ..base import NDArrayHandle, CachedOpHandle, CachedOpBatcherHandle, SymbolHandle
 from ..base import check_call
 from .. import _global_var
 
@@ -190,6 +190,56 @@ class CachedOp(object):
             return [create_ndarray_fn(ctypes.cast(output_vars[i], NDArrayHandle),
                                       stype=out_stypes[i]) for i in range(num_output.value)]
 
+    def warmup(self, *args, **kwargs):
+        """Run shape inference and memory planning ahead of time for the shapes, types
+        and storage types of the inputs, so that a later call with inputs of the same
+        signature does not run them. The inputs only provide their attributes, their
+        content is not read, e.g. arrays created by `mx.nd.empty`.
+
+        Parameters
+        ----------
+        *args : NDArray
+            Inputs of the same signature as the inputs of a later call.
+        default_ctx : Context, optional
+            Context of the call, defaults to the context of the first input.
+        for_training : bool, default False
+            Whether to plan the graph used when recording for autograd.
+        """
+        default_ctx = kwargs.pop('default_ctx', None)
+        for_training = kwargs.pop('for_training', False)
+        if kwargs:
+            raise TypeError(
+                "CachedOp.warmup got unexpected keyword argument(s): " + \
+                ', '.join(kwargs.keys()))
+        default_ctx = args[0].ctx if default_ctx is None else default_ctx
+        check_call(_LIB.MXCachedOpWarmup(
+            self.handle,
+            ctypes.c_int(len(args)),
+            c_handle_array(args),
+            ctypes.c_int(default_ctx.device_typeid),
+            ctypes.c_int(default_ctx.device_id),
+            ctypes.c_bool(for_training)))
+
+    def plan_cache_stats(self):
+        """Counters of the plan caches, also reported to the profiler.
+
+        Returns
+        -------
+        dict
+            hits and misses of the forward and backward calls, compile_time_us spent
+            in inference and memory planning on misses, and memory_bytes planned by
+            the cached input signatures.
+        """
+        hits = ctypes.c_uint64()
+        misses = ctypes.c_uint64()
+        compile_time_us = ctypes.c_uint64()
+        memory_bytes = ctypes.c_int64()
+        check_call(_LIB.MXCachedOpGetPlanCacheStats(
+            self.handle, ctypes.byref(hits), ctypes.byref(misses),
+            ctypes.byref(compile_time_us), ctypes.byref(memory_bytes)))
+        return {'hits': hits.value, 'misses': misses.value,
+                'compile_time_us': compile_time_us.value, 'memory_bytes': memory_bytes.value}
+
     def _register_op_hook(self, callback, monitor_all=False):
         """Install callback for monitor.
 
@@ -207,3 +257,98 @@ class CachedOp(object):
             self.handle,
             self._monitor_callback,
             ctypes.c_int(monitor_all)))
+
+
+class CachedOpBatcher(object):
+    """Batches single-sample requests from many threads into forwards of a CachedOp.
+
+    The requests are queued and run by a worker thread of the backend: the requests
+    whose samples have the same shapes and types are coalesced into a batch, which
+    runs once it has `max_batch_size` requests or its oldest request waited for
+    `max_latency_us`. The batch is padded to the next of `batch_sizes`, so that the
+    CachedOp only sees a few input shapes. Every request gets its rows of the batch
+    outputs, views of them which are not copied.
+
+    Parameters
+    ----------
+    op : CachedOp
+        Operator run on the batches, the batch axis is the first axis of its data
+        inputs and outputs.
+    inputs : list of NDArray or None
+        Inputs of the operator, None for the data inputs which are batched.
+    ctx : Context, optional
+        Context of the batches, defaults to the current context.
+    max_batch_size : int, default 32
+        Maximum number of requests run in one forward.
+    max_latency_us : int, default 1000
+        Maximum time in microseconds a request waits for more requests.
+    batch_sizes : list of int, optional
+        Increasing batch sizes the batches are padded to, ending with `max_batch_size`.
+        Defaults to the powers of two up to `max_batch_size`.
+    """
+    __slots__ = ["handle"]
+
+    def __init__(self, op, inputs, ctx=None, max_batch_size=32, max_latency_us=1000,
+                 batch_sizes=None):
+        from ..context import current_context
+        ctx = current_context() if ctx is None else ctx
+        self.handle = CachedOpBatcherHandle()
+        flags = [('max_batch_size', max_batch_size), ('max_latency_us', max_latency_us)]
+        if batch_sizes is not None:
+            flags.append(('batch_sizes', tuple(batch_sizes)))
+        input_handles = (NDArrayHandle * len(inputs))()
+        input_handles[:] = [None if arr is None else arr.handle for arr in inputs]
+        check_call(_LIB.MXCreateCachedOpBatcher(
+            op.handle,
+            ctypes.c_int(len(inputs)),
+            input_handles,
+            ctypes.c_int(ctx.device_typeid),
+            ctypes.c_int(ctx.device_id),
+            len(flags),
+            c_str_array([key for key, _ in flags]),
+            c_str_array([str(val) for _, val in flags]),
+            ctypes.byref(self.handle)))
+
+    def __del__(self):
+        check_call(_LIB.MXFreeCachedOpBatcher(self.handle))
+
+    def __call__(self, *data):
+        """Submits a request and waits for its outputs, may be called from many threads.
+
+        Parameters
+        ----------
+        *data : NDArray
+            One sample of every data input, without the batch axis.
+
+        Returns
+        -------
+        NDArray or list of NDArray
+            The rows of the outputs for the request.
+        """
+        num_output = ctypes.c_int(0)
+        output_vars = ctypes.POINTER(NDArrayHandle)()
+        check_call(_LIB.MXCachedOpBatcherInvoke(
+            self.handle,
+            ctypes.c_int(len(data)),
+            c_handle_array(data),
+            ctypes.byref(num_output),
+            ctypes.byref(output_vars)))
+        outputs = [_global_var._ndarray_cls(ctypes.cast(output_vars[i], NDArrayHandle))
+                   for i in range(num_output.value)]
+        return outputs[0] if len(outputs) == 1 else outputs
+
+    def stats(self):
+        """Counters of the batcher, also reported to the profiler.
+
+        Returns
+        -------
+        dict
+            num_requests and num_batches run, num_padded rows added to the batches,
+            latency_us summed over the requests from submission to outputs ready and
+            busy_us spent running batches.
+        """
+        counters = [ctypes.c_uint64() for _ in range(5)]
+        check_call(_LIB.MXCachedOpBatcherGetStats(
+            self.handle, *[ctypes.byref(c) for c in counters]))
+        names = ['num_requests', 'num_batches', 'num_padded', 'latency_us', 'busy_us']
+        return {name: c.value for name, c in zip(names, counters)}
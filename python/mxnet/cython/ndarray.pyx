@@ -106,7 +106,7 @@ cdef class CachedOp:
     cdef int is_np_sym
     cdef readonly object mhandle
 
-    def __init__(self, sym, flags=()):
+    def __init__(self, sym, flags=(), thread_safe=False):
         cdef vector[string] s_flag_keys
         cdef vector[string] s_flag_vals
         if flags is not None:
@@ -125,7 +125,7 @@ cdef class CachedOp:
             CBeginPtr(c_flag_keys),
             CBeginPtr(c_flag_vals),
             &self.chandle,
-            False))
+            bool(thread_safe)))
 
     def __del__(self):
         CALL(MXFreeCachedOp(self.chandle))
@@ -195,6 +195,35 @@ cdef class CachedOp:
         else:
             return [NewArray(p_output_vars[i], p_output_stypes[i], self.is_np_sym) for i in range(num_output)]
 
+    def warmup(self, *args, default_ctx=None, for_training=False):
+        """Run shape inference and memory planning ahead of time for the shapes, types
+        and storage types of the inputs, so that a later call with inputs of the same
+        signature does not run them. The inputs only provide their attributes, their
+        content is not read, e.g. arrays created by `mx.nd.empty`.
+        """
+        default_ctx = args[0].ctx if default_ctx is None else default_ctx
+        chandle = _ctypes.cast(<unsigned long long>self.chandle, _ctypes.c_void_p)
+        handles = (_ctypes.c_void_p * len(args))(*[i.handle.value for i in args])
+        CALL(_LIB.MXCachedOpWarmup(chandle,
+                                   _ctypes.c_int(len(args)),
+                                   handles,
+                                   _ctypes.c_int(default_ctx.device_typeid),
+                                   _ctypes.c_int(default_ctx.device_id),
+                                   _ctypes.c_bool(for_training)))
+
+    def plan_cache_stats(self):
+        """Counters of the plan caches, also reported to the profiler."""
+        hits = _ctypes.c_uint64()
+        misses = _ctypes.c_uint64()
+        compile_time_us = _ctypes.c_uint64()
+        memory_bytes = _ctypes.c_int64()
+        chandle = _ctypes.cast(<unsigned long long>self.chandle, _ctypes.c_void_p)
+        CALL(_LIB.MXCachedOpGetPlanCacheStats(chandle, _ctypes.byref(hits), _ctypes.byref(misses),
+                                              _ctypes.byref(compile_time_us),
+                                              _ctypes.byref(memory_bytes)))
+        return {'hits': hits.value, 'misses': misses.value,
+                'compile_time_us': compile_time_us.value, 'memory_bytes': memory_bytes.value}
+
     def _register_op_hook(self, callback, monitor_all=False):
         cb_type = _ctypes.CFUNCTYPE(None, _ctypes.c_char_p, _ctypes.c_char_p, _ctypes.c_void_p, _ctypes.c_void_p)
         if callback:
@@ -1424,7 +1424,8 @@ class HybridBlock(Block):
                   static_shape=False,
                   inline_limit=2,
                   forward_bulk_size=None,
-                  backward_bulk_size=None):
+                  backward_bulk_size=None,
+                  plan_cache_max_mb=None):
         """Activates or deactivates :py:class:`HybridBlock` s recursively. Has no effect on
         non-hybrid children.
 
@@ -1446,6 +1447,9 @@ class HybridBlock(Block):
             Segment size of bulk execution during forward pass.
         backward_bulk_size : optional int, default None
             Segment size of bulk execution during backward pass.
+        plan_cache_max_mb : optional int, default None
+            Maximum memory in MB planned by the input signatures whose inferred
+            attributes and memory plans are cached, see `warmup`. No limit by default.
         """
 
         self._active = active
@@ -1456,6 +1460,8 @@ class HybridBlock(Block):
             self._flags.append(("forward_bulk_size", forward_bulk_size))
         if backward_bulk_size is not None:
             self._flags.append(("backward_bulk_size", backward_bulk_size))
+        if plan_cache_max_mb is not None:
+            self._flags.append(("plan_cache_max_mb", plan_cache_max_mb))
         self._clear_cached_op()
         if active and self._forward_hooks or self._forward_pre_hooks:
             warnings.warn('"{block}" is being hybridized while still having forward hook/pre-hook. '
@@ -1466,7 +1472,40 @@ class HybridBlock(Block):
                                            static_shape=static_shape,
                                            inline_limit=inline_limit,
                                            forward_bulk_size=forward_bulk_size,
-                                           backward_bulk_size=backward_bulk_size)
+                                           backward_bulk_size=backward_bulk_size,
+                                           plan_cache_max_mb=plan_cache_max_mb)
+
+    def warmup(self, *signatures, for_training=False):
+        """Runs shape inference and memory planning of the hybridized block ahead of
+        time for several input signatures, e.g. when loading a model for serving, so
+        that the first call with each of them does not run them. With static_alloc,
+        the memory is also grown to fit every signature. The block must have been
+        called once after `hybridize`.
+
+        Parameters
+        ----------
+        *signatures : NDArray or tuple of NDArray
+            Inputs of each signature. They only provide their shapes, types and storage
+            types, their content is not read, e.g. arrays created by `mx.nd.empty`.
+        for_training : bool, default False
+            Whether to plan the graph used when recording for autograd.
+        """
+        if not self._active or self._cached_op is None:
+            raise RuntimeError("warmup requires a hybridized block which was called once")
+        for args in signatures:
+            if not isinstance(args, (list, tuple)):
+                args = (args,)
+            args, _ = _flatten(args, "input")
+            args_without_none = [ele for ele in args if ele is not None]
+            cargs = [args_without_none[i] if is_arg else i.data()
+                     for is_arg, name, i in self._cached_op_args]
+            self._cached_op.warmup(*cargs, for_training=for_training)
+
+    def plan_cache_stats(self):
+        """Counters of the plan caches of the hybridized block, see `CachedOp.plan_cache_stats`."""
+        if self._cached_op is None:
+            raise RuntimeError("plan_cache_stats requires a hybridized block which was called once")
+        return self._cached_op.plan_cache_stats()
 
     def cast(self, dtype):
         if self._active:
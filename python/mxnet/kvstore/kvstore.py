@@ -513,10 +513,11 @@ class KVStore(KVStoreBase):
         original values is stored at the sender's end as residual and added to the
         gradient in the next iteration.
 
-        When kvstore is 'local', gradient compression is used to reduce communication
+        When kvstore is 'device', gradient compression is used to reduce communication
         between multiple devices (gpus). Gradient is quantized on each GPU which
         computed the gradients, then sent to the GPU which merges the gradients. This
-        receiving GPU dequantizes the gradients and merges them. Note that this
+        receiving GPU dequantizes the gradients and merges them. When kvstore is 'local',
+        the quantized gradients are sent to the CPU, which dequantizes and merges them. Note that this
         increases memory usage on each GPU because of the residual array stored.
 
         When kvstore is 'dist', gradient compression is used to reduce communication
@@ -535,17 +536,27 @@ class KVStore(KVStoreBase):
         a dictionary which includes `threshold` like:
         {'type': '2bit', 'threshold': 0.5}
 
+        1bit Gradient Compression sends only the sign of each value, which is
+        dequantized to `threshold` or to the negative of `threshold`, and keeps the
+        difference as residual. Every 32 float values are represented using one float:
+        {'type': '1bit', 'threshold': 0.5}
+
+        topk Gradient Compression sends only the value with the largest magnitude of
+        every block of `block_size` values, in half precision, and keeps the other values
+        as residual. Every `block_size` float values are represented using one float:
+        {'type': 'topk', 'block_size': 64}
+
         Parameters
         ----------
         compression_params : dict
             A dictionary specifying the type and parameters for gradient compression.
             The key `type` in this dictionary is a
             required string argument and specifies the type of gradient compression.
-            Currently `type` can be only `2bit`
+            Currently `type` can be `2bit`, `1bit` or `topk`
             Other keys in this dictionary are optional and specific to the type
             of gradient compression.
         """
-        if ('device' in self.type) or ('dist' in self.type): # pylint: disable=unsupported-membership-test
+        if ('device' in self.type) or ('dist' in self.type) or (self.type == 'local'): # pylint: disable=unsupported-membership-test
             ckeys, cvals = _ctype_dict(compression_params)
             check_call(_LIB.MXKVStoreSetGradientCompression(self.handle,
                                                             mx_uint(len(compression_params)),
@@ -19,9 +19,10 @@
 # pylint: disable=wildcard-import, unused-wildcard-import, redefined-builtin
 """Backend ops in mxnet.ndarray namespace"""
 from ._internal import CachedOp
+from .._ctypes.ndarray import CachedOpBatcher
 try:
     from .gen_op import * # pylint: disable=unused-wildcard-import
 except ImportError:
     pass
 
-__all__ = ['CachedOp']
+__all__ = ['CachedOp', 'CachedOpBatcher']
@@ -57,6 +57,17 @@ def set_config(**kwargs):
     aggregate_stats : boolean,
         whether to maintain aggregate stats in memory for console
         dump.  Has some negative performance impact.
+    max_file_size : int
+        with continuous dump, write the profile to a rolling set of files
+        (profile.0.json, profile.1.json, ...), each a complete trace
+        closed once it reaches this many bytes. 0 writes a single file.
+    max_files : int
+        number of most recent files of the rolling set to keep, 0 keeps all.
+    max_pending_records : int
+        maximum number of records held in memory until they are dumped,
+        further records are dropped. 0 for no limit.
+    sample_rate : int
+        record one in this many operator executions of each thread.
     profile_process : string
         whether to profile kvstore `server` or `worker`.
         server can only be profiled when kvstore is of type dist.
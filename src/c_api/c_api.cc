@@ -1973,9 +1973,12 @@ int MXNDArrayLoad(const char* fname,
       CHECK_EQ(strm->Read(&magic, sizeof(uint32_t)), sizeof(uint32_t))
         << "Failed to read 32 bits from file.";
   }
+  // Memory map local files, so that the loaded arrays alias the page cache
+  const bool mapped = dmlc::GetEnv("MXNET_NDARRAY_LOAD_MMAP", false) &&
+                      std::string(fname).find("://") == std::string::npos;
 
   if (magic == 0x04034b50 || magic == 0x504b0304) {  // zip file format; assumed to be npz
-      auto[data, names] = npz::load_arrays(fname);
+      auto[data, names] = npz::load_arrays(fname, mapped);
       ret->ret_handles.resize(data.size());
       for (size_t i = 0; i < data.size(); ++i) {
           NDArray *ptr = new NDArray();
@@ -1998,13 +2001,16 @@ int MXNDArrayLoad(const char* fname,
       *out_size = 1;
       ret->ret_handles.resize(1);
       NDArray *ptr = new NDArray();
-      *ptr = npy::load_array(fname);  // Only supports local filesystem at this point in time
+      // Only supports local filesystem at this point in time
+      *ptr = mapped ? npy::load_array_mapped(fname) : npy::load_array(fname);
       ret->ret_handles[0] = ptr;
       *out_arr = dmlc::BeginPtr(ret->ret_handles);
   } else {
       std::vector<NDArray> data;
       std::vector<std::string> &names = ret->ret_vec_str;
-      {
+      if (mapped) {
+          mxnet::NDArray::LoadMapped(fname, &data, &names);
+      } else {
           std::unique_ptr<dmlc::Stream> fi(dmlc::Stream::Create(fname, "r"));
           mxnet::NDArray::Load(fi.get(), &data, &names);
       }
@@ -38,6 +38,7 @@
 #include "../imperative/imperative_utils.h"
 #include "../imperative/cached_op.h"
 #include "../imperative/cached_op_threadsafe.h"
+#include "../imperative/cached_op_batcher.h"
 #include "../profiler/profiler.h"
 
 using namespace mxnet;
@@ -398,6 +399,111 @@ int MXAutogradGetSymbol(NDArrayHandle handle, SymbolHandle *out) {
   API_END();
 }
 
+int MXCachedOpWarmup(CachedOpHandle handle,
+                     int num_inputs,
+                     NDArrayHandle *inputs,
+                     int default_dev_type,
+                     int default_dev_id,
+                     bool for_training) {
+  API_BEGIN();
+  CachedOpPtr op = *static_cast<CachedOpPtr*>(handle);
+  std::vector<NDArray*> ndinputs;
+  ndinputs.reserve(num_inputs);
+  for (int i = 0; i < num_inputs; ++i) {
+    ndinputs.push_back(reinterpret_cast<NDArray*>(inputs[i]));
+  }
+  Context ctx = Context::Create(static_cast<Context::DeviceType>(default_dev_type),
+                                default_dev_id);
+  op->Warmup(ndinputs, ctx, for_training);
+  API_END();
+}
+
+int MXCachedOpGetPlanCacheStats(CachedOpHandle handle,
+                                uint64_t *hits,
+                                uint64_t *misses,
+                                uint64_t *compile_time_us,
+                                int64_t *memory_bytes) {
+  API_BEGIN();
+  CachedOpPtr op = *static_cast<CachedOpPtr*>(handle);
+  const auto& stats = op->plan_cache_stats();
+  *hits = stats.hits;
+  *misses = stats.misses;
+  *compile_time_us = stats.compile_time_us;
+  *memory_bytes = stats.memory_bytes;
+  API_END();
+}
+
+int MXCreateCachedOpBatcher(CachedOpHandle handle,
+                            int num_inputs,
+                            NDArrayHandle *inputs,
+                            int dev_type,
+                            int dev_id,
+                            int num_flags,
+                            const char** keys,
+                            const char** vals,
+                            CachedOpBatcherHandle *out) {
+  API_BEGIN();
+  CachedOpPtr op = *static_cast<CachedOpPtr*>(handle);
+  std::vector<NDArray> ndinputs(num_inputs);
+  for (int i = 0; i < num_inputs; ++i) {
+    if (inputs[i] != nullptr) ndinputs[i] = *static_cast<NDArray*>(inputs[i]);
+  }
+  std::vector<std::pair<std::string, std::string> > flags;
+  flags.reserve(num_flags);
+  for (int i = 0; i < num_flags; ++i) {
+    flags.emplace_back(keys[i], vals[i]);
+  }
+  Context ctx = Context::Create(static_cast<Context::DeviceType>(dev_type), dev_id);
+  *out = new CachedOpBatcher(op, ndinputs, ctx, flags);
+  API_END();
+}
+
+int MXFreeCachedOpBatcher(CachedOpBatcherHandle handle) {
+  API_BEGIN();
+  delete static_cast<CachedOpBatcher*>(handle);
+  API_END();
+}
+
+int MXCachedOpBatcherInvoke(CachedOpBatcherHandle handle,
+                            int num_data,
+                            NDArrayHandle *data,
+                            int *num_outputs,
+                            NDArrayHandle **outputs) {
+  MXAPIThreadLocalEntry<> *ret = MXAPIThreadLocalStore<>::Get();
+  API_BEGIN();
+  CachedOpBatcher* batcher = static_cast<CachedOpBatcher*>(handle);
+  std::vector<NDArray> nddata;
+  nddata.reserve(num_data);
+  for (int i = 0; i < num_data; ++i) {
+    nddata.push_back(*static_cast<NDArray*>(data[i]));
+  }
+  std::vector<NDArray> ndoutputs = batcher->Invoke(nddata);
+  ret->ret_handles.clear();
+  ret->ret_handles.reserve(ndoutputs.size());
+  for (auto& output : ndoutputs) {
+    ret->ret_handles.push_back(new NDArray(std::move(output)));
+  }
+  *num_outputs = ret->ret_handles.size();
+  *outputs = dmlc::BeginPtr(ret->ret_handles);
+  API_END();
+}
+
+int MXCachedOpBatcherGetStats(CachedOpBatcherHandle handle,
+                              uint64_t *num_requests,
+                              uint64_t *num_batches,
+                              uint64_t *num_padded,
+                              uint64_t *latency_us,
+                              uint64_t *busy_us) {
+  API_BEGIN();
+  const auto& stats = static_cast<CachedOpBatcher*>(handle)->stats();
+  *num_requests = stats.num_requests;
+  *num_batches = stats.num_batches;
+  *num_padded = stats.num_padded;
+  *latency_us = stats.latency_us;
+  *busy_us = stats.busy_us;
+  API_END();
+}
+
 int MXCachedOpRegisterOpHook(NDArrayHandle handle,
                              CachedOpMonitorCallback callback,
                              bool monitor_all) {
@@ -179,6 +179,10 @@ struct ProfileConfigParam : public dmlc::Parameter<ProfileConfigParam> {
   bool continuous_dump;
   float dump_period;
   bool aggregate_stats;
+  int64_t max_file_size;
+  int max_files;
+  int64_t max_pending_records;
+  int sample_rate;
   int profile_process;
   DMLC_DECLARE_PARAMETER(ProfileConfigParam) {
     DMLC_DECLARE_FIELD(profile_all).set_default(false)
@@ -206,6 +210,20 @@ struct ProfileConfigParam : public dmlc::Parameter<ProfileConfigParam> {
     DMLC_DECLARE_FIELD(aggregate_stats).set_default(false)
       .describe("Maintain aggregate stats, required for MXDumpAggregateStats.  Note that "
       "this can have a negative performance impact. Default is False.");
+    DMLC_DECLARE_FIELD(max_file_size).set_default(0).set_lower_bound(0)
+      .describe("When continuous dump is enabled, write the profile to a rolling set of "
+                "files named after filename, e.g. profile.0.json, profile.1.json, ..., "
+                "each a complete trace closed once it reaches this many bytes. "
+                "Default is 0, write a single file.");
+    DMLC_DECLARE_FIELD(max_files).set_default(0).set_lower_bound(0)
+      .describe("Number of most recent files of the rolling set to keep, older ones are "
+                "deleted. Default is 0, keep all files.");
+    DMLC_DECLARE_FIELD(max_pending_records).set_default(0).set_lower_bound(0)
+      .describe("Maximum number of records held in memory until they are dumped, records "
+                "beyond it are dropped. Default is 0, no limit.");
+    DMLC_DECLARE_FIELD(sample_rate).set_default(1).set_lower_bound(1)
+      .describe("Record one in this many operator executions of each thread. "
+                "Default is 1, record all of them.");
     DMLC_DECLARE_FIELD(profile_process)
       .add_enum("worker", static_cast<int>(ProfileProcess::kWorker))
       .add_enum("server", static_cast<int>(ProfileProcess::kServer))
@@ -264,11 +282,17 @@ int MXSetProcessProfilerConfig(int num_params, const char* const* keys, const ch
       if (param.profile_imperative ||
           param.profile_all) { mode |= profiler::Profiler::kImperative; }
       if (param.profile_memory || param.profile_all)     { mode |= profiler::Profiler::kMemory; }
+      profiler::Profiler::StreamConfig stream;
+      stream.max_file_size = param.max_file_size;
+      stream.max_files = param.max_files;
+      stream.max_pending_records = param.max_pending_records;
+      stream.sample_rate = param.sample_rate;
       profiler::Profiler::Get()->SetConfig(profiler::Profiler::ProfilerMode(mode),
                                            std::string(param.filename),
                                            param.continuous_dump,
                                            param.dump_period,
-                                           param.aggregate_stats);
+                                           param.aggregate_stats,
+                                           stream);
 #if MXNET_USE_CUDA
       profiler::GpuDeviceStorageProfiler::Get()->SetConfig(
           param.gpu_memory_profile_filename_prefix);
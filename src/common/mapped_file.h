@@ -0,0 +1,124 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file mapped_file.h
+ * \brief Private, copy-on-write memory mapping of a local file.
+ */
+#ifndef MXNET_COMMON_MAPPED_FILE_H_
+#define MXNET_COMMON_MAPPED_FILE_H_
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // _WIN32
+
+#include <dmlc/base.h>
+#include <dmlc/logging.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+
+namespace mxnet {
+namespace common {
+
+/*!
+ * \brief Memory mapping of a whole local file.
+ *  The mapping is private: the pages are shared with the page cache (and with
+ *  every other process mapping the same file) until they are written to, at
+ *  which point the kernel copies the touched pages. Writes never reach the file.
+ *  Where mmap is unavailable the file is read into an owned buffer instead.
+ */
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string &fname) {
+#ifndef _WIN32
+    const int fd = open(fname.c_str(), O_RDONLY);
+    CHECK_GE(fd, 0) << "Failed to open " << fname << ": " << strerror(errno);
+    struct stat st;
+    CHECK_EQ(fstat(fd, &st), 0) << "Failed to stat " << fname << ": " << strerror(errno);
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ > 0) {
+      void *ptr = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+      CHECK_NE(ptr, MAP_FAILED) << "Failed to map " << fname << ": " << strerror(errno);
+      data_ = static_cast<char*>(ptr);
+    }
+    close(fd);
+#else
+    std::ifstream strm(fname, std::ios::binary | std::ios::ate);
+    CHECK(strm.is_open()) << "Failed to open " << fname;
+    size_ = static_cast<size_t>(strm.tellg());
+    buffer_.reset(new char[size_ + 1]);
+    strm.seekg(0);
+    strm.read(buffer_.get(), size_);
+    data_ = buffer_.get();
+#endif  // _WIN32
+  }
+
+  ~MappedFile() {
+#ifndef _WIN32
+    if (data_) munmap(data_, size_);
+#endif  // _WIN32
+  }
+
+  /*! \brief start of the mapping */
+  inline char *data() const { return data_; }
+  /*! \brief size of the file */
+  inline size_t size() const { return size_; }
+  /*!
+   * \brief Hint that [offset, offset + nbytes) will be read soon, so that the
+   *  kernel starts reading it in the background.
+   */
+  inline void WillNeed(size_t offset, size_t nbytes) const {
+#ifndef _WIN32
+    if (offset >= size_) return;
+    nbytes = std::min(nbytes, size_ - offset);
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t begin = offset / page * page;
+    madvise(data_ + begin, offset + nbytes - begin, MADV_WILLNEED);
+#endif  // _WIN32
+  }
+  /*!
+   * \brief Whether [offset, offset + nbytes) lies within the file and its
+   *  start is aligned to the given number of bytes.
+   */
+  inline bool CanAlias(size_t offset, size_t nbytes, size_t alignment) const {
+    return offset <= size_ && nbytes <= size_ - offset &&
+           reinterpret_cast<uintptr_t>(data_ + offset) % alignment == 0;
+  }
+
+ private:
+  char *data_ = nullptr;
+  size_t size_ = 0;
+#ifdef _WIN32
+  std::unique_ptr<char[]> buffer_;
+#endif  // _WIN32
+  DISALLOW_COPY_AND_ASSIGN(MappedFile);
+};
+
+}  // namespace common
+}  // namespace mxnet
+
+#endif  // MXNET_COMMON_MAPPED_FILE_H_
@@ -0,0 +1,172 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file numa.h
+ * \brief NUMA topology, thread and memory placement on Linux.
+ */
+#ifndef MXNET_COMMON_NUMA_H_
+#define MXNET_COMMON_NUMA_H_
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif  // __linux__
+
+#include <dmlc/logging.h>
+#include <dmlc/parameter.h>
+#include <mxnet/base.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "./utils.h"
+
+namespace mxnet {
+namespace common {
+
+/*!
+ * \brief NUMA nodes of the machine and placement of threads and memory on them.
+ *  When MXNET_CPU_NUMA_AWARE is set and the machine has several nodes, the
+ *  context cpu(i) is mapped to node i % num_nodes(): the engine workers of cpu(i)
+ *  run on the cores of that node and the memory allocated for cpu(i) is placed on it.
+ *  The topology is read from sysfs and the placement uses raw system calls, so
+ *  no libnuma is needed. On other platforms there is a single node.
+ */
+class NumaTopology {
+ public:
+  static NumaTopology *Get() {
+    static NumaTopology inst;
+    return &inst;
+  }
+  /*! \brief whether threads and memory of cpu contexts are placed on NUMA nodes */
+  inline bool enabled() const { return enabled_; }
+  /*! \brief number of NUMA nodes */
+  inline int num_nodes() const { return static_cast<int>(node_cpus_.size()); }
+  /*! \brief cpus of a node */
+  inline const std::vector<int> &cpus(int node) const { return node_cpus_.at(node); }
+  /*! \brief node of a cpu context */
+  inline int NodeOf(const Context &ctx) const {
+    return ctx.dev_id < 0 ? 0 : ctx.dev_id % num_nodes();
+  }
+  /*!
+   * \brief Restrict the calling thread to the cpus of a node.
+   * \return whether the affinity was set.
+   */
+  bool BindCurrentThread(int node) const {
+#if defined(__linux__)
+    if (cpus(node).empty()) return false;
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    for (int cpu : cpus(node)) CPU_SET(cpu, &cpuset);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset) == 0;
+#else
+    return false;
+#endif  // __linux__
+  }
+  /*!
+   * \brief Ask the kernel to place the pages of a memory range on a node.
+   *  Partial pages at both ends are left alone.
+   */
+  void BindMemory(void *ptr, size_t size, int node) const {
+#if defined(__linux__) && defined(SYS_mbind)
+    const uintptr_t begin = (reinterpret_cast<uintptr_t>(ptr) + page_size_ - 1) /
+                            page_size_ * page_size_;
+    const uintptr_t end = (reinterpret_cast<uintptr_t>(ptr) + size) / page_size_ * page_size_;
+    if (begin >= end) return;
+    // MPOL_PREFERRED rather than MPOL_BIND, so that allocations still
+    // succeed by falling back to other nodes when the node is full.
+    // Pages reused from the heap may have been touched already, MPOL_MF_MOVE
+    // migrates them, the range only covers whole pages of this allocation.
+    const int kMpolPreferred = 1;
+    const unsigned kMpolMfMove = 1 << 1;
+    std::vector<unsigned long> nodemask(node / (8 * sizeof(unsigned long)) + 1, 0);  // NOLINT(*)
+    nodemask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+    const long ret = syscall(SYS_mbind, begin, end - begin, kMpolPreferred,  // NOLINT(*)
+                             nodemask.data(), nodemask.size() * 8 * sizeof(unsigned long) + 1,
+                             kMpolMfMove);
+    if (ret != 0 && !mbind_warned_.exchange(true)) {
+      LOG(WARNING) << "mbind failed, CPU memory is not placed on NUMA nodes";
+    }
+#endif  // __linux__
+  }
+  /*! \brief size of a memory page */
+  inline size_t page_size() const { return page_size_; }
+  /*!
+   * \brief Aligned allocation of memory for a cpu context, placed on the node
+   *  of the context when enabled. Allocations of at least a page are then
+   *  page-aligned, so that no page is shared with memory of another node.
+   */
+  bool AlignedMemAlloc(void **ptr, size_t size, size_t alignment, const Context &ctx) const {
+    const bool bind = enabled_ && size >= page_size_;
+    if (!common::AlignedMemAlloc(ptr, size, bind ? std::max(alignment, page_size_) : alignment)) {
+      return false;
+    }
+    if (bind) BindMemory(*ptr, size, NodeOf(ctx));
+    return true;
+  }
+
+ private:
+  NumaTopology() {
+#if defined(__linux__)
+    page_size_ = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    for (int node = 0; ; ++node) {
+      std::ifstream strm("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+      if (!strm.is_open()) break;
+      std::string cpulist;
+      std::getline(strm, cpulist);
+      node_cpus_.push_back(ParseCpuList(cpulist));
+    }
+#endif  // __linux__
+    if (node_cpus_.empty()) node_cpus_.emplace_back();
+    enabled_ = dmlc::GetEnv("MXNET_CPU_NUMA_AWARE", false) && num_nodes() > 1;
+    if (enabled_) {
+      LOG(INFO) << "Placing CPU workers and memory on " << num_nodes() << " NUMA nodes";
+    }
+  }
+  /*! \brief parse a list of cpus such as "0-15,32-47" */
+  static std::vector<int> ParseCpuList(const std::string &cpulist) {
+    std::vector<int> cpus;
+    std::istringstream strm(cpulist);
+    std::string range;
+    while (std::getline(strm, range, ',')) {
+      if (range.empty()) continue;
+      const size_t dash = range.find('-');
+      const int first = std::stoi(range.substr(0, dash));
+      const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+      for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+    }
+    return cpus;
+  }
+
+  bool enabled_ = false;
+  size_t page_size_ = 4096;
+  std::vector<std::vector<int>> node_cpus_;
+  mutable std::atomic<bool> mbind_warned_{false};
+};
+
+}  // namespace common
+}  // namespace mxnet
+
+#endif  // MXNET_COMMON_NUMA_H_
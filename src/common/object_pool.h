@@ -24,6 +24,7 @@
 #define MXNET_COMMON_OBJECT_POOL_H_
 #include <dmlc/logging.h>
 #include <cstdlib>
+#include <memory>
 #include <mutex>
 #include <utility>
 #include <vector>
@@ -32,6 +33,13 @@ namespace mxnet {
 namespace common {
 /*!
  * \brief Object pool for fast allocation and deallocation.
+ *
+ *  Every thread keeps a cache of free objects, so that New and Delete do not
+ *  take a lock in the common case. Threads exchange free objects with the
+ *  shared pool in batches: an empty cache takes a whole batch, a cache holding
+ *  more than two batches returns one. Objects deleted by another thread than
+ *  the one which created them, e.g. operators pushed by the main thread and
+ *  completed by engine workers, thus flow back through the shared pool.
  */
 template <typename T>
 class ObjectPool {
@@ -81,18 +89,50 @@ class ObjectPool {
     };
 #endif
   };
+  /*!
+   * \brief Free list of a thread. It is trivially destructible, so that it can
+   *  still be used after the thread local destructors ran, e.g. by objects
+   *  deleted while static objects are destroyed.
+   */
+  struct ThreadCache {
+    LinkedList* head;
+    std::size_t size;
+    /*! \brief whether the cache was registered for flushing at thread exit */
+    bool registered;
+    /*! \brief whether the thread is exiting, New and Delete bypass the cache then */
+    bool exited;
+  };
+  /*!
+   * \brief Returns the free list of a thread to the pool when the thread exits.
+   */
+  struct ThreadCacheFlusher {
+    /*! \brief keeps the pool alive until the thread exits */
+    std::shared_ptr<ObjectPool> pool{ObjectPool::_GetSharedRef()};
+    ~ThreadCacheFlusher() {
+      ThreadCache& cache = LocalCache();
+      if (cache.head != nullptr) pool->PushBatch(cache.head, cache.size);
+      cache.head = nullptr;
+      cache.size = 0;
+      cache.exited = true;
+    }
+  };
   /*!
    * \brief Page size of allocation.
    *
    * Currently defined to be 4KB.
    */
   constexpr static std::size_t kPageSize = 1 << 12;
+  /*!
+   * \brief Number of objects moved between a thread cache and the pool at once,
+   *  i.e. the number of objects in a page.
+   */
+  constexpr static std::size_t kBatchSize = kPageSize / sizeof(LinkedList);
   /*! \brief internal mutex */
   std::mutex m_;
   /*!
-   * \brief Head of free list.
+   * \brief Free lists returned to the pool, with their lengths.
    */
-  LinkedList* head_{nullptr};
+  std::vector<std::pair<LinkedList*, std::size_t> > batches_;
   /*!
    * \brief Pages allocated.
    */
@@ -100,13 +140,29 @@ class ObjectPool {
   /*!
    * \brief Private constructor.
    */
-  ObjectPool();
+  ObjectPool() = default;
+  /*!
+   * \brief Get the free list of the calling thread.
+   */
+  static ThreadCache& LocalCache();
+  /*!
+   * \brief Make sure the free list of the calling thread is flushed when it exits.
+   */
+  static void RegisterCache(ThreadCache* cache);
+  /*!
+   * \brief Take a free list from the pool, allocating a page if there is none.
+   */
+  LinkedList* PopBatch(std::size_t* size);
+  /*!
+   * \brief Give a free list back to the pool.
+   */
+  void PushBatch(LinkedList* head, std::size_t size);
   /*!
    * \brief Allocate a page of raw objects.
    *
    * This function is not protected and must be called with caution.
    */
-  void AllocateChunk();
+  LinkedList* AllocateChunk();
   DISALLOW_COPY_AND_ASSIGN(ObjectPool);
 };  // class ObjectPool
 
@@ -144,14 +200,18 @@ ObjectPool<T>::~ObjectPool() {
 template <typename T>
 template <typename... Args>
 T* ObjectPool<T>::New(Args&&... args) {
-  LinkedList* ret;
-  {
-    std::lock_guard<std::mutex> lock{m_};
-    if (head_->next == nullptr) {
-      AllocateChunk();
-    }
-    ret = head_;
-    head_ = head_->next;
+  ThreadCache& cache = LocalCache();
+  if (cache.head == nullptr) {
+    cache.head = PopBatch(&cache.size);
+    if (!cache.registered) RegisterCache(&cache);
+  }
+  LinkedList* ret = cache.head;
+  cache.head = ret->next;
+  --cache.size;
+  if (cache.exited && cache.head != nullptr) {
+    PushBatch(cache.head, cache.size);
+    cache.head = nullptr;
+    cache.size = 0;
   }
   return new (static_cast<void*>(ret)) T(std::forward<Args>(args)...);
 }
@@ -160,10 +220,23 @@ template <typename T>
 void ObjectPool<T>::Delete(T* ptr) {
   ptr->~T();
   auto linked_list_ptr = reinterpret_cast<LinkedList*>(ptr);
-  {
-    std::lock_guard<std::mutex> lock{m_};
-    linked_list_ptr->next = head_;
-    head_ = linked_list_ptr;
+  ThreadCache& cache = LocalCache();
+  if (cache.exited) {
+    linked_list_ptr->next = nullptr;
+    PushBatch(linked_list_ptr, 1);
+    return;
+  }
+  if (!cache.registered) RegisterCache(&cache);
+  linked_list_ptr->next = cache.head;
+  cache.head = linked_list_ptr;
+  if (++cache.size > 2 * kBatchSize) {
+    // keep the most recently freed objects, which are likely still in cache,
+    // and hand the older ones back
+    LinkedList* tail = cache.head;
+    for (std::size_t i = 1; i < kBatchSize; ++i) tail = tail->next;
+    PushBatch(tail->next, cache.size - kBatchSize);
+    tail->next = nullptr;
+    cache.size = kBatchSize;
   }
 }
 
@@ -179,12 +252,38 @@ std::shared_ptr<ObjectPool<T> > ObjectPool<T>::_GetSharedRef() {
 }
 
 template <typename T>
-ObjectPool<T>::ObjectPool() {
-  AllocateChunk();
+typename ObjectPool<T>::ThreadCache& ObjectPool<T>::LocalCache() {
+  static thread_local ThreadCache cache = {nullptr, 0, false, false};
+  return cache;
+}
+
+template <typename T>
+void ObjectPool<T>::RegisterCache(ThreadCache* cache) {
+  static thread_local ThreadCacheFlusher flusher;
+  cache->registered = true;
+}
+
+template <typename T>
+typename ObjectPool<T>::LinkedList* ObjectPool<T>::PopBatch(std::size_t* size) {
+  std::lock_guard<std::mutex> lock{m_};
+  if (batches_.empty()) {
+    *size = kBatchSize;
+    return AllocateChunk();
+  }
+  LinkedList* head = batches_.back().first;
+  *size = batches_.back().second;
+  batches_.pop_back();
+  return head;
+}
+
+template <typename T>
+void ObjectPool<T>::PushBatch(LinkedList* head, std::size_t size) {
+  std::lock_guard<std::mutex> lock{m_};
+  batches_.emplace_back(head, size);
 }
 
 template <typename T>
-void ObjectPool<T>::AllocateChunk() {
+typename ObjectPool<T>::LinkedList* ObjectPool<T>::AllocateChunk() {
   static_assert(sizeof(LinkedList) <= kPageSize, "Object too big.");
   static_assert(sizeof(LinkedList) % alignof(LinkedList) == 0, "ObjectPooll Invariant");
   static_assert(alignof(LinkedList) % alignof(T) == 0, "ObjectPooll Invariant");
@@ -199,12 +298,11 @@ void ObjectPool<T>::AllocateChunk() {
 #endif
   allocated_.emplace_back(new_chunk_ptr);
   auto new_chunk = static_cast<LinkedList*>(new_chunk_ptr);
-  auto size = kPageSize / sizeof(LinkedList);
-  for (std::size_t i = 0; i < size - 1; ++i) {
+  for (std::size_t i = 0; i < kBatchSize - 1; ++i) {
     new_chunk[i].next = &new_chunk[i + 1];
   }
-  new_chunk[size - 1].next = head_;
-  head_ = new_chunk;
+  new_chunk[kBatchSize - 1].next = nullptr;
+  return new_chunk;
 }
 
 template <typename T>
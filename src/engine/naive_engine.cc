@@ -22,6 +22,7 @@
  * \file naive_engine.cc
  * \brief Implementation of NaiveEngine
  */
+#include <mxnet/resource.h>
 #include <atomic>
 #include <future>
 #include <memory>
@@ -183,6 +184,9 @@ class NaiveEngine final : public Engine {
                                                                      attrs.release());
       opr->opr_profile->startForDevice(exec_ctx.dev_type, exec_ctx.dev_id);
     }
+    // the operator is waited for below, so even an asynchronous one is done
+    // with its temp space at the end of the scope
+    TempSpaceScope temp_space(exec_ctx.dev_mask() == cpu::kDevMask);
     if (exec_ctx.dev_mask() == gpu::kDevMask) {
 #if MXNET_USE_CUDA
       size_t dev_id = static_cast<size_t>(exec_ctx.dev_id);
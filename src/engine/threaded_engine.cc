@@ -119,7 +119,7 @@ inline void ThreadedVar::CompleteReadDependency(Dispatcher dispatcher) {
 }
 
 template <typename Dispatcher>
-inline bool ThreadedVar::CompleteWriteDependency(Dispatcher dispatcher) {
+inline bool ThreadedVar::CompleteWriteDependency(Dispatcher dispatcher, bool modified) {
   // this is lock scope
   VersionedVarBlock *old_pending_write, *end_of_read_chain;
   OprBlock* trigger_write = nullptr;
@@ -131,7 +131,7 @@ inline bool ThreadedVar::CompleteWriteDependency(Dispatcher dispatcher) {
     CHECK_EQ(num_pending_reads_, kWriteTriggered);
 
     // increment version number
-    ++version_;
+    if (modified) ++version_;
 
     // really delete
     if (to_delete_) {
@@ -199,6 +199,26 @@ inline bool ThreadedVar::ready_to_read() {
   return this->is_ready_to_read();
 }
 
+inline bool ThreadedVar::TryStartInline(bool for_write) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  // pending exceptions are rethrown by the engine
+  if (!this->is_ready_to_read() || (var_exception && *var_exception)) return false;
+  if (!for_write) {
+    ++num_pending_reads_;
+    return true;
+  }
+  if (num_pending_reads_ != 0) return false;
+  // a triggered write without operation, as appended by AppendWriteDependency
+  assert(head_->next == nullptr);
+  assert(head_->trigger == nullptr);
+  head_->next = VersionedVarBlock::New();
+  head_->write = true;
+  pending_write_ = head_;
+  num_pending_reads_ = kWriteTriggered;
+  head_ = head_->next;
+  return true;
+}
+
 inline size_t ThreadedVar::version() {
   std::lock_guard<std::mutex> lock{mutex_};
   return this->version_;
@@ -362,6 +382,56 @@ void ThreadedEngine::PushSync(SyncFn exec_fn, Context exec_ctx,
   BulkAppend(exec_fn, exec_ctx, const_vars, mutable_vars);
 }
 
+bool ThreadedEngine::TryRunInline(SyncFn exec_fn, Context exec_ctx,
+                                  std::vector<VarHandle> const& const_vars,
+                                  std::vector<VarHandle> const& mutable_vars) {
+  // only CPU operations run without a stream, operations in the bulk of this thread
+  // are not appended to their variables yet and operations executed inline are not profiled
+  if (exec_ctx.dev_mask() != cpu::kDevMask || BulkStatusStore::Get()->count ||
+      profiler_->IsProfiling(profiler::Profiler::kImperative)) {
+    return false;
+  }
+  // The variables are marked as accessed before the operation runs, so that
+  // the operations pushed on them meanwhile by other threads wait for it.
+  std::vector<ThreadedVar*> reads, writes;
+  reads.reserve(const_vars.size());
+  writes.reserve(mutable_vars.size());
+  bool started = true;
+  for (auto var : const_vars) {
+    ThreadedVar* threaded_var = ThreadedVar::CastFromBase(var);
+    if (!(started = threaded_var->TryStartInline(false))) break;
+    reads.push_back(threaded_var);
+  }
+  for (size_t i = 0; started && i < mutable_vars.size(); ++i) {
+    ThreadedVar* threaded_var = ThreadedVar::CastFromBase(mutable_vars[i]);
+    if (!(started = threaded_var->TryStartInline(true))) break;
+    writes.push_back(threaded_var);
+  }
+  ExceptionRef opr_exception;
+  if (started) {
+    try {
+      exec_fn(RunContext{exec_ctx, nullptr, nullptr, false});
+    } catch (const std::exception&) {
+      opr_exception = std::make_shared<std::exception_ptr>(std::current_exception());
+    }
+  }
+  // complete the accesses as OnComplete does, or cancel them
+  const auto dispatcher = [this](OprBlock* opr) { this->PushToExecute(opr, false); };
+  for (ThreadedVar* var : reads) {
+    var->CompleteReadDependency(dispatcher);
+  }
+  for (ThreadedVar* var : writes) {
+    if (opr_exception) {
+      var->var_exception = opr_exception;
+      AddToGlobalExceptions(opr_exception);
+    }
+    if (var->CompleteWriteDependency(dispatcher, started)) {
+      ThreadedVar::Delete(var);
+    }
+  }
+  return started;
+}
+
 void ThreadedEngine::DeleteVariable(SyncFn delete_fn,
                                     Context exec_ctx,
                                     VarHandle var) {
@@ -30,6 +30,7 @@
 #include <dmlc/base.h>
 #include <dmlc/logging.h>
 #include <dmlc/omp.h>
+#include <mxnet/resource.h>
 #include <mxnet/storage.h>
 #include <vector>
 #include <functional>
@@ -158,15 +159,25 @@ class ThreadedVar final
    *
    * \param dispatcher the function called to trigger the operation,
    *            when all of its dependencies are satiesfied.
+   * \param modified whether the variable was written, false if the write was cancelled.
    * \tparam Dispatcher the function called to trigger an operation.
    * \return to_delete, whether this Variable can be deleted after this functin.
    */
   template <typename Dispatcher>
-  inline bool CompleteWriteDependency(Dispatcher dispatcher);
+  inline bool CompleteWriteDependency(Dispatcher dispatcher, bool modified = true);
   /*! \brief Mark this variable to be deleted. */
   inline void SetToDelete();
   /*! \return whether this variable is ready to read. */
   inline bool ready_to_read();
+  /*!
+   * \brief Start a read or write done outside of the engine, if no operation is
+   *  pending on this variable. Until the access is completed with
+   *  CompleteReadDependency or CompleteWriteDependency, the operations pushed on
+   *  this variable wait for it as for an operation run by the engine.
+   * \param for_write whether the access is a write.
+   * \return whether the access was started.
+   */
+  inline bool TryStartInline(bool for_write);
   inline size_t version() override;
   /*!
    * \brief Cast a Var pointer to ThreadedVar pointer
@@ -304,6 +315,9 @@ class ThreadedEngine : public Engine {
                 FnProperty prop = FnProperty::kNormal,
                 int priority = 0,
                 const char* opr_name = nullptr) override;
+  bool TryRunInline(SyncFn exec_fn, Context exec_ctx,
+                    std::vector<VarHandle> const& const_vars,
+                    std::vector<VarHandle> const& mutable_vars) override;
   void DeleteVariable(SyncFn delete_fn, Context exec_ctx, VarHandle var) override;
   void WaitForVar(VarHandle var) override;
   void WaitForAll() override;
@@ -378,6 +392,9 @@ class ThreadedEngine : public Engine {
         try {
           if ((!(threaded_opr->opr_exception && *threaded_opr->opr_exception) ||
               threaded_opr->prop == FnProperty::kNoSkip) || threaded_opr->wait) {
+            // the temp space of a synchronous operator is free once it returns
+            TempSpaceScope temp_space(run_ctx.ctx.dev_mask() == cpu::kDevMask &&
+                                      threaded_opr->prop != FnProperty::kAsync);
             threaded_opr->fn(run_ctx, callback);
           } else {
             callback();
@@ -33,7 +33,9 @@
 #include "../initialize.h"
 #include "./threaded_engine.h"
 #include "./thread_pool.h"
+#include "./work_stealing_queue.h"
 #include "../common/lazy_alloc_array.h"
+#include "../common/numa.h"
 #include "../common/utils.h"
 
 namespace mxnet {
@@ -45,6 +47,10 @@ namespace engine {
  *  - Use fixed amount of threads for each device.
  *  - Use special threads for copy operations.
  *  - Each stream is allocated and bound to each of the thread.
+ *  - Optionally, CPU workers of a device steal work from each other
+ *    (MXNET_CPU_WORKER_WORK_STEALING).
+ *  - Optionally, CPU workers of cpu(i) run on the cores of NUMA node
+ *    i % num_nodes (MXNET_CPU_NUMA_AWARE).
  */
 class ThreadedEnginePerDevice : public ThreadedEngine {
  public:
@@ -67,6 +73,7 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
     gpu_priority_workers_.Clear();
     gpu_copy_workers_.Clear();
     cpu_normal_workers_.Clear();
+    cpu_stealing_workers_.Clear();
     cpu_priority_worker_.reset(nullptr);
   }
 
@@ -81,6 +88,7 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
     gpu_worker_nthreads_ = common::GetNumThreadsPerGPU();
     // MXNET_CPU_WORKER_NTHREADS
     cpu_worker_nthreads_ = LibraryInitializer::Get()->cpu_worker_nthreads_;
+    cpu_work_stealing_ = dmlc::GetEnv("MXNET_CPU_WORKER_WORK_STEALING", false);
     gpu_copy_nthreads_ = dmlc::GetEnv("MXNET_GPU_COPY_NTHREADS", 2);
     // create CPU task
     int cpu_priority_nthreads = dmlc::GetEnv("MXNET_CPU_PRIORITY_NTHREADS", 4);
@@ -109,6 +117,26 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
         // CPU execution.
         if (opr_block->opr->prop == FnProperty::kCPUPrioritized) {
           cpu_priority_worker_->task_queue.Push(opr_block, opr_block->priority);
+        } else if (cpu_work_stealing_) {
+          int dev_id = ctx.dev_id;
+          int nthread = cpu_worker_nthreads_;
+          auto ptr =
+          cpu_stealing_workers_.Get(dev_id, [this, ctx, nthread]() {
+              auto blk = new WorkStealingWorkerBlock(nthread);
+              blk->pool = std::make_unique<ThreadPool>(nthread,
+                  [this, ctx, blk](std::shared_ptr<dmlc::ManualEvent> ready_event) {
+                    BindToNumaNode(ctx);
+                    this->CPUWorker(ctx, blk, ready_event);
+                  }, true);
+            return blk;
+          });
+          if (ptr) {
+            if (opr_block->opr->prop == FnProperty::kDeleteVar) {
+              ptr->task_queue.PushFront(opr_block, opr_block->priority);
+            } else {
+              ptr->task_queue.Push(opr_block, opr_block->priority);
+            }
+          }
         } else {
           int dev_id = ctx.dev_id;
           int nthread = cpu_worker_nthreads_;
@@ -117,6 +145,7 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
               auto blk = new ThreadWorkerBlock<kWorkerQueue>();
               blk->pool = std::make_unique<ThreadPool>(nthread,
                   [this, ctx, blk](std::shared_ptr<dmlc::ManualEvent> ready_event) {
+                    BindToNumaNode(ctx);
                     this->CPUWorker(ctx, blk, ready_event);
                   }, true);
             return blk;
@@ -215,17 +244,30 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
     // destructor
     ~ThreadWorkerBlock() = default;
   };
+  // working unit for CPU workers which steal tasks from each other.
+  struct WorkStealingWorkerBlock {
+    // one deque per worker thread, plus the queue for tasks pushed from other threads
+    WorkStealingTaskQueue<OprBlock*> task_queue;
+    // thread pool that works on this task
+    std::unique_ptr<ThreadPool> pool;
+    // constructor
+    explicit WorkStealingWorkerBlock(size_t nthread) : task_queue(nthread) {}
+  };
 
   /*! \brief whether this is a worker thread. */
   static MX_THREAD_LOCAL bool is_worker_;
   /*! \brief number of concurrent thread cpu worker uses */
   size_t cpu_worker_nthreads_;
+  /*! \brief whether the cpu workers of a device steal tasks from each other */
+  bool cpu_work_stealing_;
   /*! \brief number of concurrent thread each gpu worker uses */
   size_t gpu_worker_nthreads_;
   /*! \brief number of concurrent thread each gpu copy worker uses */
   size_t gpu_copy_nthreads_;
   // cpu worker
   common::LazyAllocArray<ThreadWorkerBlock<kWorkerQueue> > cpu_normal_workers_;
+  // cpu worker with work stealing
+  common::LazyAllocArray<WorkStealingWorkerBlock> cpu_stealing_workers_;
   // cpu priority worker
   std::unique_ptr<ThreadWorkerBlock<kPriorityQueue> > cpu_priority_worker_;
   // workers doing normal works on GPU
@@ -277,6 +319,18 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
     ready_event->signal();
 #endif
   }
+  /*!
+   * \brief Restrict the calling CPU worker of a context to the cores of the NUMA
+   *  node of the context, see common::NumaTopology.
+   */
+  static void BindToNumaNode(const Context& ctx) {
+    const auto numa = common::NumaTopology::Get();
+    if (!numa->enabled()) return;
+    const int node = numa->NodeOf(ctx);
+    if (!numa->BindCurrentThread(node)) {
+      LOG(WARNING) << "Failed to bind a CPU worker of " << ctx << " to NUMA node " << node;
+    }
+  }
   /*!
    * \brief CPU worker that performs operations on CPU.
    * \param block The task block of the worker.
@@ -300,6 +354,29 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
       this->ExecuteOprBlock(run_ctx, opr_block);
     }
   }
+  /*!
+   * \brief CPU worker that performs operations on CPU, stealing work from its peers.
+   * \param block The task block of the worker.
+   */
+  inline void CPUWorker(Context ctx,
+                        WorkStealingWorkerBlock *block,
+                        const std::shared_ptr<dmlc::ManualEvent>& ready_event) {
+    this->is_worker_ = true;
+    auto* task_queue = &(block->task_queue);
+    task_queue->RegisterWorker();
+    RunContext run_ctx{ctx, nullptr, nullptr, false};
+
+    // execute task
+    OprBlock* opr_block;
+    ready_event->signal();
+
+    // Set default number of threads for OMP parallel regions initiated by this thread
+    OpenMP::Get()->on_start_worker_thread(true);
+
+    while (task_queue->Pop(&opr_block)) {
+      this->ExecuteOprBlock(run_ctx, opr_block);
+    }
+  }
 
   /*!
    * \brief Get number of cores this engine should reserve for its own use
@@ -336,6 +413,7 @@ class ThreadedEnginePerDevice : public ThreadedEngine {
     SignalQueueForKill(&gpu_normal_workers_);
     SignalQueueForKill(&gpu_copy_workers_);
     SignalQueueForKill(&cpu_normal_workers_);
+    SignalQueueForKill(&cpu_stealing_workers_);
     if (cpu_priority_worker_) {
       cpu_priority_worker_->task_queue.SignalForKill();
     }
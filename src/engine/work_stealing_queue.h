@@ -0,0 +1,318 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file work_stealing_queue.h
+ * \brief Task queue with per-worker Chase-Lev deques and work stealing.
+ */
+#ifndef MXNET_ENGINE_WORK_STEALING_QUEUE_H_
+#define MXNET_ENGINE_WORK_STEALING_QUEUE_H_
+
+#include <dmlc/base.h>
+#include <dmlc/logging.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mxnet {
+namespace engine {
+
+/*!
+ * \brief Lock-free single-owner double-ended queue (Chase & Lev, SPAA'05),
+ *  with the memory orderings of Le et al., PPoPP'13.
+ *  The owner pushes and pops at the bottom, other threads steal from the top.
+ * \tparam T trivially copyable element type, usually a pointer.
+ */
+template<typename T>
+class ChaseLevDeque {
+ public:
+  explicit ChaseLevDeque(int64_t log_capacity = 8)
+      : top_(0), bottom_(0), array_(new Array(log_capacity)) {
+    arrays_.emplace_back(array_.load(std::memory_order_relaxed));
+  }
+  /*!
+   * \brief Push an element at the bottom, only called by the owner.
+   */
+  void Push(T x) {
+    const int64_t b = bottom_.load(std::memory_order_relaxed);
+    const int64_t t = top_.load(std::memory_order_acquire);
+    Array *a = array_.load(std::memory_order_relaxed);
+    if (b - t > a->size() - 1) {
+      a = Grow(a, b, t);
+    }
+    a->Put(b, x);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+  }
+  /*!
+   * \brief Pop the most recently pushed element, only called by the owner.
+   * \return whether an element was popped.
+   */
+  bool Pop(T *x) {
+    const int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    Array *a = array_.load(std::memory_order_relaxed);
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    if (t > b) {
+      // empty
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return false;
+    }
+    *x = a->Get(b);
+    if (t == b) {
+      // last element, race against the thieves
+      const bool won = top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                    std::memory_order_relaxed);
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return won;
+    }
+    return true;
+  }
+  /*!
+   * \brief Steal the oldest element, called by any thread.
+   * \return whether an element was stolen.
+   */
+  bool Steal(T *x) {
+    int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t b = bottom_.load(std::memory_order_acquire);
+    if (t >= b) return false;
+    Array *a = array_.load(std::memory_order_acquire);
+    const T value = a->Get(t);
+    if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      return false;
+    }
+    *x = value;
+    return true;
+  }
+  /*! \brief Approximate emptiness check, called by any thread. */
+  bool Empty() const {
+    return bottom_.load(std::memory_order_relaxed) <= top_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  /*! \brief Circular array of atomic slots */
+  class Array {
+   public:
+    explicit Array(int64_t log_capacity)
+        : log_capacity_(log_capacity),
+          mask_((int64_t{1} << log_capacity) - 1),
+          buffer_(new std::atomic<T>[mask_ + 1]) {}
+    inline int64_t log_capacity() const { return log_capacity_; }
+    inline int64_t size() const { return mask_ + 1; }
+    inline T Get(int64_t i) const { return buffer_[i & mask_].load(std::memory_order_relaxed); }
+    inline void Put(int64_t i, T x) { buffer_[i & mask_].store(x, std::memory_order_relaxed); }
+
+   private:
+    const int64_t log_capacity_;
+    const int64_t mask_;
+    std::unique_ptr<std::atomic<T>[]> buffer_;
+  };
+
+  Array *Grow(Array *a, int64_t b, int64_t t) {
+    Array *bigger = new Array(a->log_capacity() + 1);
+    for (int64_t i = t; i < b; ++i) {
+      bigger->Put(i, a->Get(i));
+    }
+    // Thieves may still read the old array, so it is only freed with the deque
+    arrays_.emplace_back(bigger);
+    array_.store(bigger, std::memory_order_release);
+    return bigger;
+  }
+
+  std::atomic<int64_t> top_;
+  std::atomic<int64_t> bottom_;
+  std::atomic<Array*> array_;
+  /*! \brief all arrays ever used by this deque, owned by the owner thread */
+  std::vector<std::unique_ptr<Array>> arrays_;
+};
+
+/*!
+ * \brief Blocking task queue for a group of worker threads with work stealing.
+ *  Each worker owns a deque. Tasks pushed by a worker go to its own deque and are
+ *  executed by it in LIFO order, which keeps producer-consumer chains of operations
+ *  on the same core. Tasks pushed by other threads go to a shared injection queue.
+ *  Idle workers steal the oldest tasks of the other workers before going to sleep.
+ *  The interface mirrors dmlc::ConcurrentBlockingQueue, priorities are ignored.
+ */
+template<typename T>
+class WorkStealingTaskQueue {
+ public:
+  explicit WorkStealingTaskQueue(size_t num_workers)
+      : deques_(num_workers) {
+    CHECK_GT(num_workers, 0);
+    for (auto &deque : deques_) {
+      deque.reset(new ChaseLevDeque<T>());
+    }
+  }
+  /*!
+   * \brief Register the calling thread as one of the workers of this queue.
+   *  Must be called once by every worker before the first Pop.
+   */
+  void RegisterWorker() {
+    const size_t id = num_registered_++;
+    CHECK_LT(id, deques_.size()) << "Too many workers for the work stealing queue";
+    ThisWorker() = {this, id};
+  }
+  /*!
+   * \brief Push a task.
+   * \param task the task.
+   * \param priority ignored.
+   */
+  void Push(T task, int /*priority*/ = 0) {
+    const WorkerInfo &me = ThisWorker();
+    if (me.queue == this) {
+      deques_[me.id]->Push(task);
+    } else {
+      std::lock_guard<std::mutex> lock(injection_mutex_);
+      injection_queue_.push_back(task);
+      injection_size_.store(injection_queue_.size(), std::memory_order_relaxed);
+    }
+    OnPush();
+  }
+  /*!
+   * \brief Push a task which should be executed as soon as possible.
+   *  For a worker of this queue its own deque is LIFO, so this is the same as Push.
+   */
+  void PushFront(T task, int /*priority*/ = 0) {
+    const WorkerInfo &me = ThisWorker();
+    if (me.queue == this) {
+      deques_[me.id]->Push(task);
+    } else {
+      std::lock_guard<std::mutex> lock(injection_mutex_);
+      injection_queue_.push_front(task);
+      injection_size_.store(injection_queue_.size(), std::memory_order_relaxed);
+    }
+    OnPush();
+  }
+  /*!
+   * \brief Pop a task, blocking until one is available or the queue is killed.
+   *  Only called by registered workers.
+   * \return false if the queue was signalled for kill.
+   */
+  bool Pop(T *task) {
+    const WorkerInfo &me = ThisWorker();
+    CHECK(me.queue == this) << "Pop called by a thread which is not a worker of the queue";
+    while (true) {
+      if (exit_now_.load(std::memory_order_relaxed)) return false;
+      for (int spin = 0; spin < kSpinCount; ++spin) {
+        if (TryPop(me.id, task)) {
+          pending_.fetch_sub(1);
+          return true;
+        }
+        if (pending_.load() <= 0) break;
+        std::this_thread::yield();
+      }
+      std::unique_lock<std::mutex> lock(sleep_mutex_);
+      ++num_sleeping_;
+      sleep_cv_.wait(lock, [this]() {
+        return pending_.load() > 0 || exit_now_.load();
+      });
+      --num_sleeping_;
+    }
+  }
+  /*!
+   * \brief Wake up all workers and make every following Pop return false.
+   */
+  void SignalForKill() {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    exit_now_.store(true);
+    sleep_cv_.notify_all();
+  }
+  /*! \brief Approximate number of tasks waiting in the queue. */
+  size_t Size() const {
+    const int64_t pending = pending_.load(std::memory_order_relaxed);
+    return pending > 0 ? static_cast<size_t>(pending) : 0;
+  }
+
+ private:
+  struct WorkerInfo {
+    const WorkStealingTaskQueue *queue;
+    size_t id;
+  };
+
+  static WorkerInfo &ThisWorker() {
+    static thread_local WorkerInfo info = {nullptr, 0};
+    return info;
+  }
+
+  void OnPush() {
+    // pending_ is incremented after the task is visible, so that a worker
+    // which observes it can find the task, and before num_sleeping_ is read,
+    // so that a worker going to sleep either sees the task or gets notified.
+    pending_.fetch_add(1);
+    if (num_sleeping_.load() > 0) {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      sleep_cv_.notify_one();
+    }
+  }
+
+  bool TryPop(size_t id, T *task) {
+    if (deques_[id]->Pop(task)) return true;
+    if (injection_size_.load(std::memory_order_relaxed) > 0) {
+      std::lock_guard<std::mutex> lock(injection_mutex_);
+      if (!injection_queue_.empty()) {
+        *task = injection_queue_.front();
+        injection_queue_.pop_front();
+        injection_size_.store(injection_queue_.size(), std::memory_order_relaxed);
+        return true;
+      }
+    }
+    // steal from the other workers, starting after ourselves
+    const size_t n = deques_.size();
+    for (size_t i = 1; i < n; ++i) {
+      if (deques_[(id + i) % n]->Steal(task)) return true;
+    }
+    return false;
+  }
+
+  /*! \brief number of yields before a worker without tasks goes to sleep */
+  static constexpr int kSpinCount = 16;
+  /*! \brief per-worker deques */
+  std::vector<std::unique_ptr<ChaseLevDeque<T>>> deques_;
+  /*! \brief number of workers registered so far */
+  std::atomic<size_t> num_registered_{0};
+  /*! \brief tasks pushed from threads which are not workers */
+  std::deque<T> injection_queue_;
+  std::mutex injection_mutex_;
+  /*! \brief size of the injection queue, to skip its lock when it is empty */
+  std::atomic<size_t> injection_size_{0};
+  /*!
+   * \brief number of tasks pushed and not yet popped, it may be transiently
+   *  negative since a task can be popped before the push is accounted
+   */
+  std::atomic<int64_t> pending_{0};
+  /*! \brief number of workers waiting for tasks */
+  std::atomic<int> num_sleeping_{0};
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_cv_;
+  std::atomic<bool> exit_now_{false};
+};
+
+}  // namespace engine
+}  // namespace mxnet
+
+#endif  // MXNET_ENGINE_WORK_STEALING_QUEUE_H_
@@ -33,10 +33,46 @@ DMLC_REGISTER_PARAMETER(CachedOpConfig);
 
 constexpr uint32_t kEidNotExist = std::numeric_limits<uint32_t>::max();
 
-nnvm::Symbol CachedOp::GetOptimizedSymbol() const {
+namespace {
+/*! \brief plan cache counters of all CachedOps, reported to the profiler */
+struct PlanCacheCounters {
+  profiler::ProfileDomain domain{"CachedOp"};
+  profiler::ProfileCounter hits{"Plan Cache Hits", &domain};
+  profiler::ProfileCounter misses{"Plan Cache Misses", &domain};
+  profiler::ProfileCounter compile_time_us{"Plan Compile Time (us)", &domain};
+  profiler::ProfileCounter memory_bytes{"Planned Memory of Cached Signatures (bytes)", &domain};
+
+  static PlanCacheCounters* Get() {
+    // never destroyed, CachedOps may be freed during static destruction
+    static PlanCacheCounters* inst = new PlanCacheCounters();
+    return inst;
+  }
+};
+}  // namespace
+
+nnvm::Symbol CachedOp::GetOptimizedSymbol() {
+  // Once the op has run, its graph is further optimized for the device it runs on,
+  // e.g. by pointwise fusion, so return the graph of its first state.
+  OpStatePtr state_ptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& states : cached_op_states_) {
+      if (!states.second.empty()) {
+        state_ptr = states.second.front();
+        break;
+      }
+    }
+  }
   nnvm::Symbol ret;
-  ret.outputs = std::vector<nnvm::NodeEntry>(full_graph_.outputs.begin(),
-                                             full_graph_.outputs.begin() + num_outputs());
+  if (!state_ptr) {
+    ret.outputs = std::vector<nnvm::NodeEntry>(full_graph_.outputs.begin(),
+                                               full_graph_.outputs.begin() + num_outputs());
+    return ret.Copy();
+  }
+  auto& state = state_ptr.get_state<CachedOpState>();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  const auto& outputs = state.info.full_graph.outputs;
+  ret.outputs = std::vector<nnvm::NodeEntry>(outputs.begin(), outputs.begin() + num_outputs());
   return ret.Copy();
 }
 
@@ -88,7 +124,28 @@ CachedOp::CachedOp(
   SetRefCounts(&fwd_graph_, full_graph_);
 }
 
-CachedOp::~CachedOp() = default;
+CachedOp::~CachedOp() {
+  PlanCacheCounters::Get()->memory_bytes -= plan_stats_.memory_bytes.load();
+}
+
+void CachedOp::CountPlanCacheHit() {
+  ++plan_stats_.hits;
+  ++PlanCacheCounters::Get()->hits;
+}
+
+void CachedOp::CountPlanCacheMiss(uint64_t start_us) {
+  const uint64_t elapsed = profiler::ProfileStat::NowInMicrosec() - start_us;
+  ++plan_stats_.misses;
+  plan_stats_.compile_time_us += elapsed;
+  ++PlanCacheCounters::Get()->misses;
+  PlanCacheCounters::Get()->compile_time_us += elapsed;
+}
+
+void CachedOp::CountPlanCacheMemory(int64_t delta_bytes) {
+  if (delta_bytes == 0) return;
+  plan_stats_.memory_bytes += delta_bytes;
+  PlanCacheCounters::Get()->memory_bytes += delta_bytes;
+}
 
 std::vector<nnvm::NodeEntry> CachedOp::Gradient(
     const nnvm::ObjectPtr& node,
@@ -174,15 +231,21 @@ bool CachedOp::SetForwardGraph(
   using namespace imperative;
   CHECK_EQ(inputs.size(), num_inputs());
   nnvm::Graph& g = info->fwd_graph;
+  const uint64_t start_us = profiler::ProfileStat::NowInMicrosec();
 
   ShapeVector shape_inputs(inputs.size());
   DTypeVector dtype_inputs(inputs.size());
   StorageTypeVector storage_type_inputs(inputs.size());
+  GraphPlanCache::Signature signature;
   for (size_t i = 0; i < inputs.size(); ++i) {
     shape_inputs[i] = inputs[info->input_map[i]]->shape();
     dtype_inputs[i] = inputs[info->input_map[i]]->dtype();
     storage_type_inputs[i] = inputs[info->input_map[i]]->storage_type();
+    GraphPlanCache::AppendSignature(*inputs[info->input_map[i]], &signature);
   }
+  // The restored attributes match the inputs, but the caller still
+  // has to set up its memory and executors for the new plan.
+  const bool restored = info->fwd_plans.Restore(signature, &g);
 
   bool match = true;
   bool contain_dynamic_shape = false;
@@ -204,7 +267,8 @@ bool CachedOp::SetForwardGraph(
     g.attrs.erase(AddPrefix(FORWARD, MEM_PLAN));
     g.attrs.erase(AddPrefix(FULL, MEM_PLAN));
   } else if (g.attrs.count(AddPrefix(prefix, MEM_PLAN))) {
-    return true;
+    CountPlanCacheHit();
+    return !restored;
   }
 
   const auto& idx = g.indexed_graph();
@@ -227,6 +291,9 @@ bool CachedOp::SetForwardGraph(
       AddPrefix(prefix, STORAGE_PLAN));
   g.attrs[AddPrefix(prefix, MEM_PLAN)] =
       std::make_shared<dmlc::any>(std::move(mem_plan));
+  CountPlanCacheMemory(info->fwd_plans.Save(g, config_.plan_cache_size,
+                                            size_t(config_.plan_cache_max_mb) << 20));
+  CountPlanCacheMiss(start_us);
 
   return false;
 }
@@ -266,10 +333,12 @@ bool CachedOp::SetBackwardGraph(
   std::lock_guard<std::mutex> lock(mutex_);
   Context default_ctx = inputs[0]->ctx();
   nnvm::Graph& g = info->full_graph;
+  const uint64_t start_us = profiler::ProfileStat::NowInMicrosec();
 
   if (info->bwd_output_reqs != reqs) {
     info->bwd_output_reqs = reqs;
     info->bwd_input_eid.clear();
+    CountPlanCacheMemory(info->bwd_plans.Clear());
     g = nnvm::Graph();
     g.outputs = info->fwd_graph.outputs;
     for (size_t i = 0; i < info->grad_graph.outputs.size(); ++i) {
@@ -289,6 +358,16 @@ bool CachedOp::SetBackwardGraph(
     CHECK_EQ(inputs.size(), info->bwd_input_eid.size());
   }
 
+  // backward shapes also depend on forward entries which are not inputs here
+  GraphPlanCache::Signature signature = info->fwd_plans.current();
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    if (info->bwd_input_eid[i] != kEidNotExist) {
+      GraphPlanCache::AppendSignature(*inputs[BwdOriginalInput(info->input_map, i)],
+                                      &signature);
+    }
+  }
+  const bool restored = info->bwd_plans.Restore(signature, &g);
+
   size_t num_forward_nodes = info->fwd_graph.indexed_graph().num_nodes();
   size_t num_forward_entries = info->fwd_graph.indexed_graph().num_node_entries();
 
@@ -339,7 +418,8 @@ bool CachedOp::SetBackwardGraph(
   if (!match) {
     g.attrs.erase(AddPrefix(BACKWARD, MEM_PLAN));
   } else if (g.attrs.count(AddPrefix(BACKWARD, MEM_PLAN))) {
-    return true;
+    CountPlanCacheHit();
+    return !restored;
   }
 
   StorageVector storage(idx.num_node_entries(), exec::kBadStorageID);
@@ -359,6 +439,9 @@ bool CachedOp::SetBackwardGraph(
       {num_forward_entries, idx.num_node_entries()},
       detect_inplace_addto);
   g.attrs[AddPrefix(BACKWARD, MEM_PLAN)] = std::make_shared<dmlc::any>(std::move(mem_plan));
+  CountPlanCacheMemory(info->bwd_plans.Save(g, config_.plan_cache_size,
+                                            size_t(config_.plan_cache_max_mb) << 20));
+  CountPlanCacheMiss(start_us);
 
   return false;
 }
@@ -434,6 +517,10 @@ void CachedOp::StaticAllocMemory(
   }
 
   auto& reuse_pool = keep_fwd ? state.bwd_reuse_pool : state.fwd_reuse_pool;
+  if (MemoryArena::Supports(default_ctx)) {
+    auto& arena = keep_fwd ? state.bwd_arena : state.fwd_arena;
+    reuse_pool = arena.Reserve(mem_plan, start_eid, end_eid, default_ctx);
+  }
   reuse_pool = imperative::AllocateMemory(
       g, idx, default_ctx, start_eid, end_eid, mem_plan,
       state.arrays, &state.array_reqs, std::move(reuse_pool));
@@ -643,12 +730,19 @@ OpStatePtr CachedOp::StaticForward(
     const Context& default_ctx,
     const std::vector<NDArray*>& inputs,
     const std::vector<NDArray*>& outputs) {
+  return StaticForward(GetCachedOpState(default_ctx), inputs, outputs);
+}
+
+OpStatePtr CachedOp::StaticForward(
+    const OpStatePtr& state_ptr,
+    const std::vector<NDArray*>& inputs,
+    const std::vector<NDArray*>& outputs) {
   using namespace nnvm;
   using namespace imperative;
 
   bool recording = Imperative::Get()->is_recording();
-  auto state_ptr = GetCachedOpState(default_ctx);
   auto& state = state_ptr.get_state<CachedOpState>();
+  const Context& default_ctx = state.context;
 
   // Need to lock the mutex on the state, this allows
   // for multi context push of ops to dependency engine.
@@ -845,6 +939,37 @@ OpStatePtr CachedOp::Forward(
   return op_state;
 }
 
+void CachedOp::Warmup(
+    const std::vector<NDArray*>& inputs,
+    const Context& default_ctx,
+    bool recording) {
+  CHECK_EQ(inputs.size(), num_inputs());
+  if (config_.plan_cache_size == 0) {
+    LOG(WARNING) << "CachedOp warmup has no effect with plan_cache_size=0";
+  }
+  if (config_.is_dynamic || CheckDynamicShapeExists(default_ctx, inputs, true)) {
+    // the memory of graphs with dynamic shape operators is not planned
+    config_.is_dynamic = true;
+    config_.static_alloc = false;
+    return;
+  }
+  WarmupState(GetCachedOpState(default_ctx), inputs, recording);
+}
+
+void CachedOp::WarmupState(
+    const OpStatePtr& state_ptr,
+    const std::vector<NDArray*>& inputs,
+    bool recording) {
+  auto& state = state_ptr.get_state<CachedOpState>();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  const bool match = SetForwardGraph(state.context, &state.info, recording, inputs);
+  if (config_.static_alloc && (!state.fwd_alloc || !match || state.recording != recording)) {
+    StaticAllocMemory(state_ptr, recording, false);
+    // the executors are set up for the new arrays by the next forward call
+    state.fwd_exec_init = false;
+  }
+}
+
 void CachedOp::DynamicBackward(
     const bool retain_graph,
     const OpStatePtr& op_state,
@@ -331,14 +331,19 @@ void OptimizeGraph(nnvm::Graph* full_graph, nnvm::Graph* fwd_graph, nnvm::Graph*
   input_map->resize(full_graph->indexed_graph().input_nodes().size());
   std::iota(input_map->begin(), input_map->end(), 0);
 #if MXNET_USE_CUDA && !defined(_WIN32)
-  if (context.dev_mask() == kGPU &&
+  const bool fusion_supported = true;
+#else
+  const bool fusion_supported = context.dev_mask() == kCPU;
+#endif  // MXNET_USE_CUDA && !defined(_WIN32)
+  // Pointwise fusion is on by default on GPU and opt-in on CPU
+  if (fusion_supported &&
       !inlining &&
-      dmlc::GetEnv("MXNET_USE_FUSION", true)) {
+      dmlc::GetEnv("MXNET_USE_FUSION", context.dev_mask() == kGPU)) {
     nnvm::Graph unoptimized_graph;
     common::CopyGraph(&unoptimized_graph, *full_graph, false);
 
     if (common::CheckForInputNameDuplicates(unoptimized_graph.indexed_graph())) {
-      *full_graph = exec::FusePointwise(*full_graph, num_forward_outputs);
+      *full_graph = exec::FusePointwise(*full_graph, num_forward_outputs, context);
       // Fill in input_map - mapping from the new to the original input indices.
       const auto &original_inputs = unoptimized_graph.indexed_graph().input_nodes();
       const auto &new_inputs = full_graph->indexed_graph().input_nodes();
@@ -365,14 +370,11 @@ void OptimizeGraph(nnvm::Graph* full_graph, nnvm::Graph* fwd_graph, nnvm::Graph*
       LOG(WARNING)
         << "Graph contains duplicate names for some of its inputs - fusion is NOT enabled!";
      }
-  }
-#else
-  // Only warn user if MXNET_USE_FUSION env var is explicitly set
-  if (context.dev_mask() == kGPU && !inlining &&
-      dmlc::GetEnv("MXNET_USE_FUSION", false)) {
+  } else if (!fusion_supported && !inlining &&
+             dmlc::GetEnv("MXNET_USE_FUSION", false)) {
+    // Only warn user if MXNET_USE_FUSION env var is explicitly set
     exec::WarnFusionNotSupported();
   }
-#endif  // MXNET_USE_CUDA && !defined(_WIN32)
 
   *fwd_graph = nnvm::Graph();
   fwd_graph->outputs = std::vector<nnvm::NodeEntry>(full_graph->outputs.begin(),
@@ -416,6 +418,8 @@ struct CachedOpConfig : public dmlc::Parameter<CachedOpConfig> {
   bool static_alloc;
   bool static_shape;
   bool is_dynamic;
+  uint32_t plan_cache_size;
+  uint32_t plan_cache_max_mb;
   mxnet::Tuple<uint32_t> data_indices;
   mxnet::Tuple<uint32_t> param_indices;
   std::string subgraph;
@@ -450,6 +454,17 @@ struct CachedOpConfig : public dmlc::Parameter<CachedOpConfig> {
     DMLC_DECLARE_FIELD(is_dynamic)
     .set_default(false)
     .describe("Whether the graph contains dynamic shape operators.");
+    DMLC_DECLARE_FIELD(plan_cache_size)
+    .set_default(8)
+    .describe("Number of input signatures (shapes, types and storage types) whose "
+              "inferred attributes and memory plans are kept, so that switching "
+              "back to one of them skips inference and memory planning. "
+              "0 disables the cache.");
+    DMLC_DECLARE_FIELD(plan_cache_max_mb)
+    .set_default(0)
+    .describe("Maximum memory in MB planned by the cached input signatures, "
+              "the least recently used ones are evicted beyond it. "
+              "0 means no limit.");
   }
 };
 
@@ -466,7 +481,7 @@ class CachedOp {
       const nnvm::Symbol& sym,
       const std::vector<std::pair<std::string, std::string> >& flags);
   virtual ~CachedOp();
-  nnvm::Symbol GetOptimizedSymbol() const;
+  nnvm::Symbol GetOptimizedSymbol();
   uint32_t num_inputs() const {
     return fwd_graph_.indexed_graph().input_nodes().size();
   }
@@ -526,7 +541,132 @@ class CachedOp {
   void RegisterOpHook(const CachedOp::CachedOpMonCallback& callback,
                       bool monitor_all = false);
 
+  /*! \brief Counters of the plan caches of a CachedOp, also reported to the profiler */
+  struct PlanCacheStats {
+    /*! \brief forward and backward calls which reused the inferred attributes and plans */
+    std::atomic<uint64_t> hits{0};
+    /*! \brief forward and backward calls which ran inference and memory planning */
+    std::atomic<uint64_t> misses{0};
+    /*! \brief time spent in inference and memory planning on misses */
+    std::atomic<uint64_t> compile_time_us{0};
+    /*! \brief memory planned by the cached input signatures */
+    std::atomic<int64_t> memory_bytes{0};
+  };
+  /*!
+   * \brief Run shape, type and storage type inference and memory planning ahead of
+   *  time for the input signature of the given inputs, and keep the result in the
+   *  plan cache, so that a later forward call with inputs of the same shapes, types
+   *  and storage types runs without them. With static_alloc, the memory of the state
+   *  is also grown to fit the plan. The inputs are only used for their attributes,
+   *  their content is not read.
+   */
+  virtual void Warmup(const std::vector<NDArray*>& inputs,
+                      const Context& default_ctx,
+                      bool recording);
+  const PlanCacheStats& plan_cache_stats() const {
+    return plan_stats_;
+  }
+
  protected:
+  /*!
+   * \brief Attributes of a graph (inferred shapes, types, storage types and
+   *  memory plans) for the input signatures seen most recently. Restoring them
+   *  lets a CachedOp alternate between a few input shapes, e.g. buckets of
+   *  sequence lengths, without running inference and memory planning again.
+   */
+  class GraphPlanCache {
+   public:
+    /*! \brief ndim, dims, dtype and storage type of every input */
+    using Signature = std::vector<int64_t>;
+
+    static void AppendSignature(const NDArray& arr, Signature* signature) {
+      const mxnet::TShape& shape = arr.shape();
+      signature->push_back(shape.ndim());
+      for (int i = 0; i < shape.ndim(); ++i) signature->push_back(shape[i]);
+      signature->push_back(arr.dtype());
+      signature->push_back(arr.storage_type());
+    }
+    /*!
+     * \brief Make the signature current and restore the graph attributes
+     *  saved for it.
+     * \return whether the attributes of the graph were replaced.
+     */
+    bool Restore(const Signature& signature, nnvm::Graph* g) {
+      if (signature == current_) return false;
+      current_ = signature;
+      auto it = plans_.find(signature);
+      if (it == plans_.end()) return false;
+      it->second.last_use = ++clock_;
+      g->attrs = it->second.attrs;
+      return true;
+    }
+    /*!
+     * \brief Save the attributes of the graph for the current signature, then evict
+     *  the least recently used signatures beyond capacity entries or max_bytes of
+     *  planned memory. The current signature is always kept.
+     * \return the change of the memory planned by the cached signatures, in bytes.
+     */
+    int64_t Save(const nnvm::Graph& g, size_t capacity, size_t max_bytes) {
+      if (capacity == 0) return 0;
+      const size_t old_bytes = bytes_;
+      Entry& entry = plans_[current_];
+      bytes_ -= entry.bytes;
+      entry.bytes = PlannedBytes(g);
+      bytes_ += entry.bytes;
+      entry.attrs = g.attrs;
+      entry.last_use = ++clock_;
+      while (plans_.size() > capacity || (max_bytes > 0 && bytes_ > max_bytes)) {
+        // the cache is small, a linear scan finds the least recently used entry
+        auto lru = plans_.end();
+        for (auto it = plans_.begin(); it != plans_.end(); ++it) {
+          if (it->first == current_) continue;
+          if (lru == plans_.end() || it->second.last_use < lru->second.last_use) lru = it;
+        }
+        if (lru == plans_.end()) break;
+        bytes_ -= lru->second.bytes;
+        plans_.erase(lru);
+      }
+      return static_cast<int64_t>(bytes_) - static_cast<int64_t>(old_bytes);
+    }
+    /*! \return the change of the memory planned by the cached signatures, in bytes */
+    int64_t Clear() {
+      const int64_t old_bytes = bytes_;
+      plans_.clear();
+      current_.clear();
+      bytes_ = 0;
+      return -old_bytes;
+    }
+    const Signature& current() const { return current_; }
+    /*! \brief memory planned by the cached signatures, in bytes */
+    size_t bytes() const { return bytes_; }
+
+   private:
+    /*! \brief bytes of the storages of the memory plans of a graph */
+    static size_t PlannedBytes(const nnvm::Graph& g) {
+      size_t bytes = 0;
+      for (const char* prefix : {FORWARD, FULL, BACKWARD}) {
+        auto it = g.attrs.find(AddPrefix(prefix, MEM_PLAN));
+        if (it == g.attrs.end()) continue;
+        const auto& mem_plan = nnvm::get<imperative::MemoryPlanVector>(*it->second);
+        for (size_t i = 0; i < mem_plan.size(); ++i) {
+          if (mem_plan[i].storage_id >= 0 && mem_plan[i].root == i) bytes += mem_plan[i].size;
+        }
+      }
+      return bytes;
+    }
+
+    struct Entry {
+      decltype(nnvm::Graph::attrs) attrs;
+      uint64_t last_use = 0;
+      size_t bytes = 0;
+    };
+    Signature current_;
+    uint64_t clock_ = 0;
+    size_t bytes_ = 0;
+    std::map<Signature, Entry> plans_;
+  };
+
+
   struct GraphInfo {
     nnvm::Graph fwd_graph;
     nnvm::Graph grad_graph;
@@ -536,6 +676,8 @@ class CachedOp {
     std::unordered_map<uint32_t, uint32_t> fwd_input_to_grad_output;
     std::vector<OpReqType> bwd_output_reqs;
     std::vector<uint32_t> bwd_input_eid;
+    GraphPlanCache fwd_plans;
+    GraphPlanCache bwd_plans;
   };
 
   struct CachedOpState {
@@ -590,6 +732,8 @@ class CachedOp {
     std::vector<bool> dynamic_entries;
     std::multimap<size_t, NDArray> fwd_reuse_pool;
     std::multimap<size_t, NDArray> bwd_reuse_pool;
+    imperative::MemoryArena fwd_arena;
+    imperative::MemoryArena bwd_arena;
   };
 
   OpStatePtr GetCachedOpState(const Context& ctx);
@@ -626,6 +770,16 @@ class CachedOp {
       const Context& default_ctx,
       const std::vector<NDArray*>& inputs,
       const std::vector<NDArray*>& outputs);
+  /*! \brief static forward on a given state, which the caller does not share */
+  OpStatePtr StaticForward(
+      const OpStatePtr& state_ptr,
+      const std::vector<NDArray*>& inputs,
+      const std::vector<NDArray*>& outputs);
+  /*! \brief plan a state for the signature of inputs, see Warmup */
+  void WarmupState(
+      const OpStatePtr& state_ptr,
+      const std::vector<NDArray*>& inputs,
+      bool recording);
   struct DynamicRuntime;
 
  private:
@@ -647,6 +801,10 @@ class CachedOp {
       const std::vector<OpReqType>& reqs,
       const std::vector<NDArray*>& outputs);
   size_t BwdOriginalInput(const std::vector<size_t>& input_map, size_t new_i);
+  void CountPlanCacheHit();
+  /*! \brief count a miss which started inference and planning at start_us */
+  void CountPlanCacheMiss(uint64_t start_us);
+  void CountPlanCacheMemory(int64_t delta_bytes);
 
   CachedOpConfig config_;
   nnvm::Graph fwd_graph_;
@@ -663,6 +821,7 @@ class CachedOp {
 
   std::mutex mutex_;
   std::unordered_map<Context, std::vector<OpStatePtr> > cached_op_states_;
+  PlanCacheStats plan_stats_;
 
   friend class ::mxnet::io::LazyTransformDataset;
   nnvm::Symbol sym_;
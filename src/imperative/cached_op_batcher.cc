@@ -0,0 +1,229 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file cached_op_batcher.cc
+ * \brief Dynamic batching of single-sample inference requests on a CachedOp.
+ */
+#include <algorithm>
+#include "./cached_op_batcher.h"
+#include "../profiler/profiler.h"
+
+namespace mxnet {
+
+DMLC_REGISTER_PARAMETER(CachedOpBatcherConfig);
+
+namespace {
+/*! \brief counters of all batchers, reported to the profiler */
+struct BatcherCounters {
+  profiler::ProfileDomain domain{"CachedOpBatcher"};
+  profiler::ProfileCounter num_requests{"Batched Requests", &domain};
+  profiler::ProfileCounter num_batches{"Batches", &domain};
+  profiler::ProfileCounter num_padded{"Padded Samples", &domain};
+  profiler::ProfileCounter latency_us{"Request Latency (us)", &domain};
+  profiler::ProfileCounter busy_us{"Batch Time (us)", &domain};
+
+  static BatcherCounters* Get() {
+    // never destroyed, batchers may be freed during static destruction
+    static BatcherCounters* inst = new BatcherCounters();
+    return inst;
+  }
+};
+
+inline uint64_t ElapsedMicrosec(std::chrono::steady_clock::time_point start,
+                                std::chrono::steady_clock::time_point end) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+}  // namespace
+
+CachedOpBatcher::CachedOpBatcher(
+    const CachedOpPtr& op,
+    const std::vector<NDArray>& inputs,
+    const Context& ctx,
+    const std::vector<std::pair<std::string, std::string> >& flags)
+    : op_(op), ctx_(ctx), inputs_(inputs) {
+  config_.Init(flags);
+  CHECK_EQ(inputs_.size(), op_->num_inputs())
+      << "CachedOpBatcher expects " << op_->num_inputs() << " inputs, but "
+      << inputs_.size() << " were given.";
+  for (size_t i = 0; i < inputs_.size(); ++i) {
+    if (inputs_[i].is_none()) data_indices_.push_back(i);
+  }
+  CHECK(!data_indices_.empty()) << "CachedOpBatcher requires at least one data input";
+
+  if (config_.batch_sizes.ndim() == 0) {
+    for (size_t size = 1; size < config_.max_batch_size; size *= 2) {
+      bucket_sizes_.push_back(size);
+    }
+    bucket_sizes_.push_back(config_.max_batch_size);
+  } else {
+    for (const uint32_t size : config_.batch_sizes) {
+      CHECK(bucket_sizes_.empty() ? size > 0 : size > bucket_sizes_.back())
+          << "batch_sizes must be positive and increasing";
+      bucket_sizes_.push_back(size);
+    }
+    CHECK_EQ(bucket_sizes_.back(), config_.max_batch_size)
+        << "The largest of batch_sizes must be max_batch_size";
+  }
+  worker_ = std::thread(&CachedOpBatcher::Loop, this);
+}
+
+CachedOpBatcher::~CachedOpBatcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cond_.notify_all();
+  worker_.join();
+}
+
+size_t CachedOpBatcher::BucketSize(size_t n) const {
+  return *std::lower_bound(bucket_sizes_.begin(), bucket_sizes_.end(), n);
+}
+
+std::vector<NDArray> CachedOpBatcher::Invoke(const std::vector<NDArray>& data) {
+  CHECK_EQ(data.size(), num_data())
+      << "CachedOpBatcher expects " << num_data() << " data inputs, but "
+      << data.size() << " were given.";
+  auto request = std::make_shared<Request>();
+  request->data = data;
+  for (const NDArray& sample : data) {
+    CHECK_EQ(sample.storage_type(), kDefaultStorage)
+        << "CachedOpBatcher only batches samples of default storage";
+    const mxnet::TShape& shape = sample.shape();
+    CHECK(mxnet::shape_is_known(shape) && shape.ndim() > 0)
+        << "The samples of CachedOpBatcher must have a known shape of at least one axis";
+    request->signature.push_back(shape.ndim());
+    request->signature.insert(request->signature.end(), shape.begin(), shape.end());
+    request->signature.push_back(sample.dtype());
+  }
+  std::future<std::vector<NDArray> > outputs = request->outputs.get_future();
+  request->submit_time = Clock::now();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    CHECK(!stop_) << "CachedOpBatcher is stopped";
+    queue_.push_back(std::move(request));
+  }
+  cond_.notify_one();
+  return outputs.get();
+}
+
+void CachedOpBatcher::Loop() {
+  while (true) {
+    std::vector<std::shared_ptr<Request> > batch;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cond_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+      if (queue_.empty()) return;
+      // Wait for a full batch until the oldest request is due,
+      // a stopping batcher runs the queued requests right away.
+      const Clock::time_point deadline = queue_.front()->submit_time +
+                                         std::chrono::microseconds(config_.max_latency_us);
+      cond_.wait_until(lock, deadline, [this]() {
+        return stop_ || queue_.size() >= config_.max_batch_size;
+      });
+      // the batch takes the oldest request and the next ones of the same signature
+      const std::vector<int64_t> signature = queue_.front()->signature;
+      for (auto it = queue_.begin();
+           it != queue_.end() && batch.size() < config_.max_batch_size;) {
+        if ((*it)->signature == signature) {
+          batch.push_back(std::move(*it));
+          it = queue_.erase(it);
+        } else {
+          ++it;
+        }
+      }
+    }
+    RunBatch(batch);
+  }
+}
+
+void CachedOpBatcher::RunBatch(const std::vector<std::shared_ptr<Request> >& batch) {
+  const Clock::time_point start = Clock::now();
+  const size_t n = batch.size();
+  const size_t bucket = BucketSize(n);
+  std::vector<std::vector<NDArray> > rows(n);
+  try {
+    std::vector<NDArray> inputs = inputs_;
+    for (size_t k = 0; k < data_indices_.size(); ++k) {
+      const NDArray& sample = batch[0]->data[k];
+      mxnet::TShape shape(sample.shape().ndim() + 1, -1);
+      shape[0] = bucket;
+      for (int i = 0; i < sample.shape().ndim(); ++i) {
+        shape[i + 1] = sample.shape()[i];
+      }
+      NDArray batched(shape, ctx_, false, sample.dtype());
+      for (size_t i = 0; i < n; ++i) {
+        CopyFromTo(batch[i]->data[k], batched.At(i));
+      }
+      if (bucket > n) {
+        // the outputs of the padding rows are dropped
+        NDArray padding = batched.Slice(n, bucket);
+        padding = 0;
+      }
+      inputs[data_indices_[k]] = batched;
+    }
+
+    std::vector<NDArray> outputs(op_->num_outputs());
+    std::vector<NDArray*> input_ptrs(inputs.size());
+    std::vector<NDArray*> output_ptrs(outputs.size());
+    for (size_t i = 0; i < inputs.size(); ++i) input_ptrs[i] = &inputs[i];
+    for (size_t i = 0; i < outputs.size(); ++i) output_ptrs[i] = &outputs[i];
+    op_->Forward(op_, input_ptrs, output_ptrs, ctx_);
+
+    for (const NDArray& output : outputs) {
+      output.WaitToRead();
+      CHECK(output.shape().ndim() > 0 && output.shape()[0] == static_cast<dim_t>(bucket))
+          << "CachedOpBatcher requires the batch axis to be the first axis of every output, "
+          << "but an output of shape " << output.shape() << " was computed for a batch of "
+          << bucket;
+    }
+    // the rows are views of the batch outputs, nothing is copied
+    for (size_t i = 0; i < n; ++i) {
+      rows[i].reserve(outputs.size());
+      for (const NDArray& output : outputs) rows[i].push_back(output.At(i));
+    }
+  } catch (const std::exception&) {
+    for (const auto& request : batch) {
+      request->outputs.set_exception(std::current_exception());
+    }
+    return;
+  }
+
+  const Clock::time_point end = Clock::now();
+  uint64_t latency_us = 0;
+  for (size_t i = 0; i < n; ++i) {
+    latency_us += ElapsedMicrosec(batch[i]->submit_time, end);
+    batch[i]->outputs.set_value(std::move(rows[i]));
+  }
+  const uint64_t busy_us = ElapsedMicrosec(start, end);
+  stats_.num_requests += n;
+  stats_.num_batches += 1;
+  stats_.num_padded += bucket - n;
+  stats_.latency_us += latency_us;
+  stats_.busy_us += busy_us;
+  BatcherCounters* counters = BatcherCounters::Get();
+  counters->num_requests += static_cast<int64_t>(n);
+  ++counters->num_batches;
+  counters->num_padded += static_cast<int64_t>(bucket - n);
+  counters->latency_us += static_cast<int64_t>(latency_us);
+  counters->busy_us += static_cast<int64_t>(busy_us);
+}
+
+}  // namespace mxnet
@@ -0,0 +1,143 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file cached_op_batcher.h
+ * \brief Dynamic batching of single-sample inference requests on a CachedOp.
+ */
+#ifndef MXNET_IMPERATIVE_CACHED_OP_BATCHER_H_
+#define MXNET_IMPERATIVE_CACHED_OP_BATCHER_H_
+
+#include <mxnet/ndarray.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "./cached_op.h"
+
+namespace mxnet {
+
+/*! \brief CachedOpBatcher Parameters */
+struct CachedOpBatcherConfig : public dmlc::Parameter<CachedOpBatcherConfig> {
+  uint32_t max_batch_size;
+  uint32_t max_latency_us;
+  mxnet::Tuple<uint32_t> batch_sizes;
+  DMLC_DECLARE_PARAMETER(CachedOpBatcherConfig) {
+    DMLC_DECLARE_FIELD(max_batch_size)
+    .set_default(32)
+    .set_lower_bound(1)
+    .describe("Maximum number of requests run in one forward.");
+    DMLC_DECLARE_FIELD(max_latency_us)
+    .set_default(1000)
+    .describe("Maximum time in microseconds the oldest queued request waits "
+              "for more requests before its batch is run.");
+    DMLC_DECLARE_FIELD(batch_sizes)
+    .set_default(mxnet::Tuple<uint32_t>())
+    .describe("Increasing batch sizes the batches are padded to, so that the "
+              "CachedOp only sees a few input shapes. The largest one must be "
+              "max_batch_size. Defaults to the powers of two up to max_batch_size.");
+  }
+};
+
+/*!
+ * \brief Front-end which accepts single-sample requests from many threads,
+ *  coalesces the requests whose samples have the same shapes and types into
+ *  batches, runs one forward of the CachedOp per batch on a worker thread and
+ *  hands every request views of its rows of the batch outputs.
+ *
+ *  The data inputs of the CachedOp are the batched samples, its other inputs
+ *  (e.g. parameters) are fixed when the batcher is created. A batch is run once
+ *  it has max_batch_size requests or its oldest request has waited for
+ *  max_latency_us, and is padded to the next size of batch_sizes.
+ */
+class CachedOpBatcher {
+ public:
+  /*! \brief counters of the batcher, also reported to the profiler */
+  struct Stats {
+    std::atomic<uint64_t> num_requests{0};
+    std::atomic<uint64_t> num_batches{0};
+    /*! \brief padding rows added to the batches */
+    std::atomic<uint64_t> num_padded{0};
+    /*! \brief sum over the requests of the time from submission to outputs ready */
+    std::atomic<uint64_t> latency_us{0};
+    /*! \brief time spent assembling, running and scattering batches */
+    std::atomic<uint64_t> busy_us{0};
+  };
+
+  /*!
+   * \param op the CachedOp run on the batches
+   * \param inputs inputs of the CachedOp, empty arrays mark the data inputs
+   * \param ctx context the batches are run on
+   * \param flags parameters of CachedOpBatcherConfig
+   */
+  CachedOpBatcher(const CachedOpPtr& op,
+                  const std::vector<NDArray>& inputs,
+                  const Context& ctx,
+                  const std::vector<std::pair<std::string, std::string> >& flags);
+  /*! \brief runs the queued requests, then stops the worker thread */
+  ~CachedOpBatcher();
+  /*! \brief number of data inputs of a request */
+  size_t num_data() const { return data_indices_.size(); }
+  /*!
+   * \brief Submit a request and wait until its outputs are computed.
+   * \param data one sample of every data input, without the batch axis
+   * \return one row of every output of the CachedOp, a view of the batch output
+   */
+  std::vector<NDArray> Invoke(const std::vector<NDArray>& data);
+  const Stats& stats() const { return stats_; }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+  struct Request {
+    std::vector<NDArray> data;
+    /*! \brief ndim, dims and dtype of every sample */
+    std::vector<int64_t> signature;
+    Clock::time_point submit_time;
+    std::promise<std::vector<NDArray> > outputs;
+  };
+
+  void Loop();
+  void RunBatch(const std::vector<std::shared_ptr<Request> >& batch);
+  /*! \brief smallest batch size of the buckets which fits n requests */
+  size_t BucketSize(size_t n) const;
+
+  CachedOpBatcherConfig config_;
+  CachedOpPtr op_;
+  Context ctx_;
+  std::vector<NDArray> inputs_;
+  std::vector<size_t> data_indices_;
+  std::vector<size_t> bucket_sizes_;
+
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::deque<std::shared_ptr<Request> > queue_;
+  bool stop_ = false;
+  Stats stats_;
+  std::thread worker_;
+};
+
+}  // namespace mxnet
+#endif  // MXNET_IMPERATIVE_CACHED_OP_BATCHER_H_
@@ -19,6 +19,7 @@
 
 #include <unordered_set>
 #include <iostream>
+#include <thread>
 #include "./imperative_utils.h"
 #include "./exec_pass.h"
 #include "./cached_op_threadsafe.h"
@@ -39,6 +40,47 @@ struct CachedOpThreadSafe::DynamicRuntime {
   std::vector<OpStatePtr> op_states;
 };
 
+/*!
+ * \brief Statically allocated execution states of a context, each used by
+ *  at most one call at a time. A state is checked out by flipping its flag,
+ *  so concurrent calls on different states never wait on each other.
+ */
+struct CachedOpThreadSafe::StatePool {
+  StatePool(const Context& ctx, size_t size)
+      : context(ctx), states(size), in_use(new std::atomic<bool>[size]()) {}
+
+  /*! \brief check out a free state, yielding while all of them are in use */
+  size_t Checkout() {
+    // start from a slot that depends on the thread, so that
+    // concurrent callers mostly try different slots
+    const size_t start = std::hash<std::thread::id>()(std::this_thread::get_id());
+    while (true) {
+      for (size_t k = 0; k < states.size(); ++k) {
+        const size_t i = (start + k) % states.size();
+        if (!in_use[i].load(std::memory_order_relaxed) &&
+            !in_use[i].exchange(true, std::memory_order_acquire)) {
+          return i;
+        }
+      }
+      std::this_thread::yield();
+    }
+  }
+  /*! \brief check out a given state */
+  void Checkout(size_t i) {
+    while (in_use[i].exchange(true, std::memory_order_acquire)) {
+      std::this_thread::yield();
+    }
+  }
+  void Release(size_t i) {
+    in_use[i].store(false, std::memory_order_release);
+  }
+
+  Context context;
+  std::vector<OpStatePtr> states;
+  std::unique_ptr<std::atomic<bool>[]> in_use;
+  StatePool* next = nullptr;
+};
+
 OpStatePtr CachedOpThreadSafe::GetCachedOpState(
     const Context& ctx) {
 
@@ -55,10 +97,50 @@ OpStatePtr CachedOpThreadSafe::GetCachedOpState(
   return state_ptr;
 }
 
+CachedOpThreadSafe::StatePool* CachedOpThreadSafe::GetStatePool(
+    const Context& ctx, const std::vector<NDArray*>& inputs) {
+  for (StatePool* pool = state_pools_.load(std::memory_order_acquire);
+       pool != nullptr; pool = pool->next) {
+    if (pool->context == ctx) return pool;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (StatePool* pool = state_pools_.load(std::memory_order_relaxed);
+       pool != nullptr; pool = pool->next) {
+    if (pool->context == ctx) return pool;
+  }
+  if (CheckDynamicShapeExists(ctx, inputs, true)) {
+    LOG(FATAL) << "Dynamic shapes aren't supported with thread-safe cached op";
+  }
+  nnvm::Graph full_graph;
+  std::unique_ptr<StatePool> pool(new StatePool(ctx, config_.num_states));
+  for (auto& state_ptr : pool->states) {
+    state_ptr = OpStatePtr::Create<CachedOpState>(ctx, fwd_graph_, full_graph, false);
+    // plan and allocate the memory of every state ahead of the calls
+    WarmupState(state_ptr, inputs, false);
+  }
+  pool->next = state_pools_.load(std::memory_order_relaxed);
+  state_pools_.store(pool.get(), std::memory_order_release);
+  return pool.release();
+}
+
+
+/*!
+ * \brief The flags understood by the base CachedOp, i.e. without those which
+ *  only the thread-safe CachedOp has, since CachedOpConfig rejects unknown flags.
+ */
+static std::vector<std::pair<std::string, std::string> > BaseCachedOpFlags(
+    const std::vector<std::pair<std::string, std::string> >& flags) {
+  std::vector<std::pair<std::string, std::string> > base_flags;
+  for (const auto& flag : flags) {
+    if (flag.first != "num_states") base_flags.push_back(flag);
+  }
+  return base_flags;
+}
 
 CachedOpThreadSafe::CachedOpThreadSafe(const nnvm::Symbol& sym,
                                        const std::vector<std::pair<std::string,
-                                       std::string> >& flags) : CachedOp(sym, flags) {
+                                       std::string> >& flags)
+    : CachedOp(sym, BaseCachedOpFlags(flags)) {
   using namespace nnvm;
   using namespace imperative;
   static const std::vector<const Op *> zero_ops{Op::Get("zeros_like"),
@@ -68,6 +150,9 @@ CachedOpThreadSafe::CachedOpThreadSafe(const nnvm::Symbol& sym,
   if (config_.static_shape) {
       CHECK(config_.static_alloc) << "static_alloc must be True when static_shape is True";
   }
+  if (config_.num_states > 0) {
+      CHECK(config_.static_alloc) << "static_alloc must be True when num_states is set";
+  }
 
   // construct forward graph
   CreateForwardGraph(sym.Copy(), &fwd_graph_);
@@ -159,17 +244,12 @@ OpStatePtr CachedOpThreadSafe::Forward(const std::shared_ptr<CachedOp>& op_ptr,
   // in the accept4 call in CUDA lib.
   // TODO(anirudh2290): Investigate this issue more as it also prevents parallel
   // push of ops for different contexts
-  std::lock_guard<std::mutex> lock(mutex_);
-  CHECK_EQ(inputs.size(), num_inputs());
-  const auto& idx = fwd_graph_.indexed_graph();
-  for (size_t i = 0; i < inputs.size(); ++i) {
-    CHECK_EQ(inputs[i]->ctx(), default_ctx)
-        << "CachedOp requires all inputs to live on the same context. But "
-        << idx[idx.input_nodes()[0]].source->attrs.name
-        << " is on " << default_ctx << " while "
-        << idx[idx.input_nodes()[i]].source->attrs.name
-        << " is on " << inputs[i]->ctx();
+  // With num_states, each call checks out a state of its own instead.
+  if (config_.num_states > 0) {
+    return PooledForward(default_ctx, inputs, outputs);
   }
+  std::lock_guard<std::mutex> lock(mutex_);
+  CheckInputContexts(inputs, default_ctx);
 
   int prev_bulk_size = Engine::Get()->set_bulk_size(config_.forward_bulk_size);
   OpStatePtr op_state;
@@ -190,6 +270,73 @@ OpStatePtr CachedOpThreadSafe::Forward(const std::shared_ptr<CachedOp>& op_ptr,
   return op_state;
 }
 
+OpStatePtr CachedOpThreadSafe::PooledForward(const Context& default_ctx,
+                                             const std::vector<NDArray*>& inputs,
+                                             const std::vector<NDArray*>& outputs) {
+  CheckInputContexts(inputs, default_ctx);
+  StatePool* pool = GetStatePool(default_ctx, inputs);
+  const size_t slot = pool->Checkout();
+  // The state is released once the ops are pushed, a later call on the
+  // same state is ordered after them by the engine through its arrays.
+  int prev_bulk_size = Engine::Get()->set_bulk_size(config_.forward_bulk_size);
+  OpStatePtr op_state;
+  try {
+    op_state = StaticForward(pool->states[slot], inputs, outputs);
+  } catch (const dmlc::Error& e) {
+    Engine::Get()->set_bulk_size(prev_bulk_size);
+    pool->Release(slot);
+    throw e;
+  }
+  Engine::Get()->set_bulk_size(prev_bulk_size);
+  pool->Release(slot);
+  return op_state;
+}
+
+void CachedOpThreadSafe::CheckInputContexts(const std::vector<NDArray*>& inputs,
+                                            const Context& default_ctx) const {
+  CHECK_EQ(inputs.size(), num_inputs());
+  const auto& idx = fwd_graph_.indexed_graph();
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    CHECK_EQ(inputs[i]->ctx(), default_ctx)
+        << "CachedOp requires all inputs to live on the same context. But "
+        << idx[idx.input_nodes()[0]].source->attrs.name
+        << " is on " << default_ctx << " while "
+        << idx[idx.input_nodes()[i]].source->attrs.name
+        << " is on " << inputs[i]->ctx();
+  }
+}
+
+void CachedOpThreadSafe::Warmup(const std::vector<NDArray*>& inputs,
+                                const Context& default_ctx,
+                                bool recording) {
+  CHECK(!recording) << "Only inference use case supported with thread safe cached op";
+  if (config_.num_states > 0) {
+    // grow every state of the pool for the signature, the first
+    // signature is planned when the pool is created
+    CheckInputContexts(inputs, default_ctx);
+    StatePool* pool = GetStatePool(default_ctx, inputs);
+    for (size_t i = 0; i < pool->states.size(); ++i) {
+      pool->Checkout(i);
+      WarmupState(pool->states[i], inputs, false);
+      pool->Release(i);
+    }
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  CHECK_EQ(inputs.size(), num_inputs());
+  if (CheckDynamicShapeExists(default_ctx, inputs, true)) {
+    LOG(FATAL) << "Dynamic shapes aren't supported with thread-safe cached op";
+  }
+  if (config_.static_alloc) {
+    CachedOp::Warmup(inputs, default_ctx, false);
+    return;
+  }
+  auto state_ptr = GetCachedOpState(default_ctx);
+  auto &state = state_ptr.get_state<CachedOpState>();
+  std::lock_guard<std::mutex> state_lock(state.mutex);
+  SetForwardGraph(default_ctx, &state.info, false, inputs);
+}
+
 struct CachedOpThreadSafeActualState {
   std::shared_ptr<CachedOp> op;
   OpStatePtr forward_state;
@@ -250,7 +397,14 @@ void CachedOpThreadSafeParamParser(nnvm::NodeAttrs* attrs) {
     throw dmlc::ParamError(os.str());
   }
 }
-CachedOpThreadSafe::~CachedOpThreadSafe() = default;
+CachedOpThreadSafe::~CachedOpThreadSafe() {
+  StatePool* pool = state_pools_.load();
+  while (pool != nullptr) {
+    StatePool* next = pool->next;
+    delete pool;
+    pool = next;
+  }
+}
 
 NNVM_REGISTER_OP(_CachedOpThreadSafe)
 .set_num_inputs([](const NodeAttrs& attrs) {
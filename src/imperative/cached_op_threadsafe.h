@@ -47,6 +47,8 @@ struct CachedOpThreadSafeConfig
   uint32_t forward_bulk_size;
   bool static_alloc;
   bool static_shape;
+  // number of pooled execution states per context, 0 serializes the calls
+  uint32_t num_states;
   DMLC_DECLARE_PARAMETER(CachedOpThreadSafeConfig) {
     DMLC_DECLARE_FIELD(static_alloc)
     .set_default(false)
@@ -66,6 +68,13 @@ struct CachedOpThreadSafeConfig
             DMLC_DECLARE_FIELD(param_indices)
         .set_default(mxnet::Tuple<uint32_t>())
         .describe("Position of parameters.");
+    DMLC_DECLARE_FIELD(num_states)
+        .set_default(0)
+        .describe("Number of execution states per context, each with its own "
+                  "statically allocated memory, which concurrent calls check out "
+                  "without locking so that they run independent forwards over the "
+                  "shared parameters. Requires static_alloc. 0 serializes the calls "
+                  "on a single state.");
   }
 };
 
@@ -99,6 +108,9 @@ class CachedOpThreadSafe : public CachedOp {
       const std::vector<NDArray*>& inputs,
       const std::vector<NDArray*>& outputs,
       const Context& default_ctx);
+  void Warmup(const std::vector<NDArray*>& inputs,
+              const Context& default_ctx,
+              bool recording) override;
   std::vector<std::string> ListForwardInputNames() const {
     nnvm::Symbol sym = GetForwardSym();
     return sym.ListInputNames(nnvm::Symbol::kAll);
@@ -116,17 +128,28 @@ class CachedOpThreadSafe : public CachedOp {
   struct GraphInfo;
  private:
   struct DynamicRuntime;
+  struct StatePool;
 
   OpStatePtr GetCachedOpState(const Context& ctx);
+  /*! \brief pool of states of a context, created and planned for inputs on first use */
+  StatePool* GetStatePool(const Context& ctx, const std::vector<NDArray*>& inputs);
 
   OpStatePtr DynamicForward(const Context& default_ctx,
                             const std::vector<NDArray*>& inputs,
                             const std::vector<NDArray*>& outputs);
+  OpStatePtr PooledForward(const Context& default_ctx,
+                           const std::vector<NDArray*>& inputs,
+                           const std::vector<NDArray*>& outputs);
+  void CheckInputContexts(const std::vector<NDArray*>& inputs,
+                          const Context& default_ctx) const;
 
   CachedOpThreadSafeConfig config_;
   nnvm::Graph fwd_graph_;
   std::mutex mutex_;
   std::unordered_map<Context, std::vector<OpStatePtr>> cached_op_states_;
+  // singly linked list of the pools, looked up without locking and only
+  // prepended to under mutex_
+  std::atomic<StatePool*> state_pools_{nullptr};
 };
 
 using CachedOpThreadSafePtr = std::shared_ptr<CachedOpThreadSafe>;
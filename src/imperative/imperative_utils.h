@@ -18,9 +18,13 @@
  */
 #include <mxnet/operator.h>
 #include <mxnet/imperative.h>
+#include <dmlc/thread_local.h>
 #include <nnvm/pass_functions.h>
+#include <unordered_map>
 #include <utility>
 #include <algorithm>
+#include <functional>
+#include <memory>
 #include <vector>
 #include <map>
 #include <string>
@@ -311,6 +315,194 @@ inline void SetShapeType(const Context& ctx,
   }
 }
 
+/*!
+ * \brief Attributes inferred by SetShapeType for a call of an operator on
+ *  inputs of given shapes, dtypes and storage types.
+ */
+struct DispatchCacheEntry {
+  const nnvm::Op* op;
+  int dev_mask;
+  bool is_np_shape;
+  // some operators infer the dtype of their outputs from the default dtype
+  bool is_np_default_dtype;
+  std::unordered_map<std::string, std::string> dict;
+  mxnet::ShapeVector input_shapes;
+  std::vector<int> input_types;
+  std::vector<int> input_storage_types;
+  // inferred attributes
+  mxnet::ShapeVector arg_shapes, out_shapes;
+  std::vector<int> arg_types, out_types;
+  std::vector<int> arg_storage_types, out_storage_types;
+  DispatchMode dispatch_mode;
+
+  bool Match(const Context& ctx,
+             const nnvm::NodeAttrs& attrs,
+             const std::vector<NDArray*>& inputs) const {
+    if (op != attrs.op || dev_mask != ctx.dev_mask() ||
+        is_np_shape != Imperative::Get()->is_np_shape() ||
+        is_np_default_dtype != Imperative::Get()->is_np_default_dtype() ||
+        input_shapes.size() != inputs.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      if (input_types[i] != inputs[i]->dtype() ||
+          input_storage_types[i] != inputs[i]->storage_type() ||
+          input_shapes[i] != inputs[i]->shape()) {
+        return false;
+      }
+    }
+    return dict == attrs.dict;
+  }
+};
+
+/*!
+ * \brief Per thread cache of the attributes inferred for operator calls, so that
+ *  repeated calls of an operator on inputs alike skip the attribute inference.
+ *  Entries are looked up by a hash of the operator, its attributes and its inputs,
+ *  and checked against all of them.
+ */
+class DispatchCache {
+ public:
+  static DispatchCache* Get() {
+    return dmlc::ThreadLocalStore<DispatchCache>::Get();
+  }
+
+  static size_t Hash(const Context& ctx,
+                     const nnvm::NodeAttrs& attrs,
+                     const std::vector<NDArray*>& inputs) {
+    size_t ret = std::hash<const nnvm::Op*>()(attrs.op);
+    ret = dmlc::HashCombine(ret, ctx.dev_mask());
+    ret = dmlc::HashCombine(ret, Imperative::Get()->is_np_default_dtype());
+    // the order of the attributes in the dict is arbitrary
+    size_t dict_hash = 0;
+    for (const auto& kv : attrs.dict) {
+      dict_hash += dmlc::HashCombine(std::hash<std::string>()(kv.first), kv.second);
+    }
+    ret = dmlc::HashCombine(ret, dict_hash);
+    for (const NDArray* i : inputs) {
+      ret = dmlc::HashCombine(ret, i->dtype());
+      ret = dmlc::HashCombine(ret, i->storage_type());
+      for (int j = 0; j < i->shape().ndim(); ++j) {
+        ret = dmlc::HashCombine(ret, i->shape()[j]);
+      }
+    }
+    return ret;
+  }
+
+  const DispatchCacheEntry* Find(size_t hash,
+                                 const Context& ctx,
+                                 const nnvm::NodeAttrs& attrs,
+                                 const std::vector<NDArray*>& inputs) const {
+    auto range = entries_.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second.Match(ctx, attrs, inputs)) return &it->second;
+    }
+    return nullptr;
+  }
+
+  void Insert(size_t hash, size_t capacity, DispatchCacheEntry&& entry) {
+    // calls alike are expected to repeat, so the cache is simply reset when full
+    if (entries_.size() >= capacity) entries_.clear();
+    entries_.emplace(hash, std::move(entry));
+  }
+
+ private:
+  std::unordered_multimap<size_t, DispatchCacheEntry> entries_;
+};
+
+/*!
+ * \brief SetShapeType with the inferred attributes cached per thread.
+ *
+ * Only calls on inputs of known shapes producing new outputs are cached. The
+ * number of cached calls per thread is bounded by MXNET_IMPERATIVE_DISPATCH_CACHE_SIZE.
+ */
+inline void SetShapeTypeCached(const Context& ctx,
+                               const nnvm::NodeAttrs& attrs,
+                               const std::vector<NDArray*>& inputs,
+                               const std::vector<NDArray*>& outputs,
+                               DispatchMode* dispatch_mode) {
+  static auto& infershape = nnvm::Op::GetAttr<mxnet::FInferShape>("FInferShape");
+  static const size_t capacity = dmlc::GetEnv("MXNET_IMPERATIVE_DISPATCH_CACHE_SIZE", 1024);
+  bool cacheable = capacity > 0 && infershape.count(attrs.op);
+  for (size_t i = 0; cacheable && i < inputs.size(); ++i) {
+    cacheable = shape_is_known(inputs[i]->shape());
+  }
+  for (size_t i = 0; cacheable && i < outputs.size(); ++i) {
+    cacheable = outputs[i]->is_none();
+  }
+  if (!cacheable) {
+    SetShapeType(ctx, attrs, inputs, outputs, dispatch_mode);
+    return;
+  }
+
+  MXAPIThreadLocalEntry<> *ret = MXAPIThreadLocalStore<>::Get();
+  DispatchCache* cache = DispatchCache::Get();
+  const size_t hash = DispatchCache::Hash(ctx, attrs, inputs);
+  const DispatchCacheEntry* entry = cache->Find(hash, ctx, attrs, inputs);
+  if (entry == nullptr) {
+    SetShapeType(ctx, attrs, inputs, outputs, dispatch_mode);
+    DispatchCacheEntry new_entry;
+    new_entry.op = attrs.op;
+    new_entry.dev_mask = ctx.dev_mask();
+    new_entry.is_np_shape = Imperative::Get()->is_np_shape();
+    new_entry.is_np_default_dtype = Imperative::Get()->is_np_default_dtype();
+    new_entry.dict = attrs.dict;
+    for (const NDArray* i : inputs) {
+      new_entry.input_shapes.push_back(i->shape());
+      new_entry.input_types.push_back(i->dtype());
+      new_entry.input_storage_types.push_back(i->storage_type());
+    }
+    new_entry.arg_shapes = ret->arg_shapes;
+    new_entry.out_shapes = ret->out_shapes;
+    new_entry.arg_types = ret->arg_types;
+    new_entry.out_types = ret->out_types;
+    new_entry.arg_storage_types = ret->arg_storage_types;
+    new_entry.out_storage_types = ret->out_storage_types;
+    new_entry.dispatch_mode = *dispatch_mode;
+    cache->Insert(hash, capacity, std::move(new_entry));
+    return;
+  }
+
+  ret->arg_shapes = entry->arg_shapes;
+  ret->out_shapes = entry->out_shapes;
+  ret->arg_types = entry->arg_types;
+  ret->out_types = entry->out_types;
+  ret->arg_storage_types = entry->arg_storage_types;
+  ret->out_storage_types = entry->out_storage_types;
+  *dispatch_mode = entry->dispatch_mode;
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    const auto storage_type = static_cast<NDArrayStorageType>(entry->out_storage_types[i]);
+    outputs[i]->ReInit(storage_type, entry->out_shapes[i], ctx, entry->out_types[i]);
+    outputs[i]->AssignStorageInfo(common::NodeAttrsGetProfilerScope(attrs), attrs.name);
+  }
+}
+
+/*!
+ * \brief Whether an operator call may be executed on the calling thread instead
+ *  of being pushed to the engine: small CPU operators without resources or
+ *  mutated inputs, when at most MXNET_IMPERATIVE_INLINE_MAX_SIZE elements are read
+ *  and written. Whether the arrays are ready is checked by the engine.
+ */
+inline bool CanRunInline(const Context& ctx,
+                         const std::vector<NDArray*>& inputs,
+                         const std::vector<NDArray*>& outputs,
+                         const std::vector<Resource>& requested,
+                         const std::vector<uint32_t>& mutate_idx) {
+  static const size_t max_size = dmlc::GetEnv("MXNET_IMPERATIVE_INLINE_MAX_SIZE", 0);
+  if (max_size == 0 || ctx.dev_mask() != cpu::kDevMask ||
+      !requested.empty() || !mutate_idx.empty()) {
+    return false;
+  }
+  size_t size = 0;
+  for (const auto arrs : {&inputs, &outputs}) {
+    for (const NDArray* i : *arrs) {
+      if (!shape_is_known(i->shape())) return false;
+      size += i->shape().Size();
+    }
+  }
+  return size <= max_size;
+}
+
 /*! \brief Set read and write vars, resource requests and mutate_idx
  *
  * For inputs and outputs arguments only NDArray::var() is accessed.
@@ -643,7 +835,8 @@ inline void PushFCompute(const FCompute& fn,
                   const std::vector<NDArray*>& p_inputs,
                   const std::vector<NDArray*>& p_outputs,
                   const std::vector<uint32_t>& mutate_idx,
-                  const std::vector<OpReqType>& req) {
+                  const std::vector<OpReqType>& req,
+                  bool try_inline = false) {
   using namespace common;
   static auto& fexec_type = nnvm::Op::GetAttr<FExecType>("FExecType");
 
@@ -681,7 +874,7 @@ inline void PushFCompute(const FCompute& fn,
   if (CheckIfSkipEngine(attrs)) {
     // execute without engine
     run(RunContext{ctx, nullptr, nullptr, false});
-  } else {
+  } else if (!try_inline || !Engine::Get()->TryRunInline(run, ctx, read_vars, write_vars)) {
     Engine::Get()->PushSync(
     run, ctx, read_vars, write_vars, FnProperty::kNormal,
     0, op->name.c_str());
@@ -697,7 +890,8 @@ inline void PushFComputeEx(const FComputeEx& fn,
                     const std::vector<Resource>& requested,
                     const std::vector<NDArray*>& p_inputs,
                     const std::vector<NDArray*>& p_outputs,
-                    const std::vector<OpReqType>& req) {
+                    const std::vector<OpReqType>& req,
+                    bool try_inline = false) {
   static auto& fexec_type = nnvm::Op::GetAttr<FExecType>("FExecType");
 
   const bool is_train = Imperative::Get()->is_training();
@@ -720,8 +914,10 @@ inline void PushFComputeEx(const FComputeEx& fn,
     run(RunContext{ctx, nullptr, nullptr, false});
   } else {
     CHECK(exec_type == ExecType::kSync);
-    Engine::Get()->PushSync(run, ctx, read_vars, write_vars, FnProperty::kNormal,
-                            0, op->name.c_str());
+    if (!try_inline || !Engine::Get()->TryRunInline(run, ctx, read_vars, write_vars)) {
+      Engine::Get()->PushSync(run, ctx, read_vars, write_vars, FnProperty::kNormal,
+                              0, op->name.c_str());
+    }
   }
 }
 
@@ -1143,6 +1339,100 @@ inline std::multimap<size_t, NDArray> AllocateMemory(
   return new_pool;
 }
 
+/*!
+ * \brief One contiguous allocation backing the planned storage of a graph for
+ *  all the memory plans it has been run with, e.g. one plan per input shape.
+ *  The arena is split into slots, the k-th largest slot being as large as the
+ *  k-th largest storage of any plan seen so far. Every seen plan therefore fits
+ *  into the slots and switching between them does not call the allocator.
+ *  Each slot is an NDArray of its own, so that the engine still tracks the
+ *  dependencies of every storage separately.
+ */
+class MemoryArena {
+ public:
+  /*! \brief Whether slots can be created for arrays of the given context */
+  static bool Supports(const Context& ctx) {
+    // static data NDArrays on cpu always live on cpu(0)
+    return ctx == Context::CPU() || ctx.dev_type == Context::kGPU;
+  }
+  /*!
+   * \brief Make room for a memory plan, growing the arena if it does not fit.
+   * \return the slots, to be used as reuse pool of AllocateMemory.
+   */
+  std::multimap<size_t, NDArray> Reserve(const MemoryPlanVector& mem_plan,
+                                         const uint32_t entry_start,
+                                         const uint32_t entry_end,
+                                         const Context& ctx) {
+    std::vector<size_t> sizes;
+    for (uint32_t i = entry_start; i < entry_end; ++i) {
+      const auto& plan = mem_plan[i];
+      if (plan.storage_id == exec::kExternalStorageID ||
+          plan.storage_id == exec::kDynamicStorageID || plan.root != i) {
+        continue;
+      }
+      sizes.push_back(plan.size);
+    }
+    std::sort(sizes.begin(), sizes.end(), std::greater<size_t>());
+    bool grow = ctx != ctx_ || sizes.size() > slot_sizes_.size();
+    if (sizes.size() > slot_sizes_.size()) slot_sizes_.resize(sizes.size(), 0);
+    for (size_t k = 0; k < sizes.size(); ++k) {
+      if (sizes[k] > slot_sizes_[k]) {
+        slot_sizes_[k] = sizes[k];
+        grow = true;
+      }
+    }
+    if (grow) Allocate(ctx);
+
+    std::multimap<size_t, NDArray> pool;
+    for (size_t k = 0; k < slots_.size(); ++k) {
+      pool.emplace(slot_sizes_[k], slots_[k]);
+    }
+    return pool;
+  }
+  /*! \brief Total size of the arena in bytes */
+  size_t size() const { return size_; }
+
+ private:
+  void Allocate(const Context& ctx) {
+    // aligned for vectorized cpu kernels and coalesced gpu accesses
+    const size_t alignment = 256;
+    std::vector<size_t> offsets;
+    size_ = 0;
+    for (const size_t slot_size : slot_sizes_) {
+      offsets.push_back(size_);
+      size_ += (slot_size + alignment - 1) / alignment * alignment;
+    }
+    // The memory is freed with the last slot referencing it, i.e. once
+    // the operators still running on the previous slots are done.
+    auto storage = Storage::_GetSharedRef();
+    std::shared_ptr<Storage::Handle> handle(new Storage::Handle(),
+        [storage](Storage::Handle* hd) {
+          if (hd->dptr != nullptr) storage->Free(*hd);
+          delete hd;
+        });
+    if (size_ > 0) {
+      handle->size = size_;
+      handle->ctx = ctx;
+      handle->name = "cached_op_arena";
+      storage->Alloc(handle.get());
+    }
+    slots_.clear();
+    for (size_t k = 0; k < slot_sizes_.size(); ++k) {
+      TBlob blob(static_cast<uint8_t*>(handle->dptr) + offsets[k],
+                 mxnet::TShape({static_cast<nnvm::dim_t>(slot_sizes_[k])}),
+                 ctx.dev_mask(), mshadow::kUint8, ctx.dev_id);
+      slots_.emplace_back(blob, ctx.dev_id, [handle]() {});
+    }
+    ctx_ = ctx;
+  }
+
+  Context ctx_;
+  size_t size_ = 0;
+  /*! \brief sizes of the slots in decreasing order */
+  std::vector<size_t> slot_sizes_;
+  std::vector<NDArray> slots_;
+};
+
 inline void SetupOpExec(
     const nnvm::Graph& g,
     size_t nid,
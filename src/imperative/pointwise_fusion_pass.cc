@@ -32,6 +32,7 @@
 #include <algorithm>
 #include <queue>
 #include <chrono>
+#include <tuple>
 #include "./simple_partition_pass.h"
 #include "../operator/fusion/fused_op-inl.h"
 #include "../operator/fusion/fused_op.h"
@@ -55,10 +56,9 @@ void WarnFusionNotSupported() {
   }
 }
 
-#if MXNET_USE_CUDA
-
 namespace {
 
+#if MXNET_USE_CUDA
 bool IsFusionCompatible(const nnvm::Node* n) {
   using namespace mxnet::fusion;
   if (n->op() == nullptr)
@@ -109,6 +109,19 @@ bool IsInputsOnlyCompatible(const nnvm::Node* n) {
   }
   return false;
 }
+#endif  // MXNET_USE_CUDA
+
+bool IsCPUFusionCompatible(const nnvm::Node* n) {
+  static auto& fcompute_cpu = Op::GetAttr<FCompute>("FCompute<cpu>");
+  if (n->op() == nullptr || fcompute_cpu.get(n->op(), nullptr) == nullptr)
+    return false;
+  return fusion::FindCPUOpDesc(n->attrs) != nullptr;
+}
+
+bool IsCPUInputsOnlyCompatible(const nnvm::Node* n) {
+  // the CPU backend needs all the entries of the subgraph to have the same size
+  return false;
+}
 
 void CreateSubgraphNode(const nnvm::Graph& subgraph,
                         size_t inputs_size,
@@ -359,11 +372,23 @@ Graph CopyAndReplaceSubgraphs(const Graph& g,
   return ret;
 }
 
-Graph FusePointwise(const Graph &g, const size_t num_forward_outputs) {
+Graph FusePointwise(const Graph &g, const size_t num_forward_outputs, const Context& context) {
   auto start = std::chrono::steady_clock::now();
-  auto [subset_assignment, num_subsets] = GetCompatibleSubsets(g, num_forward_outputs,  // NOLINT(*)
-                                                               IsFusionCompatible,
-                                                               IsInputsOnlyCompatible);
+  std::vector<int> subset_assignment;
+  int num_subsets = 0;
+  if (context.dev_mask() == cpu::kDevMask) {
+    std::tie(subset_assignment, num_subsets) = GetCompatibleSubsets(g, num_forward_outputs,
+                                                                    IsCPUFusionCompatible,
+                                                                    IsCPUInputsOnlyCompatible);
+  } else {
+#if MXNET_USE_CUDA
+    std::tie(subset_assignment, num_subsets) = GetCompatibleSubsets(g, num_forward_outputs,
+                                                                    IsFusionCompatible,
+                                                                    IsInputsOnlyCompatible);
+#else
+    LOG(FATAL) << "Pointwise fusion for " << context << " needs MXNet lib built with USE_CUDA=1";
+#endif  // MXNET_USE_CUDA
+  }
   Graph ret = CopyAndReplaceSubgraphs(g, subset_assignment, num_subsets,
                                       CreateSubgraphNode);
   auto end = std::chrono::steady_clock::now();
@@ -375,7 +400,6 @@ Graph FusePointwise(const Graph &g, const size_t num_forward_outputs) {
   }
   return ret;
 }
-#endif  // MXNET_USE_CUDA
 
 }  // namespace exec
 }  // namespace mxnet
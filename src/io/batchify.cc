@@ -280,7 +280,7 @@ class PadBatchify : public BatchifyFunction {
             (*outputs)[i].ReshapeAndAlloc(sshape);
           }
         } else {
-          (*outputs)[i] = NDArray(sshape, mxnet::Context::CPU(0), false, inputs[0][i].dtype());
+          (*outputs)[i] = NDArray(sshape, mxnet::Context::CPU(0), false, dtype);
         }
         MSHADOW_TYPE_SWITCH_WITH_BOOL(dtype, DType, {
           // fill pad value first
@@ -29,12 +29,16 @@
 #include <mxnet/ndarray.h>
 #include <mxnet/tensor_blob.h>
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <algorithm>
 #include <thread>
 
+#include "../common/mapped_file.h"
 #include "../imperative/cached_op.h"
 #include "../imperative/naive_cached_op.h"
 #include "../ndarray/ndarray_function.h"
@@ -61,6 +65,15 @@ struct RecordFileDatasetParam : public dmlc::Parameter<RecordFileDatasetParam> {
 
 DMLC_REGISTER_PARAMETER(RecordFileDatasetParam);
 
+/*!
+ * \brief Dataset of the records of a RecordIO file, in the order of its index file.
+ *  GetItem is called concurrently by the loader threads. Local files are memory
+ *  mapped, and every record is located through the index and parsed in place,
+ *  so the threads share no seek state and never wait for each other. Records
+ *  are returned without copying them. When records are accessed in file order,
+ *  e.g. by a sequential sampler, the kernel is asked to read ahead. Remote files
+ *  are read through a pool of stream readers, one per concurrent GetItem.
+ */
 class RecordFileDataset final : public Dataset {
  public:
   explicit RecordFileDataset(const std::vector<std::pair<std::string, std::string> >& kwargs) {
@@ -70,10 +83,33 @@ class RecordFileDataset final : public Dataset {
     dmlc::Stream *idx_stream = dmlc::Stream::Create(param_.idx_file.c_str(), "r");
     dmlc::istream is(idx_stream);
     size_t key, idx;
+    std::vector<size_t> positions;
     while (is >> key >> idx) {
-      idx_[key] = idx;
+      idx_[key].begin = idx;
+      positions.push_back(idx);
     }
     delete idx_stream;
+
+#ifndef _WIN32
+    const std::string local_prefix = "file://";
+    std::string path = param_.rec_file;
+    if (path.compare(0, local_prefix.size(), local_prefix) == 0) {
+      path = path.substr(local_prefix.size());
+    }
+    if (path.find("://") == std::string::npos) {
+      mapping_ = std::make_shared<common::MappedFile>(path);
+    }
+#endif  // _WIN32
+    if (mapping_) {
+      // a record ends where the next one in the file begins
+      std::sort(positions.begin(), positions.end());
+      for (auto& kv : idx_) {
+        auto next = std::upper_bound(positions.begin(), positions.end(), kv.second.begin);
+        kv.second.end = next == positions.end() ? mapping_->size() : *next;
+        CHECK_LE(kv.second.end, mapping_->size())
+            << "Index " << param_.idx_file << " does not match " << param_.rec_file;
+      }
+    }
   }
 
   uint64_t GetLen() const override {
@@ -83,35 +119,107 @@ class RecordFileDataset final : public Dataset {
   bool GetItem(uint64_t idx, std::vector<NDArray>* ret) override {
     ret->resize(1);
     auto& out = (*ret)[0];
-    static thread_local std::unique_ptr<dmlc::Stream> stream;
-    static thread_local std::unique_ptr<dmlc::RecordIOReader> reader;
+    auto it = idx_.find(static_cast<size_t>(idx));
+    CHECK(it != idx_.end()) << "Record " << idx << " is not in " << param_.idx_file;
+    const Record& record = it->second;
+    if (mapping_) {
+      Readahead(record);
+      dmlc::InputSplit::Blob chunk{mapping_->data() + record.begin, record.end - record.begin};
+      dmlc::RecordIOChunkReader reader(chunk, 0, 1);
+      dmlc::InputSplit::Blob blob;
+      if (reader.NextRecord(&blob)) {
+        char *dptr = static_cast<char*>(blob.dptr);
+        if (dptr >= mapping_->data() && dptr + blob.size <= mapping_->data() + mapping_->size()) {
+          // the mapping is private, writes to the record do not reach the file
+          TBlob data(dptr, TShape({static_cast<dim_t>(blob.size)}), cpu::kDevMask,
+                     mshadow::kInt8, 0);
+          auto mapping = mapping_;
+          out = NDArray(data, 0, [mapping]() {});
+        } else {
+          // records split into several parts are assembled in the reader's buffer
+          out = CopyRecord(dptr, blob.size);
+        }
+      }
+      return true;
+    }
+
+    std::unique_ptr<StreamReader> reader;
+    {
+      std::lock_guard<std::mutex> lock(readers_mutex_);
+      if (!free_readers_.empty()) {
+        reader = std::move(free_readers_.back());
+        free_readers_.pop_back();
+      }
+    }
     if (!reader) {
-      auto s = dmlc::Stream::Create(param_.rec_file.c_str(), "r");
-      stream.reset(s);
-      reader = std::make_unique<dmlc::RecordIOReader>(s);
+      reader = std::make_unique<StreamReader>();
+      reader->stream.reset(dmlc::Stream::Create(param_.rec_file.c_str(), "r"));
+      reader->reader = std::make_unique<dmlc::RecordIOReader>(reader->stream.get());
     }
-    size_t pos = idx_[static_cast<size_t>(idx)];
-    reader->Seek(pos);
-    static thread_local std::string read_buff;
-    if (reader->NextRecord(&read_buff)) {
-      const char *buf = read_buff.c_str();
-      const size_t size = read_buff.size();
-      out = NDArray(TShape({static_cast<dim_t>(size)}), Context::CPU(), false, mshadow::kInt8);
-      TBlob dst = out.data();
-      RunContext rctx{Context::CPU(), nullptr, nullptr, false};
-      mxnet::ndarray::Copy<cpu, cpu>(
-        TBlob(const_cast<void*>(reinterpret_cast<const void*>(buf)),
-          out.shape(), cpu::kDevMask, out.dtype(), 0),
-          &dst, Context::CPU(), Context::CPU(), rctx);
+    reader->reader->Seek(record.begin);
+    if (reader->reader->NextRecord(&reader->buff)) {
+      out = CopyRecord(reader->buff.c_str(), reader->buff.size());
     }
+    std::lock_guard<std::mutex> lock(readers_mutex_);
+    free_readers_.push_back(std::move(reader));
     return true;
   }
 
  private:
+  /*! \brief byte range of a record in the file */
+  struct Record {
+    size_t begin = 0;
+    size_t end = 0;
+  };
+  /*! \brief reader of a remote file, used by one GetItem at a time */
+  struct StreamReader {
+    std::unique_ptr<dmlc::Stream> stream;
+    std::unique_ptr<dmlc::RecordIOReader> reader;
+    std::string buff;
+  };
+  /*! \brief bytes read ahead of sequential accesses */
+  static constexpr size_t kReadaheadSize = 16 << 20;
+
+  static NDArray CopyRecord(const char *buf, size_t size) {
+    NDArray out(TShape({static_cast<dim_t>(size)}), Context::CPU(), false, mshadow::kInt8);
+    TBlob dst = out.data();
+    RunContext rctx{Context::CPU(), nullptr, nullptr, false};
+    mxnet::ndarray::Copy<cpu, cpu>(
+      TBlob(const_cast<void*>(reinterpret_cast<const void*>(buf)),
+        out.shape(), cpu::kDevMask, out.dtype(), 0),
+        &dst, Context::CPU(), Context::CPU(), rctx);
+    return out;
+  }
+
+  void Readahead(const Record& record) {
+    // loader threads work on consecutive records at the same time, so an
+    // access close to the previous one still counts as sequential
+    const size_t last_end = last_end_.exchange(record.end, std::memory_order_relaxed);
+    const size_t distance = record.begin > last_end ? record.begin - last_end
+                                                    : last_end - record.begin;
+    if (distance > kReadaheadSize) return;
+    size_t ahead = readahead_end_.load(std::memory_order_relaxed);
+    if (record.end + kReadaheadSize / 2 <= ahead) return;
+    const size_t from = std::max(ahead, record.end);
+    const size_t to = std::min(from + kReadaheadSize, mapping_->size());
+    if (from < to && readahead_end_.compare_exchange_strong(ahead, to)) {
+      mapping_->WillNeed(from, to - from);
+    }
+  }
+
   /*! \brief parameters */
   RecordFileDatasetParam param_;
-  /*! \brief indices */
-  std::unordered_map<size_t, size_t> idx_;
+  /*! \brief records by key */
+  std::unordered_map<size_t, Record> idx_;
+  /*! \brief mapping of a local record file */
+  std::shared_ptr<common::MappedFile> mapping_;
+  /*! \brief end of the last record read, to detect sequential accesses */
+  std::atomic<size_t> last_end_{0};
+  /*! \brief end of the range the kernel was asked to read ahead */
+  std::atomic<size_t> readahead_end_{0};
+  /*! \brief idle readers of a remote file */
+  std::vector<std::unique_ptr<StreamReader> > free_readers_;
+  std::mutex readers_mutex_;
 };
 
 MXNET_REGISTER_IO_DATASET(RecordFileDataset)
@@ -243,6 +243,10 @@ class DefaultImageAugmenter : public ImageAugmenter {
       return inter_method;
     }
   }
+  int MinSourceSize() const override {
+    // the source image is resized to resize before the other augmentations
+    return param_.resize > 0 ? param_.resize : 0;
+  }
   cv::Mat Process(const cv::Mat &src, std::vector<float> *label,
                   common::RANDOM_ENGINE *prnd) override {
     using mshadow::index_t;
@@ -59,6 +59,15 @@ class ImageAugmenter {
    */
   virtual cv::Mat Process(const cv::Mat &src, std::vector<float> *label,
                           common::RANDOM_ENGINE *prnd) = 0;
+  /*!
+   * \brief Smallest length of the shorter edge of the source image which gives
+   *  the same result up to resampling, e.g. because the augmenter resizes the
+   *  image first. Decoders may decode large images at a reduced scale down to it.
+   * \return the length, 0 if the image is needed at its full size
+   */
+  virtual int MinSourceSize() const {
+    return 0;
+  }
   // virtual destructor
   virtual ~ImageAugmenter() {}
   /*!
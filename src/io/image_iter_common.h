@@ -135,6 +135,8 @@ struct ImageRecParserParam : public dmlc::Parameter<ImageRecParserParam> {
   int shuffle_chunk_seed;
   /*! \brief random seed for augmentations */
   dmlc::optional<int> seed_aug;
+  /*! \brief whether to decode large JPEG images at a reduced scale */
+  bool scaled_decode;
 
   // declare parameters
   DMLC_DECLARE_PARAMETER(ImageRecParserParam) {
@@ -176,6 +178,11 @@ struct ImageRecParserParam : public dmlc::Parameter<ImageRecParserParam> {
         .describe("The random seed for shuffling");
     DMLC_DECLARE_FIELD(seed_aug).set_default(dmlc::optional<int>())
         .describe("Random seed for augmentations.");
+    DMLC_DECLARE_FIELD(scaled_decode).set_default(false)
+        .describe("If or not decode JPEG images which are larger than the first "
+                  "augmentation needs, e.g. than ``resize``, at a reduced scale of the DCT. "
+                  "This is much faster than decoding at full size, but the pixels differ "
+                  "slightly. Only used by ImageRecordIter built with libjpeg-turbo.");
   }
 };
 
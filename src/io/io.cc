@@ -23,6 +23,8 @@
 #include <dmlc/registry.h>
 #include "./image_augmenter.h"
 #include "./image_iter_common.h"
+#include "./iter_text_cache.h"
+#include "./iter_text_parser.h"
 
 // Registers
 namespace dmlc {
@@ -37,6 +39,8 @@ namespace io {
 DMLC_REGISTER_PARAMETER(BatchParam);
 DMLC_REGISTER_PARAMETER(BatchSamplerParam);
 DMLC_REGISTER_PARAMETER(PrefetcherParam);
+DMLC_REGISTER_PARAMETER(TextParserParam);
+DMLC_REGISTER_PARAMETER(TextCacheParam);
 DMLC_REGISTER_PARAMETER(ImageNormalizeParam);
 DMLC_REGISTER_PARAMETER(ImageRecParserParam);
 DMLC_REGISTER_PARAMETER(ImageRecordParam);
@@ -26,9 +26,12 @@
 #include <dmlc/base.h>
 #include <dmlc/logging.h>
 #include <dmlc/parameter.h>
-#include <dmlc/data.h>
+#include <cstring>
+#include <sstream>
+#include "./inst_vector.h"
 #include "./iter_prefetcher.h"
-#include "./iter_batchloader.h"
+#include "./iter_text_cache.h"
+#include "./iter_text_parser.h"
 
 namespace mxnet {
 namespace io {
@@ -57,159 +60,260 @@ struct CSVIterParam : public dmlc::Parameter<CSVIterParam> {
   }
 };
 
-class CSVIterBase: public IIterator<DataInst> {
+/*!
+ * \brief Reads CSV files straight into batches. The lines of a batch are
+ *  parsed on several threads, each directly into its row of the batch.
+ *  With a cache_file, the batches of the first full pass are also written to
+ *  the cache, which the rows are copied from in the following passes.
+ */
+class CSVIter: public IIterator<TBlobBatch> {
  public:
-  CSVIterBase() {
-    out_.data.resize(2);
-  }
-  ~CSVIterBase() override = default;
-
-  // initialize iterator loads data in
-  void Init(const std::vector<std::pair<std::string, std::string> >& kwargs) override = 0;
-  /*! \brief reset the iterator */
-  void BeforeFirst() override = 0;
-  /*! \brief move to next item */
-  bool Next() override = 0;
-  /*! \brief get current data */
-  const DataInst &Value() const override {
-    return out_;
-  }
-
- protected:
-  CSVIterParam param_;
-
-  DataInst out_;
-
-  // internal instance counter
-  unsigned inst_counter_{0};
-  // at end
-  bool end_{false};
-
-  // label parser
-  size_t label_ptr_{0}, label_size_{0};
-  size_t data_ptr_{0}, data_size_{0};
-};
+  CSVIter() = default;
+  ~CSVIter() override = default;
 
-template <typename DType>
-class CSVIterTyped: public CSVIterBase {
- public:
-  ~CSVIterTyped() override = default;
   // intialize iterator loads data in
   void Init(const std::vector<std::pair<std::string, std::string> >& kwargs) override {
     param_.InitAllowUnknown(kwargs);
-    data_parser_.reset(dmlc::Parser<uint32_t, DType>::Create(param_.data_csv.c_str(), 0, 1, "csv"));
-    if (param_.label_csv != "NULL") {
-      label_parser_.reset(
-        dmlc::Parser<uint32_t, DType>::Create(param_.label_csv.c_str(), 0, 1, "csv"));
+    batch_param_.InitAllowUnknown(kwargs);
+    parser_param_.InitAllowUnknown(kwargs);
+    cache_param_.InitAllowUnknown(kwargs);
+    dtype_ = mshadow::kFloat32;
+    for (const auto& arg : kwargs) {
+      if (arg.first == "dtype") {
+        if (arg.second == "int32") {
+          dtype_ = mshadow::kInt32;
+        } else if (arg.second == "int64") {
+          dtype_ = mshadow::kInt64;
+        } else if (arg.second == "float32") {
+          dtype_ = mshadow::kFloat32;
+        } else {
+          CHECK(false) << arg.second << " is not supported for CSVIter";
+        }
+      }
+    }
+    // without label_csv all the labels are a single 0
+    label_shape_ = param_.label_csv != "NULL" ? param_.label_shape
+                                              : mxnet::TShape(mshadow::Shape1(1));
+    std::ostringstream key;
+    key << "CSVIter data_csv=" << param_.data_csv << " data_shape=" << param_.data_shape
+        << " label_csv=" << param_.label_csv << " label_shape=" << label_shape_
+        << " dtype=" << dtype_;
+    cache_key_ = key.str();
+    if (!cache_param_.cache_file.empty() && TextCacheExists(cache_param_.cache_file)) {
+      cache_reader_.reset(new TextCacheReader(cache_param_.cache_file, cache_key_));
     } else {
-      dummy_label.set_pad(false);
-      dummy_label.Resize(mshadow::Shape1(1));
-      dummy_label = 0;
+      data_reader_.reset(new TextLineReader(param_.data_csv, 0, 1));
+      if (param_.label_csv != "NULL") {
+        label_reader_.reset(new TextLineReader(param_.label_csv, 0, 1));
+      }
     }
+    const size_t batch_size = batch_param_.batch_size;
+    data_.resize(mshadow::Shape1(batch_size * param_.data_shape.Size()), dtype_);
+    label_.resize(mshadow::Shape1(batch_size * label_shape_.Size()), dtype_);
+    std::memset(label_.dptr_, 0, label_.Size() * mshadow::mshadow_sizeof(dtype_));
+
+    out_.inst_index = new unsigned[batch_size];
+    out_.batch_size = batch_size;
+    out_.data.clear();
+    out_.data.emplace_back(data_.dptr_, BatchShape(param_.data_shape), cpu::kDevMask, dtype_, 0);
+    out_.data.emplace_back(label_.dptr_, BatchShape(label_shape_), cpu::kDevMask, dtype_, 0);
+    Reset();
   }
 
   void BeforeFirst() override {
-    data_parser_->BeforeFirst();
-    if (label_parser_.get() != nullptr) {
-      label_parser_->BeforeFirst();
+    if (!batch_param_.round_batch || num_overflow_ == 0) {
+      // otherwise the readers already restarted for the overflow
+      Reset();
+    } else {
+      num_overflow_ = 0;
     }
-    data_ptr_ = label_ptr_ = 0;
-    data_size_ = label_size_ = 0;
-    inst_counter_ = 0;
-    end_ = false;
   }
 
   bool Next() override {
-    if (end_) return false;
-    while (data_ptr_ >= data_size_) {
-      if (!data_parser_->Next()) {
-        end_ = true; return false;
-      }
-      data_ptr_ = 0;
-      data_size_ = data_parser_->Value().size;
+    out_.num_batch_padd = 0;
+    // if overflown from previous round, directly return false, until before first is called
+    if (num_overflow_ != 0) return false;
+    const size_t batch_size = batch_param_.batch_size;
+    size_t top = Fill(0);
+    if (cache_writer_.get() != nullptr) {
+      cache_writer_->Append(top, {
+        TBlob(data_.dptr_, mshadow::Shape1(top * param_.data_shape.Size()),
+              cpu::kDevMask, dtype_, 0),
+        TBlob(label_.dptr_, mshadow::Shape1(top * label_shape_.Size()),
+              cpu::kDevMask, dtype_, 0)});
+      // the input is exhausted, read the cache from now on
+      if (top < batch_size) FinishCache();
     }
-    out_.index = inst_counter_++;
-    CHECK_LT(data_ptr_, data_size_);
-    out_.data[0] = AsTBlob(data_parser_->Value()[data_ptr_++], param_.data_shape);
-
-    if (label_parser_.get() != nullptr) {
-      while (label_ptr_ >= label_size_) {
-        CHECK(label_parser_->Next())
-            << "Data CSV's row is smaller than the number of rows in label_csv";
-        label_ptr_ = 0;
-        label_size_ = label_parser_->Value().size;
-      }
-      CHECK_LT(label_ptr_, label_size_);
-      out_.data[1] = AsTBlob(label_parser_->Value()[label_ptr_++], param_.label_shape);
+    if (top == batch_size) return true;
+    if (top == 0) return false;
+    if (batch_param_.round_batch) {
+      Reset();
+      const size_t last = top;
+      top = Fill(top);
+      CHECK_EQ(top, batch_size) << "number of input must be bigger than batch size";
+      num_overflow_ = static_cast<int>(batch_size - last);
+      out_.num_batch_padd = num_overflow_;
     } else {
-      out_.data[1] = dummy_label;
+      out_.num_batch_padd = batch_size - top;
     }
     return true;
   }
 
+  const TBlobBatch &Value() const override {
+    return out_;
+  }
+
  private:
-  inline TBlob AsTBlob(const dmlc::Row<uint32_t, DType>& row, const mxnet::TShape& shape) {
-    CHECK_EQ(row.length, shape.Size())
-        << "The data size in CSV do not match size of shape: "
-        << "specified shape=" << shape << ", the csv row-length=" << row.length;
-    const DType* ptr = row.value;
-    return TBlob((DType*)ptr, shape, cpu::kDevMask, 0);  // NOLINT(*)
+  mxnet::TShape BatchShape(const mxnet::TShape& shape) const {
+    mxnet::TShape batch_shape(shape.ndim() + 1, -1);
+    batch_shape[0] = batch_param_.batch_size;
+    for (int i = 0; i < shape.ndim(); ++i) batch_shape[i + 1] = shape[i];
+    return batch_shape;
   }
-  // dummy label
-  mshadow::TensorContainer<cpu, 1, DType> dummy_label;
-  std::unique_ptr<dmlc::Parser<uint32_t, DType> > label_parser_;
-  std::unique_ptr<dmlc::Parser<uint32_t, DType> > data_parser_;
-};
 
-class CSVIter: public IIterator<DataInst> {
- public:
-  CSVIter() = default;
-  ~CSVIter() override = default;
+  void Reset() {
+    inst_counter_ = 0;
+    if (cache_reader_.get() != nullptr) {
+      cache_reader_->BeforeFirst(cache_param_.cache_shuffle, cache_param_.cache_seed);
+      return;
+    }
+    data_reader_->BeforeFirst();
+    if (label_reader_.get() != nullptr) {
+      label_reader_->BeforeFirst();
+    }
+    if (!cache_param_.cache_file.empty()) {
+      // drops the cache of an unfinished pass
+      cache_writer_.reset();
+      cache_writer_.reset(new TextCacheWriter(cache_param_.cache_file, cache_key_,
+                                              {dtype_, dtype_}));
+    }
+  }
 
-  // intialize iterator loads data in
-  void Init(const std::vector<std::pair<std::string, std::string> >& kwargs) override {
-    param_.InitAllowUnknown(kwargs);
-    bool dtype_has_value = false;
-    int target_dtype = -1;
-    for (const auto& arg : kwargs) {
-      if (arg.first == "dtype") {
-        dtype_has_value = true;
-        if (arg.second == "int32") {
-          target_dtype = mshadow::kInt32;
-        } else if (arg.second == "int64") {
-          target_dtype = mshadow::kInt64;
-        } else if (arg.second == "float32") {
-          target_dtype = mshadow::kFloat32;
-        } else {
-          CHECK(false) << arg.second << " is not supported for CSVIter";
-        }
+  void FinishCache() {
+    cache_writer_->Finish();
+    cache_writer_.reset();
+    data_reader_.reset();
+    label_reader_.reset();
+    cache_reader_.reset(new TextCacheReader(cache_param_.cache_file, cache_key_));
+  }
+
+  /*! \brief fill the rows from top on, returns the new number of rows */
+  size_t Fill(size_t top) {
+    return cache_reader_.get() != nullptr ? FillFromCache(top) : FillFromText(top);
+  }
+
+  size_t FillFromCache(size_t top) {
+    const size_t batch_size = batch_param_.batch_size;
+    const size_t data_size = param_.data_shape.Size();
+    const size_t label_size = label_shape_.Size();
+    TextCacheReader::Span span;
+    while (top < batch_size && cache_reader_->Next(batch_size - top, &span)) {
+      MSHADOW_TYPE_SWITCH(dtype_, DType, {
+        const DType* data = cache_reader_->Array<DType>(span.block, 0);
+        const DType* label = cache_reader_->Array<DType>(span.block, 1);
+        std::memcpy(data_.dptr<DType>() + top * data_size, data + span.begin * data_size,
+                    span.num_rows * data_size * sizeof(DType));
+        std::memcpy(label_.dptr<DType>() + top * label_size, label + span.begin * label_size,
+                    span.num_rows * label_size * sizeof(DType));
+      });
+      const size_t first_row = cache_reader_->FirstRow(span.block) + span.begin;
+      for (size_t i = 0; i < span.num_rows; ++i) {
+        out_.inst_index[top + i] = static_cast<unsigned>(first_row + i);
       }
+      top += span.num_rows;
     }
-    if (dtype_has_value && target_dtype == mshadow::kInt32) {
-      iterator_.reset(reinterpret_cast<CSVIterBase*>(new CSVIterTyped<int32_t>()));
-    } else if (dtype_has_value && target_dtype == mshadow::kInt64) {
-      iterator_.reset(reinterpret_cast<CSVIterBase*>(new CSVIterTyped<int64_t>()));
-    } else if (!dtype_has_value || target_dtype == mshadow::kFloat32) {
-      iterator_.reset(reinterpret_cast<CSVIterBase*>(new CSVIterTyped<float>()));
+    return top;
+  }
+
+  /*! \brief parse lines into the rows from top on, returns the new number of rows */
+  size_t FillFromText(size_t top) {
+    const size_t batch_size = batch_param_.batch_size;
+    const TextLine* lines;
+    size_t num_lines;
+    while (top < batch_size && data_reader_->Next(batch_size - top, &lines, &num_lines)) {
+      ParseRows(lines, num_lines, top, data_, param_.data_shape);
+      if (label_reader_.get() != nullptr) {
+        for (size_t done = 0; done < num_lines;) {
+          size_t num_labels;
+          CHECK(label_reader_->Next(num_lines - done, &lines, &num_labels))
+              << "label_csv has less rows than data_csv";
+          ParseRows(lines, num_labels, top + done, label_, param_.label_shape);
+          done += num_labels;
+        }
+      }
+      for (size_t i = 0; i < num_lines; ++i) {
+        out_.inst_index[top + i] = inst_counter_++;
+      }
+      top += num_lines;
     }
-    iterator_->Init(kwargs);
+    return top;
   }
 
-  void BeforeFirst() override {
-    iterator_->BeforeFirst();
+  void ParseRows(const TextLine* lines, size_t num_lines, size_t top,
+                 const TBlob& batch, const mxnet::TShape& shape) {
+    const size_t row_size = shape.Size();
+    switch (dtype_) {
+      case mshadow::kInt32:
+        ParseRows(lines, num_lines, batch.dptr<int32_t>() + top * row_size, shape);
+        break;
+      case mshadow::kInt64:
+        ParseRows(lines, num_lines, batch.dptr<int64_t>() + top * row_size, shape);
+        break;
+      default:
+        ParseRows(lines, num_lines, batch.dptr<float>() + top * row_size, shape);
+    }
+    TextParserCounters::Get()->num_rows += static_cast<int64_t>(num_lines);
   }
 
-  bool Next() override {
-    return iterator_->Next();
+  template<typename DType>
+  void ParseRows(const TextLine* lines, size_t num_lines, DType* out,
+                 const mxnet::TShape& shape) {
+    const size_t row_size = shape.Size();
+    ParseLinesParallel(num_lines, parser_param_.preprocess_threads, [&](size_t i) {
+      ParseRow(lines[i], out + i * row_size, shape);
+    });
   }
 
-  const DataInst &Value() const override {
-    return iterator_->Value();
+  /*! \brief parse the comma separated values of a line, empty values are 0 */
+  template<typename DType>
+  static void ParseRow(const TextLine& line, DType* out, const mxnet::TShape& shape) {
+    const size_t row_size = shape.Size();
+    size_t length = 0;
+    const char* p = line.begin;
+    while (true) {
+      DType value = 0;
+      p = SkipBlank(p, line.end);
+      const char* q = ParseNumber(p, line.end, &value);
+      if (length < row_size) out[length] = value;
+      ++length;
+      p = SkipBlank(q, line.end);
+      if (p == line.end) break;
+      CHECK_EQ(*p, ',') << "Invalid value in CSV row: " << std::string(line.begin, line.end);
+      if (++p == line.end) break;
+    }
+    CHECK_EQ(length, row_size)
+        << "The data size in CSV do not match size of shape: "
+        << "specified shape=" << shape << ", the csv row-length=" << length;
   }
 
- private:
   CSVIterParam param_;
-  std::unique_ptr<CSVIterBase> iterator_;
+  BatchParam batch_param_;
+  TextParserParam parser_param_;
+  TextCacheParam cache_param_;
+  int dtype_;
+  mxnet::TShape label_shape_;
+  TBlobBatch out_;
+  TBlobContainer data_;
+  TBlobContainer label_;
+  std::unique_ptr<TextLineReader> data_reader_;
+  std::unique_ptr<TextLineReader> label_reader_;
+  std::string cache_key_;
+  std::unique_ptr<TextCacheWriter> cache_writer_;
+  std::unique_ptr<TextCacheReader> cache_reader_;
+  // internal instance counter
+  unsigned inst_counter_{0};
+  // number of instances read from the next round to fill the last batch
+  int num_overflow_{0};
 };
 
 
@@ -232,6 +336,13 @@ to set `round_batch` to False.
 
 If ``data_csv = 'data/'`` is set, then all the files in this directory will be read.
 
+The lines of a batch are parsed on `preprocess_threads` threads.
+
+When `cache_file` is set, the parsed rows are written to that file during the first full pass
+over the data, and the following passes read them from it instead of parsing the CSV files
+again. With `cache_shuffle` set to ``True`` the blocks of the cache, one batch each, are read
+in a new random order every pass.
+
 ``reset()`` is expected to be called only after a complete pass of data.
 
 By default, the CSVIter parses all entries in the data file as float32 data type,
@@ -309,10 +420,11 @@ Examples::
 .add_arguments(CSVIterParam::__FIELDS__())
 .add_arguments(BatchParam::__FIELDS__())
 .add_arguments(PrefetcherParam::__FIELDS__())
+.add_arguments(TextParserParam::__FIELDS__())
+.add_arguments(TextCacheParam::__FIELDS__())
 .set_body([]() {
     return new PrefetcherIter(
-        new BatchLoader(
-            new CSVIter()));
+        new CSVIter());
   });
 
 }  // namespace io
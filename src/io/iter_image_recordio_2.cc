@@ -33,6 +33,8 @@
 #include <dmlc/omp.h>
 #include <dmlc/common.h>
 #include <dmlc/timer.h>
+#include <algorithm>
+#include <cmath>
 #include <memory>
 #include <type_traits>
 #if MXNET_USE_LIBJPEG_TURBO
@@ -75,7 +77,7 @@ class ImageRecordIOParser2 {
     mshadow::Tensor<cpu, 3, DType>* data_ptr, const bool is_mirrored, const float contrast_scaled,
     const float illumination_scaled);
 #if MXNET_USE_LIBJPEG_TURBO
-  cv::Mat TJimdecode(cv::Mat buf, int color);
+  cv::Mat TJimdecode(cv::Mat buf, int color, int min_size);
 #endif
 #endif
   inline size_t ParseChunk(DType* data_dptr, real_t* label_dptr, const size_t current_size,
@@ -121,7 +123,9 @@ class ImageRecordIOParser2 {
   // (without IndexedRecordIO support)
   bool legacy_shuffle_;
   // whether mean image is ready.
-  bool meanfile_ready_;
+  bool meanfile_ready_{false};
+  // length of the shorter edge JPEG images may be decoded down to, 0 for full size
+  int decode_min_size_{0};
   /*! \brief OMPException obj to store and rethrow exceptions from omp blocks*/
   dmlc::OMPException omp_exc_;
 };
@@ -169,6 +173,10 @@ inline void ImageRecordIOParser2<DType>::Init(
     }
     prnds_.emplace_back(new common::RANDOM_ENGINE((i + 1) * kRandMagic));
   }
+  // only the first augmenter sees the decoded image
+  if (param_.scaled_decode && !augmenters_[0].empty()) {
+    decode_min_size_ = augmenters_[0][0]->MinSourceSize();
+  }
   if (param_.path_imglist.length() != 0) {
     label_map_ = std::make_unique<ImageLabelMap>(param_.path_imglist.c_str(),
       param_.label_width, !param_.verbose);
@@ -378,92 +386,82 @@ inline bool ImageRecordIOParser2<DType>::ParseNext(DataBatch *out) {
 }
 
 #if MXNET_USE_OPENCV
+/*!
+ * \brief Write value(j) for the pixels j of a row into the row of an output
+ *  plane, mirrored if needed. The loops are vectorized, value(j) must not
+ *  depend on other pixels.
+ */
+template<typename DType, typename F>
+inline void StoreRow(DType* dst, const int cols, const bool is_mirrored, const F& value) {
+  // mirror here to avoid memory copies
+  // logic from iter_normalize.h, function SetOutImg
+  if (is_mirrored) {
+    DType* last = dst + cols - 1;
+    #pragma omp simd
+    for (int j = 0; j < cols; ++j) {
+      last[-j] = value(j);
+    }
+  } else {
+    #pragma omp simd
+    for (int j = 0; j < cols; ++j) {
+      dst[j] = value(j);
+    }
+  }
+}
+
 template<typename DType>
 template<int n_channels>
 void ImageRecordIOParser2<DType>::ProcessImage(const cv::Mat& res,
   mshadow::Tensor<cpu, 3, DType>* data_ptr, const bool is_mirrored, const float contrast_scaled,
   const float illumination_scaled) {
-  float RGBA_MULT[4] = { 0 };
-  float RGBA_BIAS[4] = { 0 };
-  float RGBA_MEAN[4] = { 0 };
-  int16_t RGBA_MEAN_INT[4] = {0};
   mshadow::Tensor<cpu, 3, DType>& data = (*data_ptr);
-  if (!std::is_same<DType, uint8_t>::value) {
-    RGBA_MULT[0] = contrast_scaled / normalize_param_.std_r;
-    RGBA_MULT[1] = contrast_scaled / normalize_param_.std_g;
-    RGBA_MULT[2] = contrast_scaled / normalize_param_.std_b;
-    RGBA_MULT[3] = contrast_scaled / normalize_param_.std_a;
-    RGBA_BIAS[0] = illumination_scaled / normalize_param_.std_r;
-    RGBA_BIAS[1] = illumination_scaled / normalize_param_.std_g;
-    RGBA_BIAS[2] = illumination_scaled / normalize_param_.std_b;
-    RGBA_BIAS[3] = illumination_scaled / normalize_param_.std_a;
-    if (!meanfile_ready_) {
-      RGBA_MEAN[0] = normalize_param_.mean_r;
-      RGBA_MEAN[1] = normalize_param_.mean_g;
-      RGBA_MEAN[2] = normalize_param_.mean_b;
-      RGBA_MEAN[3] = normalize_param_.mean_a;
-      RGBA_MEAN_INT[0] = std::round(normalize_param_.mean_r);
-      RGBA_MEAN_INT[1] = std::round(normalize_param_.mean_g);
-      RGBA_MEAN_INT[2] = std::round(normalize_param_.mean_b);
-      RGBA_MEAN_INT[3] = std::round(normalize_param_.mean_a);
-    }
-  }
-
-  int swap_indices[n_channels]; // NOLINT(*)
-  if (n_channels == 1) {
-    swap_indices[0] = 0;
-  } else if (n_channels == 3) {
-    swap_indices[0] = 2;
-    swap_indices[1] = 1;
-    swap_indices[2] = 0;
-  } else if (n_channels == 4) {
-    swap_indices[0] = 2;
-    swap_indices[1] = 1;
-    swap_indices[2] = 0;
-    swap_indices[3] = 3;
-  }
-
-  DType RGBA[n_channels] = {};
+  const float RGBA_STD[4] = {normalize_param_.std_r, normalize_param_.std_g,
+                             normalize_param_.std_b, normalize_param_.std_a};
+  const float RGBA_MEAN[4] = {normalize_param_.mean_r, normalize_param_.mean_g,
+                              normalize_param_.mean_b, normalize_param_.mean_a};
+  // OpenCV stores BGR (or BGRA) and we want RGB (or RGBA)
+  const int swap_indices[4] = {n_channels == 1 ? 0 : 2, 1, 0, 3};
+  const int cols = res.cols;
+  // The image is converted one row at a time: the row of every output plane is
+  // filled from the interleaved pixels, with the channel swap, normalization and
+  // mirroring fused into a single pass (logic from iter_normalize.h, function
+  // SetOutImg).
   for (int i = 0; i < res.rows; ++i) {
-    const uchar* im_data = res.ptr<uchar>(i);
-    for (int j = 0; j < res.cols; ++j) {
-      if (std::is_same<DType, int8_t>::value) {
-        if (meanfile_ready_) {
-          for (int k = 0; k < n_channels; ++k) {
-            RGBA[k] = cv::saturate_cast<int8_t>(im_data[swap_indices[k]] -
-                                    static_cast<int16_t>(std::round(meanimg_[k][i][j])));
-          }
+    const uchar* im_row = res.ptr<uchar>(i);
+    for (int k = 0; k < n_channels; ++k) {
+      const uchar* src = im_row + swap_indices[k];
+      DType* dst = data[k][i].dptr_;
+      const float* mean_row = meanfile_ready_ ? meanimg_[k][i].dptr_ : nullptr;
+      if (std::is_same<DType, uint8_t>::value) {
+        StoreRow(dst, cols, is_mirrored, [src](int j) {
+          return static_cast<DType>(src[j * n_channels]);
+        });
+      } else if (std::is_same<DType, int8_t>::value) {
+        if (mean_row != nullptr) {
+          StoreRow(dst, cols, is_mirrored, [src, mean_row](int j) {
+            return static_cast<DType>(cv::saturate_cast<int8_t>(
+                src[j * n_channels] - static_cast<int16_t>(std::round(mean_row[j]))));
+          });
         } else {
-          for (int k = 0; k < n_channels; ++k) {
-            RGBA[k] = cv::saturate_cast<int8_t>(im_data[swap_indices[k]] - RGBA_MEAN_INT[k]);
-          }
+          const int16_t mean = std::round(RGBA_MEAN[k]);
+          StoreRow(dst, cols, is_mirrored, [src, mean](int j) {
+            return static_cast<DType>(cv::saturate_cast<int8_t>(src[j * n_channels] - mean));
+          });
         }
       } else {
-        for (int k = 0; k < n_channels; ++k) {
-          RGBA[k] = im_data[swap_indices[k]];
-        }
-        if (!std::is_same<DType, uint8_t>::value) {
-          // normalize/mirror here to avoid memory copies
-          // logic from iter_normalize.h, function SetOutImg
-          for (int k = 0; k < n_channels; ++k) {
-            if (meanfile_ready_) {
-              RGBA[k] = (RGBA[k] - meanimg_[k][i][j]) * RGBA_MULT[k] + RGBA_BIAS[k];
-            } else {
-              RGBA[k] = (RGBA[k] - RGBA_MEAN[k]) * RGBA_MULT[k] + RGBA_BIAS[k];
-            }
-          }
-        }
-      }
-      for (int k = 0; k < n_channels; ++k) {
-        // mirror here to avoid memory copies
-        // logic from iter_normalize.h, function SetOutImg
-        if (is_mirrored) {
-          data[k][i][res.cols - j - 1] = RGBA[k];
+        const float mult = contrast_scaled / RGBA_STD[k];
+        const float bias = illumination_scaled / RGBA_STD[k];
+        if (mean_row != nullptr) {
+          StoreRow(dst, cols, is_mirrored, [src, mean_row, mult, bias](int j) {
+            return static_cast<DType>((src[j * n_channels] - mean_row[j]) * mult + bias);
+          });
         } else {
-          data[k][i][j] = RGBA[k];
+          const float mean = RGBA_MEAN[k];
+          StoreRow(dst, cols, is_mirrored, [src, mean, mult, bias](int j) {
+            return static_cast<DType>((src[j * n_channels] - mean) * mult + bias);
+          });
         }
       }
-      im_data += n_channels;
     }
   }
 }
@@ -479,7 +477,7 @@ bool is_jpeg(unsigned char * file) {
 }
 
 template<typename DType>
-cv::Mat ImageRecordIOParser2<DType>::TJimdecode(cv::Mat image, int color) {
+cv::Mat ImageRecordIOParser2<DType>::TJimdecode(cv::Mat image, int color, int min_size) {
   unsigned char* jpeg = image.ptr();
   size_t jpeg_size = image.rows * image.cols;
 
@@ -496,8 +494,26 @@ cv::Mat ImageRecordIOParser2<DType>::TJimdecode(cv::Mat image, int color) {
                                 &w, &h, &subsamp);
   if (err != 0) {
     // If it is a malformed JPEG then fall back to OpenCV
+    tjDestroy(handle);
     return cv::imdecode(image, color);
   }
+  if (min_size > 0) {
+    // decode at the smallest scale of the DCT which keeps the shorter edge
+    // at least min_size, which skips most of the work for large images
+    int num_factors;
+    const tjscalingfactor* factors = tjGetScalingFactors(&num_factors);
+    int scaled_w = w, scaled_h = h;
+    for (int i = 0; i < num_factors; ++i) {
+      const int factor_w = TJSCALED(w, factors[i]);
+      const int factor_h = TJSCALED(h, factors[i]);
+      if (std::min(factor_w, factor_h) >= min_size && factor_w < scaled_w) {
+        scaled_w = factor_w;
+        scaled_h = factor_h;
+      }
+    }
+    w = scaled_w;
+    h = scaled_h;
+  }
   cv::Mat ret = cv::Mat(h, w, color ? CV_8UC3 : CV_8UC1);
   err = tjDecompress2(handle,
                       jpeg,
@@ -508,11 +524,11 @@ cv::Mat ImageRecordIOParser2<DType>::TJimdecode(cv::Mat image, int color) {
                       h,
                       color ? TJPF_BGR : TJPF_GRAY,
                       0);
+  tjDestroy(handle);
   if (err != 0) {
     // If it is a malformed JPEG then fall back to OpenCV
     return cv::imdecode(image, color);
   }
-  tjDestroy(handle);
   return ret;
 }
 #endif
@@ -566,14 +582,14 @@ inline size_t ImageRecordIOParser2<DType>::ParseChunk(DType* data_dptr, real_t*
       switch (param_.data_shape[0]) {
        case 1:
 #if MXNET_USE_LIBJPEG_TURBO
-        res = TJimdecode(buf, 0);
+        res = TJimdecode(buf, 0, decode_min_size_);
 #else
         res = cv::imdecode(buf, 0);
 #endif
         break;
        case 3:
 #if MXNET_USE_LIBJPEG_TURBO
-        res = TJimdecode(buf, 1);
+        res = TJimdecode(buf, 1, decode_min_size_);
 #else
         res = cv::imdecode(buf, 1);
 #endif
@@ -841,6 +857,9 @@ class ImageRecordIter2Wrapper : public IIterator<DataBatch> {
         case mshadow::kFloat32:
           record_iter_ = new ImageRecordIter2CPU<float>();
           break;
+        case mshadow::kFloat16:
+          record_iter_ = new ImageRecordIter2CPU<mshadow::half::half_t>();
+          break;
         case mshadow::kUint8:
           record_iter_ = new ImageRecordIter2CPU<uint8_t>();
           break;
@@ -856,6 +875,9 @@ class ImageRecordIter2Wrapper : public IIterator<DataBatch> {
         case mshadow::kFloat32:
           record_iter_ = new ImageRecordIter2<float>();
           break;
+        case mshadow::kFloat16:
+          record_iter_ = new ImageRecordIter2<mshadow::half::half_t>();
+          break;
         case mshadow::kUint8:
           record_iter_ = new ImageRecordIter2<uint8_t>();
           break;
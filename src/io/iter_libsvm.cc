@@ -25,9 +25,14 @@
 #include <dmlc/base.h>
 #include <dmlc/logging.h>
 #include <dmlc/parameter.h>
-#include <dmlc/data.h>
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
 #include "./iter_sparse_prefetcher.h"
-#include "./iter_sparse_batchloader.h"
+#include "./iter_text_cache.h"
+#include "./iter_text_parser.h"
 
 namespace mxnet {
 namespace io {
@@ -64,7 +69,15 @@ struct LibSVMIterParam : public dmlc::Parameter<LibSVMIterParam> {
   }
 };
 
-class LibSVMIter: public SparseIIterator<DataInst> {
+/*!
+ * \brief Reads LibSVM files straight into batches of CSR arrays. The lines of
+ *  a batch are parsed on several threads: a first pass counts the features of
+ *  every line, which gives the row offsets, a second one writes the features
+ *  directly into their place in the batch. With a cache_file, the batches of
+ *  the first full pass are also written to the cache, which the rows are
+ *  copied from in the following passes.
+ */
+class LibSVMIter: public SparseIIterator<TBlobBatch> {
  public:
   LibSVMIter() = default;
   ~LibSVMIter() override = default;
@@ -72,79 +85,86 @@ class LibSVMIter: public SparseIIterator<DataInst> {
   // intialize iterator loads data in
   void Init(const std::vector<std::pair<std::string, std::string> >& kwargs) override {
     param_.InitAllowUnknown(kwargs);
+    batch_param_.InitAllowUnknown(kwargs);
+    parser_param_.InitAllowUnknown(kwargs);
+    cache_param_.InitAllowUnknown(kwargs);
     CHECK_EQ(param_.data_shape.ndim(), 1) << "dimension of data_shape is expected to be 1";
     CHECK_GT(param_.num_parts, 0) << "number of parts should be positive";
     CHECK_GE(param_.part_index, 0) << "part index should be non-negative";
-    data_parser_.reset(dmlc::Parser<uint64_t>::Create(param_.data_libsvm.c_str(),
-                                                      param_.part_index,
-                                                      param_.num_parts, "libsvm"));
-    if (param_.label_libsvm != "NULL") {
-      label_parser_.reset(dmlc::Parser<uint64_t>::Create(param_.label_libsvm.c_str(),
-                                                         param_.part_index,
-                                                         param_.num_parts, "libsvm"));
+    if (!batch_param_.round_batch) {
+      LOG(FATAL) << "LibSVMIter doesn't support round_batch == false yet";
+    }
+    has_label_file_ = param_.label_libsvm != "NULL";
+    if (has_label_file_) {
       CHECK_GT(param_.label_shape.Size(), 1)
         << "label_shape is not expected to be (1,) when param_.label_libsvm is set.";
     } else {
       CHECK_EQ(param_.label_shape.Size(), 1)
         << "label_shape is expected to be (1,) when param_.label_libsvm is NULL";
     }
-    // both data and label are of CSRStorage in libsvm format
-    if (param_.label_shape.Size() > 1) {
-      out_.data.resize(6);
+    std::ostringstream key;
+    key << "LibSVMIter data_libsvm=" << param_.data_libsvm << " data_shape=" << param_.data_shape
+        << " label_libsvm=" << param_.label_libsvm << " label_shape=" << param_.label_shape
+        << " part=" << param_.part_index << "/" << param_.num_parts;
+    cache_key_ = key.str();
+    if (!cache_param_.cache_file.empty() && TextCacheExists(cache_param_.cache_file)) {
+      cache_reader_.reset(new TextCacheReader(cache_param_.cache_file, cache_key_));
     } else {
-      // only data is of CSRStorage in libsvm format.
-      out_.data.resize(4);
+      data_reader_.reset(new TextLineReader(param_.data_libsvm, param_.part_index,
+                                            param_.num_parts));
+      if (has_label_file_) {
+        label_reader_.reset(new TextLineReader(param_.label_libsvm, param_.part_index,
+                                               param_.num_parts));
+      }
     }
+    const size_t batch_size = batch_param_.batch_size;
+    // both data and label are of CSRStorage with a label file,
+    // otherwise only data is of CSRStorage and the label is dense
+    data_.Init(batch_size);
+    if (has_label_file_) {
+      label_.Init(batch_size);
+    } else {
+      labels_.resize(batch_size);
+    }
+    out_.inst_index = new unsigned[batch_size];
+    out_.batch_size = batch_size;
+    Reset();
   }
 
   void BeforeFirst() override {
-    data_parser_->BeforeFirst();
-    if (label_parser_.get() != nullptr) {
-      label_parser_->BeforeFirst();
+    if (num_overflow_ == 0) {
+      Reset();
+    } else {
+      // the readers already restarted for the overflow
+      num_overflow_ = 0;
     }
-    data_ptr_ = label_ptr_ = 0;
-    data_size_ = label_size_ = 0;
-    inst_counter_ = 0;
-    end_ = false;
   }
 
   bool Next() override {
-    if (end_) return false;
-    while (data_ptr_ >= data_size_) {
-      if (!data_parser_->Next()) {
-        end_ = true; return false;
-      }
-      data_ptr_ = 0;
-      data_size_ = data_parser_->Value().size;
+    out_.num_batch_padd = 0;
+    // if overflown from previous round, directly return false, until before first is called
+    if (num_overflow_ != 0) return false;
+    const size_t batch_size = batch_param_.batch_size;
+    size_t top = Fill(0);
+    if (cache_writer_.get() != nullptr) {
+      cache_writer_->Append(top, Arrays(top));
+      // the input is exhausted, read the cache from now on
+      if (top < batch_size) FinishCache();
     }
-    out_.index = inst_counter_++;
-    CHECK_LT(data_ptr_, data_size_);
-    const auto data_row = data_parser_->Value()[data_ptr_++];
-    // data, indices and indptr
-    out_.data[0] = AsDataBlob(data_row);
-    out_.data[1] = AsIdxBlob(data_row);
-    out_.data[2] = AsIndPtrPlaceholder(data_row);
-
-    if (label_parser_.get() != nullptr) {
-      while (label_ptr_ >= label_size_) {
-        CHECK(label_parser_->Next())
-            << "Data LibSVM's row is smaller than the number of rows in label_libsvm";
-        label_ptr_ = 0;
-        label_size_ = label_parser_->Value().size;
-      }
-      CHECK_LT(label_ptr_, label_size_);
-      const auto label_row = label_parser_->Value()[label_ptr_++];
-      // data, indices and indptr
-      out_.data[3] = AsDataBlob(label_row);
-      out_.data[4] = AsIdxBlob(label_row);
-      out_.data[5] = AsIndPtrPlaceholder(label_row);
-    } else {
-      out_.data[3] = AsScalarLabelBlob(data_row);
+    if (top == 0) return false;
+    if (top < batch_size) {
+      Reset();
+      const size_t last = top;
+      top = Fill(top);
+      CHECK_EQ(top, batch_size) << "number of input must be bigger than batch size";
+      num_overflow_ = static_cast<int>(batch_size - last);
+      out_.num_batch_padd = num_overflow_;
     }
+    out_.data = Arrays(batch_size);
     return true;
   }
 
-  const DataInst &Value() const override {
+  const TBlobBatch &Value() const override {
     return out_;
   }
 
@@ -154,44 +174,254 @@ class LibSVMIter: public SparseIIterator<DataInst> {
   }
 
   const mxnet::TShape GetShape(bool is_data) const override {
-    if (is_data) return param_.data_shape;
-    return param_.label_shape;
+    const mxnet::TShape& inst_shape = is_data ? param_.data_shape : param_.label_shape;
+    mxnet::TShape shape(inst_shape.ndim() + 1, -1);
+    shape[0] = batch_param_.batch_size;
+    for (int i = 0; i < inst_shape.ndim(); ++i) shape[i + 1] = inst_shape[i];
+    return shape;
   }
 
  private:
-  inline TBlob AsDataBlob(const dmlc::Row<uint64_t>& row) {
-    const real_t* ptr = row.value;
-    mxnet::TShape shape(mshadow::Shape1(row.length));
-    return TBlob((real_t*) ptr, shape, cpu::kDevMask);  // NOLINT(*)
+  /*! \brief values, column indices and row offsets of a batch */
+  struct CSRBuffer {
+    std::vector<real_t> values;
+    std::vector<int64_t> indices;
+    std::vector<int64_t> indptr;
+
+    void Init(size_t batch_size) {
+      // grown on demand, starts with one feature per row
+      values.resize(batch_size);
+      indices.resize(batch_size);
+      indptr.assign(batch_size + 1, 0);
+    }
+    /*! \brief make room for nnz features */
+    void Reserve(size_t nnz) {
+      if (values.size() < nnz) {
+        const size_t capacity = std::max(nnz, 2 * values.size());
+        values.resize(capacity);
+        indices.resize(capacity);
+      }
+    }
+  };
+
+  void Reset() {
+    inst_counter_ = 0;
+    if (cache_reader_.get() != nullptr) {
+      cache_reader_->BeforeFirst(cache_param_.cache_shuffle, cache_param_.cache_seed);
+      return;
+    }
+    data_reader_->BeforeFirst();
+    if (label_reader_.get() != nullptr) {
+      label_reader_->BeforeFirst();
+    }
+    if (!cache_param_.cache_file.empty()) {
+      std::vector<int> dtypes = {mshadow::kFloat32, mshadow::kInt64, mshadow::kInt64};
+      if (has_label_file_) {
+        dtypes.insert(dtypes.end(), {mshadow::kFloat32, mshadow::kInt64, mshadow::kInt64});
+      } else {
+        dtypes.push_back(mshadow::kFloat32);
+      }
+      // drops the cache of an unfinished pass
+      cache_writer_.reset();
+      cache_writer_.reset(new TextCacheWriter(cache_param_.cache_file, cache_key_, dtypes));
+    }
+  }
+
+  void FinishCache() {
+    cache_writer_->Finish();
+    cache_writer_.reset();
+    data_reader_.reset();
+    label_reader_.reset();
+    cache_reader_.reset(new TextCacheReader(cache_param_.cache_file, cache_key_));
+  }
+
+  /*! \brief fill the rows from top on, returns the new number of rows */
+  size_t Fill(size_t top) {
+    return cache_reader_.get() != nullptr ? FillFromCache(top) : FillFromText(top);
+  }
+
+  size_t FillFromCache(size_t top) {
+    const size_t batch_size = batch_param_.batch_size;
+    TextCacheReader::Span span;
+    while (top < batch_size && cache_reader_->Next(batch_size - top, &span)) {
+      CopyRows(span, 0, top, &data_);
+      if (has_label_file_) {
+        CopyRows(span, 3, top, &label_);
+      } else {
+        const real_t* labels = cache_reader_->Array<real_t>(span.block, 3);
+        std::copy(labels + span.begin, labels + span.begin + span.num_rows,
+                  labels_.begin() + top);
+      }
+      const size_t first_row = cache_reader_->FirstRow(span.block) + span.begin;
+      for (size_t i = 0; i < span.num_rows; ++i) {
+        out_.inst_index[top + i] = static_cast<unsigned>(first_row + i);
+      }
+      top += span.num_rows;
+    }
+    return top;
+  }
+
+  /*! \brief copy the rows of a span of the CSR arrays at array into the rows from row on */
+  void CopyRows(const TextCacheReader::Span& span, size_t array, size_t row, CSRBuffer* csr) {
+    const int64_t* src_indptr = cache_reader_->Array<int64_t>(span.block, array + 2) + span.begin;
+    const int64_t begin = src_indptr[0];
+    const size_t nnz = static_cast<size_t>(src_indptr[span.num_rows] - begin);
+    int64_t* indptr = csr->indptr.data() + row;
+    csr->Reserve(indptr[0] + nnz);
+    std::memcpy(csr->values.data() + indptr[0],
+                cache_reader_->Array<real_t>(span.block, array) + begin, nnz * sizeof(real_t));
+    std::memcpy(csr->indices.data() + indptr[0],
+                cache_reader_->Array<int64_t>(span.block, array + 1) + begin,
+                nnz * sizeof(int64_t));
+    for (size_t i = 0; i < span.num_rows; ++i) {
+      indptr[i + 1] = indptr[0] + src_indptr[i + 1] - begin;
+    }
   }
 
-  inline TBlob AsIdxBlob(const dmlc::Row<uint64_t>& row) {
-    const uint64_t* ptr = row.index;
-    mxnet::TShape shape(mshadow::Shape1(row.length));
-    return TBlob((int64_t*) ptr, shape, cpu::kDevMask, mshadow::kInt64);  // NOLINT(*)
+  /*! \brief parse lines into the rows from top on, returns the new number of rows */
+  size_t FillFromText(size_t top) {
+    const size_t batch_size = batch_param_.batch_size;
+    const TextLine* lines;
+    size_t num_lines;
+    while (top < batch_size && data_reader_->Next(batch_size - top, &lines, &num_lines)) {
+      if (has_label_file_) {
+        // the label column of the data file is ignored
+        AppendRows(lines, num_lines, top, param_.data_shape[0], &data_, nullptr);
+        for (size_t done = 0; done < num_lines;) {
+          size_t num_labels;
+          CHECK(label_reader_->Next(num_lines - done, &lines, &num_labels))
+              << "Data LibSVM's row is smaller than the number of rows in label_libsvm";
+          AppendRows(lines, num_labels, top + done, param_.label_shape[0], &label_, nullptr);
+          done += num_labels;
+        }
+      } else {
+        AppendRows(lines, num_lines, top, param_.data_shape[0], &data_, labels_.data() + top);
+      }
+      for (size_t i = 0; i < num_lines; ++i) {
+        out_.inst_index[top + i] = inst_counter_++;
+      }
+      top += num_lines;
+    }
+    return top;
+  }
+
+  /*!
+   * \brief parse lines into the rows from row on
+   * \param labels the labels of the lines, nullptr to skip the label column
+   */
+  void AppendRows(const TextLine* lines, size_t num_lines, size_t row, int64_t num_cols,
+                  CSRBuffer* csr, real_t* labels) {
+    const int nthreads = parser_param_.preprocess_threads;
+    int64_t* indptr = csr->indptr.data() + row;
+    ParseLinesParallel(num_lines, nthreads, [&](size_t i) {
+      indptr[i + 1] = CountFeatures(lines[i]);
+    });
+    for (size_t i = 0; i < num_lines; ++i) {
+      indptr[i + 1] += indptr[i];
+    }
+    csr->Reserve(indptr[num_lines]);
+    real_t* values = csr->values.data();
+    int64_t* indices = csr->indices.data();
+    ParseLinesParallel(num_lines, nthreads, [&](size_t i) {
+      ParseRow(lines[i], num_cols, values + indptr[i], indices + indptr[i],
+               labels == nullptr ? nullptr : labels + i);
+    });
+    TextParserCounters::Get()->num_rows += static_cast<int64_t>(num_lines);
   }
 
-  inline TBlob AsIndPtrPlaceholder(const dmlc::Row<uint64_t>& row) {
-    return TBlob(nullptr, mshadow::Shape1(0), cpu::kDevMask, mshadow::kInt64);
+  static bool IsQid(const char* p, const char* end) {
+    return StartsWithNoCase(p, end, "qid:");
+  }
+
+  /*! \brief number of features of a line */
+  static int64_t CountFeatures(const TextLine& line) {
+    const char* p = line.begin;
+    const char* token_end = line.end;
+    int64_t count = 0;
+    // skip the label
+    NextToken(&p, line.end, &token_end);
+    for (p = token_end; NextToken(&p, line.end, &token_end); p = token_end) {
+      count += !IsQid(p, token_end);
+    }
+    return count;
+  }
+
+  /*!
+   * \brief parse a line of "label[:weight] [qid:id] index[:value] ...",
+   *  features without a value are 1
+   */
+  static void ParseRow(const TextLine& line, int64_t num_cols,
+                       real_t* values, int64_t* indices, real_t* label) {
+    const char* p = line.begin;
+    const char* token_end = line.end;
+    NextToken(&p, line.end, &token_end);
+    if (label != nullptr) {
+      const char* q = ParseNumber(p, token_end, label);
+      CHECK(q != p && (q == token_end || *q == ':'))
+          << "Invalid label in LibSVM row: " << std::string(line.begin, line.end);
+    }
+    int64_t k = 0;
+    for (p = token_end; NextToken(&p, line.end, &token_end); p = token_end) {
+      if (IsQid(p, token_end)) continue;
+      int64_t index = 0;
+      real_t value = 1;
+      const char* q = ParseNumber(p, token_end, &index);
+      CHECK(q != p && (q == token_end || *q == ':'))
+          << "Invalid feature in LibSVM row: " << std::string(line.begin, line.end);
+      CHECK(index >= 0 && index < num_cols)
+          << "Feature index " << index << " is out of the range [0, " << num_cols << ")";
+      if (q != token_end) {
+        CHECK(ParseNumber(q + 1, token_end, &value) == token_end)
+            << "Invalid feature in LibSVM row: " << std::string(line.begin, line.end);
+      }
+      values[k] = value;
+      indices[k] = index;
+      ++k;
+    }
+  }
+
+  /*!
+   * \brief the buffers of the first num_rows rows, shaped by their number of
+   *  features: values, indices and indptr of the data, then those of the label
+   *  or the dense label
+   */
+  std::vector<TBlob> Arrays(size_t num_rows) {
+    std::vector<TBlob> arrays;
+    AddArrays(&data_, num_rows, &arrays);
+    if (has_label_file_) {
+      AddArrays(&label_, num_rows, &arrays);
+    } else {
+      arrays.emplace_back(labels_.data(), mshadow::Shape1(num_rows), cpu::kDevMask);
+    }
+    return arrays;
   }
 
-  inline TBlob AsScalarLabelBlob(const dmlc::Row<uint64_t>& row) {
-    const real_t* ptr = row.label;
-    return TBlob((real_t*) ptr, mshadow::Shape1(1), cpu::kDevMask);  // NOLINT(*)
+  static void AddArrays(CSRBuffer* csr, size_t num_rows, std::vector<TBlob>* arrays) {
+    const size_t nnz = static_cast<size_t>(csr->indptr[num_rows]);
+    arrays->emplace_back(csr->values.data(), mshadow::Shape1(nnz), cpu::kDevMask);
+    arrays->emplace_back(csr->indices.data(), mshadow::Shape1(nnz), cpu::kDevMask);
+    arrays->emplace_back(csr->indptr.data(), mshadow::Shape1(num_rows + 1), cpu::kDevMask);
   }
 
   LibSVMIterParam param_;
-  // output instance
-  DataInst out_;
+  BatchParam batch_param_;
+  TextParserParam parser_param_;
+  TextCacheParam cache_param_;
+  bool has_label_file_;
+  TBlobBatch out_;
+  CSRBuffer data_;
+  CSRBuffer label_;
+  // dense labels read from the data file
+  std::vector<real_t> labels_;
+  std::unique_ptr<TextLineReader> data_reader_;
+  std::unique_ptr<TextLineReader> label_reader_;
+  std::string cache_key_;
+  std::unique_ptr<TextCacheWriter> cache_writer_;
+  std::unique_ptr<TextCacheReader> cache_reader_;
   // internal instance counter
   unsigned inst_counter_{0};
-  // at end
-  bool end_{false};
-  // label parser
-  size_t label_ptr_{0}, label_size_{0};
-  size_t data_ptr_{0}, data_size_{0};
-  std::unique_ptr<dmlc::Parser<uint64_t> > label_parser_;
-  std::unique_ptr<dmlc::Parser<uint64_t> > data_parser_;
+  // number of instances read from the next round to fill the last batch
+  int num_overflow_{0};
 };
 
 
@@ -212,6 +442,11 @@ The dimension of both `data_shape` and `label_shape` are expected to be 1.
 
 The `data_libsvm` parameter is used to set the path input LibSVM file.
 When it is set to a directory, all the files in the directory will be read.
+The lines of a batch are parsed on `preprocess_threads` threads. When `cache_file` is set,
+the parsed rows are written to that file during the first full pass over the data, and the
+following passes read them from it instead of parsing the LibSVM files again. With
+`cache_shuffle` set to ``True`` the blocks of the cache, one batch each, are read in a new random
+order every pass.
 
 When `label_libsvm` is set to ``NULL``, both data and label are read from the file specified
 by `data_libsvm`. In this case, the data is stored in `csr` storage type, while the label is a 1D
@@ -299,10 +534,11 @@ Example::
 .add_arguments(LibSVMIterParam::__FIELDS__())
 .add_arguments(BatchParam::__FIELDS__())
 .add_arguments(PrefetcherParam::__FIELDS__())
+.add_arguments(TextParserParam::__FIELDS__())
+.add_arguments(TextCacheParam::__FIELDS__())
 .set_body([]() {
     return new SparsePrefetcherIter(
-        new SparseBatchLoader(
-            new LibSVMIter()));
+        new LibSVMIter());
   });
 
 }  // namespace io
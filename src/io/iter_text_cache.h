@@ -0,0 +1,314 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file iter_text_cache.h
+ * \brief binary cache of the batches parsed by the text data iterators, so
+ *  that only the first pass over the data parses text
+ */
+#ifndef MXNET_IO_ITER_TEXT_CACHE_H_
+#define MXNET_IO_ITER_TEXT_CACHE_H_
+
+#include <dmlc/logging.h>
+#include <dmlc/parameter.h>
+#include <mxnet/tensor_blob.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+#include "../common/mapped_file.h"
+
+namespace mxnet {
+namespace io {
+
+// parameters of the text iterator cache
+struct TextCacheParam : public dmlc::Parameter<TextCacheParam> {
+  /*! \brief path of the cache */
+  std::string cache_file;
+  /*! \brief whether to shuffle the blocks of the cache */
+  bool cache_shuffle;
+  /*! \brief seed of the block shuffle */
+  int cache_seed;
+  // declare parameters
+  DMLC_DECLARE_PARAMETER(TextCacheParam) {
+    DMLC_DECLARE_FIELD(cache_file).set_default("")
+        .describe("Path of a binary cache of the parsed data, e.g. next to the input file. "
+                  "If the file does not exist it is written during the first full pass "
+                  "over the input, and the following passes read the batches from it "
+                  "instead of parsing the input. Empty to disable the cache.");
+    DMLC_DECLARE_FIELD(cache_shuffle).set_default(false)
+        .describe("Whether to read the blocks of the cache, one batch each, in a random "
+                  "order every pass. The rows within a block keep their order.");
+    DMLC_DECLARE_FIELD(cache_seed).set_default(0)
+        .describe("The random seed of cache_shuffle.");
+  }
+};
+
+/*!
+ * \brief Layout of the cache file. Every block holds the same arrays, those of
+ *  the batch of the iterator restricted to the rows of the block, e.g. values,
+ *  indices and row offsets of CSR data. All arrays start at a multiple of
+ *  8 bytes, so that they can be used in place from a mapping of the file.
+ *
+ *    header: magic, version, key length, key, number of arrays, their dtypes
+ *    blocks: the arrays of every block
+ *    index:  first row, number of rows, offset and size of every array of
+ *            every block
+ *    footer: offset of the index, number of blocks, magic
+ *
+ *  The key describes the parameters of the iterator which the content of the
+ *  cache depends on.
+ */
+struct TextCacheFormat {
+  static constexpr uint64_t kMagic = 0x31454843414354ULL;  // "TCACHE1"
+  static constexpr uint64_t kVersion = 1;
+  static constexpr size_t kAlign = 8;
+  static constexpr size_t kFooterSize = 3 * sizeof(uint64_t);
+};
+
+/*!
+ * \brief Writes a cache block by block to a temporary file, which is renamed
+ *  to the cache on Finish. An unfinished cache is removed.
+ */
+class TextCacheWriter {
+ public:
+  TextCacheWriter(const std::string& path, const std::string& key,
+                  const std::vector<int>& dtypes)
+      : path_(path), tmp_path_(path + ".tmp"), dtypes_(dtypes),
+        strm_(tmp_path_, std::ios::binary | std::ios::trunc) {
+    CHECK(strm_.is_open()) << "Failed to open " << tmp_path_;
+    WriteU64(TextCacheFormat::kMagic);
+    WriteU64(TextCacheFormat::kVersion);
+    WriteU64(key.size());
+    Write(key.data(), key.size());
+    WriteU64(dtypes_.size());
+    for (const int dtype : dtypes_) WriteU64(dtype);
+  }
+
+  ~TextCacheWriter() {
+    if (!finished_) {
+      strm_.close();
+      std::remove(tmp_path_.c_str());
+    }
+  }
+
+  /*! \brief append a block of num_rows rows, holding the given arrays */
+  void Append(size_t num_rows, const std::vector<TBlob>& arrays) {
+    CHECK_EQ(arrays.size(), dtypes_.size());
+    if (num_rows == 0) return;
+    index_.push_back(num_rows_);
+    index_.push_back(num_rows);
+    for (size_t i = 0; i < arrays.size(); ++i) {
+      CHECK_EQ(arrays[i].type_flag_, dtypes_[i]);
+      index_.push_back(offset_);
+      index_.push_back(arrays[i].Size());
+      Write(arrays[i].dptr_, arrays[i].Size() * mshadow::mshadow_sizeof(dtypes_[i]));
+    }
+    num_rows_ += num_rows;
+    ++num_blocks_;
+  }
+
+  /*! \brief write the index and move the file to the cache path */
+  void Finish() {
+    const uint64_t index_offset = offset_;
+    Write(index_.data(), index_.size() * sizeof(uint64_t));
+    WriteU64(index_offset);
+    WriteU64(num_blocks_);
+    WriteU64(TextCacheFormat::kMagic);
+    strm_.close();
+    CHECK(!strm_.fail()) << "Failed to write " << tmp_path_;
+    CHECK_EQ(std::rename(tmp_path_.c_str(), path_.c_str()), 0)
+        << "Failed to move " << tmp_path_ << " to " << path_;
+    finished_ = true;
+    LOG(INFO) << "Wrote " << num_rows_ << " rows in " << num_blocks_ << " blocks to " << path_;
+  }
+
+ private:
+  void WriteU64(uint64_t value) {
+    Write(&value, sizeof(value));
+  }
+
+  void Write(const void* data, size_t nbytes) {
+    static const char kZeros[TextCacheFormat::kAlign] = {0};
+    const size_t padding = (TextCacheFormat::kAlign - nbytes % TextCacheFormat::kAlign) %
+                           TextCacheFormat::kAlign;
+    strm_.write(static_cast<const char*>(data), nbytes);
+    strm_.write(kZeros, padding);
+    offset_ += nbytes + padding;
+  }
+
+  std::string path_;
+  std::string tmp_path_;
+  std::vector<int> dtypes_;
+  std::ofstream strm_;
+  std::vector<uint64_t> index_;
+  uint64_t offset_{0};
+  uint64_t num_rows_{0};
+  uint64_t num_blocks_{0};
+  bool finished_{false};
+};
+
+/*!
+ * \brief Reads the rows of a cache through a memory mapping, block by block in
+ *  the order of the file or in a random order.
+ */
+class TextCacheReader {
+ public:
+  /*! \brief rows [begin, begin + num_rows) of a block */
+  struct Span {
+    size_t block;
+    size_t begin;
+    size_t num_rows;
+  };
+
+  TextCacheReader(const std::string& path, const std::string& key)
+      : path_(path), file_(path) {
+    size_t pos = 0;
+    CHECK_EQ(ReadU64(&pos), TextCacheFormat::kMagic) << path_ << " is not a cache file";
+    CHECK_EQ(ReadU64(&pos), TextCacheFormat::kVersion) << "Unsupported version of " << path_;
+    const size_t key_size = ReadU64(&pos);
+    CHECK_LE(pos + key_size, file_.size()) << path_ << " is truncated";
+    const std::string file_key(file_.data() + pos, key_size);
+    CHECK_EQ(file_key, key) << path_ << " is the cache of other parameters of the iterator, "
+                            << "remove it to rebuild the cache";
+    pos += (key_size + TextCacheFormat::kAlign - 1) / TextCacheFormat::kAlign *
+           TextCacheFormat::kAlign;
+    const size_t num_arrays = ReadU64(&pos);
+    for (size_t i = 0; i < num_arrays; ++i) {
+      dtypes_.push_back(static_cast<int>(ReadU64(&pos)));
+    }
+
+    CHECK(file_.size() >= pos + TextCacheFormat::kFooterSize) << path_ << " is truncated";
+    size_t footer = file_.size() - TextCacheFormat::kFooterSize;
+    const size_t index_offset = ReadU64(&footer);
+    const size_t num_blocks = ReadU64(&footer);
+    CHECK_EQ(ReadU64(&footer), TextCacheFormat::kMagic) << path_ << " is truncated";
+    const size_t block_size = 2 + 2 * num_arrays;
+    CHECK(index_offset + num_blocks * block_size * sizeof(uint64_t) ==
+          file_.size() - TextCacheFormat::kFooterSize) << path_ << " is corrupted";
+    const uint64_t* index = reinterpret_cast<const uint64_t*>(file_.data() + index_offset);
+    index_.assign(index, index + num_blocks * block_size);
+    for (size_t b = 0; b < num_blocks; ++b) {
+      for (size_t i = 0; i < num_arrays; ++i) {
+        CHECK_LE(ArrayOffset(b, i) + ArraySize(b, i) * mshadow::mshadow_sizeof(dtypes_[i]),
+                 index_offset) << path_ << " is corrupted";
+      }
+    }
+  }
+
+  size_t num_blocks() const {
+    return index_.size() / (2 + 2 * dtypes_.size());
+  }
+
+  /*! \brief restart from the first block, in a new random order if shuffle is set */
+  void BeforeFirst(bool shuffle, unsigned seed) {
+    order_.resize(num_blocks());
+    std::iota(order_.begin(), order_.end(), 0);
+    if (shuffle) {
+      std::mt19937 rng(seed + epoch_);
+      std::shuffle(order_.begin(), order_.end(), rng);
+    }
+    ++epoch_;
+    pos_ = 0;
+    row_ = 0;
+  }
+
+  /*!
+   * \brief Get the next rows of the current block.
+   * \param max_rows maximum number of rows returned
+   * \return false at the end of the cache
+   */
+  bool Next(size_t max_rows, Span* span) {
+    if (pos_ == order_.size()) return false;
+    const size_t block = order_[pos_];
+    span->block = block;
+    span->begin = row_;
+    span->num_rows = std::min(max_rows, BlockRows(block) - row_);
+    row_ += span->num_rows;
+    if (row_ == BlockRows(block)) {
+      row_ = 0;
+      if (++pos_ < order_.size()) {
+        // start reading the next block from disk while this one is used
+        const size_t next = order_[pos_];
+        const size_t last = dtypes_.size() - 1;
+        const size_t end = ArrayOffset(next, last) +
+                           ArraySize(next, last) * mshadow::mshadow_sizeof(dtypes_[last]);
+        file_.WillNeed(ArrayOffset(next, 0), end - ArrayOffset(next, 0));
+      }
+    }
+    return true;
+  }
+
+  /*! \brief index of the first row of a block in the input */
+  size_t FirstRow(size_t block) const {
+    return BlockIndex(block)[0];
+  }
+  size_t BlockRows(size_t block) const {
+    return BlockIndex(block)[1];
+  }
+  /*! \brief number of elements of array i of a block */
+  size_t ArraySize(size_t block, size_t i) const {
+    return BlockIndex(block)[3 + 2 * i];
+  }
+  /*! \brief array i of a block */
+  template<typename DType>
+  const DType* Array(size_t block, size_t i) const {
+    CHECK_EQ(mshadow::DataType<DType>::kFlag, dtypes_[i]);
+    return reinterpret_cast<const DType*>(file_.data() + ArrayOffset(block, i));
+  }
+
+ private:
+  const uint64_t* BlockIndex(size_t block) const {
+    return index_.data() + block * (2 + 2 * dtypes_.size());
+  }
+
+  size_t ArrayOffset(size_t block, size_t i) const {
+    return BlockIndex(block)[2 + 2 * i];
+  }
+
+  uint64_t ReadU64(size_t* pos) const {
+    CHECK_LE(*pos + sizeof(uint64_t), file_.size()) << path_ << " is truncated";
+    uint64_t value;
+    std::memcpy(&value, file_.data() + *pos, sizeof(value));
+    *pos += sizeof(value);
+    return value;
+  }
+
+  std::string path_;
+  common::MappedFile file_;
+  std::vector<int> dtypes_;
+  std::vector<uint64_t> index_;
+  std::vector<size_t> order_;
+  size_t pos_{0};
+  size_t row_{0};
+  unsigned epoch_{0};
+};
+
+/*! \brief whether the cache file exists */
+inline bool TextCacheExists(const std::string& path) {
+  return std::ifstream(path).good();
+}
+
+}  // namespace io
+}  // namespace mxnet
+#endif  // MXNET_IO_ITER_TEXT_CACHE_H_
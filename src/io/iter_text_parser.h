@@ -0,0 +1,296 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file iter_text_parser.h
+ * \brief line reader and number parsing shared by the text data iterators,
+ *  which parse the lines of a batch on several threads
+ */
+#ifndef MXNET_IO_ITER_TEXT_PARSER_H_
+#define MXNET_IO_ITER_TEXT_PARSER_H_
+
+#include <dmlc/common.h>
+#include <dmlc/io.h>
+#include <dmlc/omp.h>
+#include <dmlc/parameter.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "../profiler/profiler.h"
+
+namespace mxnet {
+namespace io {
+
+// parameters of the text parsers
+struct TextParserParam : public dmlc::Parameter<TextParserParam> {
+  /*! \brief number of threads */
+  int preprocess_threads;
+  // declare parameters
+  DMLC_DECLARE_PARAMETER(TextParserParam) {
+    DMLC_DECLARE_FIELD(preprocess_threads).set_lower_bound(1).set_default(4)
+        .describe("The number of threads to parse the lines of a batch.");
+  }
+};
+
+/*! \brief parse throughput of the text iterators, reported to the profiler */
+struct TextParserCounters {
+  profiler::ProfileDomain domain{"TextParser"};
+  profiler::ProfileCounter num_bytes{"Read Bytes", &domain};
+  profiler::ProfileCounter num_rows{"Parsed Rows", &domain};
+  profiler::ProfileCounter parse_us{"Parse Time (us)", &domain};
+
+  static TextParserCounters* Get() {
+    // never destroyed, iterators may be freed during static destruction
+    static TextParserCounters* inst = new TextParserCounters();
+    return inst;
+  }
+};
+
+/*! \brief a non blank line of text, without the line break */
+struct TextLine {
+  const char* begin;
+  const char* end;
+};
+
+inline bool IsBlank(char c) {
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline bool IsDigit(char c) {
+  return static_cast<unsigned>(c - '0') < 10;
+}
+
+inline const char* SkipBlank(const char* p, const char* end) {
+  while (p != end && IsBlank(*p)) ++p;
+  return p;
+}
+
+/*!
+ * \brief Find the next blank separated token at or after *p.
+ * \return false if there is no token left
+ */
+inline bool NextToken(const char** p, const char* end, const char** token_end) {
+  const char* q = SkipBlank(*p, end);
+  if (q == end) return false;
+  *p = q;
+  while (q != end && !IsBlank(*q)) ++q;
+  *token_end = q;
+  return true;
+}
+
+/*!
+ * \brief Reads a text file, or the files of a directory, in line aligned
+ *  chunks and hands out their lines. The lines stay valid until the next call
+ *  of Next or BeforeFirst.
+ */
+class TextLineReader {
+ public:
+  TextLineReader(const std::string& uri, unsigned part_index, unsigned num_parts)
+      : source_(dmlc::InputSplit::Create(uri.c_str(), part_index, num_parts, "text")) {}
+
+  void BeforeFirst() {
+    source_->BeforeFirst();
+    lines_.clear();
+    pos_ = 0;
+  }
+
+  /*!
+   * \brief Get the next lines of the current chunk.
+   * \param max_lines maximum number of lines returned
+   * \return false at the end of the data
+   */
+  bool Next(size_t max_lines, const TextLine** lines, size_t* num_lines) {
+    while (pos_ >= lines_.size()) {
+      dmlc::InputSplit::Blob chunk;
+      if (!source_->NextChunk(&chunk)) return false;
+      SplitLines(static_cast<const char*>(chunk.dptr), chunk.size);
+      TextParserCounters::Get()->num_bytes += static_cast<int64_t>(chunk.size);
+    }
+    *lines = lines_.data() + pos_;
+    *num_lines = std::min(max_lines, lines_.size() - pos_);
+    pos_ += *num_lines;
+    return true;
+  }
+
+ private:
+  void SplitLines(const char* p, size_t size) {
+    const char* end = p + size;
+    lines_.clear();
+    pos_ = 0;
+    while (p != end) {
+      const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+      if (eol == nullptr) eol = end;
+      TextLine line{SkipBlank(p, eol), eol};
+      while (line.end != line.begin && IsBlank(line.end[-1])) --line.end;
+      if (line.begin != line.end) lines_.push_back(line);
+      p = eol == end ? end : eol + 1;
+    }
+  }
+
+  std::unique_ptr<dmlc::InputSplit> source_;
+  std::vector<TextLine> lines_;
+  size_t pos_{0};
+};
+
+/*! \brief whether [p, end) starts with the lower case word, ignoring case */
+inline bool StartsWithNoCase(const char* p, const char* end, const char* word) {
+  for (; *word != '\0'; ++p, ++word) {
+    if (p == end || (*p | 0x20) != *word) return false;
+  }
+  return true;
+}
+
+/*! \brief 10^e */
+inline double Pow10(int e) {
+  static const double kPow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  return e < 23 ? kPow10[e] : std::pow(10.0, e);
+}
+
+/*!
+ * \brief Parse a decimal floating point number, inf or nan at p.
+ * \return the end of the number, p if there is no number at p
+ */
+inline const char* ParseDouble(const char* p, const char* end, double* out) {
+  const char* begin = p;
+  bool negative = false;
+  if (p != end && (*p == '-' || *p == '+')) {
+    negative = *p == '-';
+    ++p;
+  }
+  const bool is_nan = StartsWithNoCase(p, end, "nan");
+  if (is_nan || StartsWithNoCase(p, end, "inf")) {
+    p += 3;
+    if (!is_nan && StartsWithNoCase(p, end, "inity")) p += 5;
+    const double value = is_nan ? std::numeric_limits<double>::quiet_NaN()
+                                : std::numeric_limits<double>::infinity();
+    *out = negative ? -value : value;
+    return p;
+  }
+  // the first 19 significant digits fit into the mantissa, the others only
+  // scale it
+  uint64_t mantissa = 0;
+  int digits = 0;
+  int exponent = 0;
+  bool any_digit = false;
+  for (; p != end && IsDigit(*p); ++p) {
+    any_digit = true;
+    if (digits < 19) {
+      mantissa = mantissa * 10 + (*p - '0');
+      digits += mantissa != 0;
+    } else {
+      ++exponent;
+    }
+  }
+  if (p != end && *p == '.') {
+    for (++p; p != end && IsDigit(*p); ++p) {
+      any_digit = true;
+      if (digits < 19) {
+        mantissa = mantissa * 10 + (*p - '0');
+        digits += mantissa != 0;
+        --exponent;
+      }
+    }
+  }
+  if (!any_digit) return begin;
+  if (p != end && (*p == 'e' || *p == 'E')) {
+    const char* q = p + 1;
+    bool negative_exponent = false;
+    if (q != end && (*q == '-' || *q == '+')) {
+      negative_exponent = *q == '-';
+      ++q;
+    }
+    if (q != end && IsDigit(*q)) {
+      int e = 0;
+      for (; q != end && IsDigit(*q); ++q) {
+        if (e < 100000) e = e * 10 + (*q - '0');
+      }
+      exponent += negative_exponent ? -e : e;
+      p = q;
+    }
+  }
+  double value = static_cast<double>(mantissa);
+  if (mantissa != 0 && exponent != 0) {
+    value = exponent < 0 ? value / Pow10(-exponent) : value * Pow10(exponent);
+  }
+  *out = negative ? -value : value;
+  return p;
+}
+
+/*!
+ * \brief Parse a number at p into DType. Integers with a fraction or an
+ *  exponent are parsed as floating point numbers and truncated.
+ * \return the end of the number, p if there is no number at p
+ */
+template<typename DType>
+inline const char* ParseNumber(const char* p, const char* end, DType* out) {
+  if (std::is_integral<DType>::value) {
+    const char* q = p;
+    bool negative = false;
+    if (q != end && (*q == '-' || *q == '+')) {
+      negative = *q == '-';
+      ++q;
+    }
+    const char* digits = q;
+    uint64_t value = 0;
+    for (; q != end && IsDigit(*q); ++q) value = value * 10 + (*q - '0');
+    if (q != digits && (q == end || (*q != '.' && *q != 'e' && *q != 'E'))) {
+      *out = static_cast<DType>(negative ? -static_cast<int64_t>(value)
+                                         : static_cast<int64_t>(value));
+      return q;
+    }
+  }
+  double value = 0;
+  const char* q = ParseDouble(p, end, &value);
+  if (q != p) *out = static_cast<DType>(value);
+  return q;
+}
+
+/*!
+ * \brief Run fn(i) for the lines i in [0, n) on up to nthreads threads and
+ *  rethrow the first error. The time is accounted to the parse counters.
+ */
+template<typename F>
+inline void ParseLinesParallel(size_t n, int nthreads, const F& fn) {
+  // at least a few dozen lines per thread to amortize the fork
+  const int kMinLinesPerThread = 32;
+  nthreads = std::max(1, std::min(nthreads, static_cast<int>(
+      (n + kMinLinesPerThread - 1) / kMinLinesPerThread)));
+  const auto start = std::chrono::steady_clock::now();
+  dmlc::OMPException omp_exc;
+  const int64_t num_lines = static_cast<int64_t>(n);
+  #pragma omp parallel for num_threads(nthreads) schedule(static)
+  for (int64_t i = 0; i < num_lines; ++i) {
+    omp_exc.Run([&] { fn(static_cast<size_t>(i)); });
+  }
+  omp_exc.Rethrow();
+  TextParserCounters::Get()->parse_us += std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace io
+}  // namespace mxnet
+#endif  // MXNET_IO_ITER_TEXT_PARSER_H_
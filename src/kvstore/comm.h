@@ -32,6 +32,7 @@
 #include <thread>
 #include "mxnet/ndarray.h"
 #include "gradient_compression.h"
+#include "../common/numa.h"
 #include "../ndarray/ndarray_function.h"
 #include "../operator/tensor/sparse_retain-inl.h"
 #include "../profiler/profiler.h"
@@ -121,6 +122,11 @@ class CommCPU : public Comm {
 
   const NDArray& Reduce(int key, const std::vector<NDArray>& src,
                         int priority) override {
+    // when this reduce is called from kvstore_dist, gc is not set
+    // we don't do compression twice in dist_sync
+    if ((gc_ != nullptr) && (gc_->get_type() != CompressionType::kNone)) {
+      return ReduceCompressed(key, src, priority);
+    }
     auto& buf = merge_buf_[key];
     const auto stype = src[0].storage_type();
     // avoid extra copy for single device, but it may bring problems for
@@ -142,35 +148,7 @@ class CommCPU : public Comm {
     NDArray& buf_merged = buf.merged_buf(stype);
     // normal dense reduce
     if (stype == kDefaultStorage) {
-      std::vector<Engine::VarHandle> const_vars(src.size() - 1);
-      std::vector<NDArray> reduce(src.size());
-      CopyFromTo(src[0], &buf_merged, priority);
-      reduce[0] = buf_merged;
-
-      if (buf.copy_buf.empty()) {
-        buf.copy_buf.resize(src.size()-1);
-        for (size_t j = 0; j < src.size() - 1; ++j) {
-          // allocate copy buffer
-          buf.copy_buf[j] = NDArray(
-            src[0].shape(), pinned_ctx_, false, src[0].dtype());
-        }
-      }
-      CHECK(stype == buf.copy_buf[0].storage_type())
-           << "Storage type mismatch detected. " << stype << "(src) vs. "
-           << buf.copy_buf[0].storage_type() << "(buf.copy_buf)";
-      for (size_t i = 1; i < src.size(); ++i) {
-        CopyFromTo(src[i], &(buf.copy_buf[i-1]), priority);
-        reduce[i] = buf.copy_buf[i-1];
-        const_vars[i-1] = reduce[i].var();
-      }
-
-      Engine::Get()->PushAsync(
-        [reduce, this](RunContext rctx, Engine::CallbackOnComplete on_complete) {
-          ReduceSumCPU(reduce);
-          on_complete();
-        }, Context::CPU(), const_vars, {reduce[0].var()},
-        FnProperty::kCPUPrioritized, priority, "KVStoreReduce");
-
+      ReduceDense(&buf, src, priority);
     } else {
       // sparse reduce
       std::vector<Engine::VarHandle> const_vars(src.size());
@@ -207,6 +185,64 @@ class CommCPU : public Comm {
     return buf_merged;
   }
 
+  const NDArray& ReduceCompressed(int key, const std::vector<NDArray>& src,
+                                  int priority) {
+    CHECK_EQ(src[0].storage_type(), kDefaultStorage)
+      << "Gradient compression for row sparse storage type is not supported";
+    CHECK_EQ(src[0].dtype(), mshadow::kFloat32)
+      << "Gradient compression is only supported for float32 type of parameters";
+    auto& buf = merge_buf_[key];
+    NDArray& buf_merged = buf.merged_buf(kDefaultStorage);
+    if (buf.residual.empty()) {
+      // one residual and compressed buffer for each source, the data of the
+      // first source is dequantized into buf_merged and the others into copy_buf
+      buf.residual.resize(src.size());
+      buf.compressed_send_buf.resize(src.size());
+      buf.compressed_recv_buf.resize(src.size());
+      const int64_t small_size = gc_->GetCompressedSize(src[0].shape().Size());
+      for (size_t i = 0; i < src.size(); ++i) {
+        buf.residual[i] = NDArray(src[0].shape(), src[i].ctx(), false, src[0].dtype());
+        buf.residual[i] = 0;
+        buf.compressed_send_buf[i] = NDArray(mxnet::TShape{small_size}, src[i].ctx(),
+                                             false, src[0].dtype());
+        buf.compressed_recv_buf[i] = NDArray(mxnet::TShape{small_size}, pinned_ctx_,
+                                             false, src[0].dtype());
+      }
+    }
+    if (buf.copy_buf.empty()) {
+      buf.copy_buf.resize(src.size() - 1);
+      for (size_t j = 0; j < src.size() - 1; ++j) {
+        buf.copy_buf[j] = NDArray(src[0].shape(), pinned_ctx_, false, src[0].dtype());
+      }
+    }
+
+    std::vector<Engine::VarHandle> const_vars(src.size() - 1);
+    std::vector<NDArray> reduce(src.size());
+    for (size_t i = 0; i < src.size(); ++i) {
+      // compress on the device which computed the gradient, before the copy
+      gc_->Quantize(src[i], &(buf.compressed_send_buf[i]), &(buf.residual[i]), priority);
+      if (buf.compressed_send_buf[i].ctx() != buf.compressed_recv_buf[i].ctx()) {
+        CopyFromTo(buf.compressed_send_buf[i], &(buf.compressed_recv_buf[i]), priority);
+      } else {
+        // avoid memory copy when they are on same context
+        buf.compressed_recv_buf[i] = buf.compressed_send_buf[i];
+      }
+      NDArray *out = (i == 0) ? &buf_merged : &(buf.copy_buf[i - 1]);
+      gc_->Dequantize(buf.compressed_recv_buf[i], out, priority);
+      reduce[i] = *out;
+      if (i > 0) const_vars[i - 1] = reduce[i].var();
+    }
+    if (src.size() > 1) {
+      Engine::Get()->PushAsync(
+        [reduce, this](RunContext rctx, Engine::CallbackOnComplete on_complete) {
+          ReduceSumCPU(reduce);
+          on_complete();
+        }, Context::CPU(), const_vars, {reduce[0].var()},
+        FnProperty::kCPUPrioritized, priority, "KVStoreReduce");
+    }
+    return buf_merged;
+  }
+
   void Broadcast(int key, const NDArray& src,
                  const std::vector<NDArray*> dst, int priority) override {
     int mask = src.ctx().dev_mask();
@@ -269,6 +305,7 @@ class CommCPU : public Comm {
   }
 
  private:
+  struct BufferEntry;
   // reduce sum into val[0]
   inline void ReduceSumCPU(const std::vector<NDArray> &in_data) {
     MSHADOW_TYPE_SWITCH(in_data[0].dtype(), DType, {
@@ -355,6 +392,182 @@ class CommCPU : public Comm {
     });
   }
 
+  /*!
+   * \brief Sum dense sources into buf->merged.
+   *
+   * Sources on CPU are read directly. Sources on other devices are copied by
+   * chunks of MXNET_KVSTORE_BIGARRAY_BOUND elements into buffers of their own,
+   * and each chunk is summed as soon as its copies are done, so that the
+   * copies of the next chunks overlap with the sum. With MXNET_CPU_NUMA_AWARE,
+   * CPU sources of several NUMA nodes are first summed on their node.
+   */
+  void ReduceDense(BufferEntry* buf, const std::vector<NDArray>& src, int priority) {
+    const NDArray& merged = buf->merged;
+    const size_t total = src[0].shape().Size();
+    std::vector<NDArray> cpu_src, dev_src;
+    for (const auto& s : src) {
+      CHECK_EQ(s.shape().Size(), total) << "Shape mismatch of the arrays to reduce";
+      (s.ctx().dev_mask() == Context::kCPU ? cpu_src : dev_src).push_back(s);
+    }
+    cpu_src = ReduceOnNumaNodes(buf, cpu_src, priority);
+
+    const size_t chunk = std::max<size_t>(dev_src.empty() ? total : bigarray_bound_, 1);
+    const size_t num_chunks = (total + chunk - 1) / chunk;
+    if (buf->chunk_buf.size() != dev_src.size() ||
+        (!dev_src.empty() && buf->chunk_buf[0].size() != num_chunks)) {
+      buf->chunk_buf.assign(dev_src.size(), std::vector<NDArray>(num_chunks));
+      for (auto& bufs : buf->chunk_buf) {
+        for (size_t c = 0; c < num_chunks; ++c) {
+          const size_t size = std::min(chunk, total - c * chunk);
+          bufs[c] = NDArray(mxnet::TShape(mshadow::Shape1(size)), pinned_ctx_,
+                            false, src[0].dtype());
+        }
+      }
+    }
+    for (size_t c = 0; c < num_chunks; ++c) {
+      const size_t begin = c * chunk;
+      const size_t end = std::min(begin + chunk, total);
+      std::vector<Engine::VarHandle> const_vars;
+      std::vector<NDArray> chunk_src;
+      for (const auto& s : cpu_src) {
+        const_vars.push_back(s.var());
+        chunk_src.push_back(s);
+      }
+      for (size_t i = 0; i < dev_src.size(); ++i) {
+        NDArray& dst = buf->chunk_buf[i][c];
+        if (num_chunks == 1) {
+          CopyFromTo(dev_src[i], &dst, priority);
+        } else {
+          NDArray flat = dev_src[i].Reshape(mxnet::TShape(mshadow::Shape1(total)));
+          CopyFromTo(flat.Slice(begin, end), &dst, priority);
+        }
+        const_vars.push_back(dst.var());
+        chunk_src.push_back(dst);
+      }
+      // sources read directly are offset to the chunk, chunk buffers are not
+      const size_t num_direct = cpu_src.size();
+      Engine::Get()->PushAsync(
+        [chunk_src, merged, begin, end, num_direct, this](RunContext rctx,
+                                                          Engine::CallbackOnComplete on_complete) {
+          MSHADOW_TYPE_SWITCH(merged.dtype(), DType, {
+            std::vector<const DType*> dptr(chunk_src.size());
+            for (size_t i = 0; i < chunk_src.size(); ++i) {
+              dptr[i] = chunk_src[i].data().dptr<DType>() + (i < num_direct ? begin : 0);
+            }
+            ReduceSumCPUTree(dptr, merged.data().dptr<DType>() + begin, end - begin);
+          });
+          on_complete();
+        }, Context::CPU(), const_vars, {merged.var()},
+        FnProperty::kCPUPrioritized, priority, "KVStoreReduce");
+    }
+  }
+
+  /*!
+   * \brief Sum the CPU sources of each NUMA node with more than one, on that
+   *  node, when NUMA-aware placement is enabled and the sources span several nodes.
+   * \return the sources left to sum, one per node.
+   */
+  std::vector<NDArray> ReduceOnNumaNodes(BufferEntry* buf, const std::vector<NDArray>& src,
+                                         int priority) {
+    const auto numa = common::NumaTopology::Get();
+    if (!numa->enabled() || src.size() <= 2) return src;
+    std::vector<std::vector<NDArray>> groups(numa->num_nodes());
+    for (const auto& s : src) groups[numa->NodeOf(s.ctx())].push_back(s);
+    const size_t used_nodes = std::count_if(groups.begin(), groups.end(),
+        [](const std::vector<NDArray>& g) { return !g.empty(); });
+    if (used_nodes <= 1) return src;
+
+    buf->numa_buf.resize(groups.size());
+    std::vector<NDArray> ret;
+    for (size_t node = 0; node < groups.size(); ++node) {
+      const auto& group = groups[node];
+      if (group.size() <= 1) {
+        ret.insert(ret.end(), group.begin(), group.end());
+        continue;
+      }
+      NDArray& partial = buf->numa_buf[node];
+      if (partial.is_none() || partial.shape() != src[0].shape() ||
+          partial.dtype() != src[0].dtype()) {
+        partial = NDArray(src[0].shape(), Context::CPU(node), false, src[0].dtype());
+      }
+      std::vector<Engine::VarHandle> const_vars;
+      for (const auto& s : group) const_vars.push_back(s.var());
+      // pushed to the workers of the node
+      Engine::Get()->PushAsync(
+        [group, partial, this](RunContext rctx, Engine::CallbackOnComplete on_complete) {
+          MSHADOW_TYPE_SWITCH(partial.dtype(), DType, {
+            std::vector<const DType*> dptr(group.size());
+            for (size_t i = 0; i < group.size(); ++i) dptr[i] = group[i].data().dptr<DType>();
+            ReduceSumCPUTree(dptr, partial.data().dptr<DType>(), partial.shape().Size());
+          });
+          on_complete();
+        }, partial.ctx(), const_vars, {partial.var()},
+        FnProperty::kNormal, priority, "KVStoreReduceNuma");
+      ret.push_back(partial);
+    }
+    return ret;
+  }
+
+  /*!
+   * \brief out[0, size) = src[first][offset, offset + size) + ... + src[last - 1][...],
+   *  summed as a tree whose leaves are groups of at most 4 sources, so that the
+   *  number of passes over out grows with the log of the number of sources.
+   *  scratch holds size elements for each level of the tree.
+   */
+  template<typename DType>
+  inline static void TreeSum(const std::vector<const DType*>& src, size_t first, size_t last,
+                             size_t offset, size_t size, DType* out, DType* scratch) {
+    const size_t n = last - first;
+    if (n > 4) {
+      const size_t mid = first + n / 2;
+      TreeSum(src, first, mid, offset, size, out, scratch + size);
+      TreeSum(src, mid, last, offset, size, scratch, scratch + size);
+      for (size_t j = 0; j < size; ++j) out[j] += scratch[j];
+      return;
+    }
+    const DType* in_0 = src[first] + offset;
+    const DType* in_1 = n > 1 ? src[first + 1] + offset : nullptr;
+    const DType* in_2 = n > 2 ? src[first + 2] + offset : nullptr;
+    const DType* in_3 = n > 3 ? src[first + 3] + offset : nullptr;
+    switch (n) {
+      case 1:
+        std::copy(in_0, in_0 + size, out);
+        break;
+      case 2:
+        for (size_t j = 0; j < size; ++j) out[j] = in_0[j] + in_1[j];
+        break;
+      case 3:
+        for (size_t j = 0; j < size; ++j) out[j] = in_0[j] + in_1[j] + in_2[j];
+        break;
+      default:
+        for (size_t j = 0; j < size; ++j) out[j] = in_0[j] + in_1[j] + in_2[j] + in_3[j];
+        break;
+    }
+  }
+
+  /*!
+   * \brief out = sum of src, by blocks small enough to stay in cache while all
+   *  the sources are added, in parallel for big arrays.
+   */
+  template<typename DType>
+  inline void ReduceSumCPUTree(const std::vector<const DType*>& src, DType* out, size_t total) {
+    const size_t block = 4 << 10;
+    const size_t num_blocks = (total + block - 1) / block;
+    size_t levels = 0;
+    for (size_t n = src.size(); n > 4; n = (n + 1) / 2) ++levels;
+    const int nthreads = total < bigarray_bound_ ? 1 : std::max(nthread_reduction_, 1);
+    #pragma omp parallel num_threads(nthreads)
+    {
+      std::vector<DType> scratch(levels * block);
+      #pragma omp for schedule(static)
+      for (long j = 0; j < static_cast<long>(num_blocks); ++j) { // NOLINT(*)
+        const size_t begin = j * block;
+        const size_t size = std::min(block, total - begin);
+        TreeSum(src, 0, src.size(), begin, size, out + begin, scratch.data());
+      }
+    }
+  }
+
   template<typename DType>
   inline static void ReduceSumCPU(
       const std::vector<DType*> &dptr, size_t offset, index_t size) {
@@ -416,6 +629,16 @@ class CommCPU : public Comm {
     NDArray merged;
     /// \brief the cpu buffer for gpu data
     std::vector<NDArray> copy_buf;
+    /// \brief the cpu buffers for the chunks of gpu data, per source
+    std::vector<std::vector<NDArray>> chunk_buf;
+    /// \brief the partial sums of the cpu data of each NUMA node
+    std::vector<NDArray> numa_buf;
+    /// \brief the residual buffer for gradient compression
+    std::vector<NDArray> residual;
+    /// \brief the small buffer for compressed data in sender
+    std::vector<NDArray> compressed_send_buf;
+    /// \brief the small buffer for compressed data in receiver
+    std::vector<NDArray> compressed_recv_buf;
     /// \brief the merged buffer for the given storage type
     inline NDArray& merged_buf(NDArrayStorageType stype) {
       if (stype == kDefaultStorage) {
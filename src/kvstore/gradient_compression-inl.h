@@ -26,6 +26,7 @@
 #define MXNET_KVSTORE_GRADIENT_COMPRESSION_INL_H_
 
 #include <vector>
+#include "./gradient_compression.h"
 #include "../operator/mxnet_op.h"
 
 namespace mxnet {
@@ -36,6 +37,14 @@ void Quantize2BitImpl(mshadow::Stream<mshadow::gpu> *s, const std::vector<mxnet:
                       const float threshold);
 void Dequantize2BitImpl(mshadow::Stream<mshadow::gpu> *s, const std::vector<mxnet::TBlob> &inputs,
                         const float threshold);
+void Quantize1BitImpl(mshadow::Stream<mshadow::gpu> *s, const std::vector<mxnet::TBlob> &inputs,
+                      const float threshold);
+void Dequantize1BitImpl(mshadow::Stream<mshadow::gpu> *s, const std::vector<mxnet::TBlob> &inputs,
+                        const float threshold);
+void QuantizeTopKImpl(mshadow::Stream<mshadow::gpu> *s, const std::vector<mxnet::TBlob> &inputs,
+                      const int block_size);
+void DequantizeTopKImpl(mshadow::Stream<mshadow::gpu> *s, const std::vector<mxnet::TBlob> &inputs,
+                        const int block_size);
 
 struct quantize_2bit {
   MSHADOW_XINLINE static void Map(int out_block_id,
@@ -138,6 +147,135 @@ void Dequantize2BitKernelLaunch(mshadow::Stream<xpu> *s, const std::vector<mxnet
           threshold);               // positive threshold
 }
 
+struct quantize_1bit {
+  MSHADOW_XINLINE static void Map(index_t out_block_id,
+                                  index_t original_size,
+                                  float *out,
+                                  float *grad,
+                                  float *residual,
+                                  const float threshold) {
+    // this block contains the signs of upto 32 values starting from out_block_id*32,
+    // the sign of value start+j is stored in bit j
+    const index_t start = out_block_id << 5;
+    const index_t end = (start + 32 <= original_size) ? start + 32 : original_size;
+    uint32_t bits = 0;
+    // no branches in the loop, so that it can be vectorized on cpu
+    for (index_t i = start; i < end; i++) {
+      const float r = residual[i] + grad[i];
+      const uint32_t positive = r >= 0.f;
+      bits |= positive << (i - start);
+      // keep the error of sending +threshold or -threshold for the next push
+      residual[i] = r - (positive ? threshold : -threshold);
+    }
+    *reinterpret_cast<uint32_t *>(out + out_block_id) = bits;
+  }
+};
+
+template<typename xpu>
+void Quantize1BitKernelLaunch(mshadow::Stream<xpu> *s, const std::vector<mxnet::TBlob> &inputs,
+                              const float threshold) {
+  mxnet::op::mxnet_op::Kernel<quantize_1bit, xpu>
+    ::Launch(s,
+            inputs[2].Size(),         // compressed array size
+            inputs[0].Size(),         // original size
+            inputs[2].dptr<float>(),  // compressed array
+            inputs[0].dptr<float>(),  // original array
+            inputs[1].dptr<float>(),  // residual array
+            threshold);               // magnitude of dequantized values
+}
+
+struct dequantize_1bit {
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  float *out,
+                                  float *in,
+                                  const float threshold) {
+    const uint32_t bits = *reinterpret_cast<uint32_t *>(in + (i >> 5));
+    out[i] = ((bits >> (i & 31)) & 1) ? threshold : -threshold;
+  }
+};
+
+template<typename xpu>
+void Dequantize1BitKernelLaunch(mshadow::Stream<xpu> *s, const std::vector<mxnet::TBlob> &inputs,
+                                const float threshold) {
+  mxnet::op::mxnet_op::Kernel<dequantize_1bit, xpu>
+  ::Launch(s,
+          inputs[1].Size(),         // original size
+          inputs[1].dptr<float>(),  // out array
+          inputs[0].dptr<float>(),  // compressed array
+          threshold);               // magnitude of dequantized values
+}
+
+struct quantize_topk {
+  MSHADOW_XINLINE static void Map(index_t out_block_id,
+                                  index_t original_size,
+                                  float *out,
+                                  float *grad,
+                                  float *residual,
+                                  const int block_size) {
+    // this block keeps the largest accumulated value of upto block_size values
+    // starting from out_block_id*block_size, as its offset in the upper 16 bits
+    // and its value as float16 in the lower 16 bits
+    const index_t start = out_block_id * block_size;
+    const index_t end = (start + block_size <= original_size) ? start + block_size
+                                                              : original_size;
+    index_t top = start;
+    float top_abs = -1.f;
+    for (index_t i = start; i < end; i++) {
+      residual[i] += grad[i];
+      const float mag = residual[i] < 0.f ? -residual[i] : residual[i];
+      if (mag > top_abs) {
+        top_abs = mag;
+        top = i;
+      }
+    }
+    // values out of the float16 range are sent in several pushes
+    const float max_half = 65504.f;
+    const float val = residual[top] > max_half ? max_half :
+                      (residual[top] < -max_half ? -max_half : residual[top]);
+    const mshadow::half::half_t sent(val);
+    // the residual keeps everything which was not sent, including the float16 rounding
+    residual[top] -= static_cast<float>(sent);
+    *reinterpret_cast<uint32_t *>(out + out_block_id) =
+      (static_cast<uint32_t>(top - start) << 16) | sent.half_;
+  }
+};
+
+template<typename xpu>
+void QuantizeTopKKernelLaunch(mshadow::Stream<xpu> *s, const std::vector<mxnet::TBlob> &inputs,
+                              const int block_size) {
+  mxnet::op::mxnet_op::Kernel<quantize_topk, xpu>
+    ::Launch(s,
+            inputs[2].Size(),         // compressed array size
+            inputs[0].Size(),         // original size
+            inputs[2].dptr<float>(),  // compressed array
+            inputs[0].dptr<float>(),  // original array
+            inputs[1].dptr<float>(),  // residual array
+            block_size);              // number of values per compressed value
+}
+
+struct dequantize_topk {
+  MSHADOW_XINLINE static void Map(index_t i,
+                                  float *out,
+                                  float *in,
+                                  const int block_size) {
+    const index_t block = i / block_size;
+    const uint32_t packed = *reinterpret_cast<uint32_t *>(in + block);
+    out[i] = (i - block * block_size == static_cast<index_t>(packed >> 16)) ?
+             static_cast<float>(mshadow::half::half_t::Binary(packed & 0xffff)) : 0.f;
+  }
+};
+
+template<typename xpu>
+void DequantizeTopKKernelLaunch(mshadow::Stream<xpu> *s, const std::vector<mxnet::TBlob> &inputs,
+                                const int block_size) {
+  mxnet::op::mxnet_op::Kernel<dequantize_topk, xpu>
+  ::Launch(s,
+          inputs[1].Size(),         // original size
+          inputs[1].dptr<float>(),  // out array
+          inputs[0].dptr<float>(),  // compressed array
+          block_size);              // number of values per compressed value
+}
+
 inline void Quantize2BitImpl(mshadow::Stream<mshadow::cpu> *s,
                              const std::vector<mxnet::TBlob> &inputs,
                              const float threshold) {
@@ -149,6 +287,72 @@ inline void Dequantize2BitImpl(mshadow::Stream<mshadow::cpu> *s,
                                const float threshold) {
   Dequantize2BitKernelLaunch(s, inputs, threshold);
 }
+
+inline void Quantize1BitImpl(mshadow::Stream<mshadow::cpu> *s,
+                             const std::vector<mxnet::TBlob> &inputs,
+                             const float threshold) {
+  Quantize1BitKernelLaunch(s, inputs, threshold);
+}
+
+inline void Dequantize1BitImpl(mshadow::Stream<mshadow::cpu> *s,
+                               const std::vector<mxnet::TBlob> &inputs,
+                               const float threshold) {
+  Dequantize1BitKernelLaunch(s, inputs, threshold);
+}
+
+inline void QuantizeTopKImpl(mshadow::Stream<mshadow::cpu> *s,
+                             const std::vector<mxnet::TBlob> &inputs,
+                             const int block_size) {
+  QuantizeTopKKernelLaunch(s, inputs, block_size);
+}
+
+inline void DequantizeTopKImpl(mshadow::Stream<mshadow::cpu> *s,
+                               const std::vector<mxnet::TBlob> &inputs,
+                               const int block_size) {
+  DequantizeTopKKernelLaunch(s, inputs, block_size);
+}
+
+/*!
+ * \brief Quantize inputs = {original, residual, compressed} with the given type
+ */
+template<typename xpu>
+void QuantizeImpl(mshadow::Stream<xpu> *s, const std::vector<mxnet::TBlob> &inputs,
+                  const CompressionType type, const float threshold, const int block_size) {
+  switch (type) {
+    case CompressionType::kTwoBit:
+      Quantize2BitImpl(s, inputs, threshold);
+      break;
+    case CompressionType::kOneBit:
+      Quantize1BitImpl(s, inputs, threshold);
+      break;
+    case CompressionType::kTopK:
+      QuantizeTopKImpl(s, inputs, block_size);
+      break;
+    default:
+      LOG(FATAL) << "Unsupported quantization of type " << static_cast<int>(type);
+  }
+}
+
+/*!
+ * \brief Dequantize inputs = {compressed, original} with the given type
+ */
+template<typename xpu>
+void DequantizeImpl(mshadow::Stream<xpu> *s, const std::vector<mxnet::TBlob> &inputs,
+                    const CompressionType type, const float threshold, const int block_size) {
+  switch (type) {
+    case CompressionType::kTwoBit:
+      Dequantize2BitImpl(s, inputs, threshold);
+      break;
+    case CompressionType::kOneBit:
+      Dequantize1BitImpl(s, inputs, threshold);
+      break;
+    case CompressionType::kTopK:
+      DequantizeTopKImpl(s, inputs, block_size);
+      break;
+    default:
+      LOG(FATAL) << "Unsupported dequantization of type " << static_cast<int>(type);
+  }
+}
 }  // namespace kvstore
 }  // namespace mxnet
 
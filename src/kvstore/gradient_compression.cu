@@ -36,5 +36,25 @@ void Dequantize2BitImpl(mshadow::Stream<gpu>* s, const std::vector<TBlob>& input
                         const float threshold) {
   Dequantize2BitKernelLaunch(s, inputs, threshold);
 }
+
+void Quantize1BitImpl(mshadow::Stream<gpu>* s, const std::vector<TBlob>& inputs,
+                      const float threshold) {
+  Quantize1BitKernelLaunch(s, inputs, threshold);
+}
+
+void Dequantize1BitImpl(mshadow::Stream<gpu>* s, const std::vector<TBlob>& inputs,
+                        const float threshold) {
+  Dequantize1BitKernelLaunch(s, inputs, threshold);
+}
+
+void QuantizeTopKImpl(mshadow::Stream<gpu>* s, const std::vector<TBlob>& inputs,
+                      const int block_size) {
+  QuantizeTopKKernelLaunch(s, inputs, block_size);
+}
+
+void DequantizeTopKImpl(mshadow::Stream<gpu>* s, const std::vector<TBlob>& inputs,
+                        const int block_size) {
+  DequantizeTopKKernelLaunch(s, inputs, block_size);
+}
 }  // namespace kvstore
 }  // namespace mxnet
@@ -35,17 +35,23 @@ namespace mxnet {
 namespace kvstore {
 
 enum class CompressionType {
-  kNone, kTwoBit
+  kNone, kTwoBit, kOneBit, kTopK
 };
 
 struct GradientCompressionParam : public dmlc::Parameter<GradientCompressionParam> {
   std::string type;
   float threshold;
+  int block_size;
   DMLC_DECLARE_PARAMETER(GradientCompressionParam) {
     DMLC_DECLARE_FIELD(type)
-      .describe("Type of gradient compression to use, like `2bit` for example");
+      .describe("Type of gradient compression to use, one of `2bit`, `1bit` and `topk`");
     DMLC_DECLARE_FIELD(threshold).set_default(0.5)
-      .describe("Threshold to use for 2bit gradient compression");
+      .describe("Threshold to use for 2bit gradient compression, and magnitude of "
+                "the values sent by 1bit gradient compression");
+    DMLC_DECLARE_FIELD(block_size).set_default(64)
+      .set_range(2, 65536)
+      .describe("For topk gradient compression, only the largest value of each block "
+                "of `block_size` values is sent");
   }
 };
 
@@ -78,6 +84,18 @@ class GradientCompression {
    */
   void SetTwoBitCompression(const float threshold);
 
+  /*!
+   * \brief sets one bit gradient compression
+   * \param threshold magnitude of the dequantized values
+   */
+  void SetOneBitCompression(const float threshold);
+
+  /*!
+   * \brief sets top-k gradient compression
+   * \param block_size number of values out of which the largest one is sent
+   */
+  void SetTopKCompression(const int block_size);
+
   /*!
    * \brief encodes parameters of gc into a string
    */
@@ -132,6 +150,12 @@ class GradientCompression {
    * all negative gradients will be thresholded to -1*`threshold_`
    */
   float threshold_ = 0;
+
+  /*!
+   * \brief denotes the block size used by top-k compression, each block of
+   * `block_size_` gradients is compressed into one value
+   */
+  int block_size_ = 0;
 };
 }  // namespace kvstore
 }  // namespace mxnet
@@ -32,6 +32,7 @@
 #include <mxnet/imperative.h>
 #include <mshadow/tensor.h>
 #include "./ndarray_function.h"
+#include "../common/mapped_file.h"
 #include "../common/utils.h"
 #include "../operator/tensor/matrix_op-inl.h"
 #include "../operator/tensor/init_op.h"
@@ -1850,6 +1851,10 @@ bool NDArray::LegacyLoad(dmlc::Stream *strm, const uint32_t magic) {
 }
 
 bool NDArray::Load(dmlc::Stream *strm) {
+  return Load(strm, nullptr);
+}
+
+bool NDArray::Load(dmlc::Stream *strm, const std::shared_ptr<common::MappedFile> &mapping) {
   uint32_t magic;
   if (strm->Read(&magic, sizeof(uint32_t)) != sizeof(uint32_t)) return false;
   if (magic == NDARRAY_V3_MAGIC) {
@@ -1917,28 +1922,45 @@ bool NDArray::Load(dmlc::Stream *strm) {
     }
   }
 
-  // load data into CPU
+  // alias the data in the mapped file if possible, instead of copying it
   NDArray temp;
-  if (0 == nad) {
-    temp = NDArray(shape, Context::CPU(), false, type_flag);
-  } else {
-    temp = NDArray(static_cast<NDArrayStorageType>(stype), shape,
-                   Context::CPU(), false, type_flag,
-                   aux_types, aux_shapes, sshape);
+  bool aliased = false;
+  if (mapping && 0 == nad) {
+    auto *mapped_strm = static_cast<dmlc::SeekStream*>(strm);
+    const size_t offset = mapped_strm->Tell();
+    const size_t type_size = mshadow::mshadow_sizeof(type_flag);
+    const size_t nbytes = type_size * shape.Size();
+    if (mapping->CanAlias(offset, nbytes, type_size)) {
+      TBlob blob(mapping->data() + offset, shape, cpu::kDevMask, type_flag, 0);
+      temp = NDArray(blob, 0, [mapping]() {});
+      mapped_strm->Seek(offset + nbytes);
+      aliased = true;
+    }
   }
-  // load data
-  TBlob load_data = temp.data();
-  size_t type_size = mshadow::mshadow_sizeof(type_flag);
-  size_t nread = type_size * load_data.Size();
-  if (strm->Read(load_data.dptr_, nread) != nread) return false;
 
-  // load aux_data
-  if (nad > 0) {
-    for (int i = 0; i < nad; ++i) {
-      load_data = temp.aux_data(i);
-      type_size = mshadow::mshadow_sizeof(load_data.type_flag_);
-      nread = type_size * load_data.Size();
-      if (strm->Read(load_data.dptr_, nread) != nread) return false;
+  if (!aliased) {
+    // load data into CPU
+    if (0 == nad) {
+      temp = NDArray(shape, Context::CPU(), false, type_flag);
+    } else {
+      temp = NDArray(static_cast<NDArrayStorageType>(stype), shape,
+                     Context::CPU(), false, type_flag,
+                     aux_types, aux_shapes, sshape);
+    }
+    // load data
+    TBlob load_data = temp.data();
+    size_t type_size = mshadow::mshadow_sizeof(type_flag);
+    size_t nread = type_size * load_data.Size();
+    if (strm->Read(load_data.dptr_, nread) != nread) return false;
+
+    // load aux_data
+    if (nad > 0) {
+      for (int i = 0; i < nad; ++i) {
+        load_data = temp.aux_data(i);
+        type_size = mshadow::mshadow_sizeof(load_data.type_flag_);
+        nread = type_size * load_data.Size();
+        if (strm->Read(load_data.dptr_, nread) != nread) return false;
+      }
     }
   }
 
@@ -1989,6 +2011,31 @@ void NDArray::Load(dmlc::Stream* fi,
       << "Invalid NDArray file format";
 }
 
+void NDArray::LoadMapped(const std::string& fname,
+                         std::vector<NDArray>* data,
+                         std::vector<std::string>* keys) {
+  auto mapping = std::make_shared<common::MappedFile>(fname);
+  dmlc::MemoryFixedSizeStream strm(mapping->data(), mapping->size());
+  uint64_t header, reserved, size;
+  CHECK(strm.Read(&header))
+      << "Invalid NDArray file format";
+  CHECK(strm.Read(&reserved))
+      << "Invalid NDArray file format";
+  CHECK(header == kMXAPINDArrayListMagic)
+      << "Invalid NDArray file format";
+  CHECK(strm.Read(&size))
+      << "Invalid NDArray file format";
+  data->resize(size);
+  for (auto& array : *data) {
+    CHECK(array.Load(&strm, mapping))
+        << "Invalid NDArray file format";
+  }
+  CHECK(strm.Read(keys))
+      << "Invalid NDArray file format";
+  CHECK(keys->size() == 0 || keys->size() == data->size())
+      << "Invalid NDArray file format";
+}
+
 NDArray NDArray::Copy(Context ctx) const {
   NDArray ret;
   if (kDefaultStorage == storage_type()) {
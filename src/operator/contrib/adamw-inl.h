@@ -29,6 +29,7 @@
 #include <vector>
 #include "../mshadow_op.h"
 #include "../elemwise_op_common.h"
+#include "../multi_tensor_cpu-inl.h"
 
 namespace mxnet {
 namespace op {
@@ -397,6 +398,9 @@ void FillMultiAdamKernelParam(const nnvm::NodeAttrs& attrs,
   pParam->epsilon = p.epsilon;
 
   pParam->count = p.num_weights;
+  CHECK(pParam->count <= MultiAdamKernelParam<DType, MPDType>::N)
+    << "Invalid number of weights, the maximum value is "
+    << MultiAdamKernelParam<DType, MPDType>::N << ", and got " << pParam->count;
   pParam->max_size = 0;
   constexpr bool isSame = std::is_same<DType, MPDType>::value;
   for (int i = 0; i < pParam->count; ++i) {
@@ -441,6 +445,76 @@ static inline void MultiAdamWUpdate(const nnvm::NodeAttrs& attrs,
   });
 }
 
+/*! \brief AdamW update of elements [begin, end) of one weight on CPU */
+template<int req, bool has_mixed_precision, typename DType, typename MPDType>
+inline void MultiAdamWChunkCPU(size_t begin, size_t end, DType* out, const DType* weight,
+                               const DType* grad, MPDType* mean_data, MPDType* var_data,
+                               MPDType* weight32, const MPDType lr, const MPDType wd,
+                               const MPDType eta, const MPDType beta1, const MPDType beta2,
+                               const MPDType epsilon, const MPDType clip_gradient,
+                               const MPDType rescale_grad) {
+  #pragma omp simd
+  for (size_t i = begin; i < end; ++i) {
+    MPDType w = has_mixed_precision ? weight32[i] : MPDType(weight[i]);
+    MPDType scaled_grad = rescale_grad * static_cast<MPDType>(grad[i]);
+    if (clip_gradient >= 0.0f)
+      scaled_grad = mshadow_op::clip::Map(scaled_grad, clip_gradient);
+
+    const auto mean = beta1 * (mean_data[i] - scaled_grad) + scaled_grad;
+    const auto adj = mshadow_op::square::Map(scaled_grad);
+    const auto var = beta2 * (var_data[i] - adj) + adj;
+
+    mean_data[i] = mean;
+    var_data[i] = var;
+    w = w - eta * (lr * mean / (mshadow_op::square_root::Map(var) + epsilon) + wd * w);
+    if (has_mixed_precision)
+      weight32[i] = w;
+
+    KERNEL_ASSIGN(out[i], req, w);
+  }
+}
+
+/*!
+ * \brief Multi-tensor AdamW on CPU, the elements of all the weights are split
+ *  into equal chunks over the threads and there is no limit on their number.
+ */
+template<template<typename> class MPTypeChooser, int input_stride>
+static inline void MultiAdamWUpdateCPU(const nnvm::NodeAttrs& attrs,
+                                       const OpContext &ctx,
+                                       const std::vector<TBlob> &inputs,
+                                       const std::vector<OpReqType> &req,
+                                       const std::vector<TBlob> &outputs,
+                                       const float rescale_grad) {
+  const MultiAdamWParam& p = nnvm::get<MultiAdamWParam>(attrs.parsed);
+  std::vector<size_t> sizes(p.num_weights);
+  for (int i = 0; i < p.num_weights; ++i) {
+    sizes[i] = inputs[i * input_stride].shape_.Size();
+  }
+  const MultiTensorChunks partition(sizes);
+  MSHADOW_REAL_TYPE_SWITCH(outputs[0].type_flag_, DType, {
+    using MPDType = typename MPTypeChooser<DType>::type;
+    constexpr bool has_mp = !std::is_same<DType, MPDType>::value;
+    MXNET_ASSIGN_REQ_SWITCH(req[0], Req, {
+      MultiTensorForEachChunk(partition, [&](size_t, const MultiTensorChunks::Chunk& chunk) {
+        const size_t t = chunk.tensor;
+        const size_t idx = t * input_stride;
+        MultiAdamWChunkCPU<Req, has_mp>(
+          chunk.begin, chunk.end,
+          outputs[t].dptr<DType>(),
+          inputs[idx].dptr<DType>(),
+          inputs[idx + 1].dptr<DType>(),
+          inputs[idx + 2].dptr<MPDType>(),
+          inputs[idx + 3].dptr<MPDType>(),
+          has_mp ? inputs[idx + input_stride - 1].dptr<MPDType>() : nullptr,
+          static_cast<MPDType>(p.lrs[t]), static_cast<MPDType>(p.wds[t]),
+          static_cast<MPDType>(p.etas[t]), static_cast<MPDType>(p.beta1),
+          static_cast<MPDType>(p.beta2), static_cast<MPDType>(p.epsilon),
+          static_cast<MPDType>(p.clip_gradient), static_cast<MPDType>(rescale_grad));
+      });
+    });
+  });
+}
+
 template<typename xpu>
 void GetScaleFloat(mshadow::Stream<xpu> *s, const TBlob &scale_blob, float *pScalef);
 
@@ -494,6 +568,25 @@ inline void multiMPUpdate(const nnvm::NodeAttrs& attrs,
       (attrs, ctx, inputs_wo_scale, req, outputs, scalef);
 }
 
+template<bool MP>
+inline void multiMPUpdateCPU(const nnvm::NodeAttrs& attrs,
+                             const OpContext &ctx,
+                             const std::vector<TBlob> &inputs,
+                             const std::vector<OpReqType> &req,
+                             const std::vector<TBlob> &outputs) {
+  std::vector<TBlob> inputs_wo_scale;
+  float scalef;
+  if (!PrepareInputBlobs<cpu>(ctx, inputs, &inputs_wo_scale, &scalef))
+    return;
+
+  if (!MP)
+    MultiAdamWUpdateCPU<Adam_type_identity, 4>
+      (attrs, ctx, inputs_wo_scale, req, outputs, scalef);
+  else
+    MultiAdamWUpdateCPU<Adam_single_precision, 5>
+      (attrs, ctx, inputs_wo_scale, req, outputs, scalef);
+}
+
 }  // namespace op
 }  // namespace mxnet
 
@@ -116,9 +116,6 @@ inline bool MultiLAMBInferShape(const nnvm::NodeAttrs& attrs,
   auto& input_shapes = *in_attrs;
   auto& output_shapes = *out_attrs;
 
-  CHECK_LE(param.num_tensors, 45)
-    << "Invalid number of tensors, the maximum value is 45, and got "
-    << param.num_tensors;
   CHECK_EQ(param.learning_rates.ndim(), param.num_tensors)
     << "Number of learning rates is inconsistent with num_tensors "
     << "parameter passed. Expected number of learning rates: "
@@ -225,6 +222,9 @@ void FillMultiLAMBKernelParam(const nnvm::NodeAttrs& attrs,
   mxnet_op::Stream<xpu>* s = ctx.get_stream<xpu>();
 
   multi_param->ntensors = p.num_tensors;
+  CHECK(p.num_tensors <= MultiLAMBKernelParam<DType, MPDType>::N)
+    << "Invalid number of tensors, the maximum value is "
+    << MultiLAMBKernelParam<DType, MPDType>::N << ", and got " << p.num_tensors;
   multi_param->total_size = 0;
   multi_param->max_size = 0;
   multi_param->nchunks = 0;
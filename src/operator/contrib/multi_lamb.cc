@@ -24,133 +24,177 @@
  * \author Moises Hernandez
  */
 
+#include <cmath>
 #include "./multi_lamb-inl.h"
 #include "../elemwise_op_common.h"
+#include "../multi_tensor_cpu-inl.h"
 
 namespace mxnet {
 namespace op {
 
-template<typename MPDType, bool has_mixed_precision>
-struct MultiLAMBKernelStep1 {
-  template<typename DType>
-  MSHADOW_XINLINE static void Map(int i,
-                                  const MultiLAMBKernelParam<DType, MPDType>& kernel_params,
-                                  const float beta1, const float beta2,
-                                  const float epsilon,
-                                  const float clip_gradient,
-                                  const bool bias_correction,
-                                  const float rescale_grad,
-                                  float* temp_g) {
-    using namespace mshadow_op;
-    for (size_t index = 0; index < kernel_params.ntensors; ++index) {
-      if ((size_t)i < kernel_params.sizes[index]) {
-        MPDType w = has_mixed_precision ? kernel_params.weights32[index][i]:
-                                          MPDType(kernel_params.weights[index][i]);
-        MPDType scaled_grad = static_cast<MPDType>(kernel_params.grads[index][i])*rescale_grad;
-        if (clip_gradient >= 0.0f)
-            scaled_grad = mshadow_op::clip::Map(scaled_grad, static_cast<MPDType>(clip_gradient));
-        MPDType mean = static_cast<MPDType>(beta1) * kernel_params.mean[index][i] +
-          (static_cast<MPDType>(1.0f) - static_cast<MPDType>(beta1)) * scaled_grad;
-        MPDType var = static_cast<MPDType>(beta2) * kernel_params.var[index][i] +
-          (static_cast<MPDType>(1.0f) - static_cast<MPDType>(beta2)) * scaled_grad * scaled_grad;
-        kernel_params.mean[index][i] = mean;
-        kernel_params.var[index][i] = var;
-
-        MPDType g;
-        if (bias_correction) {
-          MPDType mean_hat = mean / (static_cast<MPDType>(1.0f) -
-                                    power::Map(static_cast<MPDType>(beta1),
-                                    static_cast<MPDType>(kernel_params.step_count[index])));
-          MPDType var_hat = var / (static_cast<MPDType>(1.0f) -
-                                  power::Map(static_cast<MPDType>(beta2),
-                                  static_cast<MPDType>(kernel_params.step_count[index])));
-          g = mean_hat / (sqrt(var_hat) + static_cast<MPDType>(epsilon)) +
-                         kernel_params.wds[index] * w;
-        } else {
-          g = mean / (sqrt(var) + static_cast<MPDType>(epsilon)) +
-                      kernel_params.wds[index] * w;
-        }
-        temp_g[kernel_params.tensor2temp_g[index]+i] = g;
-      }
-    }
+/*!
+ * \brief Adam step of elements [begin, end) of one tensor: updates mean and var,
+ *  writes the update direction to temp_g and returns the sums of squares of
+ *  the weights and of temp_g over the elements.
+ */
+template<bool has_mixed_precision, typename DType, typename MPDType>
+inline void MultiLAMBStep1ChunkCPU(size_t begin, size_t end, const DType* weight,
+                                   const DType* grad, MPDType* mean_data, MPDType* var_data,
+                                   const MPDType* weight32, float* temp_g,
+                                   const MPDType beta1, const MPDType beta2,
+                                   const MPDType epsilon, const MPDType clip_gradient,
+                                   const MPDType rescale_grad, const MPDType wd,
+                                   const MPDType mean_div, const MPDType var_div,
+                                   float* sum_sq_weights, float* sum_sq_temp_g) {
+  const MPDType one = static_cast<MPDType>(1.0f);
+  float sum_w = 0.0f;
+  float sum_g = 0.0f;
+  #pragma omp simd reduction(+ : sum_w, sum_g)
+  for (size_t i = begin; i < end; ++i) {
+    MPDType w = has_mixed_precision ? weight32[i] : MPDType(weight[i]);
+    MPDType scaled_grad = static_cast<MPDType>(grad[i]) * rescale_grad;
+    if (clip_gradient >= 0.0f)
+      scaled_grad = mshadow_op::clip::Map(scaled_grad, clip_gradient);
+    MPDType mean = beta1 * mean_data[i] + (one - beta1) * scaled_grad;
+    MPDType var = beta2 * var_data[i] + (one - beta2) * scaled_grad * scaled_grad;
+    mean_data[i] = mean;
+    var_data[i] = var;
+
+    const MPDType mean_hat = mean / mean_div;
+    const MPDType var_hat = var / var_div;
+    const float g = mean_hat / (mshadow_op::square_root::Map(var_hat) + epsilon) + wd * w;
+    temp_g[i] = g;
+    sum_w += static_cast<float>(w) * static_cast<float>(w);
+    sum_g += g * g;
+  }
+  *sum_sq_weights = sum_w;
+  *sum_sq_temp_g = sum_g;
+}
+
+/*! \brief trust ratio scaled step of elements [begin, end) of one tensor */
+template<int req, bool has_mixed_precision, typename DType, typename MPDType>
+inline void MultiLAMBStep2ChunkCPU(size_t begin, size_t end, DType* out, const DType* weight,
+                                   MPDType* weight32, const float* temp_g,
+                                   const MPDType lr_adjusted) {
+  #pragma omp simd
+  for (size_t i = begin; i < end; ++i) {
+    MPDType w = has_mixed_precision ? weight32[i] : MPDType(weight[i]);
+    w -= lr_adjusted * temp_g[i];
+    if (has_mixed_precision)
+      weight32[i] = w;
+    KERNEL_ASSIGN(out[i], req, w);
+  }
+}
+
+/*!
+ * \brief Multi-tensor LAMB on CPU. Both steps run over equal chunks of the
+ *  concatenated tensors, the norms of every tensor are reduced from the sums
+ *  of squares of its chunks, so there is no limit on the number of tensors.
+ */
+template<template<typename> class MPTypeChooser, int input_stride>
+inline void MultiLAMBCPU(const nnvm::NodeAttrs& attrs,
+                         const OpContext &ctx,
+                         const std::vector<TBlob> &inputs,
+                         const std::vector<OpReqType> &req,
+                         const std::vector<TBlob> &outputs) {
+  const MultiLAMBParam& p = nnvm::get<MultiLAMBParam>(attrs.parsed);
+  Stream<cpu>* s = ctx.get_stream<cpu>();
+  const size_t ntensors = p.num_tensors;
+  std::vector<size_t> sizes(ntensors);
+  std::vector<size_t> tensor2temp_g(ntensors);
+  size_t total_size = 0;
+  for (size_t i = 0; i < ntensors; ++i) {
+    sizes[i] = inputs[i * input_stride].shape_.Size();
+    tensor2temp_g[i] = total_size;
+    total_size += sizes[i];
   }
-};
-
-template<typename MPDType, bool has_mixed_precision>
-struct MultiLAMBKernelStep2 {
-  template<typename DType>
-  MSHADOW_XINLINE static void Map(int i,
-                                  const MultiLAMBKernelParam<DType, MPDType>& kernel_params,
-                                  const float* sum_sq_weigths,
-                                  const float* sum_sq_temp_g,
-                                  const float* temp_g,
-                                  const float lower_bound,
-                                  const float upper_bound,
-                                  const OpReqType req) {
-    for (size_t index = 0; index < kernel_params.ntensors; ++index) {
-      if ((size_t)i < kernel_params.sizes[index]) {
-        MPDType w = has_mixed_precision ? kernel_params.weights32[index][i]:
-                                          MPDType(kernel_params.weights[index][i]);
-        float r1 = sqrt(sum_sq_weigths[index]);
-        float r2 = sqrt(sum_sq_temp_g[index]);
-        if (lower_bound >= 0)
-          r1 = std::max(r1, lower_bound);
-        if (upper_bound >= 0)
-          r1 = std::min(r1, upper_bound);
-
-        // calculate lamb_trust_ratio
-        MPDType r;
-        if (r1 == 0.0f || r2 == 0.0f)
-          r = 1.0f;
-        else
-          r = r1/r2;
-
-        MPDType lr_adjusted = kernel_params.learning_rates[index] * r;
-        w -= lr_adjusted * temp_g[kernel_params.tensor2temp_g[index]+i];
-
-        // update weights
-        if (has_mixed_precision)
-          kernel_params.weights32[index][i] = w;
-        KERNEL_ASSIGN(kernel_params.out_data[index][i], req, w);
+  const MultiTensorChunks partition(sizes);
+  const size_t nchunks = partition.size();
+
+  // temp_g, then the sums of squares of the weights and of temp_g of every chunk
+  Tensor<cpu, 1, float> workspace =
+    ctx.requested[multilamb::kTempSpace].get_space_typed<cpu, 1, float>(
+      Shape1(total_size + 2 * nchunks), s);
+  float* temp_g = workspace.dptr_;
+  float* chunk_sum_sq_weights = temp_g + total_size;
+  float* chunk_sum_sq_temp_g = chunk_sum_sq_weights + nchunks;
+
+  MSHADOW_REAL_TYPE_SWITCH(inputs[0].type_flag_, DType, {
+    using MPDType = typename MPTypeChooser<DType>::type;
+    constexpr bool has_mp = !std::is_same<DType, MPDType>::value;
+    MultiTensorForEachChunk(partition, [&](size_t c, const MultiTensorChunks::Chunk& chunk) {
+      const size_t t = chunk.tensor;
+      const size_t idx = t * input_stride;
+      MPDType mean_div = 1.0f;
+      MPDType var_div = 1.0f;
+      if (p.bias_correction) {
+        const MPDType step = static_cast<MPDType>(p.step_count[t]);
+        mean_div -= mshadow_op::power::Map(static_cast<MPDType>(p.beta1), step);
+        var_div -= mshadow_op::power::Map(static_cast<MPDType>(p.beta2), step);
       }
+      // if mixed precision, then the last input in a set
+      // is 32-bit master copy of the weights
+      MultiLAMBStep1ChunkCPU<has_mp>(
+        chunk.begin, chunk.end,
+        inputs[idx].dptr<DType>(),
+        inputs[idx + 1].dptr<DType>(),
+        inputs[idx + 2].dptr<MPDType>(),
+        inputs[idx + 3].dptr<MPDType>(),
+        has_mp ? inputs[idx + input_stride - 1].dptr<MPDType>() : nullptr,
+        temp_g + tensor2temp_g[t],
+        static_cast<MPDType>(p.beta1), static_cast<MPDType>(p.beta2),
+        static_cast<MPDType>(p.epsilon), static_cast<MPDType>(p.clip_gradient),
+        static_cast<MPDType>(p.rescale_grad), static_cast<MPDType>(p.wds[t]),
+        mean_div, var_div,
+        &chunk_sum_sq_weights[c], &chunk_sum_sq_temp_g[c]);
+    });
+
+    // lamb_trust_ratio of every tensor
+    std::vector<float> sum_sq_weights(ntensors, 0.0f);
+    std::vector<float> sum_sq_temp_g(ntensors, 0.0f);
+    for (size_t c = 0; c < nchunks; ++c) {
+      sum_sq_weights[partition.chunks[c].tensor] += chunk_sum_sq_weights[c];
+      sum_sq_temp_g[partition.chunks[c].tensor] += chunk_sum_sq_temp_g[c];
     }
-  }
-};
-
-template<typename MPDType, typename DType>
-void CallKernel1(Stream<cpu>* s,
-                  const MultiLAMBKernelParam<DType, MPDType>& kernel_params,
-                  const MultiLAMBParam &param,
-                  float* temp_g,
-                  int* block_to_tensor,
-                  int* block_to_chunk) {
-  Kernel<MultiLAMBKernelStep1<MPDType, !std::is_same<DType, MPDType>::value>, cpu>::
-                               Launch(s, kernel_params.max_size,
-                               kernel_params,
-                               param.beta1, param.beta2,
-                               param.epsilon,
-                               param.clip_gradient,
-                               param.bias_correction,
-                               param.rescale_grad,
-                               temp_g);
+    std::vector<MPDType> lr_adjusted(ntensors);
+    for (size_t t = 0; t < ntensors; ++t) {
+      float r1 = std::sqrt(sum_sq_weights[t]);
+      const float r2 = std::sqrt(sum_sq_temp_g[t]);
+      if (p.lower_bound >= 0)
+        r1 = std::max(r1, p.lower_bound);
+      if (p.upper_bound >= 0)
+        r1 = std::min(r1, p.upper_bound);
+      const MPDType r = (r1 == 0.0f || r2 == 0.0f) ? 1.0f : r1 / r2;
+      lr_adjusted[t] = static_cast<MPDType>(p.learning_rates[t]) * r;
+    }
+
+    MXNET_ASSIGN_REQ_SWITCH(req[0], Req, {
+      MultiTensorForEachChunk(partition, [&](size_t, const MultiTensorChunks::Chunk& chunk) {
+        const size_t t = chunk.tensor;
+        const size_t idx = t * input_stride;
+        MultiLAMBStep2ChunkCPU<Req, has_mp>(
+          chunk.begin, chunk.end,
+          outputs[t].dptr<DType>(),
+          inputs[idx].dptr<DType>(),
+          has_mp ? inputs[idx + input_stride - 1].dptr<MPDType>() : nullptr,
+          temp_g + tensor2temp_g[t],
+          lr_adjusted[t]);
+      });
+    });
+  });
 }
 
-template<typename MPDType, typename DType>
-void CallKernel2(Stream<cpu>* s,
-                  const MultiLAMBKernelParam<DType, MPDType>& kernel_params,
-                  const MultiLAMBParam &param,
-                  float* r1, float* r2,
-                  float* temp_g,
-                  int* block_to_tensor,
-                  int* block_to_chunk,
-                  const OpReqType req) {
-  Kernel<MultiLAMBKernelStep2<MPDType, !std::is_same<DType, MPDType>::value>, cpu>::
-                               Launch(s, kernel_params.max_size,
-                               kernel_params,
-                               r1, r2,
-                               temp_g,
-                               param.lower_bound, param.upper_bound,
-                               req);
+template<bool MP>
+inline void MultiLAMBUpdateCPU(const nnvm::NodeAttrs& attrs,
+                               const OpContext &ctx,
+                               const std::vector<TBlob> &inputs,
+                               const std::vector<OpReqType> &req,
+                               const std::vector<TBlob> &outputs) {
+  if (!MP) {
+    MultiLAMBCPU<LAMBTypeIdentity, 4>(attrs, ctx, inputs, req, outputs);
+  } else {
+    MultiLAMBCPU<LAMBSinglePrecision, 5>(attrs, ctx, inputs, req, outputs);
+  }
 }
 
 DMLC_REGISTER_PARAMETER(MultiLAMBParam);
@@ -204,7 +248,7 @@ NNVM_REGISTER_OP(_multi_lamb_update)
   [](const NodeAttrs& attrs) {
     return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
   })
-.set_attr<FCompute>("FCompute<cpu>", MultiLAMBUpdate<cpu, false>)
+.set_attr<FCompute>("FCompute<cpu>", MultiLAMBUpdateCPU<false>)
 .add_argument("data", "NDArray-or-Symbol[]", "data")
 .add_arguments(MultiLAMBParam::__FIELDS__());
 
@@ -243,7 +287,7 @@ NNVM_REGISTER_OP(_multi_mp_lamb_update)
   [](const NodeAttrs& attrs) {
     return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
   })
-.set_attr<FCompute>("FCompute<cpu>", MultiLAMBUpdate<cpu, true>)
+.set_attr<FCompute>("FCompute<cpu>", MultiLAMBUpdateCPU<true>)
 .add_argument("data", "NDArray-or-Symbol[]", "data")
 .add_arguments(MultiLAMBParam::__FIELDS__());
 
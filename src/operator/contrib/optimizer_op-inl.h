@@ -37,6 +37,7 @@
 #include "../mshadow_op.h"
 #include "../mxnet_op.h"
 #include "../operator_common.h"
+#include "../tensor/indexing_op.h"
 #include "../tensor/init_op.h"
 #include "../tensor/util/tensor_util-inl.h"
 
@@ -241,6 +242,228 @@ inline void GroupAdagradUpdateEx(const nnvm::NodeAttrs &attrs,
   }
 }
 
+struct EmbeddingSGDParam : public dmlc::Parameter<EmbeddingSGDParam> {
+  float lr;
+  float wd;
+  float rescale_grad;
+  float clip_gradient;
+  DMLC_DECLARE_PARAMETER(EmbeddingSGDParam) {
+    DMLC_DECLARE_FIELD(lr)
+    .describe("Learning rate");
+    DMLC_DECLARE_FIELD(wd)
+    .set_default(0.0f)
+    .describe("Weight decay augments the objective function with a "
+              "regularization term that penalizes large weights. "
+              "The penalty scales with the square of the magnitude of each weight.");
+    DMLC_DECLARE_FIELD(rescale_grad)
+    .set_default(1.0f)
+    .describe("Rescale gradient to grad = rescale_grad*grad.");
+    DMLC_DECLARE_FIELD(clip_gradient)
+    .set_default(-1.0f)
+    .describe("Clip gradient to the range of [-clip_gradient, clip_gradient] "
+              "If clip_gradient <= 0, gradient clipping is turned off. "
+              "grad = max(min(grad, clip_gradient), -clip_gradient).");
+  }
+};
+
+struct EmbeddingAdamParam : public dmlc::Parameter<EmbeddingAdamParam> {
+  float lr;
+  float beta1;
+  float beta2;
+  float epsilon;
+  float wd;
+  float rescale_grad;
+  float clip_gradient;
+  DMLC_DECLARE_PARAMETER(EmbeddingAdamParam) {
+    DMLC_DECLARE_FIELD(lr)
+    .describe("Learning rate");
+    DMLC_DECLARE_FIELD(beta1)
+    .set_default(0.9f)
+    .describe("The decay rate for the 1st moment estimates.");
+    DMLC_DECLARE_FIELD(beta2)
+    .set_default(0.999f)
+    .describe("The decay rate for the 2nd moment estimates.");
+    DMLC_DECLARE_FIELD(epsilon)
+    .set_default(1e-8f)
+    .describe("A small constant for numerical stability.");
+    DMLC_DECLARE_FIELD(wd)
+    .set_default(0.0f)
+    .describe("Weight decay augments the objective function with a "
+              "regularization term that penalizes large weights. "
+              "The penalty scales with the square of the magnitude of each weight.");
+    DMLC_DECLARE_FIELD(rescale_grad)
+    .set_default(1.0f)
+    .describe("Rescale gradient to grad = rescale_grad*grad.");
+    DMLC_DECLARE_FIELD(clip_gradient)
+    .set_default(-1.0f)
+    .describe("Clip gradient to the range of [-clip_gradient, clip_gradient] "
+              "If clip_gradient <= 0, gradient clipping is turned off. "
+              "grad = max(min(grad, clip_gradient), -clip_gradient).");
+  }
+};
+
+/*!
+ * \brief Shape inference of the embedding updates: weight, data, output gradient
+ *  of the embedding, then the states of the optimizer, shaped as the weight.
+ */
+inline bool EmbeddingUpdateShape(const nnvm::NodeAttrs& attrs,
+                                 mxnet::ShapeVector* in_attrs,
+                                 mxnet::ShapeVector* out_attrs) {
+  CHECK_GE(in_attrs->size(), 3U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  SHAPE_ASSIGN_CHECK(*out_attrs, 0, in_attrs->at(0));
+  SHAPE_ASSIGN_CHECK(*in_attrs, 0, out_attrs->at(0));
+  for (size_t i = 3; i < in_attrs->size(); ++i) {
+    SHAPE_ASSIGN_CHECK(*in_attrs, i, out_attrs->at(0));
+  }
+  const mxnet::TShape& wshape = in_attrs->at(0);
+  const mxnet::TShape& dshape = in_attrs->at(1);
+  if (!shape_is_known(wshape) || !shape_is_known(dshape)) return false;
+  CHECK_EQ(wshape.ndim(), 2U) << "The weight of the embedding should be 2D";
+  mxnet::TShape gshape(dshape.ndim() + 1, -1);
+  for (int i = 0; i < dshape.ndim(); ++i) gshape[i] = dshape[i];
+  gshape[dshape.ndim()] = wshape[1];
+  SHAPE_ASSIGN_CHECK(*in_attrs, 2, gshape);
+  return true;
+}
+
+inline bool EmbeddingUpdateType(const nnvm::NodeAttrs& attrs,
+                                std::vector<int>* in_attrs,
+                                std::vector<int>* out_attrs) {
+  CHECK_GE(in_attrs->size(), 3U);
+  CHECK_EQ(out_attrs->size(), 1U);
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, in_attrs->at(0));
+  TYPE_ASSIGN_CHECK(*in_attrs, 0, out_attrs->at(0));
+  for (size_t i = 2; i < in_attrs->size(); ++i) {
+    TYPE_ASSIGN_CHECK(*in_attrs, i, out_attrs->at(0));
+  }
+  // the indices keep their own type
+  return out_attrs->at(0) != -1 && in_attrs->at(1) != -1;
+}
+
+/*!
+ * \brief Update the rows of the weight of an embedding referenced by data with the
+ *  output gradient of the embedding, without materializing the row_sparse gradient.
+ *  Each referenced row is handled by a single thread, which sums its gradient
+ *  and calls update(row, grad) with it.
+ */
+template<typename DType, typename RowUpdate>
+inline void EmbeddingUpdateRowsCPU(const OpContext& ctx,
+                                   const TBlob& data,
+                                   const TBlob& ograd,
+                                   const nnvm::dim_t num_rows,
+                                   const nnvm::dim_t row_length,
+                                   RowUpdate update) {
+  using nnvm::dim_t;
+  mshadow::Stream<cpu>* s = ctx.get_stream<cpu>();
+  const dim_t num_indices = data.Size();
+  if (num_indices == 0) return;
+  const int num_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  mshadow::Tensor<cpu, 1, dim_t> workspace =
+    ctx.requested[0].get_space_typed<cpu, 1, dim_t>(
+      mshadow::Shape1(GroupEmbeddingIndicesWorkspaceSize(num_indices, num_threads)), s);
+  MSHADOW_TYPE_SWITCH(data.type_flag_, IType, {
+    const IType* idx = data.dptr<IType>();
+    for (dim_t i = 0; i < num_indices; ++i) {
+      CHECK(idx[i] >= 0 && static_cast<dim_t>(idx[i]) < num_rows)
+        << "Embedding input contains data out of bound";
+    }
+    const EmbeddingIndexGroups groups =
+      GroupEmbeddingIndicesCPU(idx, num_indices, num_rows, workspace.dptr_, num_threads);
+    const DType* ograd_data = ograd.dptr<DType>();
+    #pragma omp parallel num_threads(num_threads)
+    {
+      std::vector<DType> grad(row_length);
+      #pragma omp for schedule(dynamic, 64)
+      for (dim_t r = 0; r < groups.nnr; ++r) {
+        std::fill(grad.begin(), grad.end(), DType(0));
+        for (dim_t k = groups.offsets[r]; k < groups.offsets[r + 1]; ++k) {
+          const DType* ograd_row = ograd_data + groups.positions[k] * row_length;
+          for (dim_t j = 0; j < row_length; ++j) grad[j] += ograd_row[j];
+        }
+        update(groups.rows[r], grad.data());
+      }
+    }
+  });
+}
+
+/*! \brief the output starts as a copy of the weight unless written in place */
+inline void EmbeddingUpdatePrepareOutput(const TBlob& weight, const OpReqType req,
+                                         const TBlob& out) {
+  CHECK(req == kWriteInplace || req == kWriteTo)
+    << "The embedding updates only support req write or inplace";
+  if (req == kWriteTo && out.dptr_ != weight.dptr_) {
+    memcpy(out.dptr_, weight.dptr_, weight.Size() * mshadow::mshadow_sizeof(weight.type_flag_));
+  }
+}
+
+template<typename xpu>
+inline void EmbeddingSGDUpdate(const nnvm::NodeAttrs& attrs,
+                               const OpContext& ctx,
+                               const std::vector<TBlob>& inputs,
+                               const std::vector<OpReqType>& req,
+                               const std::vector<TBlob>& outputs) {
+  const EmbeddingSGDParam& param = nnvm::get<EmbeddingSGDParam>(attrs.parsed);
+  if (req[0] == kNullOp) return;
+  const TBlob& weight = inputs[0];
+  EmbeddingUpdatePrepareOutput(weight, req[0], outputs[0]);
+  const nnvm::dim_t row_length = weight.shape_[1];
+  MSHADOW_REAL_TYPE_SWITCH(weight.type_flag_, DType, {
+    DType* out_data = outputs[0].dptr<DType>();
+    const DType lr = param.lr, wd = param.wd;
+    const DType rescale_grad = param.rescale_grad, clip_gradient = param.clip_gradient;
+    EmbeddingUpdateRowsCPU<DType>(ctx, inputs[1], inputs[2], weight.shape_[0], row_length,
+      [=](nnvm::dim_t row, const DType* grad) {
+        DType* w = out_data + row * row_length;
+        for (nnvm::dim_t j = 0; j < row_length; ++j) {
+          DType grad_rescaled = rescale_grad * grad[j];
+          if (clip_gradient >= 0.0f) {
+            grad_rescaled = mshadow_op::clip::Map(grad_rescaled, clip_gradient);
+          }
+          grad_rescaled += wd * w[j];
+          w[j] -= lr * grad_rescaled;
+        }
+      });
+  });
+}
+
+template<typename xpu>
+inline void EmbeddingAdamUpdate(const nnvm::NodeAttrs& attrs,
+                                const OpContext& ctx,
+                                const std::vector<TBlob>& inputs,
+                                const std::vector<OpReqType>& req,
+                                const std::vector<TBlob>& outputs) {
+  const EmbeddingAdamParam& param = nnvm::get<EmbeddingAdamParam>(attrs.parsed);
+  if (req[0] == kNullOp) return;
+  const TBlob& weight = inputs[0];
+  EmbeddingUpdatePrepareOutput(weight, req[0], outputs[0]);
+  const nnvm::dim_t row_length = weight.shape_[1];
+  MSHADOW_REAL_TYPE_SWITCH(weight.type_flag_, DType, {
+    DType* out_data = outputs[0].dptr<DType>();
+    DType* mean_data = inputs[3].dptr<DType>();
+    DType* var_data = inputs[4].dptr<DType>();
+    const DType lr = param.lr, wd = param.wd, epsilon = param.epsilon;
+    const DType beta1 = param.beta1, beta2 = param.beta2;
+    const DType rescale_grad = param.rescale_grad, clip_gradient = param.clip_gradient;
+    EmbeddingUpdateRowsCPU<DType>(ctx, inputs[1], inputs[2], weight.shape_[0], row_length,
+      [=](nnvm::dim_t row, const DType* grad) {
+        DType* w = out_data + row * row_length;
+        DType* mean = mean_data + row * row_length;
+        DType* var = var_data + row * row_length;
+        for (nnvm::dim_t j = 0; j < row_length; ++j) {
+          DType grad_rescaled = rescale_grad * grad[j];
+          if (clip_gradient >= 0.0f) {
+            grad_rescaled = mshadow_op::clip::Map(grad_rescaled, clip_gradient);
+          }
+          grad_rescaled += wd * w[j];
+          mean[j] = beta1 * mean[j] + (1.f - beta1) * grad_rescaled;
+          var[j] = beta2 * var[j] + (1.f - beta2) * grad_rescaled * grad_rescaled;
+          w[j] -= lr * mean[j] / (mshadow_op::square_root::Map(var[j]) + epsilon);
+        }
+      });
+  });
+}
+
 }  // namespace op
 }  // namespace mxnet
 
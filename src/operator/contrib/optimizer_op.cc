@@ -30,6 +30,8 @@ namespace mxnet {
 namespace op {
 
 DMLC_REGISTER_PARAMETER(GroupAdagradParam);
+DMLC_REGISTER_PARAMETER(EmbeddingSGDParam);
+DMLC_REGISTER_PARAMETER(EmbeddingAdamParam);
 
 /*!
  * \brief Shape inference function for Group AdaGrad.
@@ -85,5 +87,83 @@ Note that non-zero values for the weight decay option are not supported.
 .add_argument("history", "NDArray-or-Symbol", "History")
 .add_arguments(GroupAdagradParam::__FIELDS__());
 
+NNVM_REGISTER_OP(_contrib_embedding_sgd_update)
+.describe(R"code(Update the weight of an Embedding with the output gradient of the
+embedding, fusing the backward pass of Embedding with ``sparse_grad=True`` and the
+lazy SGD update.
+
+The gradient of the rows referenced by ``data`` is summed per distinct index and
+only these rows of the weight are updated, by::
+
+    grad = clip(sum(ograd[data == row]) * rescale_grad, clip_gradient) + wd * weight[row]
+    weight[row] = weight[row] - lr * grad
+
+This is equivalent to ``sgd_update(weight, grad, lazy_update=True)`` with the
+row_sparse gradient of the embedding, without materializing that gradient.
+The weight must be dense. Only available on CPU.
+
+)code" ADD_FILELINE)
+.set_num_inputs(3)
+.set_num_outputs(1)
+.set_attr_parser(ParamParser<EmbeddingSGDParam>)
+.set_attr<mxnet::FInferShape>("FInferShape", EmbeddingUpdateShape)
+.set_attr<nnvm::FInferType>("FInferType", EmbeddingUpdateType)
+.set_attr<FResourceRequest>("FResourceRequest",
+  [](const NodeAttrs& attrs) {
+    return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+  })
+.set_attr<nnvm::FInplaceOption>("FInplaceOption",
+  [](const NodeAttrs& attrs) {
+    return std::vector<std::pair<int, int> >{{0, 0}};
+  })
+.set_attr<FCompute>("FCompute<cpu>", EmbeddingSGDUpdate<cpu>)
+.add_argument("weight", "NDArray-or-Symbol", "Weight of the embedding")
+.add_argument("data", "NDArray-or-Symbol", "Input data of the embedding")
+.add_argument("ograd", "NDArray-or-Symbol", "Gradient of the output of the embedding")
+.add_arguments(EmbeddingSGDParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_contrib_embedding_adam_update)
+.describe(R"code(Update the weight of an Embedding with the output gradient of the
+embedding, fusing the backward pass of Embedding with ``sparse_grad=True`` and the
+lazy Adam update.
+
+The gradient of the rows referenced by ``data`` is summed per distinct index and
+only these rows of the weight, mean and var are updated, by::
+
+    grad = clip(sum(ograd[data == row]) * rescale_grad, clip_gradient) + wd * weight[row]
+    mean[row] = beta1 * mean[row] + (1 - beta1) * grad
+    var[row] = beta2 * var[row] + (1 - beta2) * (grad ** 2)
+    weight[row] = weight[row] - lr * mean[row] / (sqrt(var[row]) + epsilon)
+
+This is equivalent to ``adam_update(weight, grad, mean, var, lazy_update=True)``
+with the row_sparse gradient of the embedding, without materializing that gradient.
+The weight and states must be dense. Only available on CPU.
+
+)code" ADD_FILELINE)
+.set_num_inputs(5)
+.set_num_outputs(1)
+.set_attr_parser(ParamParser<EmbeddingAdamParam>)
+.set_attr<mxnet::FInferShape>("FInferShape", EmbeddingUpdateShape)
+.set_attr<nnvm::FInferType>("FInferType", EmbeddingUpdateType)
+.set_attr<FResourceRequest>("FResourceRequest",
+  [](const NodeAttrs& attrs) {
+    return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+  })
+.set_attr<nnvm::FInplaceOption>("FInplaceOption",
+  [](const NodeAttrs& attrs) {
+    return std::vector<std::pair<int, int> >{{0, 0}};
+  })
+.set_attr<nnvm::FMutateInputs>("FMutateInputs",
+  [](const nnvm::NodeAttrs& attrs) {
+    return std::vector<uint32_t>{3, 4};
+  })
+.set_attr<FCompute>("FCompute<cpu>", EmbeddingAdamUpdate<cpu>)
+.add_argument("weight", "NDArray-or-Symbol", "Weight of the embedding")
+.add_argument("data", "NDArray-or-Symbol", "Input data of the embedding")
+.add_argument("ograd", "NDArray-or-Symbol", "Gradient of the output of the embedding")
+.add_argument("mean", "NDArray-or-Symbol", "Moving mean")
+.add_argument("var", "NDArray-or-Symbol", "Moving variance")
+.add_arguments(EmbeddingAdamParam::__FIELDS__());
+
 }  // namespace op
 }  // namespace mxnet
@@ -43,6 +43,23 @@ struct InterleavedMatMulParam : public dmlc::Parameter<InterleavedMatMulParam> {
   }
 };
 
+struct InterleavedFusedSelfAttParam : public dmlc::Parameter<InterleavedFusedSelfAttParam> {
+  int heads;
+  bool causal;
+  bool use_valid_length;
+  DMLC_DECLARE_PARAMETER(InterleavedFusedSelfAttParam) {
+    DMLC_DECLARE_FIELD(heads)
+    .describe("Set number of heads");
+    DMLC_DECLARE_FIELD(causal)
+    .set_default(false)
+    .describe("If true, each position only attends to itself and the previous positions.");
+    DMLC_DECLARE_FIELD(use_valid_length)
+    .set_default(false)
+    .describe("If true, the keys at positions beyond the valid_length of their sequence "
+              "are masked.");
+  }
+};
+
 template<typename xpu>
 static void DivSqrtDimForward_(const nnvm::NodeAttrs& attrs,
                   const OpContext& ctx,
@@ -23,6 +23,8 @@
  * \brief CPU implementation of the operators used in Transformer
  */
 #include <mxnet/base.h>
+#include <algorithm>
+#include <limits>
 #include "./transformer-inl.h"
 #include "../tensor/elemwise_unary_op.h"
 
@@ -30,6 +32,7 @@ namespace mxnet {
 namespace op {
 
 DMLC_REGISTER_PARAMETER(InterleavedMatMulParam);
+DMLC_REGISTER_PARAMETER(InterleavedFusedSelfAttParam);
 
 static bool InterleavedMatMulSelfAttQKShape(const NodeAttrs& attrs,
                                             mxnet::ShapeVector* in_shape,
@@ -647,6 +650,295 @@ void BackwardInterleavedMatMulEncDecValAttCPU(const nnvm::NodeAttrs& attrs,
   }
 }
 
+// Tiles of the fused self attention: a tile of queries goes through all the
+// tiles of keys, so that the attention weights of a whole sequence are never stored.
+static const index_t kSelfAttTileQ = 64;
+static const index_t kSelfAttTileK = 128;
+
+static bool InterleavedFusedSelfAttShape(const NodeAttrs& attrs,
+                                         mxnet::ShapeVector* in_shape,
+                                         mxnet::ShapeVector* out_shape) {
+  const auto& params = nnvm::get<InterleavedFusedSelfAttParam>(attrs.parsed);
+  CHECK_EQ(in_shape->size(), params.use_valid_length ? 2U : 1U)
+    << "Input:[queries_keys_values" << (params.use_valid_length ? ", valid_length" : "")
+    << "] currently have, " << in_shape->size() << " inputs";
+  auto qkv_shape = in_shape->at(0);
+  if (!shape_is_known(qkv_shape)) return false;
+  CHECK_EQ(qkv_shape.ndim(), 3U)
+    << "Input queries_keys_values should be 3D in seq_length-batch-3*proj_dim, "
+    << "currently is: " << qkv_shape.ndim() << "D";
+  CHECK_EQ(qkv_shape[2] % (3 * params.heads), 0)
+    << "queries_keys_values.shape[2] should be a multiple of 3 * heads, "
+    << "currently is " << qkv_shape[2];
+  if (params.use_valid_length) {
+    SHAPE_ASSIGN_CHECK(*in_shape, 1, mxnet::TShape({qkv_shape[1]}));
+  }
+  SHAPE_ASSIGN_CHECK(*out_shape, 0,
+    mxnet::TShape({qkv_shape[0], qkv_shape[1], qkv_shape[2] / 3}));
+  SHAPE_ASSIGN_CHECK(*out_shape, 1,
+    mxnet::TShape({params.heads * qkv_shape[1], qkv_shape[0]}));
+  return true;
+}
+
+static bool InterleavedFusedSelfAttType(const NodeAttrs& attrs,
+                                        std::vector<int>* in_attrs,
+                                        std::vector<int>* out_attrs) {
+  TYPE_ASSIGN_CHECK(*out_attrs, 0, in_attrs->at(0));
+  TYPE_ASSIGN_CHECK(*out_attrs, 1, in_attrs->at(0));
+  TYPE_ASSIGN_CHECK(*in_attrs, 0, out_attrs->at(0));
+  return in_attrs->at(0) != -1;
+}
+
+static std::vector<index_t> FusedSelfAttValidLength(const InterleavedFusedSelfAttParam& params,
+                                                    const TBlob* valid_length_blob,
+                                                    index_t sequences,
+                                                    index_t seq_len) {
+  std::vector<index_t> valid_length(sequences, seq_len);
+  if (params.use_valid_length) {
+    MSHADOW_TYPE_SWITCH(valid_length_blob->type_flag_, DType, {
+      const DType* lengths = valid_length_blob->dptr<DType>();
+      for (index_t i = 0; i < sequences; ++i) {
+        const index_t length = static_cast<index_t>(lengths[i]);
+        valid_length[i] = std::min(std::max(length, static_cast<index_t>(0)), seq_len);
+      }
+    });
+  }
+  return valid_length;
+}
+
+void InterleavedFusedSelfAttCPU(const nnvm::NodeAttrs& attrs,
+                                const OpContext &ctx,
+                                const std::vector<TBlob> &inputs,
+                                const std::vector<OpReqType> &req,
+                                const std::vector<TBlob> &outputs) {
+  const auto& params = nnvm::get<InterleavedFusedSelfAttParam>(attrs.parsed);
+  if (req[0] == kNullOp && req[1] == kNullOp)
+    return;
+
+  CHECK_EQ(inputs[0].type_flag_, mshadow::kFloat32)
+    << "Only FP32 is supported on CPU at the moment";
+
+  mshadow::Stream<cpu>* s = ctx.get_stream<cpu>();
+  const float* queries_keys_values = inputs[0].dptr<float>();
+  float* output                    = outputs[0].dptr<float>();
+  float* logsumexp                 = outputs[1].dptr<float>();
+  const index_t qkv_seq_len    = inputs[0].shape_[0];
+  const index_t sequences      = inputs[0].shape_[1];
+  const index_t output_lin_dim = inputs[0].shape_[2];
+  const index_t embed_dim      = output_lin_dim / 3;
+  const index_t head_dim       = embed_dim / params.heads;
+  const index_t attn_batches   = params.heads * sequences;
+  const index_t lead_dim       = attn_batches * 3 * head_dim;
+  const index_t out_lead_dim   = attn_batches * head_dim;
+  const float scale            = 1.0 / sqrt(static_cast<float>(head_dim));
+  const float inf              = std::numeric_limits<float>::infinity();
+  const std::vector<index_t> valid_length =
+    FusedSelfAttValidLength(params, params.use_valid_length ? &inputs[1] : nullptr,
+                            sequences, qkv_seq_len);
+
+  const index_t num_q_tiles = (qkv_seq_len + kSelfAttTileQ - 1) / kSelfAttTileQ;
+  const int omp_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  // scores, unnormalized output, running max and running sum of a tile of queries
+  const index_t thread_space = kSelfAttTileQ * (kSelfAttTileK + head_dim + 2);
+  mshadow::Tensor<cpu, 1, float> workspace = ctx.requested[0].get_space_typed<cpu, 1, float>(
+    mshadow::Shape1(omp_threads * thread_space), s);
+
+  #pragma omp parallel for num_threads(omp_threads) schedule(dynamic)
+  for (index_t task = 0; task < attn_batches * num_q_tiles; ++task) {
+    float* scores  = workspace.dptr_ + omp_get_thread_num() * thread_space;
+    float* acc     = scores + kSelfAttTileQ * kSelfAttTileK;
+    float* row_max = acc + kSelfAttTileQ * head_dim;
+    float* row_sum = row_max + kSelfAttTileQ;
+    const index_t batch   = task / num_q_tiles;
+    const index_t q_begin = task % num_q_tiles * kSelfAttTileQ;
+    const index_t q_rows  = std::min(kSelfAttTileQ, qkv_seq_len - q_begin);
+    const float* queries  = queries_keys_values + batch * 3 * head_dim;
+    const float* keys     = queries + head_dim;
+    const float* values   = queries + 2 * head_dim;
+    index_t kv_end = valid_length[batch / params.heads];
+    if (params.causal) kv_end = std::min(kv_end, q_begin + q_rows);
+
+    std::fill(acc, acc + q_rows * head_dim, 0.f);
+    std::fill(row_max, row_max + q_rows, -inf);
+    std::fill(row_sum, row_sum + q_rows, 0.f);
+    for (index_t kv_begin = 0; kv_begin < kv_end; kv_begin += kSelfAttTileK) {
+      const index_t kv_cols = std::min(kSelfAttTileK, kv_end - kv_begin);
+      cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasTrans,
+                  q_rows, kv_cols, head_dim,
+                  scale, queries + q_begin * lead_dim, lead_dim,
+                  keys + kv_begin * lead_dim, lead_dim,
+                  0.f, scores, kSelfAttTileK);
+      // online softmax: the output accumulated so far is rescaled to the new maximum
+      for (index_t r = 0; r < q_rows; ++r) {
+        float* row = scores + r * kSelfAttTileK;
+        const index_t cols = params.causal ?
+                             std::min(kv_cols, q_begin + r + 1 - kv_begin) : kv_cols;
+        float new_max = row_max[r];
+        for (index_t c = 0; c < cols; ++c) new_max = std::max(new_max, row[c]);
+        float sum = 0.f;
+        for (index_t c = 0; c < cols; ++c) {
+          row[c] = std::exp(row[c] - new_max);
+          sum += row[c];
+        }
+        for (index_t c = std::max(cols, static_cast<index_t>(0)); c < kv_cols; ++c) row[c] = 0.f;
+        if (cols > 0) {
+          const float correction = std::exp(row_max[r] - new_max);
+          row_sum[r] = row_sum[r] * correction + sum;
+          for (index_t d = 0; d < head_dim; ++d) acc[r * head_dim + d] *= correction;
+          row_max[r] = new_max;
+        }
+      }
+      cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans,
+                  q_rows, head_dim, kv_cols,
+                  1.f, scores, kSelfAttTileK,
+                  values + kv_begin * lead_dim, lead_dim,
+                  1.f, acc, head_dim);
+    }
+
+    for (index_t r = 0; r < q_rows; ++r) {
+      const index_t i = q_begin + r;
+      // queries without any key to attend to get a zero output
+      const float inv_sum = row_sum[r] > 0.f ? 1.f / row_sum[r] : 0.f;
+      float* out_row = output + i * out_lead_dim + batch * head_dim;
+      if (req[0] == kAddTo) {
+        for (index_t d = 0; d < head_dim; ++d) out_row[d] += acc[r * head_dim + d] * inv_sum;
+      } else if (req[0] != kNullOp) {
+        for (index_t d = 0; d < head_dim; ++d) out_row[d] = acc[r * head_dim + d] * inv_sum;
+      }
+      if (req[1] != kNullOp) {
+        logsumexp[batch * qkv_seq_len + i] = row_sum[r] > 0.f ?
+                                             row_max[r] + std::log(row_sum[r]) : inf;
+      }
+    }
+  }
+}
+
+void BackwardInterleavedFusedSelfAttCPU(const nnvm::NodeAttrs& attrs,
+                                        const OpContext &ctx,
+                                        const std::vector<TBlob> &inputs,
+                                        const std::vector<OpReqType> &req,
+                                        const std::vector<TBlob> &outputs) {
+  const auto& params = nnvm::get<InterleavedFusedSelfAttParam>(attrs.parsed);
+  const int num_inputs = params.use_valid_length ? 2 : 1;
+  if (params.use_valid_length && (req[1] == kWriteTo || req[1] == kWriteInplace)) {
+    memset(outputs[1].dptr_, 0,
+           outputs[1].shape_.Size() * mshadow::mshadow_sizeof(outputs[1].type_flag_));
+  }
+  if (req[0] == kNullOp)
+    return;
+
+  CHECK_EQ(inputs[0].type_flag_, mshadow::kFloat32)
+    << "Only FP32 is supported on CPU at the moment";
+
+  mshadow::Stream<cpu>* s = ctx.get_stream<cpu>();
+  const float* output_grads        = inputs[0].dptr<float>();
+  const float* queries_keys_values = inputs[1].dptr<float>();
+  const float* output              = inputs[1 + num_inputs].dptr<float>();
+  const float* logsumexp           = inputs[2 + num_inputs].dptr<float>();
+  float* queries_keys_values_grads = outputs[0].dptr<float>();
+  const index_t qkv_seq_len    = inputs[1].shape_[0];
+  const index_t sequences      = inputs[1].shape_[1];
+  const index_t output_lin_dim = inputs[1].shape_[2];
+  const index_t embed_dim      = output_lin_dim / 3;
+  const index_t head_dim       = embed_dim / params.heads;
+  const index_t attn_batches   = params.heads * sequences;
+  const index_t lead_dim       = attn_batches * 3 * head_dim;
+  const index_t out_lead_dim   = attn_batches * head_dim;
+  const float scale            = 1.0 / sqrt(static_cast<float>(head_dim));
+  const std::vector<index_t> valid_length =
+    FusedSelfAttValidLength(params, params.use_valid_length ? &inputs[2] : nullptr,
+                            sequences, qkv_seq_len);
+
+  if (req[0] != kAddTo) {
+    memset(queries_keys_values_grads, 0, outputs[0].shape_.Size() * sizeof (float));
+  }
+
+  const int omp_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  // attention weights and their gradients for a tile, and dot(output_grads, output) per query
+  const index_t thread_space = 2 * kSelfAttTileQ * kSelfAttTileK + qkv_seq_len;
+  mshadow::Tensor<cpu, 1, float> workspace = ctx.requested[0].get_space_typed<cpu, 1, float>(
+    mshadow::Shape1(omp_threads * thread_space), s);
+
+  // The gradients of keys and values accumulate over all the queries, so the
+  // work is split by attention batch only.
+  #pragma omp parallel for num_threads(omp_threads) schedule(dynamic)
+  for (index_t batch = 0; batch < attn_batches; ++batch) {
+    float* probs  = workspace.dptr_ + omp_get_thread_num() * thread_space;
+    float* dprobs = probs + kSelfAttTileQ * kSelfAttTileK;
+    float* delta  = dprobs + kSelfAttTileQ * kSelfAttTileK;
+    const float* queries  = queries_keys_values + batch * 3 * head_dim;
+    const float* keys     = queries + head_dim;
+    const float* values   = queries + 2 * head_dim;
+    float* queries_grads  = queries_keys_values_grads + batch * 3 * head_dim;
+    float* keys_grads     = queries_grads + head_dim;
+    float* values_grads   = queries_grads + 2 * head_dim;
+    const float* out_grads = output_grads + batch * head_dim;
+    const float* out       = output + batch * head_dim;
+    const float* lse       = logsumexp + batch * qkv_seq_len;
+    const index_t kv_end   = valid_length[batch / params.heads];
+
+    for (index_t i = 0; i < qkv_seq_len; ++i) {
+      float dot = 0.f;
+      for (index_t d = 0; d < head_dim; ++d) {
+        dot += out_grads[i * out_lead_dim + d] * out[i * out_lead_dim + d];
+      }
+      delta[i] = dot;
+    }
+    for (index_t kv_begin = 0; kv_begin < kv_end; kv_begin += kSelfAttTileK) {
+      const index_t kv_cols = std::min(kSelfAttTileK, kv_end - kv_begin);
+      // in causal attention the keys are only attended by the queries at or after them
+      for (index_t q_begin = params.causal ? kv_begin : 0; q_begin < qkv_seq_len;
+           q_begin += kSelfAttTileQ) {
+        const index_t q_rows = std::min(kSelfAttTileQ, qkv_seq_len - q_begin);
+        // attention weights recomputed from the saved log-sum-exp
+        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasTrans,
+                    q_rows, kv_cols, head_dim,
+                    scale, queries + q_begin * lead_dim, lead_dim,
+                    keys + kv_begin * lead_dim, lead_dim,
+                    0.f, probs, kSelfAttTileK);
+        for (index_t r = 0; r < q_rows; ++r) {
+          float* row = probs + r * kSelfAttTileK;
+          const index_t cols = params.causal ?
+                               std::min(kv_cols, q_begin + r + 1 - kv_begin) : kv_cols;
+          for (index_t c = 0; c < cols; ++c) row[c] = std::exp(row[c] - lse[q_begin + r]);
+          for (index_t c = std::max(cols, static_cast<index_t>(0)); c < kv_cols; ++c) {
+            row[c] = 0.f;
+          }
+        }
+        // values_grads += probs^T * output_grads
+        cblas_sgemm(CblasRowMajor, CblasTrans, CblasNoTrans,
+                    kv_cols, head_dim, q_rows,
+                    1.f, probs, kSelfAttTileK,
+                    out_grads + q_begin * out_lead_dim, out_lead_dim,
+                    1.f, values_grads + kv_begin * lead_dim, lead_dim);
+        // gradient of the attention weights
+        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasTrans,
+                    q_rows, kv_cols, head_dim,
+                    1.f, out_grads + q_begin * out_lead_dim, out_lead_dim,
+                    values + kv_begin * lead_dim, lead_dim,
+                    0.f, dprobs, kSelfAttTileK);
+        // gradient of the scores through the softmax
+        for (index_t r = 0; r < q_rows; ++r) {
+          for (index_t c = 0; c < kv_cols; ++c) {
+            const index_t idx = r * kSelfAttTileK + c;
+            dprobs[idx] = probs[idx] * (dprobs[idx] - delta[q_begin + r]);
+          }
+        }
+        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans,
+                    q_rows, head_dim, kv_cols,
+                    scale, dprobs, kSelfAttTileK,
+                    keys + kv_begin * lead_dim, lead_dim,
+                    1.f, queries_grads + q_begin * lead_dim, lead_dim);
+        cblas_sgemm(CblasRowMajor, CblasTrans, CblasNoTrans,
+                    kv_cols, head_dim, q_rows,
+                    scale, dprobs, kSelfAttTileK,
+                    queries + q_begin * lead_dim, lead_dim,
+                    1.f, keys_grads + kv_begin * lead_dim, lead_dim);
+      }
+    }
+  }
+}
+
 NNVM_REGISTER_OP(_contrib_interleaved_matmul_selfatt_qk)
 .describe(R"code(Compute the matrix multiplication between the projections of
 queries and keys in multihead attention use as self attention.
@@ -830,6 +1122,88 @@ NNVM_REGISTER_OP(_backward_interleaved_matmul_encdec_valatt)
 .set_attr_parser(ParamParser<InterleavedMatMulParam>)
 .set_attr<FCompute>("FCompute<cpu>", BackwardInterleavedMatMulEncDecValAttCPU);
 
+NNVM_REGISTER_OP(_contrib_interleaved_fused_selfatt)
+.describe(R"code(Compute multihead self attention in a single pass over the interleaved
+projections of queries, keys and values.
+
+the input must be a single tensor of interleaved projections
+of queries, keys and values following the layout:
+(seq_length, batch_size, num_heads * head_dim * 3)
+
+and the output follows the layout:
+(seq_length, batch_size, num_heads * head_dim)
+
+the equivalent code would be::
+
+    att = mx.nd.contrib.interleaved_matmul_selfatt_qk(queries_keys_values, heads=num_heads)
+    att = mx.nd.softmax(att, axis=-1)
+    output = mx.nd.contrib.interleaved_matmul_selfatt_valatt(queries_keys_values, att,
+                                                              heads=num_heads)
+
+where the attention scores of masked keys are ignored by the softmax. With ``causal``
+each position attends to itself and the previous positions only, with ``use_valid_length``
+the keys at positions beyond ``valid_length`` of their sequence are ignored.
+
+The scores are computed by tiles and normalized with an online softmax, the
+(batch_size * num_heads, seq_length, seq_length) attention weights are never stored.
+Only float32 on CPU is supported.
+
+)code" ADD_FILELINE)
+.set_num_inputs([](const NodeAttrs& attrs) {
+  const auto& params = nnvm::get<InterleavedFusedSelfAttParam>(attrs.parsed);
+  return params.use_valid_length ? 2U : 1U;
+})
+.set_num_outputs(2)
+.set_attr<nnvm::FNumVisibleOutputs>("FNumVisibleOutputs", [](const NodeAttrs& attrs) {
+  return 1;
+})
+.set_attr_parser(ParamParser<InterleavedFusedSelfAttParam>)
+.set_attr<nnvm::FListInputNames>("FListInputNames", [](const NodeAttrs& attrs) {
+  const auto& params = nnvm::get<InterleavedFusedSelfAttParam>(attrs.parsed);
+  return params.use_valid_length ?
+         std::vector<std::string>{"queries_keys_values", "valid_length"} :
+         std::vector<std::string>{"queries_keys_values"};
+})
+.set_attr<nnvm::FListOutputNames>("FListOutputNames", [](const NodeAttrs& attrs) {
+  return std::vector<std::string>{"output", "logsumexp"};
+})
+.set_attr<mxnet::FInferShape>("FInferShape", InterleavedFusedSelfAttShape)
+.set_attr<nnvm::FInferType>("FInferType", InterleavedFusedSelfAttType)
+.set_attr<FResourceRequest>("FResourceRequest", [](const NodeAttrs& attrs) {
+  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+})
+.set_attr<FCompute>("FCompute<cpu>", InterleavedFusedSelfAttCPU)
+.set_attr<nnvm::FGradient>("FGradient",
+  [](const nnvm::ObjectPtr& n, const std::vector<nnvm::NodeEntry>& ograds) {
+    // output gradient, inputs, output and log-sum-exp of the attention weights
+    std::vector<nnvm::NodeEntry> heads{ograds[0]};
+    heads.insert(heads.end(), n->inputs.begin(), n->inputs.end());
+    heads.emplace_back(n, 0, 0);
+    heads.emplace_back(n, 1, 0);
+    return MakeGradNode("_backward_interleaved_fused_selfatt", n, heads, n->attrs.dict);
+  })
+.add_argument("queries_keys_values", "NDArray-or-Symbol", "Interleaved queries, keys and values")
+.add_argument("valid_length", "NDArray-or-Symbol",
+              "Valid length of each sequence, used if use_valid_length is true")
+.add_arguments(InterleavedFusedSelfAttParam::__FIELDS__());
+
+NNVM_REGISTER_OP(_backward_interleaved_fused_selfatt)
+.set_num_inputs([](const NodeAttrs& attrs) {
+  const auto& params = nnvm::get<InterleavedFusedSelfAttParam>(attrs.parsed);
+  return params.use_valid_length ? 5U : 4U;
+})
+.set_num_outputs([](const NodeAttrs& attrs) {
+  const auto& params = nnvm::get<InterleavedFusedSelfAttParam>(attrs.parsed);
+  return params.use_valid_length ? 2U : 1U;
+})
+.set_attr<nnvm::TIsBackward>("TIsBackward", true)
+.set_attr_parser(ParamParser<InterleavedFusedSelfAttParam>)
+.set_attr<FResourceRequest>("FResourceRequest", [](const NodeAttrs& attrs) {
+  return std::vector<ResourceRequest>{ResourceRequest::kTempSpace};
+})
+.set_attr<FCompute>("FCompute<cpu>", BackwardInterleavedFusedSelfAttCPU);
+
+
 
 // relu
 MXNET_OPERATOR_REGISTER_UNARY(_contrib_div_sqrt_dim)
@@ -20,16 +20,17 @@
 #ifndef MXNET_OPERATOR_FUSION_FUSED_OP_INL_H_
 #define MXNET_OPERATOR_FUSION_FUSED_OP_INL_H_
 
+#include <nnvm/node.h>
 #include <string>
 #include <map>
 #include <vector>
 
-#if MXNET_USE_CUDA
-
 namespace mxnet {
 
 namespace fusion {
 
+#if MXNET_USE_CUDA
+
 const std::map<std::string, std::vector<std::vector<std::string>>> ops_desc = {
   {"elemwise_add"                      , {{"op::add(%, %)", "_0", "_1"}}},
   {"_plus"                             , {{"op::add(%, %)", "_0", "_1"}}},
@@ -230,10 +231,202 @@ const char kernel_end[] = R"code(}
 }
 )code";
 
+#endif  // MXNET_USE_CUDA
+
+// Pointwise functions of the CPU backend, see FusedOp::Forward<cpu>
+enum CPUOpcode {
+  // unary, "_0"
+  kCPUIdentity, kCPUZero, kCPUOne, kCPUNegative, kCPURelu, kCPUSigmoid, kCPUSoftsign,
+  kCPUSoftrelu, kCPUTanh, kCPUGelu, kCPUExp, kCPUExpm1, kCPULog, kCPULog10, kCPULog2,
+  kCPULog1p, kCPUDegrees, kCPURadians, kCPUSin, kCPUCos, kCPUTan, kCPUArcsin, kCPUArccos,
+  kCPUArctan, kCPUSinh, kCPUCosh, kCPUArcsinh, kCPUArccosh, kCPUArctanh, kCPUSqrt,
+  kCPURsqrt, kCPUCbrt, kCPURcbrt, kCPUSquare, kCPURound, kCPURint, kCPUFix, kCPUFloor,
+  kCPUCeil, kCPUTrunc, kCPUSign, kCPUReciprocal, kCPUAbs, kCPUGamma, kCPUGammaln,
+  kCPUErf, kCPUErfinv, kCPULogicalNot,
+  // binary, "_0" and "_1"
+  kCPUAdd, kCPUSub, kCPUMul, kCPUDiv, kCPUPower, kCPUMaximum, kCPUMinimum, kCPUMod,
+  kCPUHypot,
+  // gradient "_0" times the derivative at "_1"
+  kCPUBackwardRelu, kCPUBackwardSigmoid, kCPUBackwardTanh, kCPUBackwardSqrt,
+  kCPUBackwardSquare, kCPUBackwardLog, kCPUBackwardExpm1, kCPUBackwardSin,
+  kCPUBackwardCos, kCPUBackwardAbs,
+  // "_0" and a scalar attribute
+  kCPUAddScalar, kCPUSubScalar, kCPURSubScalar, kCPUMulScalar, kCPUDivScalar,
+  kCPURDivScalar, kCPUPowerScalar, kCPURPowerScalar, kCPUModScalar, kCPURModScalar,
+  kCPUHypotScalar, kCPUSmoothL1,
+  // "_0" and two scalar attributes
+  kCPUClip
+};
+
+/*!
+ * \brief Description of an output of an operator for the CPU backend:
+ *  the function and its arguments, either inputs of the operator ("_0", "_1", ...)
+ *  or names of scalar attributes.
+ */
+struct CPUOpDesc {
+  CPUOpcode opcode;
+  std::vector<std::string> args;
+};
+
+/*!
+ * \brief Operators supported by the CPU backend, one description per output.
+ *  Casts are identities, the result of every operator is rounded to its type.
+ *  An empty list of arguments stands for all the inputs of the operator.
+ */
+const std::map<std::string, std::vector<CPUOpDesc>> cpu_ops_desc = {
+  {"add_n"                             , {{kCPUAdd, {}}}},
+  {"elemwise_add"                      , {{kCPUAdd, {"_0", "_1"}}}},
+  {"_plus"                             , {{kCPUAdd, {"_0", "_1"}}}},
+  {"_Plus"                             , {{kCPUAdd, {"_0", "_1"}}}},
+  {"_add"                              , {{kCPUAdd, {"_0", "_1"}}}},
+  {"elemwise_sub"                      , {{kCPUSub, {"_0", "_1"}}}},
+  {"_minus"                            , {{kCPUSub, {"_0", "_1"}}}},
+  {"_Minus"                            , {{kCPUSub, {"_0", "_1"}}}},
+  {"_sub"                              , {{kCPUSub, {"_0", "_1"}}}},
+  {"elemwise_mul"                      , {{kCPUMul, {"_0", "_1"}}}},
+  {"_mul"                              , {{kCPUMul, {"_0", "_1"}}}},
+  {"_Mul"                              , {{kCPUMul, {"_0", "_1"}}}},
+  {"elemwise_div"                      , {{kCPUDiv, {"_0", "_1"}}}},
+  {"_div"                              , {{kCPUDiv, {"_0", "_1"}}}},
+  {"_Div"                              , {{kCPUDiv, {"_0", "_1"}}}},
+  {"_Power"                            , {{kCPUPower, {"_0", "_1"}}}},
+  {"_power"                            , {{kCPUPower, {"_0", "_1"}}}},
+  {"_Maximum"                          , {{kCPUMaximum, {"_0", "_1"}}}},
+  {"_maximum"                          , {{kCPUMaximum, {"_0", "_1"}}}},
+  {"_Minimum"                          , {{kCPUMinimum, {"_0", "_1"}}}},
+  {"_minimum"                          , {{kCPUMinimum, {"_0", "_1"}}}},
+  {"_mod"                              , {{kCPUMod, {"_0", "_1"}}}},
+  {"_hypot"                            , {{kCPUHypot, {"_0", "_1"}}}},
+  {"amp_cast"                          , {{kCPUIdentity, {"_0"}}}},
+  {"_backward_amp_cast"                , {{kCPUIdentity, {"_0"}}}},
+  {"Cast"                              , {{kCPUIdentity, {"_0"}}}},
+  {"cast"                              , {{kCPUIdentity, {"_0"}}}},
+  {"_copy"                             , {{kCPUIdentity, {"_0"}}}},
+  {"_identity_with_attr_like_rhs"      , {{kCPUIdentity, {"_0"}}}},
+  {"squeeze"                           , {{kCPUIdentity, {"_0"}}}},
+  {"flatten"                           , {{kCPUIdentity, {"_0"}}}},
+  {"Reshape"                           , {{kCPUIdentity, {"_0"}}}},
+  {"reshape"                           , {{kCPUIdentity, {"_0"}}}},
+  {"_backward_reshape"                 , {{kCPUIdentity, {"_0"}}}},
+  {"expand_dims"                       , {{kCPUIdentity, {"_0"}}}},
+  {"zeros_like"                        , {{kCPUZero, {"_0"}}}},
+  {"ones_like"                         , {{kCPUOne, {"_0"}}}},
+  {"negative"                          , {{kCPUNegative, {"_0"}}}},
+  {"relu"                              , {{kCPURelu, {"_0"}}}},
+  {"sigmoid"                           , {{kCPUSigmoid, {"_0"}}}},
+  {"softsign"                          , {{kCPUSoftsign, {"_0"}}}},
+  {"tanh"                              , {{kCPUTanh, {"_0"}}}},
+  {"exp"                               , {{kCPUExp, {"_0"}}}},
+  {"expm1"                             , {{kCPUExpm1, {"_0"}}}},
+  {"log"                               , {{kCPULog, {"_0"}}}},
+  {"log10"                             , {{kCPULog10, {"_0"}}}},
+  {"log2"                              , {{kCPULog2, {"_0"}}}},
+  {"log1p"                             , {{kCPULog1p, {"_0"}}}},
+  {"degrees"                           , {{kCPUDegrees, {"_0"}}}},
+  {"radians"                           , {{kCPURadians, {"_0"}}}},
+  {"sin"                               , {{kCPUSin, {"_0"}}}},
+  {"cos"                               , {{kCPUCos, {"_0"}}}},
+  {"tan"                               , {{kCPUTan, {"_0"}}}},
+  {"arcsin"                            , {{kCPUArcsin, {"_0"}}}},
+  {"arccos"                            , {{kCPUArccos, {"_0"}}}},
+  {"arctan"                            , {{kCPUArctan, {"_0"}}}},
+  {"sinh"                              , {{kCPUSinh, {"_0"}}}},
+  {"cosh"                              , {{kCPUCosh, {"_0"}}}},
+  {"arcsinh"                           , {{kCPUArcsinh, {"_0"}}}},
+  {"arccosh"                           , {{kCPUArccosh, {"_0"}}}},
+  {"arctanh"                           , {{kCPUArctanh, {"_0"}}}},
+  {"sqrt"                              , {{kCPUSqrt, {"_0"}}}},
+  {"rsqrt"                             , {{kCPURsqrt, {"_0"}}}},
+  {"cbrt"                              , {{kCPUCbrt, {"_0"}}}},
+  {"rcbrt"                             , {{kCPURcbrt, {"_0"}}}},
+  {"square"                            , {{kCPUSquare, {"_0"}}}},
+  {"round"                             , {{kCPURound, {"_0"}}}},
+  {"rint"                              , {{kCPURint, {"_0"}}}},
+  {"fix"                               , {{kCPUFix, {"_0"}}}},
+  {"floor"                             , {{kCPUFloor, {"_0"}}}},
+  {"ceil"                              , {{kCPUCeil, {"_0"}}}},
+  {"trunc"                             , {{kCPUTrunc, {"_0"}}}},
+  {"sign"                              , {{kCPUSign, {"_0"}}}},
+  {"reciprocal"                        , {{kCPUReciprocal, {"_0"}}}},
+  {"abs"                               , {{kCPUAbs, {"_0"}}}},
+  {"gamma"                             , {{kCPUGamma, {"_0"}}}},
+  {"gammaln"                           , {{kCPUGammaln, {"_0"}}}},
+  {"erf"                               , {{kCPUErf, {"_0"}}}},
+  {"erfinv"                            , {{kCPUErfinv, {"_0"}}}},
+  {"logical_not"                       , {{kCPULogicalNot, {"_0"}}}},
+  {"_plus_scalar"                      , {{kCPUAddScalar, {"_0", "scalar"}}}},
+  {"_PlusScalar"                       , {{kCPUAddScalar, {"_0", "scalar"}}}},
+  {"_minus_scalar"                     , {{kCPUSubScalar, {"_0", "scalar"}}}},
+  {"_MinusScalar"                      , {{kCPUSubScalar, {"_0", "scalar"}}}},
+  {"_rminus_scalar"                    , {{kCPURSubScalar, {"_0", "scalar"}}}},
+  {"_RMinusScalar"                     , {{kCPURSubScalar, {"_0", "scalar"}}}},
+  {"_mul_scalar"                       , {{kCPUMulScalar, {"_0", "scalar"}}}},
+  {"_MulScalar"                        , {{kCPUMulScalar, {"_0", "scalar"}}}},
+  {"_div_scalar"                       , {{kCPUDivScalar, {"_0", "scalar"}}}},
+  {"_DivScalar"                        , {{kCPUDivScalar, {"_0", "scalar"}}}},
+  {"_rdiv_scalar"                      , {{kCPURDivScalar, {"_0", "scalar"}}}},
+  {"_RDivScalar"                       , {{kCPURDivScalar, {"_0", "scalar"}}}},
+  {"_power_scalar"                     , {{kCPUPowerScalar, {"_0", "scalar"}}}},
+  {"_PowerScalar"                      , {{kCPUPowerScalar, {"_0", "scalar"}}}},
+  {"_rpower_scalar"                    , {{kCPURPowerScalar, {"_0", "scalar"}}}},
+  {"_RPowerScalar"                     , {{kCPURPowerScalar, {"_0", "scalar"}}}},
+  {"_mod_scalar"                       , {{kCPUModScalar, {"_0", "scalar"}}}},
+  {"_rmod_scalar"                      , {{kCPURModScalar, {"_0", "scalar"}}}},
+  {"_hypot_scalar"                     , {{kCPUHypotScalar, {"_0", "scalar"}}}},
+  {"smooth_l1"                         , {{kCPUSmoothL1, {"_0", "scalar"}}}},
+  {"clip"                              , {{kCPUClip, {"_0", "a_min", "a_max"}}}},
+  {"_backward_relu"                    , {{kCPUBackwardRelu, {"_0", "_1"}}}},
+  {"_backward_sigmoid"                 , {{kCPUBackwardSigmoid, {"_0", "_1"}}}},
+  {"_backward_tanh"                    , {{kCPUBackwardTanh, {"_0", "_1"}}}},
+  {"_backward_sqrt"                    , {{kCPUBackwardSqrt, {"_0", "_1"}}}},
+  {"_backward_square"                  , {{kCPUBackwardSquare, {"_0", "_1"}}}},
+  {"_backward_log"                     , {{kCPUBackwardLog, {"_0", "_1"}}}},
+  {"_backward_expm1"                   , {{kCPUBackwardExpm1, {"_0", "_1"}}}},
+  {"_backward_sin"                     , {{kCPUBackwardSin, {"_0", "_1"}}}},
+  {"_backward_cos"                     , {{kCPUBackwardCos, {"_0", "_1"}}}},
+  {"_backward_abs"                     , {{kCPUBackwardAbs, {"_0", "_1"}}}},
+  {"_backward_mul_scalar"              , {{kCPUMulScalar, {"_0", "scalar"}}}},
+  {"_backward_div_scalar"              , {{kCPUDivScalar, {"_0", "scalar"}}}},
+  {"_backward_sub"                     , {{kCPUIdentity, {"_0"}},
+                                          {kCPUNegative, {"_0"}}}},
+  {"_backward_mul"                     , {{kCPUMul, {"_0", "_2"}},
+                                          {kCPUMul, {"_0", "_1"}}}}
+};
+
+// Activation ops of the CPU backend: based on "act_type" attribute
+const std::map<std::string, std::vector<CPUOpDesc>> cpu_activation_ops = {
+  {"relu"                              , {{kCPURelu, {"_0"}}}},
+  {"sigmoid"                           , {{kCPUSigmoid, {"_0"}}}},
+  {"tanh"                              , {{kCPUTanh, {"_0"}}}},
+  {"softrelu"                          , {{kCPUSoftrelu, {"_0"}}}},
+  {"softsign"                          , {{kCPUSoftsign, {"_0"}}}}
+};
+
+// LeakyReLU ops of the CPU backend: based on "act_type" attribute
+const std::map<std::string, std::vector<CPUOpDesc>> cpu_LeakyReLU_ops = {
+  {"gelu"                              , {{kCPUGelu, {"_0"}}}}
+};
+
+/*!
+ * \brief Description of the outputs of an operator for the CPU backend.
+ * \return nullptr if the CPU backend does not support the operator.
+ */
+inline const std::vector<CPUOpDesc>* FindCPUOpDesc(const nnvm::NodeAttrs& attrs) {
+  if (attrs.op == nullptr) return nullptr;
+  const std::map<std::string, std::vector<CPUOpDesc>>* table = &cpu_ops_desc;
+  std::string key = attrs.op->name;
+  if (key == "Activation" || key == "LeakyReLU") {
+    table = key == "Activation" ? &cpu_activation_ops : &cpu_LeakyReLU_ops;
+    const auto act_type = attrs.dict.find("act_type");
+    if (act_type == attrs.dict.end()) return nullptr;
+    key = act_type->second;
+  }
+  const auto it = table->find(key);
+  return it == table->end() ? nullptr : &it->second;
+}
+
 }  // namespace fusion
 
 }  // namespace mxnet
 
-#endif  // MXNET_USE_CUDA
-
 #endif  // MXNET_OPERATOR_FUSION_FUSED_OP_INL_H_
@@ -17,14 +17,19 @@
  * under the License.
  */
 
+#include <algorithm>
+#include <string>
 #include <tuple>
+#include <vector>
 
 #include "./fused_op.h"
+#include "./fused_op-inl.h"
+#include "../mshadow_op.h"
+#include "../mxnet_op.h"
 #include "../operator_common.h"
+#include "../../common/utils.h"
 #include "../../imperative/exec_pass.h"
 
-#if MXNET_USE_CUDA
-
 namespace mxnet {
 
 DMLC_REGISTER_PARAMETER(FusedOpConfig);
@@ -50,8 +55,13 @@ void FusedOpParamParser(nnvm::NodeAttrs* attrs) {
 }
 
 FusedOp::FusedOp(const nnvm::NodeAttrs* attrs, const FusedOpConfig& config) :
+#if MXNET_USE_CUDA
+    kernel_function_dev_id_(-1),
+#endif  // MXNET_USE_CUDA
     initialized_(false),
-    kernel_function_dev_id_(-1) {
+    cpu_num_slots_(0),
+    cpu_use_double_(false),
+    cpu_unfused_(false) {
   inputs_ = std::vector<FusedOpEntry>(config.num_inputs);
   outputs_ = std::vector<FusedOpEntry>(config.num_outputs);
   subgraph_ = nnvm::Graph();
@@ -177,6 +187,486 @@ FusedOp::GetAttrs(const std::string& attr_name, const uint32_t node_id) {
                          outputs);
 }
 
+void FusedOp::SelectIntermediateAttrs(const std::vector<mxnet::TShape> &in_shapes,
+                                      const std::vector<mxnet::TShape> &out_shapes,
+                                      const std::vector<int> &in_dtypes,
+                                      const std::vector<int> &out_dtypes) {
+  for (auto it = intermediate_shapes_.begin();
+       it != intermediate_shapes_.end();
+       ++it) {
+    if (it->input_attr == in_shapes && it->output_attr == out_shapes) {
+      intermediate_shapes_.erase(intermediate_shapes_.begin(), it);
+      break;
+    }
+  }
+  for (auto it = intermediate_dtypes_.begin();
+       it != intermediate_dtypes_.end();
+       ++it) {
+    if (it->input_attr == in_dtypes && it->output_attr == out_dtypes) {
+      intermediate_dtypes_.erase(intermediate_dtypes_.begin(), it);
+      break;
+    }
+  }
+}
+
+namespace {
+
+inline bool IsFloatingType(const int dtype) {
+  return dtype == mshadow::kFloat16 || dtype == mshadow::kFloat32 ||
+         dtype == mshadow::kFloat64;
+}
+
+}  // namespace
+
+bool FusedOp::GenerateCPUProgram(const std::vector<int> &node_dtypes,
+                                 const mxnet::ShapeVector &node_shapes) {
+  using fusion::CPUOpDesc;
+  const auto& g = subgraph_.indexed_graph();
+  const auto& input_nids = g.input_nodes();
+  cpu_program_.clear();
+  cpu_input_slots_.assign(input_nids.size(), -1);
+  cpu_output_slots_.clear();
+  cpu_num_slots_ = 0;
+  cpu_use_double_ = false;
+
+  // All the entries need the same number of elements and a floating point type,
+  // the interpreter would not reproduce the semantics of integer operators.
+  const size_t size = node_shapes[g.entry_id(g.outputs()[0])].Size();
+  for (size_t eid = 0; eid < g.num_node_entries(); ++eid) {
+    if (!IsFloatingType(node_dtypes[eid]) || node_shapes[eid].Size() != size) return false;
+    cpu_use_double_ = cpu_use_double_ || node_dtypes[eid] == mshadow::kFloat64;
+  }
+  std::vector<const std::vector<CPUOpDesc>*> descs(g.num_nodes(), nullptr);
+  for (size_t nid = 0; nid < g.num_nodes(); ++nid) {
+    const auto& node = g[nid];
+    if (node.source->is_variable()) continue;
+    descs[nid] = fusion::FindCPUOpDesc(node.source->attrs);
+    if (descs[nid] == nullptr || descs[nid]->size() < node.source->num_outputs()) return false;
+  }
+
+  // Remaining uses of every entry, the outputs of the subgraph are never released
+  const uint64_t kPinned = uint64_t(1) << 32;
+  std::vector<uint64_t> entry_uses(g.num_node_entries(), 0);
+  auto arg_entry = [&g](const nnvm::IndexedGraph::Node& node, const std::string& arg) {
+    return g.entry_id(node.inputs[std::stoi(arg.substr(1))]);
+  };
+  for (size_t nid = 0; nid < g.num_nodes(); ++nid) {
+    if (descs[nid] == nullptr) continue;
+    const auto& node = g[nid];
+    for (const auto& desc : *descs[nid]) {
+      if (desc.args.empty()) {
+        for (const auto& e : node.inputs) ++entry_uses[g.entry_id(e)];
+      }
+      for (const auto& arg : desc.args) {
+        if (arg[0] == '_') ++entry_uses[arg_entry(node, arg)];
+      }
+    }
+  }
+  for (const auto& e : g.outputs()) entry_uses[g.entry_id(e)] += kPinned;
+
+  // Slots are reused once all the uses of the entries they hold are done
+  std::vector<int> entry_slots(g.num_node_entries(), -1);
+  std::vector<uint64_t> slot_uses;
+  std::vector<int> free_slots;
+  auto acquire_slot = [&](uint32_t eid) {
+    int slot;
+    if (free_slots.empty()) {
+      slot = cpu_num_slots_++;
+      slot_uses.push_back(0);
+    } else {
+      slot = free_slots.back();
+      free_slots.pop_back();
+    }
+    slot_uses[slot] = entry_uses[eid];
+    entry_slots[eid] = slot;
+    return slot;
+  };
+  auto release_use = [&](uint32_t eid) {
+    const int slot = entry_slots[eid];
+    if (--slot_uses[slot] == 0) free_slots.push_back(slot);
+  };
+  // Type to round a result to, when narrower than the compute type
+  auto round_dtype = [this](int dtype) {
+    return dtype == mshadow::kFloat16 || (cpu_use_double_ && dtype == mshadow::kFloat32) ?
+           dtype : -1;
+  };
+
+  for (size_t i = 0; i < input_nids.size(); ++i) {
+    const uint32_t eid = g.entry_id(input_nids[i], 0);
+    if (entry_uses[eid] > 0) cpu_input_slots_[i] = acquire_slot(eid);
+  }
+  for (size_t nid = 0; nid < g.num_nodes(); ++nid) {
+    if (descs[nid] == nullptr) continue;
+    const auto& node = g[nid];
+    const auto& dict = node.source->attrs.dict;
+    std::vector<uint32_t> used;
+    for (uint32_t k = 0; k < node.source->num_outputs(); ++k) {
+      const uint32_t eid = g.entry_id(nid, k);
+      const CPUOpDesc& desc = (*descs[nid])[k];
+      if (desc.args.empty()) {
+        for (const auto& e : node.inputs) used.push_back(g.entry_id(e));
+      }
+      for (const auto& arg : desc.args) {
+        if (arg[0] == '_') used.push_back(arg_entry(node, arg));
+      }
+      // Unused results are not computed
+      if (entry_uses[eid] == 0) continue;
+      CPUInstr instr = {desc.opcode, -1, {-1, -1}, {1, 1}, round_dtype(node_dtypes[eid])};
+      if (desc.args.empty()) {
+        // Sum of all the inputs, rounded after every addition like the operator
+        instr.in_slots[0] = entry_slots[g.entry_id(node.inputs[0])];
+        instr.opcode = fusion::kCPUIdentity;
+        instr.out_slot = acquire_slot(eid);
+        cpu_program_.push_back(instr);
+        for (size_t j = 1; j < node.inputs.size(); ++j) {
+          instr.opcode = fusion::kCPUAdd;
+          instr.in_slots[0] = instr.out_slot;
+          instr.in_slots[1] = entry_slots[g.entry_id(node.inputs[j])];
+          cpu_program_.push_back(instr);
+        }
+        continue;
+      }
+      int num_slots = 0, num_scalars = 0;
+      for (const auto& arg : desc.args) {
+        if (arg[0] == '_') {
+          instr.in_slots[num_slots++] = entry_slots[arg_entry(node, arg)];
+        } else {
+          const auto it = dict.find(arg);
+          if (it != dict.end()) instr.scalars[num_scalars] = std::stod(it->second);
+          ++num_scalars;
+        }
+      }
+      if (instr.opcode == fusion::kCPUIdentity) {
+        // Values of the argument are exact in a type at least as wide
+        const int in_dtype = node_dtypes[arg_entry(node, desc.args[0])];
+        if (in_dtype == node_dtypes[eid] || in_dtype == mshadow::kFloat16) {
+          instr.round_dtype = -1;
+        }
+      }
+      if (instr.opcode == fusion::kCPUIdentity && instr.round_dtype == -1) {
+        // No computation needed, the result shares the slot of the argument
+        entry_slots[eid] = instr.in_slots[0];
+        slot_uses[instr.in_slots[0]] += entry_uses[eid];
+        continue;
+      }
+      // The arguments are released only after all the outputs of the node
+      // got their slot, the results of a node never overwrite its arguments
+      instr.out_slot = acquire_slot(eid);
+      cpu_program_.push_back(instr);
+    }
+    for (const uint32_t eid : used) release_use(eid);
+  }
+  for (const auto& e : g.outputs()) cpu_output_slots_.push_back(entry_slots[g.entry_id(e)]);
+  return true;
+}
+
+namespace {
+
+template <typename OP, typename CType>
+inline void CPUUnary(CType *out, const CType *in, const index_t n) {
+  for (index_t i = 0; i < n; ++i) out[i] = OP::Map(in[i]);
+}
+
+template <typename OP, typename CType>
+inline void CPUBinary(CType *out, const CType *lhs, const CType *rhs, const index_t n) {
+  for (index_t i = 0; i < n; ++i) out[i] = OP::Map(lhs[i], rhs[i]);
+}
+
+template <typename GRAD, typename CType>
+inline void CPUBackward(CType *out, const CType *ograd, const CType *in, const index_t n) {
+  for (index_t i = 0; i < n; ++i) out[i] = ograd[i] * GRAD::Map(in[i]);
+}
+
+template <typename OP, typename CType>
+inline void CPUScalar(CType *out, const CType *in, const double scalar, const index_t n) {
+  const CType b = static_cast<CType>(scalar);
+  for (index_t i = 0; i < n; ++i) out[i] = OP::Map(in[i], b);
+}
+
+template <typename CType>
+inline void CPUFill(CType *out, const CType value, const index_t n) {
+  for (index_t i = 0; i < n; ++i) out[i] = value;
+}
+
+template <typename CType>
+inline void CPURound(CType *out, const int dtype, const index_t n) {
+  if (dtype == mshadow::kFloat16) {
+    for (index_t i = 0; i < n; ++i) {
+      out[i] = static_cast<CType>(static_cast<float>(mshadow::half::half_t(out[i])));
+    }
+  } else {
+    for (index_t i = 0; i < n; ++i) out[i] = static_cast<CType>(static_cast<float>(out[i]));
+  }
+}
+
+template <typename CType, typename DType>
+inline void CPULoad(CType *out, const DType *in, const index_t n) {
+  for (index_t i = 0; i < n; ++i) out[i] = static_cast<CType>(in[i]);
+}
+
+template <typename CType, typename DType>
+inline void CPUStore(DType *out, const CType *in, const OpReqType req, const index_t n) {
+  if (req == kAddTo) {
+    for (index_t i = 0; i < n; ++i) out[i] += static_cast<DType>(in[i]);
+  } else if (req != kNullOp) {
+    for (index_t i = 0; i < n; ++i) out[i] = static_cast<DType>(in[i]);
+  }
+}
+
+}  // namespace
+
+template <typename CType>
+void FusedOp::RunCPUProgram(const OpContext &ctx,
+                            const std::vector<TBlob> &inputs,
+                            const std::vector<OpReqType> &req,
+                            const std::vector<TBlob> &outputs) {
+  using namespace fusion;
+  const index_t N = outputs[0].Size();
+  if (N == 0) return;
+  const index_t num_blocks = (N + CPU_BLOCK - 1) / CPU_BLOCK;
+  const int omp_threads = std::min<index_t>(
+      engine::OpenMP::Get()->GetRecommendedOMPThreadCount(), num_blocks);
+  #pragma omp parallel num_threads(omp_threads)
+  {
+    std::vector<CType> buffer(static_cast<size_t>(cpu_num_slots_) * CPU_BLOCK);
+    auto slot = [&buffer](int s) { return buffer.data() + static_cast<size_t>(s) * CPU_BLOCK; };
+    #pragma omp for schedule(static)
+    for (index_t block = 0; block < num_blocks; ++block) {
+      const index_t offset = block * CPU_BLOCK;
+      const index_t n = std::min<index_t>(CPU_BLOCK, N - offset);
+      for (size_t i = 0; i < inputs.size(); ++i) {
+        if (cpu_input_slots_[i] < 0) continue;
+        MSHADOW_REAL_TYPE_SWITCH(inputs[i].type_flag_, DType, {
+          CPULoad(slot(cpu_input_slots_[i]), inputs[i].dptr<DType>() + offset, n);
+        });
+      }
+      for (const CPUInstr& instr : cpu_program_) {
+        CType *out = slot(instr.out_slot);
+        const CType *a = instr.in_slots[0] < 0 ? nullptr : slot(instr.in_slots[0]);
+        const CType *b = instr.in_slots[1] < 0 ? nullptr : slot(instr.in_slots[1]);
+        switch (instr.opcode) {
+#define MXNET_FUSED_CPU_UNARY(code, OP) \
+          case code: CPUUnary<mshadow_op::OP>(out, a, n); break;
+#define MXNET_FUSED_CPU_BINARY(code, OP) \
+          case code: CPUBinary<mshadow_op::OP>(out, a, b, n); break;
+#define MXNET_FUSED_CPU_BACKWARD(code, GRAD) \
+          case code: CPUBackward<mshadow_op::GRAD>(out, a, b, n); break;
+#define MXNET_FUSED_CPU_SCALAR(code, OP) \
+          case code: CPUScalar<mshadow_op::OP>(out, a, instr.scalars[0], n); break;
+          MXNET_FUSED_CPU_UNARY(kCPUIdentity, identity)
+          MXNET_FUSED_CPU_UNARY(kCPUNegative, negation)
+          MXNET_FUSED_CPU_UNARY(kCPURelu, relu)
+          MXNET_FUSED_CPU_UNARY(kCPUSigmoid, sigmoid)
+          MXNET_FUSED_CPU_UNARY(kCPUSoftsign, softsign)
+          MXNET_FUSED_CPU_UNARY(kCPUSoftrelu, softrelu)
+          MXNET_FUSED_CPU_UNARY(kCPUTanh, tanh)
+          MXNET_FUSED_CPU_UNARY(kCPUGelu, gelu)
+          MXNET_FUSED_CPU_UNARY(kCPUExp, exp)
+          MXNET_FUSED_CPU_UNARY(kCPUExpm1, expm1)
+          MXNET_FUSED_CPU_UNARY(kCPULog, log)
+          MXNET_FUSED_CPU_UNARY(kCPULog10, log10)
+          MXNET_FUSED_CPU_UNARY(kCPULog2, log2)
+          MXNET_FUSED_CPU_UNARY(kCPULog1p, log1p)
+          MXNET_FUSED_CPU_UNARY(kCPUDegrees, degrees)
+          MXNET_FUSED_CPU_UNARY(kCPURadians, radians)
+          MXNET_FUSED_CPU_UNARY(kCPUSin, sin)
+          MXNET_FUSED_CPU_UNARY(kCPUCos, cos)
+          MXNET_FUSED_CPU_UNARY(kCPUTan, tan)
+          MXNET_FUSED_CPU_UNARY(kCPUArcsin, arcsin)
+          MXNET_FUSED_CPU_UNARY(kCPUArccos, arccos)
+          MXNET_FUSED_CPU_UNARY(kCPUArctan, arctan)
+          MXNET_FUSED_CPU_UNARY(kCPUSinh, sinh)
+          MXNET_FUSED_CPU_UNARY(kCPUCosh, cosh)
+          MXNET_FUSED_CPU_UNARY(kCPUArcsinh, arcsinh)
+          MXNET_FUSED_CPU_UNARY(kCPUArccosh, arccosh)
+          MXNET_FUSED_CPU_UNARY(kCPUArctanh, arctanh)
+          MXNET_FUSED_CPU_UNARY(kCPUSqrt, square_root)
+          MXNET_FUSED_CPU_UNARY(kCPURsqrt, reciprocal_square_root)
+          MXNET_FUSED_CPU_UNARY(kCPUCbrt, cube_root)
+          MXNET_FUSED_CPU_UNARY(kCPURcbrt, reciprocal_cube_root)
+          MXNET_FUSED_CPU_UNARY(kCPUSquare, square)
+          MXNET_FUSED_CPU_UNARY(kCPURound, round)
+          MXNET_FUSED_CPU_UNARY(kCPURint, rint)
+          MXNET_FUSED_CPU_UNARY(kCPUFix, fix)
+          MXNET_FUSED_CPU_UNARY(kCPUFloor, floor)
+          MXNET_FUSED_CPU_UNARY(kCPUCeil, ceil)
+          MXNET_FUSED_CPU_UNARY(kCPUTrunc, trunc)
+          MXNET_FUSED_CPU_UNARY(kCPUSign, sign)
+          MXNET_FUSED_CPU_UNARY(kCPUReciprocal, reciprocal)
+          MXNET_FUSED_CPU_UNARY(kCPUAbs, abs)
+          MXNET_FUSED_CPU_UNARY(kCPUGamma, gamma)
+          MXNET_FUSED_CPU_UNARY(kCPUGammaln, gammaln)
+          MXNET_FUSED_CPU_UNARY(kCPUErf, erf)
+          MXNET_FUSED_CPU_UNARY(kCPUErfinv, erfinv)
+          MXNET_FUSED_CPU_UNARY(kCPULogicalNot, nt)
+          MXNET_FUSED_CPU_BINARY(kCPUAdd, plus)
+          MXNET_FUSED_CPU_BINARY(kCPUSub, minus)
+          MXNET_FUSED_CPU_BINARY(kCPUMul, mul)
+          MXNET_FUSED_CPU_BINARY(kCPUDiv, div)
+          MXNET_FUSED_CPU_BINARY(kCPUPower, power)
+          MXNET_FUSED_CPU_BINARY(kCPUMaximum, maximum)
+          MXNET_FUSED_CPU_BINARY(kCPUMinimum, minimum)
+          MXNET_FUSED_CPU_BINARY(kCPUMod, mod)
+          MXNET_FUSED_CPU_BINARY(kCPUHypot, hypot)
+          MXNET_FUSED_CPU_BACKWARD(kCPUBackwardRelu, relu_grad)
+          MXNET_FUSED_CPU_BACKWARD(kCPUBackwardSigmoid, sigmoid_grad)
+          MXNET_FUSED_CPU_BACKWARD(kCPUBackwardTanh, tanh_grad)
+          MXNET_FUSED_CPU_BACKWARD(kCPUBackwardSqrt, square_root_grad)
+          MXNET_FUSED_CPU_BACKWARD(kCPUBackwardSquare, square_grad)
+          MXNET_FUSED_CPU_BACKWARD(kCPUBackwardLog, log_grad)
+          MXNET_FUSED_CPU_BACKWARD(kCPUBackwardExpm1, exp)
+          MXNET_FUSED_CPU_BACKWARD(kCPUBackwardSin, sin_grad)
+          MXNET_FUSED_CPU_BACKWARD(kCPUBackwardCos, cos_grad)
+          MXNET_FUSED_CPU_BACKWARD(kCPUBackwardAbs, sign)
+          MXNET_FUSED_CPU_SCALAR(kCPUAddScalar, plus)
+          MXNET_FUSED_CPU_SCALAR(kCPUSubScalar, minus)
+          MXNET_FUSED_CPU_SCALAR(kCPURSubScalar, rminus)
+          MXNET_FUSED_CPU_SCALAR(kCPUMulScalar, mul)
+          MXNET_FUSED_CPU_SCALAR(kCPUDivScalar, div)
+          MXNET_FUSED_CPU_SCALAR(kCPURDivScalar, rdiv)
+          MXNET_FUSED_CPU_SCALAR(kCPUPowerScalar, power)
+          MXNET_FUSED_CPU_SCALAR(kCPURPowerScalar, rpower)
+          MXNET_FUSED_CPU_SCALAR(kCPUModScalar, mod)
+          MXNET_FUSED_CPU_SCALAR(kCPURModScalar, rmod)
+          MXNET_FUSED_CPU_SCALAR(kCPUHypotScalar, hypot)
+          MXNET_FUSED_CPU_SCALAR(kCPUSmoothL1, smooth_l1_loss)
+#undef MXNET_FUSED_CPU_UNARY
+#undef MXNET_FUSED_CPU_BINARY
+#undef MXNET_FUSED_CPU_BACKWARD
+#undef MXNET_FUSED_CPU_SCALAR
+          case kCPUZero:
+            CPUFill(out, CType(0), n);
+            break;
+          case kCPUOne:
+            CPUFill(out, CType(1), n);
+            break;
+          case kCPUClip: {
+            const CType lower = static_cast<CType>(instr.scalars[0]);
+            const CType upper = static_cast<CType>(instr.scalars[1]);
+            for (index_t i = 0; i < n; ++i) out[i] = mshadow_op::clip::Map(a[i], lower, upper);
+            break;
+          }
+          default:
+            LOG(FATAL) << "Unknown opcode " << instr.opcode << " of fused op";
+        }
+        if (instr.round_dtype != -1) CPURound(out, instr.round_dtype, n);
+      }
+      // All the inputs of the block are loaded before any output is stored,
+      // so outputs may share memory with inputs.
+      for (size_t i = 0; i < outputs.size(); ++i) {
+        MSHADOW_REAL_TYPE_SWITCH(outputs[i].type_flag_, DType, {
+          CPUStore(outputs[i].dptr<DType>() + offset, slot(cpu_output_slots_[i]), req[i], n);
+        });
+      }
+    }
+  }
+}
+
+void FusedOp::RunCPUUnfused(const OpContext &ctx,
+                            const std::vector<TBlob> &inputs,
+                            const std::vector<OpReqType> &req,
+                            const std::vector<TBlob> &outputs,
+                            const std::vector<int> &node_dtypes,
+                            const mxnet::ShapeVector &node_shapes) {
+  using namespace mxnet_op;
+  static auto& fcompute_cpu = nnvm::Op::GetAttr<FCompute>("FCompute<cpu>");
+  const auto& g = subgraph_.indexed_graph();
+  const auto& input_nids = g.input_nodes();
+  // Results are kept in buffers of the op and copied to the outputs at the end,
+  // as outputs may share memory with inputs still needed by later nodes.
+  std::vector<TBlob> entries(g.num_node_entries());
+  cpu_unfused_buffers_.resize(g.num_node_entries());
+  for (size_t i = 0; i < input_nids.size(); ++i) {
+    entries[g.entry_id(input_nids[i], 0)] = inputs[i];
+  }
+  for (size_t nid = 0; nid < g.num_nodes(); ++nid) {
+    const auto& node = g[nid];
+    if (node.source->is_variable()) continue;
+    const FCompute fcompute = fcompute_cpu.get(node.source->op(), nullptr);
+    CHECK(fcompute != nullptr) << "Operator " << node.source->op()->name
+                               << " of fused op has no CPU implementation";
+    std::vector<TBlob> node_inputs, node_outputs;
+    for (const auto& e : node.inputs) node_inputs.push_back(entries[g.entry_id(e)]);
+    for (uint32_t k = 0; k < node.source->num_outputs(); ++k) {
+      const uint32_t eid = g.entry_id(nid, k);
+      const mxnet::TShape& shape = node_shapes[eid];
+      auto& buffer = cpu_unfused_buffers_[eid];
+      buffer.resize(shape.Size() * mshadow::mshadow_sizeof(node_dtypes[eid]));
+      entries[eid] = TBlob(buffer.data(), shape, cpu::kDevMask, node_dtypes[eid]);
+      node_outputs.push_back(entries[eid]);
+    }
+    const std::vector<OpReqType> node_req(node_outputs.size(), kWriteTo);
+    fcompute(node.source->attrs, ctx, node_inputs, node_req, node_outputs);
+  }
+  mshadow::Stream<cpu> *s = ctx.get_stream<cpu>();
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    const TBlob& result = entries[g.entry_id(g.outputs()[i])];
+    MSHADOW_TYPE_SWITCH_WITH_BOOL(outputs[i].type_flag_, DType, {
+      MXNET_ASSIGN_REQ_SWITCH(req[i], Req, {
+        Kernel<op_with_req<mshadow_op::identity, Req>, cpu>::Launch(
+          s, outputs[i].Size(), outputs[i].dptr<DType>(), result.dptr<DType>());
+      });
+    });
+  }
+}
+
+template <>
+void FusedOp::Forward<cpu>(const nnvm::NodeAttrs& attrs,
+                           const OpContext &ctx,
+                           const std::vector<TBlob> &inputs,
+                           const std::vector<OpReqType> &req,
+                           const std::vector<TBlob> &outputs) {
+  std::lock_guard<std::mutex> lock(my_mutex_);
+  CHECK_GE(outputs.size(), 1) << "There needs to be at least 1 output.";
+  CHECK_EQ(inputs.size(), inputs_.size());
+  CHECK_EQ(outputs.size(), outputs_.size());
+
+  std::vector<mxnet::TShape> in_shapes, out_shapes;
+  std::vector<int> in_dtypes, out_dtypes;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    in_shapes.push_back(inputs[i].shape_);
+    in_dtypes.push_back(inputs[i].type_flag_);
+    initialized_ = initialized_ && inputs[i].type_flag_ == inputs_[i].dtype;
+    inputs_[i].dtype = inputs[i].type_flag_;
+    inputs_[i].ndim = inputs[i].ndim();
+  }
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    out_shapes.push_back(outputs[i].shape_);
+    out_dtypes.push_back(outputs[i].type_flag_);
+    initialized_ = initialized_ && outputs[i].type_flag_ == outputs_[i].dtype;
+    outputs_[i].dtype = outputs[i].type_flag_;
+    outputs_[i].ndim = outputs[i].ndim();
+  }
+  SelectIntermediateAttrs(in_shapes, out_shapes, in_dtypes, out_dtypes);
+  const auto& node_shapes = intermediate_shapes_[0].internal_attr;
+  const auto& node_dtypes = intermediate_dtypes_[0].internal_attr;
+
+  // The program only depends on the types, the sizes are checked at every call
+  if (!initialized_) {
+    cpu_unfused_ = !GenerateCPUProgram(node_dtypes, node_shapes);
+    initialized_ = true;
+  }
+  bool same_size = true;
+  for (const auto& blob : inputs) same_size = same_size && blob.Size() == outputs[0].Size();
+  for (const auto& blob : outputs) same_size = same_size && blob.Size() == outputs[0].Size();
+  if (cpu_unfused_ || !same_size) {
+    RunCPUUnfused(ctx, inputs, req, outputs, node_dtypes, node_shapes);
+  } else if (cpu_use_double_) {
+    RunCPUProgram<double>(ctx, inputs, req, outputs);
+  } else {
+    RunCPUProgram<float>(ctx, inputs, req, outputs);
+  }
+}
+
+void FusedOpForwardCPU(const nnvm::NodeAttrs& attrs,
+                       const OpContext &ctx,
+                       const std::vector<TBlob> &inputs,
+                       const std::vector<OpReqType> &req,
+                       const std::vector<TBlob> &outputs) {
+  const FusedOpPtr& op = nnvm::get<FusedOpPtr>(attrs.parsed);
+  op->Forward<cpu>(attrs, ctx, inputs, req, outputs);
+}
+
 bool FusedOpInferShape(const nnvm::NodeAttrs& attrs,
                        std::vector<mxnet::TShape> *in_attrs,
                        std::vector<mxnet::TShape> *out_attrs) {
@@ -240,6 +730,7 @@ NNVM_REGISTER_OP(_FusedOp)
                                              FusedOpProvideStorageType)
 .set_attr<mxnet::FInferShape>("FInferShape", FusedOpInferShape)
 .set_attr<nnvm::FInferType>("FInferType", FusedOpInferType)
+.set_attr<FCompute>("FCompute<cpu>", FusedOpForwardCPU)
 .set_attr_parser(FusedOpParamParser)
 .add_argument("data", "NDArray-or-Symbol[]", "Data");
 
@@ -301,5 +792,3 @@ NNVM_REGISTER_OP(_FusedOpOutHelper)
 .set_attr<exec::FAccessSubgraphType>("FAccessSubgraphType", FusedOpOutHelperType);
 
 }  // namespace mxnet
-
-#endif  // MXNET_USE_CUDA
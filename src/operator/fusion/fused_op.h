@@ -28,15 +28,15 @@
 #include <mutex>
 #include <tuple>
 
-#if MXNET_USE_CUDA
-
 namespace mxnet {
 
+#if MXNET_USE_CUDA
 namespace fusion {
   enum KernelVariants {kGeneral, kShapeOptimized,
     kNumKernelVariants  // Not a variant- leave this at the end
   };
 }
+#endif  // MXNET_USE_CUDA
 
 struct FusedOpConfig : public dmlc::Parameter<FusedOpConfig> {
   int num_inputs;
@@ -57,7 +57,11 @@ struct FusedOpEntry {
 
 class FusedOp {
  public:
+#if MXNET_USE_CUDA
   static const int NTHREADS = 512;
+#endif  // MXNET_USE_CUDA
+  // Number of elements processed at once by a CPU thread
+  static const int CPU_BLOCK = 512;
 
   explicit FusedOp(const nnvm::NodeAttrs* attrs, const FusedOpConfig& config);
   ~FusedOp() {}
@@ -125,6 +129,43 @@ class FusedOp {
   }
 
  private:
+  /*! \brief Keep only the intermediate shapes and types of the given inputs and outputs */
+  void SelectIntermediateAttrs(const std::vector<mxnet::TShape> &in_shapes,
+                               const std::vector<mxnet::TShape> &out_shapes,
+                               const std::vector<int> &in_dtypes,
+                               const std::vector<int> &out_dtypes);
+
+  /*! \brief Instruction of the CPU backend: computes one entry of the subgraph */
+  struct CPUInstr {
+    int opcode;
+    int out_slot;
+    int in_slots[2];
+    double scalars[2];
+    // type to round the result to, -1 when the compute type is exact
+    int round_dtype;
+  };
+
+  /*!
+   * \brief Translate the subgraph into a program of the CPU backend.
+   * \return false if the subgraph needs to be run operator by operator
+   */
+  bool GenerateCPUProgram(const std::vector<int> &node_dtypes,
+                          const mxnet::ShapeVector &node_shapes);
+
+  template <typename CType>
+  void RunCPUProgram(const OpContext &ctx,
+                     const std::vector<TBlob> &inputs,
+                     const std::vector<OpReqType> &req,
+                     const std::vector<TBlob> &outputs);
+
+  void RunCPUUnfused(const OpContext &ctx,
+                     const std::vector<TBlob> &inputs,
+                     const std::vector<OpReqType> &req,
+                     const std::vector<TBlob> &outputs,
+                     const std::vector<int> &node_dtypes,
+                     const mxnet::ShapeVector &node_shapes);
+
+#if MXNET_USE_CUDA
   std::string GenerateCode(const std::vector<OpReqType> &req,
                            const std::vector<int> &in_dtypes,
                            const std::vector<int> &out_dtypes,
@@ -146,6 +187,7 @@ class FusedOp {
                            std::vector<int> *out_dtypes,
                            std::vector<int> *out_ndims,
                            int *nvec);
+#endif  // MXNET_USE_CUDA
 
   std::vector<FusedOpEntry> inputs_;
   std::vector<FusedOpEntry> outputs_;
@@ -177,9 +219,21 @@ class FusedOp {
   std::vector<uint32_t> extra_shape_args_;
   std::vector<uint32_t> check_shape_args_;
 
+#if MXNET_USE_CUDA
   CUfunction kernel_functions_[fusion::kNumKernelVariants];
-  bool initialized_;
   int kernel_function_dev_id_;
+#endif  // MXNET_USE_CUDA
+  bool initialized_;
+
+  // Program of the CPU backend: slots hold blocks of CPU_BLOCK elements
+  std::vector<CPUInstr> cpu_program_;
+  std::vector<int> cpu_input_slots_;
+  std::vector<int> cpu_output_slots_;
+  int cpu_num_slots_;
+  bool cpu_use_double_;
+  bool cpu_unfused_;
+  // Intermediate results when running operator by operator
+  std::vector<std::vector<char>> cpu_unfused_buffers_;
 
   static std::mutex mutex_;
   std::mutex my_mutex_;
@@ -200,6 +254,4 @@ using FusedOpHelperParamPtr = std::shared_ptr<FusedOpHelperParam>;
 
 }  // namespace mxnet
 
-#endif  // MXNET_USE_CUDA
-
 #endif  // MXNET_OPERATOR_FUSION_FUSED_OP_H_
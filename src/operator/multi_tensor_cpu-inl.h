@@ -0,0 +1,91 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file multi_tensor_cpu-inl.h
+ * \brief Load balanced CPU loops over the elements of a list of tensors,
+ *  used by the multi-tensor optimizer updates.
+ */
+#ifndef MXNET_OPERATOR_MULTI_TENSOR_CPU_INL_H_
+#define MXNET_OPERATOR_MULTI_TENSOR_CPU_INL_H_
+
+#include <dmlc/common.h>
+#include <algorithm>
+#include <vector>
+#include "./mxnet_op.h"
+
+namespace mxnet {
+namespace op {
+
+/*!
+ * \brief Split of the concatenation of a list of tensors into chunks of about
+ *  equal size. A chunk never crosses the end of a tensor, so a large tensor is
+ *  spread over all the threads while many small tensors share one.
+ */
+struct MultiTensorChunks {
+  /*! \brief elements [begin, end) of tensor */
+  struct Chunk {
+    size_t tensor;
+    size_t begin;
+    size_t end;
+  };
+  std::vector<Chunk> chunks;
+  int nthreads;
+
+  /*! \param sizes number of elements of every tensor */
+  explicit MultiTensorChunks(const std::vector<size_t>& sizes)
+      : nthreads(engine::OpenMP::Get()->GetRecommendedOMPThreadCount()) {
+    // a few chunks per thread even out the short chunks at the tensor ends,
+    // the lower bound keeps the loop overhead small for small models
+    const size_t kMinChunkSize = 8192;
+    const size_t kChunksPerThread = 4;
+    size_t total = 0;
+    for (const size_t size : sizes) total += size;
+    const size_t nparts = kChunksPerThread * std::max(nthreads, 1);
+    const size_t chunk_size = std::max(kMinChunkSize, (total + nparts - 1) / nparts);
+    for (size_t t = 0; t < sizes.size(); ++t) {
+      for (size_t begin = 0; begin < sizes[t]; begin += chunk_size) {
+        chunks.push_back({t, begin, std::min(sizes[t], begin + chunk_size)});
+      }
+    }
+  }
+  size_t size() const { return chunks.size(); }
+};
+
+/*!
+ * \brief Run fn(c, chunk) for every chunk c of the partition in parallel.
+ *  An exception thrown by fn, e.g. by a failed CHECK, is rethrown after the loop.
+ */
+template<typename F>
+inline void MultiTensorForEachChunk(const MultiTensorChunks& partition, const F& fn) {
+  const index_t nchunks = static_cast<index_t>(partition.size());
+  dmlc::OMPException omp_exc;
+  #pragma omp parallel for num_threads(partition.nthreads) schedule(dynamic, 1)
+  for (index_t c = 0; c < nchunks; ++c) {
+    omp_exc.Run([&] {
+      fn(static_cast<size_t>(c), partition.chunks[c]);
+    });
+  }
+  omp_exc.Rethrow();
+}
+
+}  // namespace op
+}  // namespace mxnet
+
+#endif  // MXNET_OPERATOR_MULTI_TENSOR_CPU_INL_H_
@@ -37,6 +37,7 @@
 #include "./mshadow_op.h"
 #include "./elemwise_op_common.h"
 #include "mxnet_op.h"
+#include "./multi_tensor_cpu-inl.h"
 #include "./tensor/init_op.h"
 #include "./tensor/util/tensor_util-inl.h"
 
@@ -269,6 +270,9 @@ MultiSGDKernelParam<DType, MPDType> FillMultiSGDKernelParam(const nnvm::NodeAttr
   param.rescale_grad = p.rescale_grad;
   param.momentum = 0;
   param.count = p.num_weights;
+  CHECK(param.count <= MultiSGDKernelParam<DType, MPDType>::N)
+    << "Invalid number of weights, the maximum value is "
+    << MultiSGDKernelParam<DType, MPDType>::N << ", and got " << param.count;
   param.max_size = 0;
   for (int i = 0; i < param.count; ++i) {
     param.sizes[i] = inputs[i * input_stride].shape_.Size();
@@ -374,6 +378,81 @@ inline void MultiSGDMomUpdate(const nnvm::NodeAttrs& attrs,
   });
 }
 
+/*! \brief SGD update of elements [begin, end) of one weight on CPU */
+template<int req, bool has_momentum, bool has_mixed_precision,
+         typename DType, typename MPDType>
+inline void MultiSGDChunkCPU(size_t begin, size_t end, DType* out, const DType* weight,
+                             const DType* grad, MPDType* mom, MPDType* weight32,
+                             const MPDType lr, const MPDType wd, const MPDType momentum,
+                             const MPDType rescale_grad, const MPDType clip_gradient) {
+  #pragma omp simd
+  for (size_t i = begin; i < end; ++i) {
+    MPDType w = has_mixed_precision ? weight32[i] : MPDType(weight[i]);
+    MPDType g = rescale_grad * static_cast<MPDType>(grad[i]);
+    if (clip_gradient >= 0.0f) {
+      g = mshadow_op::clip::Map(g, clip_gradient);
+    }
+    g += wd * w;
+    if (has_momentum) {
+      mom[i] = momentum * mom[i] - lr * g;
+      w = w + mom[i];
+    } else {
+      w -= lr * g;
+    }
+    if (has_mixed_precision) {
+      weight32[i] = w;
+    }
+    KERNEL_ASSIGN(out[i], req, w);
+  }
+}
+
+inline float MultiSGDMomentum(const MultiSGDParam&) { return 0.0f; }
+inline float MultiSGDMomentum(const MultiSGDMomParam& p) { return p.momentum; }
+
+/*!
+ * \brief Multi-tensor SGD (with momentum) on CPU. Instead of one thread per
+ *  element index of the largest weight, the elements of all the weights are
+ *  split into equal chunks over the threads, so there is no limit on the
+ *  number of weights and a few large weights do not leave threads idle.
+ */
+template<template<typename> class MPTypeChooser, int input_stride, bool has_momentum>
+inline void MultiSGDUpdateCPU(const nnvm::NodeAttrs& attrs,
+                              const OpContext &ctx,
+                              const std::vector<TBlob> &inputs,
+                              const std::vector<OpReqType> &req,
+                              const std::vector<TBlob> &outputs) {
+  using ParamType = typename std::conditional<has_momentum,
+                                              MultiSGDMomParam, MultiSGDParam>::type;
+  const ParamType& p = nnvm::get<ParamType>(attrs.parsed);
+  std::vector<size_t> sizes(p.num_weights);
+  for (int i = 0; i < p.num_weights; ++i) {
+    sizes[i] = inputs[i * input_stride].shape_.Size();
+  }
+  const MultiTensorChunks partition(sizes);
+  MSHADOW_REAL_TYPE_SWITCH(outputs[0].type_flag_, DType, {
+    using MPDType = typename MPTypeChooser<DType>::type;
+    constexpr bool has_mp = !std::is_same<DType, MPDType>::value;
+    MXNET_ASSIGN_REQ_SWITCH(req[0], Req, {
+      MultiTensorForEachChunk(partition, [&](size_t, const MultiTensorChunks::Chunk& chunk) {
+        const size_t t = chunk.tensor;
+        const size_t idx = t * input_stride;
+        // if mixed precision, then the last input in a set
+        // is 32-bit master copy of the weights
+        MultiSGDChunkCPU<Req, has_momentum, has_mp>(
+          chunk.begin, chunk.end,
+          outputs[t].dptr<DType>(),
+          inputs[idx].dptr<DType>(),
+          inputs[idx + 1].dptr<DType>(),
+          has_momentum ? inputs[idx + 2].dptr<MPDType>() : nullptr,
+          has_mp ? inputs[idx + input_stride - 1].dptr<MPDType>() : nullptr,
+          static_cast<MPDType>(p.lrs[t]), static_cast<MPDType>(p.wds[t]),
+          static_cast<MPDType>(MultiSGDMomentum(p)),
+          static_cast<MPDType>(p.rescale_grad), static_cast<MPDType>(p.clip_gradient));
+      });
+    });
+  });
+}
+
 struct SGDKernel {
   template<typename DType>
   MSHADOW_XINLINE static void Map(index_t i, DType* out_data, const DType* weight_data,
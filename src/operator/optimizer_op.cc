@@ -339,7 +339,7 @@ It updates the weights using::
     }
     return ret;
   })
-.set_attr<FCompute>("FCompute<cpu>", MultiSGDUpdate<cpu, type_identity, 2>)
+.set_attr<FCompute>("FCompute<cpu>", MultiSGDUpdateCPU<type_identity, 2, false>)
 .add_argument("data", "NDArray-or-Symbol[]", "Weights")
 .add_arguments(MultiSGDParam::__FIELDS__());
 
@@ -395,7 +395,7 @@ Where the parameter ``momentum`` is the decay rate of momentum estimates at each
     }
     return ret;
   })
-.set_attr<FCompute>("FCompute<cpu>", MultiSGDMomUpdate<cpu, type_identity, 3>)
+.set_attr<FCompute>("FCompute<cpu>", MultiSGDUpdateCPU<type_identity, 3, true>)
 .add_argument("data", "NDArray-or-Symbol[]", "Weights, gradients and momentum")
 .add_arguments(MultiSGDMomParam::__FIELDS__());
 
@@ -439,7 +439,7 @@ It updates the weights using::
     }
     return ret;
   })
-.set_attr<FCompute>("FCompute<cpu>", MultiSGDUpdate<cpu, single_precision, 3>)
+.set_attr<FCompute>("FCompute<cpu>", MultiSGDUpdateCPU<single_precision, 3, false>)
 .add_argument("data", "NDArray-or-Symbol[]", "Weights")
 .add_arguments(MultiSGDParam::__FIELDS__());
 
@@ -496,7 +496,7 @@ Where the parameter ``momentum`` is the decay rate of momentum estimates at each
     }
     return ret;
   })
-.set_attr<FCompute>("FCompute<cpu>", MultiSGDMomUpdate<cpu, single_precision, 4>)
+.set_attr<FCompute>("FCompute<cpu>", MultiSGDUpdateCPU<single_precision, 4, true>)
 .add_argument("data", "NDArray-or-Symbol[]", "Weights")
 .add_arguments(MultiSGDMomParam::__FIELDS__());
 
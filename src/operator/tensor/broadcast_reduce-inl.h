@@ -27,6 +27,7 @@
 
 #include <mxnet/operator_util.h>
 #include <algorithm>
+#include <memory>
 #include <vector>
 #include <string>
 #include <utility>
@@ -353,12 +354,266 @@ void BinaryBroadcastComputeImpl(Stream<cpu> *s, const OpReqType req,
                     lhs.dptr<DType>(), rhs.dptr<DType>(), out.dptr<DType>());
 }
 
+/*!
+ * \brief Non-volatile form of a reducer, for the accumulators kept in registers by the
+ *  reductions over contiguous memory. The volatile references taken by the reducers
+ *  are needed by the GPU warp reductions but keep the compiler from vectorizing.
+ */
+template<typename Reducer>
+struct lane_reducer {
+  static const bool enabled = false;
+};
+
+template<>
+struct lane_reducer<mshadow_op::sum> {
+  static const bool enabled = true;
+  /*! \brief compensated summation, as mshadow_op::sum */
+  template<typename AType>
+  MSHADOW_XINLINE static void Reduce(AType& val, const AType src, AType& residual) {  // NOLINT(*)
+    const AType y = src - residual;
+    const AType t = val + y;
+    residual = (t - val) - y;
+    val = t;
+  }
+};
+
+template<>
+struct lane_reducer<mshadow::red::maximum> {
+  static const bool enabled = true;
+  template<typename AType>
+  MSHADOW_XINLINE static void Reduce(AType& val, const AType src, AType&) {  // NOLINT(*)
+    // a NaN accumulator is kept, as in mshadow::red::maximum, val == val only fails for NaN
+    if (val == val && !(val >= src)) val = src;
+  }
+};
+
+template<>
+struct lane_reducer<mshadow::red::minimum> {
+  static const bool enabled = true;
+  template<typename AType>
+  MSHADOW_XINLINE static void Reduce(AType& val, const AType src, AType&) {  // NOLINT(*)
+    if (val == val && !(val <= src)) val = src;
+  }
+};
+
+template<typename Reducer, typename AType>
+struct use_lane_reducer {
+  static const bool value = lane_reducer<Reducer>::enabled &&
+                            std::is_arithmetic<AType>::value &&
+                            !std::is_same<AType, bool>::value;
+};
+
+/*! \brief reduce one element into a local accumulator */
+template<typename Reducer, typename AType>
+MSHADOW_XINLINE void reduce_local(AType& val, const AType src, AType& residual) {  // NOLINT(*)
+  if constexpr (use_lane_reducer<Reducer, AType>::value) {
+    lane_reducer<Reducer>::Reduce(val, src, residual);
+  } else {
+    Reducer::Reduce(val, src, residual);
+  }
+}
+
+/*!
+ * \brief Reduce len contiguous elements into val and residual. Reducers with a lane
+ *  form use independent accumulators for consecutive elements, which the compiler
+ *  turns into SIMD lanes, and merge them at the end.
+ */
+template<typename Reducer, typename AType, typename DType, typename OP>
+inline void seq_reduce_contiguous(const DType* __restrict big, const size_t len,
+                                  AType* val, AType* residual) {
+  const int kLanes = 16;
+  if constexpr (use_lane_reducer<Reducer, AType>::value) {
+    if (len < 16 * kLanes) {
+      // too short to make up for merging the lanes
+      AType v = *val, r = *residual;
+      for (size_t k = 0; k < len; ++k) {
+        lane_reducer<Reducer>::Reduce(v, AType(OP::Map(big[k])), r);
+      }
+      *val = v;
+      *residual = r;
+      return;
+    }
+    AType vals[kLanes], residuals[kLanes];
+    for (int l = 0; l < kLanes; ++l) {
+      Reducer::SetInitValue(vals[l], residuals[l]);
+    }
+    size_t k = 0;
+    for (; k + kLanes <= len; k += kLanes) {
+      for (int l = 0; l < kLanes; ++l) {
+        lane_reducer<Reducer>::Reduce(vals[l], AType(OP::Map(big[k + l])), residuals[l]);
+      }
+    }
+    for (int l = 0; k < len; ++k, ++l) {
+      lane_reducer<Reducer>::Reduce(vals[l], AType(OP::Map(big[k])), residuals[l]);
+    }
+    for (int l = 0; l < kLanes; ++l) {
+      Reducer::Merge(*val, *residual, vals[l], residuals[l]);
+    }
+  } else {
+    for (size_t k = 0; k < len; ++k) {
+      AType temp = OP::Map(big[k]);
+      Reducer::Reduce(*val, temp, *residual);
+    }
+  }
+}
+
+/*! \brief Memory layout of a reduction, which selects the kernel */
+enum ReduceLayout {
+  /*! \brief any axes, coordinates are computed for every element */
+  kReduceGeneric,
+  /*! \brief the innermost axes, every output reduces a contiguous row of big */
+  kReduceInner,
+  /*! \brief the outermost axes, every output reduces a column of big */
+  kReduceOuter
+};
+
+/*!
+ * \brief Detect the layout of a reduction from the reduced shape and strides
+ * \param N Number of outputs
+ */
+template<int ndim>
+inline ReduceLayout reduce_layout(const Shape<ndim>& rshape, const Shape<ndim>& rstride,
+                                  const size_t N) {
+  // the reduced axes are in rshape from outermost to innermost,
+  // they form a single block of big when each stride continues the next one
+  index_t inner = 0, expected = 0;
+  for (int i = ndim - 1; i >= 0; --i) {
+    if (rshape[i] == 1) continue;
+    if (inner == 0) {
+      inner = expected = rstride[i];
+    } else if (rstride[i] != expected) {
+      return kReduceGeneric;
+    }
+    expected *= rshape[i];
+  }
+  if (inner == 1) return kReduceInner;
+  if (inner > 1 && static_cast<size_t>(inner) == N) return kReduceOuter;
+  return kReduceGeneric;
+}
+
+/*!
+ * \brief Reduction over the innermost axes, the rows are reduced by different threads.
+ *  When there are fewer rows than threads, each row is split among the threads.
+ */
+template<typename Reducer, typename AType, typename DType, typename OType, typename OP>
+void seq_reduce_inner(const size_t N, const size_t M, const bool addto,
+                      const DType *big, OType *small) {
+  const int thread_count = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  if (N >= static_cast<size_t>(thread_count)) {
+    #pragma omp parallel for num_threads(thread_count)
+    for (index_t idx = 0; idx < static_cast<index_t>(N); ++idx) {
+      AType val, residual;
+      Reducer::SetInitValue(val, residual);
+      seq_reduce_contiguous<Reducer, AType, DType, OP>(big + idx * M, M, &val, &residual);
+      Reducer::Finalize(val, residual);
+      assign(&small[idx], addto, OType(val));
+    }
+    return;
+  }
+  // chunks of at least a few pages, smaller ones are not worth a thread
+  const size_t kMinChunk = 4096;
+  const int num_chunks = static_cast<int>(std::max<size_t>(
+      1, std::min<size_t>(thread_count, M / kMinChunk)));
+  const size_t chunk = (M + num_chunks - 1) / num_chunks;
+  auto vals = std::make_unique<AType[]>(num_chunks);
+  auto residuals = std::make_unique<AType[]>(num_chunks);
+  for (size_t idx = 0; idx < N; ++idx) {
+    #pragma omp parallel for num_threads(num_chunks) if (num_chunks > 1)
+    for (int i = 0; i < num_chunks; ++i) {
+      const size_t begin = std::min(M, i * chunk);
+      const size_t end = std::min(M, begin + chunk);
+      Reducer::SetInitValue(vals[i], residuals[i]);
+      seq_reduce_contiguous<Reducer, AType, DType, OP>(big + idx * M + begin, end - begin,
+                                                       &vals[i], &residuals[i]);
+    }
+    AType val, residual;
+    Reducer::SetInitValue(val, residual);
+    for (int i = 0; i < num_chunks; ++i) {
+      Reducer::Merge(val, residual, vals[i], residuals[i]);
+    }
+    Reducer::Finalize(val, residual);
+    assign(&small[idx], addto, OType(val));
+  }
+}
+
+/*!
+ * \brief Reduction over the outermost axes: output n reduces big[k * N + n] over k.
+ *  The outputs are processed in tiles whose accumulators stay in cache while the rows
+ *  of big are streamed through, so that all loads are contiguous. Tiles are spread
+ *  over the threads, when there are too few of them the rows are split as well.
+ */
+template<typename Reducer, typename AType, typename DType, typename OType, typename OP>
+void seq_reduce_outer(const size_t N, const size_t M, const bool addto,
+                      const DType *big, OType *small) {
+  const size_t kTile = 256;
+  const size_t kMinRows = 64;
+  const int thread_count = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  const size_t num_tiles = (N + kTile - 1) / kTile;
+  const size_t num_chunks = num_tiles >= static_cast<size_t>(thread_count) ? 1 :
+      std::max<size_t>(1, std::min<size_t>((thread_count + num_tiles - 1) / num_tiles,
+                                           M / kMinRows));
+  const size_t rows = (M + num_chunks - 1) / num_chunks;
+  // partial results of every chunk of rows, when the rows are split
+  std::unique_ptr<AType[]> vals, residuals;
+  if (num_chunks > 1) {
+    vals = std::make_unique<AType[]>(num_chunks * N);
+    residuals = std::make_unique<AType[]>(num_chunks * N);
+  }
+  #pragma omp parallel for num_threads(thread_count) schedule(static)
+  for (index_t w = 0; w < static_cast<index_t>(num_tiles * num_chunks); ++w) {
+    const size_t n0 = (w % num_tiles) * kTile;
+    const size_t len = std::min(kTile, N - n0);
+    const size_t chunk = w / num_tiles;
+    const size_t k_end = std::min(M, (chunk + 1) * rows);
+    AType tile_val[kTile], tile_residual[kTile];
+    AType* __restrict val = num_chunks > 1 ? &vals[chunk * N + n0] : tile_val;
+    AType* __restrict residual = num_chunks > 1 ? &residuals[chunk * N + n0] : tile_residual;
+    for (size_t n = 0; n < len; ++n) {
+      Reducer::SetInitValue(val[n], residual[n]);
+    }
+    for (size_t k = chunk * rows; k < k_end; ++k) {
+      const DType* __restrict row = big + k * N + n0;
+      for (size_t n = 0; n < len; ++n) {
+        reduce_local<Reducer>(val[n], AType(OP::Map(row[n])), residual[n]);
+      }
+    }
+    if (num_chunks == 1) {
+      for (size_t n = 0; n < len; ++n) {
+        Reducer::Finalize(val[n], residual[n]);
+        assign(&small[n0 + n], addto, OType(val[n]));
+      }
+    }
+  }
+  if (num_chunks == 1) return;
+  #pragma omp parallel for num_threads(thread_count) if (N >= kTile)
+  for (index_t n = 0; n < static_cast<index_t>(N); ++n) {
+    AType val = vals[n], residual = residuals[n];
+    for (size_t chunk = 1; chunk < num_chunks; ++chunk) {
+      Reducer::Merge(val, residual, vals[chunk * N + n], residuals[chunk * N + n]);
+    }
+    Reducer::Finalize(val, residual);
+    assign(&small[n], addto, OType(val));
+  }
+}
+
 template<typename Reducer, int ndim, typename AType, typename DType, typename OType, typename OP,
          typename IndexOP = mxnet::op::mshadow_op::set_index_no_op<AType, index_t>>
 void seq_reduce_compute(const size_t N, const size_t M, const bool addto,
                         const DType *big, OType *small, const Shape<ndim> bshape,
                         const Shape<ndim> sshape, const Shape<ndim> rshape,
                         const Shape<ndim> rstride) {
+  if constexpr (!IndexOP::do_op) {
+    switch (M > 1 ? reduce_layout(rshape, rstride, N) : kReduceGeneric) {
+      case kReduceInner:
+        seq_reduce_inner<Reducer, AType, DType, OType, OP>(N, M, addto, big, small);
+        return;
+      case kReduceOuter:
+        seq_reduce_outer<Reducer, AType, DType, OType, OP>(N, M, addto, big, small);
+        return;
+      default:
+        break;
+    }
+  }
   const int thread_count = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
   #pragma omp parallel for num_threads(thread_count) if (N >= thread_count)
   for (index_t idx = 0; idx < static_cast<index_t>(N); ++idx) {
@@ -379,18 +379,20 @@ inline void SparseEmbeddingOpBackwardRspImpl<cpu>(const bool deterministic,
   CHECK_EQ(req, kWriteTo) << "SparseEmbedding layer doesn't support "
                           << "weight gradient calculation with req != write";
 
-  // Request temporary storage for marking non-zero rows and prefix sum
   Stream<cpu> *s = ctx.get_stream<cpu>();
-  dim_t num_rows = output.shape()[0];
-  dim_t row_length = output.shape()[1];
-  size_t workspace_size = num_rows * sizeof(dim_t);
-  Tensor<cpu, 1, char> workspace =
-    ctx.requested[embedding::kTempSpace].get_space_typed<cpu, 1, char>(
-      Shape1(workspace_size), s);
-  dim_t* row_flg = reinterpret_cast<dim_t*>(workspace.dptr_);
-  // prefix sum array re-uses the row_flg array temp space
-  dim_t* prefix_sum = row_flg;
-  dim_t data_size = static_cast<dim_t>(data.shape_.Size());
+  const dim_t num_rows = output.shape()[0];
+  const dim_t row_length = output.shape()[1];
+  const dim_t data_size = static_cast<dim_t>(data.shape_.Size());
+  if (data_size == 0) {
+    FillZerosRspImpl(s, output);
+    return;
+  }
+  // the rows of the gradient are the distinct indices, found by sorting the indices
+  // rather than by marking the rows of the whole weight
+  const int num_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  Tensor<cpu, 1, dim_t> workspace =
+    ctx.requested[embedding::kTempSpace].get_space_typed<cpu, 1, dim_t>(
+      Shape1(GroupEmbeddingIndicesWorkspaceSize(data_size, num_threads)), s);
 
   MSHADOW_TYPE_SWITCH(data.type_flag_, IType, {
     MSHADOW_SGL_DBL_TYPE_SWITCH(ograd.type_flag_, DType, {
@@ -404,37 +406,23 @@ inline void SparseEmbeddingOpBackwardRspImpl<cpu>(const bool deterministic,
           bool is_valid = CheckIndexOutOfBound(data_ptr, data.shape_.Size(), min, max);
           CHECK(is_valid) << "Embedding input contains data out of bound";
         }
-        // mark row flags
-        Fill<false>(s, TBlob(row_flg, Shape1(num_rows), cpu::kDevMask), kWriteTo, 0);
-        Kernel<MarkRowFlgKernel, cpu>::Launch(s, data_size, row_flg, data.dptr<IType>());
-        // calculate inclusive prefix sum
-        // TODO(haibin) ideally this is should be done in parallel
-        prefix_sum[0] = row_flg[0];
-        for (dim_t i = 1; i < num_rows; i++) {
-          prefix_sum[i] = prefix_sum[i - 1] + row_flg[i];
-        }
-        // total number of non-zero rows
-        dim_t nnr = prefix_sum[num_rows - 1];
-        if (nnr == 0) {
-          FillZerosRspImpl(s, output);
-          return;
-        }
-        output.CheckAndAlloc({Shape1(nnr)});
+        const EmbeddingIndexGroups groups = GroupEmbeddingIndicesCPU(
+          data.dptr<IType>(), data_size, num_rows, workspace.dptr_, num_threads);
+        output.CheckAndAlloc({Shape1(groups.nnr)});
         RType* grad_row_idx = output.aux_data(kIdx).dptr<RType>();
-        // fill row_idx array of output matrix, using the row_flg values
-        Kernel<FillRspRowIdxKernel, cpu>::Launch(s, num_rows,
-            grad_row_idx, prefix_sum, num_rows);
-        // prefill with zeros
         DType* grad_data = output.data().dptr<DType>();
-        Fill<false>(s, TBlob(grad_data, Shape1(nnr * row_length),
-            cpu::kDevMask), kWriteTo, 0);
-        // add the final gradients
-        const int num_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
-        dim_t segment_len = (nnr + num_threads - 1) / num_threads;
-        Kernel<AddTakeGradRspKernel, cpu>::Launch(s, num_threads, grad_data, prefix_sum,
-                                                  ograd.dptr<DType>(), row_length,
-                                                  data.dptr<IType>(), data_size, segment_len,
-                                                  num_rows);
+        const DType* ograd_data = ograd.dptr<DType>();
+        // every row of the gradient is summed by a single thread, in the order of the indices
+        #pragma omp parallel for num_threads(num_threads) schedule(dynamic, 64)
+        for (dim_t r = 0; r < groups.nnr; ++r) {
+          grad_row_idx[r] = static_cast<RType>(groups.rows[r]);
+          DType* grad_row = grad_data + r * row_length;
+          std::fill(grad_row, grad_row + row_length, DType(0));
+          for (dim_t k = groups.offsets[r]; k < groups.offsets[r + 1]; ++k) {
+            const DType* ograd_row = ograd_data + groups.positions[k] * row_length;
+            for (dim_t j = 0; j < row_length; ++j) grad_row[j] += ograd_row[j];
+          }
+        }
       });
     });
   });
@@ -439,47 +439,117 @@ void EmbeddingOpBackward(const nnvm::NodeAttrs& attrs,
   });
 }
 
-struct AddTakeGradRspKernel {
-  /*!
-   * \brief Each thread i is responsible for row slices in [segment_start, segment_end)
-            of the result gradient
-   * \param tid             global thread id
-   * \param grad            the gradient to calculate
-   * \param prefix_sum      the inclusive prefix sum of row ids of the gradient
-   * \param ograd           output gradient
-   * \param row_length      the length of the row slices of the gradient
-   * \param data_val        the values of input data
-   * \param data_size       number of values of input data
-   * \param segment_length  the length of row segment to process for each thread
-   * \param nnr             total number of non-zero rows of result gradient
-   */
-  template<typename DType, typename IType>
-  MSHADOW_CINLINE static void Map(int tid,
-                                  DType* grad,
-                                  const nnvm::dim_t* prefix_sum,
-                                  const DType* ograd,
-                                  const nnvm::dim_t row_length,
-                                  const IType* data_val,
-                                  const nnvm::dim_t data_size,
-                                  const nnvm::dim_t segment_length,
-                                  const nnvm::dim_t nnr) {
-    using nnvm::dim_t;
-    dim_t segment_start = tid * segment_length;
-    dim_t segment_end = std::min(nnr, segment_start + segment_length);
-    // scan all data
-    for (dim_t data_i = 0; data_i < data_size; data_i++) {
-      dim_t data = static_cast<dim_t>(data_val[data_i]);
-      dim_t grad_row_id = prefix_sum[data] - 1;
-      if (grad_row_id < segment_start || grad_row_id >= segment_end) continue;
-      // no projection is performed
-      dim_t ograd_i = data_i * row_length;
-      dim_t grad_i = grad_row_id * row_length;
-      for (dim_t offset = 0; offset < row_length; offset++) {
-        grad[grad_i + offset] += ograd[ograd_i + offset];
+/*!
+ * \brief The positions of the indices of an embedding grouped by index: the
+ *  positions of rows[r] are positions[offsets[r], offsets[r + 1]), in increasing order.
+ */
+struct EmbeddingIndexGroups {
+  /*! \brief number of distinct indices */
+  nnvm::dim_t nnr;
+  /*! \brief the distinct indices, sorted */
+  const nnvm::dim_t* rows;
+  const nnvm::dim_t* offsets;
+  const nnvm::dim_t* positions;
+};
+
+/*! \brief number of dim_t of workspace needed by GroupEmbeddingIndicesCPU */
+inline size_t GroupEmbeddingIndicesWorkspaceSize(nnvm::dim_t num_indices, int num_threads) {
+  return 6 * num_indices + 1 + num_threads * 256;
+}
+
+/*!
+ * \brief Group the positions of the indices of an embedding by index on CPU.
+ *
+ *  The (index, position) pairs are sorted with a stable parallel radix sort on
+ *  digits of 8 bits, with a histogram per thread, for as many digits as num_rows
+ *  needs; the distinct indices are then found with a parallel prefix count.
+ *  Time and memory are linear in the number of indices, whatever num_rows.
+ * \param idx the indices, in [0, num_rows)
+ * \param workspace GroupEmbeddingIndicesWorkspaceSize(num_indices, num_threads) dim_t
+ */
+template<typename IType>
+inline EmbeddingIndexGroups GroupEmbeddingIndicesCPU(const IType* idx,
+                                                     const nnvm::dim_t num_indices,
+                                                     const nnvm::dim_t num_rows,
+                                                     nnvm::dim_t* workspace,
+                                                     const int num_threads) {
+  using nnvm::dim_t;
+  const dim_t n = num_indices;
+  dim_t* keys = workspace;
+  dim_t* positions = keys + n;
+  dim_t* sorted_keys = positions + n;
+  dim_t* sorted_positions = sorted_keys + n;
+  dim_t* rows = sorted_positions + n;
+  dim_t* offsets = rows + n;
+  // counts of each digit in each chunk, then of distinct indices in each chunk
+  dim_t* counts = offsets + n + 1;
+  const dim_t chunk = std::max<dim_t>((n + num_threads - 1) / num_threads, 1);
+
+  #pragma omp parallel for num_threads(num_threads)
+  for (dim_t i = 0; i < n; ++i) {
+    keys[i] = static_cast<dim_t>(idx[i]);
+    positions[i] = i;
+  }
+  int num_bits = 0;
+  while (num_bits < 63 && (dim_t(1) << num_bits) < num_rows) ++num_bits;
+  for (int shift = 0; shift < num_bits; shift += 8) {
+    #pragma omp parallel for num_threads(num_threads)
+    for (int t = 0; t < num_threads; ++t) {
+      dim_t* count = counts + t * 256;
+      std::fill(count, count + 256, 0);
+      for (dim_t i = t * chunk; i < std::min(n, (t + 1) * chunk); ++i) {
+        ++count[(keys[i] >> shift) & 255];
+      }
+    }
+    // the chunks of a digit follow each other, so that the sort is stable
+    dim_t offset = 0;
+    for (int digit = 0; digit < 256; ++digit) {
+      for (int t = 0; t < num_threads; ++t) {
+        const dim_t count = counts[t * 256 + digit];
+        counts[t * 256 + digit] = offset;
+        offset += count;
       }
     }
+    #pragma omp parallel for num_threads(num_threads)
+    for (int t = 0; t < num_threads; ++t) {
+      dim_t* offset = counts + t * 256;
+      for (dim_t i = t * chunk; i < std::min(n, (t + 1) * chunk); ++i) {
+        const dim_t dst = offset[(keys[i] >> shift) & 255]++;
+        sorted_keys[dst] = keys[i];
+        sorted_positions[dst] = positions[i];
+      }
+    }
+    std::swap(keys, sorted_keys);
+    std::swap(positions, sorted_positions);
   }
-};
+
+  #pragma omp parallel for num_threads(num_threads)
+  for (int t = 0; t < num_threads; ++t) {
+    dim_t count = 0;
+    for (dim_t i = t * chunk; i < std::min(n, (t + 1) * chunk); ++i) {
+      count += i == 0 || keys[i] != keys[i - 1];
+    }
+    counts[t] = count;
+  }
+  dim_t nnr = 0;
+  for (int t = 0; t < num_threads; ++t) {
+    const dim_t count = counts[t];
+    counts[t] = nnr;
+    nnr += count;
+  }
+  #pragma omp parallel for num_threads(num_threads)
+  for (int t = 0; t < num_threads; ++t) {
+    dim_t r = counts[t];
+    for (dim_t i = t * chunk; i < std::min(n, (t + 1) * chunk); ++i) {
+      if (i == 0 || keys[i] != keys[i - 1]) {
+        rows[r] = keys[i];
+        offsets[r++] = i;
+      }
+    }
+  }
+  offsets[nnr] = n;
+  return EmbeddingIndexGroups{nnr, rows, offsets, positions};
+}
 
 template<typename xpu>
 inline void SparseEmbeddingOpBackwardRspImpl(const bool deterministic,
@@ -29,6 +29,8 @@
 #include <dmlc/optional.h>
 #include <mshadow/tensor.h>
 #include <algorithm>
+#include <cstring>
+#include <limits>
 #include <vector>
 #include <string>
 #include <type_traits>
@@ -223,48 +225,176 @@ struct fill_ind {
   }
 };
 
+/*!
+ * \brief A value of a row and its position in the row, for the cpu sorts.
+ *  Entries are ordered by value, then by position, so that the result is
+ *  deterministic whatever the number of threads.
+ */
+template<typename DType>
+struct TopKEntry {
+  DType val;
+  index_t pos;
+};
+
+template<typename DType>
+struct TopKEntryCodec {
+  typedef TopKEntry<DType> Entry;
+  bool is_ascend;
+  explicit TopKEntryCodec(bool is_ascend) : is_ascend(is_ascend) {}
+  inline Entry Encode(DType val, index_t pos) const { return Entry{val, pos}; }
+  inline index_t Position(const Entry& e) const { return e.pos; }
+  inline bool operator()(const Entry& a, const Entry& b) const {
+    if (a.val == b.val) return a.pos < b.pos;
+    return is_ascend ? a.val < b.val : a.val > b.val;
+  }
+};
+
+/*!
+ * \brief Packs a float and its position in a 64 bit key, so that the cpu sorts compare
+ *  plain integers held in registers: the high half holds the bits of the float mapped
+ *  to an unsigned order (complemented when descending), the low half holds the position.
+ */
+struct TopKFloatCodec {
+  typedef uint64_t Entry;
+  uint32_t flip;
+  explicit TopKFloatCodec(bool is_ascend) : flip(is_ascend ? 0U : 0xFFFFFFFFU) {}
+  inline Entry Encode(float val, index_t pos) const {
+    uint32_t bits;
+    std::memcpy(&bits, &val, sizeof(bits));
+    bits ^= (bits >> 31) ? 0xFFFFFFFFU : 0x80000000U;
+    return (static_cast<uint64_t>(bits ^ flip) << 32) | static_cast<uint32_t>(pos);
+  }
+  inline index_t Position(Entry e) const {
+    return static_cast<index_t>(e & 0xFFFFFFFFU);
+  }
+  inline bool operator()(Entry a, Entry b) const { return a < b; }
+};
+
+/*!
+ * \brief Move the first K entries of [first, last) in sorted order to its front.
+ *  nth_element is linear in the length of the range, so only the K selected
+ *  entries are sorted.
+ */
+template<typename Entry, typename Codec>
+inline void TopKSelect(Entry* first, Entry* last, index_t K, const Codec& codec) {
+  const index_t n = last - first;
+  if (K < n) std::nth_element(first, first + K, last, codec);
+  std::sort(first, first + std::min(K, n), codec);
+}
+
+/*! \brief merge two sorted runs, keeping at most the first K entries */
+template<typename Entry, typename Codec>
+inline index_t TopKMerge(const Entry* a, index_t na, const Entry* b, index_t nb,
+                         Entry* out, index_t K, const Codec& codec) {
+  const index_t n = std::min(K, na + nb);
+  index_t i = 0, j = 0;
+  for (index_t o = 0; o < n; ++o) {
+    if (j == nb || (i < na && !codec(b[j], a[i]))) {
+      out[o] = a[i++];
+    } else {
+      out[o] = b[j++];
+    }
+  }
+  return n;
+}
+
+/*!
+ * \brief Top K of the M rows of length N of vals on cpu: the K first entries of each
+ *  row of sorted_vals and indices receive the selected values and their flat indices.
+ *  Rows are processed in parallel when there are enough of them. Otherwise each row
+ *  is split in a chunk per thread, the top K of each chunk is selected in parallel
+ *  and the sorted chunks are merged pairwise in parallel, keeping K entries per run.
+ */
+template<typename Codec, typename DType, typename IDXType>
+inline void TopKSortCPU(const DType* vals, DType* sorted_vals, IDXType* indices,
+                        index_t M, index_t N, index_t K, const Codec& codec) {
+  typedef typename Codec::Entry Entry;
+  // rows shorter than this are not split among threads
+  const index_t kMinSplitLength = 1 << 14;
+  const int omp_threads = engine::OpenMP::Get()->GetRecommendedOMPThreadCount();
+  if (K == 0) return;
+  if (M >= omp_threads || N < kMinSplitLength) {
+    #pragma omp parallel num_threads(omp_threads)
+    {
+      std::vector<Entry> buf(N);
+      #pragma omp for
+      for (index_t i = 0; i < M; ++i) {
+        const DType* row = vals + i * N;
+        for (index_t j = 0; j < N; ++j) buf[j] = codec.Encode(row[j], j);
+        TopKSelect(buf.data(), buf.data() + N, K, codec);
+        for (index_t j = 0; j < K; ++j) {
+          const index_t pos = codec.Position(buf[j]);
+          sorted_vals[i * N + j] = row[pos];
+          indices[i * N + j] = static_cast<IDXType>(i * N + pos);
+        }
+      }
+    }
+    return;
+  }
+  std::vector<Entry> buf(N), merged(N);
+  const index_t chunk = (N + omp_threads - 1) / omp_threads;
+  const index_t num_chunks = (N + chunk - 1) / chunk;
+  std::vector<index_t> run_length(num_chunks);
+  for (index_t i = 0; i < M; ++i) {
+    const DType* row = vals + i * N;
+    #pragma omp parallel for num_threads(omp_threads)
+    for (index_t c = 0; c < num_chunks; ++c) {
+      const index_t begin = c * chunk, end = std::min(N, begin + chunk);
+      for (index_t j = begin; j < end; ++j) buf[j] = codec.Encode(row[j], j);
+      TopKSelect(buf.data() + begin, buf.data() + end, K, codec);
+      run_length[c] = std::min(K, end - begin);
+    }
+    Entry* src = buf.data();
+    Entry* dst = merged.data();
+    for (index_t step = 1; step < num_chunks; step *= 2) {
+      #pragma omp parallel for num_threads(omp_threads)
+      for (index_t c = 0; c < num_chunks; c += 2 * step) {
+        if (c + step < num_chunks) {
+          run_length[c] = TopKMerge(src + c * chunk, run_length[c],
+                                    src + (c + step) * chunk, run_length[c + step],
+                                    dst + c * chunk, K, codec);
+        } else {
+          std::copy(src + c * chunk, src + c * chunk + run_length[c], dst + c * chunk);
+        }
+      }
+      std::swap(src, dst);
+    }
+    for (index_t j = 0; j < K; ++j) {
+      const index_t pos = codec.Position(src[j]);
+      sorted_vals[i * N + j] = row[pos];
+      indices[i * N + j] = static_cast<IDXType>(i * N + pos);
+    }
+  }
+}
+
+template<typename DType, typename IDXType>
+inline void TopKSortCPU(const DType* vals, DType* sorted_vals, IDXType* indices,
+                        index_t M, index_t N, index_t K, bool is_ascend) {
+  TopKSortCPU(vals, sorted_vals, indices, M, N, K, TopKEntryCodec<DType>(is_ascend));
+}
+
+template<typename IDXType>
+inline void TopKSortCPU(const float* vals, float* sorted_vals, IDXType* indices,
+                        index_t M, index_t N, index_t K, bool is_ascend) {
+  if (N <= static_cast<index_t>(std::numeric_limits<uint32_t>::max())) {
+    TopKSortCPU(vals, sorted_vals, indices, M, N, K, TopKFloatCodec(is_ascend));
+  } else {
+    TopKSortCPU(vals, sorted_vals, indices, M, N, K, TopKEntryCodec<float>(is_ascend));
+  }
+}
+
 template<typename DType, typename IDXType>
 MSHADOW_FORCE_INLINE void TopKSort(const Tensor<cpu, 1, DType>& dat,
                                    const Tensor<cpu, 1, IDXType>& ind,
                                    const Tensor<cpu, 1, char>& work,
                                    IDXType K, IDXType N, bool is_ascend,
                                    Stream<cpu> *s) {
-  // Use full sort when K is relatively large.
-  const bool full_sort(K*8 > N);
   // Batch size.
   const size_t M(work.size(0)/(sizeof(DType)*N));
-  const int omp_threads(engine::OpenMP::Get()->GetRecommendedOMPThreadCount());
-  #pragma omp parallel for num_threads(omp_threads)
-  for (index_t i = 0; i < static_cast<index_t>(M); ++i) {
-    // Tensor `work` stores the flattened source data, while `dat` stores the sorted result.
-    DType *vals = reinterpret_cast<DType*>(work.dptr_);
-    DType *sorted_vals = dat.dptr_+i*N;
-    IDXType *indices = ind.dptr_+i*N;
-    if (is_ascend) {
-      if (full_sort) {
-        std::sort(indices, indices+N,
-                  [&](const IDXType& i1, const IDXType& i2){
-          return vals[i1] < vals[i2]; });
-      } else {
-        std::partial_sort(indices, indices+K, indices+N,
-                          [&](const IDXType& i1, const IDXType& i2){
-          return vals[i1] < vals[i2]; });
-      }
-    } else {
-      if (full_sort) {
-        std::sort(indices, indices+N,
-                  [&](const IDXType& i1, const IDXType& i2){
-          return vals[i1] > vals[i2]; });
-      } else {
-        std::partial_sort(indices, indices+K, indices+N,
-                          [&](const IDXType& i1, const IDXType& i2){
-          return vals[i1] > vals[i2]; });
-      }
-    }
-    for (IDXType j = 0; j < K; ++j) {
-      sorted_vals[j] = vals[indices[j]];
-    }
-  }
+  // Tensor `work` stores the flattened source data, while `dat` stores the sorted result.
+  TopKSortCPU(reinterpret_cast<const DType*>(work.dptr_), dat.dptr_, ind.dptr_,
+              static_cast<index_t>(M), static_cast<index_t>(N), static_cast<index_t>(K),
+              is_ascend);
 }
 
 #ifdef __CUDACC__
@@ -498,8 +628,11 @@ void TopKImpl(const RunContext &ctx,
     workspace_curr_ptr += temp_size;
   }
 
-  mxnet_op::Kernel<range_fwd, xpu>::Launch(s, batch_size * element_num, 1, IDXType{0}, IDXType{1},
-    kWriteTo, reinterpret_cast<IDXType*>(indices.dptr_));
+  // The cpu sorts write the indices of the selected elements themselves.
+  if (!std::is_same<xpu, cpu>::value) {
+    mxnet_op::Kernel<range_fwd, xpu>::Launch(s, batch_size * element_num, 1, IDXType{0},
+      IDXType{1}, kWriteTo, reinterpret_cast<IDXType*>(indices.dptr_));
+  }
   CHECK_EQ(indices.CheckContiguous(), true);
 
   // 2. Perform inplace batch sort.
@@ -694,8 +827,11 @@ void TopKImplwithWorkspace(const RunContext &ctx,
     workspace_curr_ptr += temp_size;
   }
 
-  mxnet_op::Kernel<range_fwd, xpu>::Launch(s, batch_size * element_num, 1, index_t{0}, index_t{1},
-    kWriteTo, indices.dptr_);
+  // The cpu sorts write the indices of the selected elements themselves.
+  if (!std::is_same<xpu, cpu>::value) {
+    mxnet_op::Kernel<range_fwd, xpu>::Launch(s, batch_size * element_num, 1, index_t{0},
+      index_t{1}, kWriteTo, indices.dptr_);
+  }
   CHECK_EQ(indices.CheckContiguous(), true);
 
   // 2. Perform inplace batch sort.
@@ -128,8 +128,13 @@ void Profiler::SetConfig(int mode,
                          std::string output_filename,
                          bool continuous_dump,
                          float dump_period,
-                         bool aggregate_stats) {
+                         bool aggregate_stats,
+                         const StreamConfig &stream) {
   CHECK(!continuous_dump || dump_period > 0);
+  CHECK_GE(stream.max_file_size, 0);
+  CHECK_GE(stream.max_files, 0);
+  CHECK_GE(stream.max_pending_records, 0);
+  CHECK_GE(stream.sample_rate, 1);
   std::lock_guard<std::recursive_mutex> lock{this->m_};
   this->mode_ = mode;
   this->filename_ = output_filename;
@@ -137,6 +142,15 @@ void Profiler::SetConfig(int mode,
   if (!this->filename_.empty()) {
     ::unlink(this->filename_.c_str());
   }
+  this->max_file_size_ = stream.max_file_size;
+  this->max_files_ = stream.max_files;
+  this->max_pending_records_ = stream.max_pending_records;
+  this->sample_rate_ = static_cast<uint32_t>(stream.sample_rate);
+  this->stream_file_index_ = 0;
+  this->stream_file_open_ = false;
+  if (this->max_file_size_ > 0 && !this->filename_.empty()) {
+    ::unlink(StreamFileName(0).c_str());
+  }
   SetContinuousProfileDump(continuous_dump, dump_period);
   // Adjust whether storing aggregate stats as necessary
   if (aggregate_stats) {
@@ -163,6 +177,15 @@ void Profiler::EmitPid(std::ostream *os, const std::string& name, size_t pid) {
         << "        }";
 }
 
+std::string Profiler::StreamFileName(uint64_t index) const {
+  const size_t dot = filename_.rfind('.');
+  const size_t slash = filename_.find_last_of("/\\");
+  if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+    return filename_ + "." + std::to_string(index);
+  }
+  return filename_.substr(0, dot) + "." + std::to_string(index) + filename_.substr(dot);
+}
+
 void Profiler::DumpProfile(bool perform_cleanup) {
   std::lock_guard<std::recursive_mutex> lock{this->m_};
   if (!IsEnableOutput()) {
@@ -171,13 +194,17 @@ void Profiler::DumpProfile(bool perform_cleanup) {
   if (perform_cleanup) {
     SetContinuousProfileDump(false, 1.0f);
   }
+  // When streaming, each file of the rolling set is a complete trace of its own,
+  // starting with the process names and closed once it is large enough
+  const bool streaming = continuous_dump_ && max_file_size_ > 0;
   std::ofstream file;
-  const bool first_pass = ++profile_dump_count_ == 1;
-  const bool last_pass = perform_cleanup || !continuous_dump_;
+  ++profile_dump_count_;
+  const bool first_pass = streaming ? !stream_file_open_ : profile_dump_count_ == 1;
+  const std::string filename = streaming ? StreamFileName(stream_file_index_) : filename_;
   if (!first_pass && continuous_dump_) {
-    file.open(filename_, std::ios::app|std::ios::out);
+    file.open(filename, std::ios::app|std::ios::ate|std::ios::out);
   } else {
-    file.open(filename_, std::ios::trunc|std::ios::out);
+    file.open(filename, std::ios::trunc|std::ios::out);
   }
   if (first_pass || !continuous_dump_) {
     file << "{" << std::endl;
@@ -195,17 +222,24 @@ void Profiler::DumpProfile(bool perform_cleanup) {
       this->EmitPid(&file, d.dev_name_, pid);
       process_ids_.emplace(pid);
     }
+    if (streaming) {
+      // names of the categories are emitted again in the new file
+      category_to_pid_.clear();
+      stream_file_open_ = true;
+    }
   }
 
   // Hold ref in case SetConfig() resets aggregate_stats_
   // If aggregate stats aren't enabled, this won't cause a locked instruction
   std::shared_ptr<AggregateStats> ptr_aggregate_stats = aggregate_stats_.get()
                                                         ? aggregate_stats_ : nullptr;
+  int64_t num_dequeued = 0;
   for (uint32_t i = 0; i < dev_num; ++i) {
     DeviceStats &d = profile_stat[i];
     ProfileStat *_opr_stat;
     while (d.opr_exec_stats_->try_dequeue(_opr_stat)) {
       CHECK_NOTNULL(_opr_stat);
+      ++num_dequeued;
       std::unique_ptr<ProfileStat> opr_stat(_opr_stat);  // manage lifecycle
       opr_stat->process_id_ = i;  // lie and set process id to be the device number
       file << ",\n" << std::endl;
@@ -221,6 +255,7 @@ void Profiler::DumpProfile(bool perform_cleanup) {
   ProfileStat *_profile_stat;
   while (general_stats_.opr_exec_stats_->try_dequeue(_profile_stat)) {
     CHECK_NOTNULL(_profile_stat);
+    ++num_dequeued;
     file << ",";
     std::unique_ptr<ProfileStat> profile_stat(_profile_stat);  // manage lifecycle
     CHECK_NE(profile_stat->categories_.c_str()[0], '\0') << "Category must be set";
@@ -242,13 +277,29 @@ void Profiler::DumpProfile(bool perform_cleanup) {
       ptr_aggregate_stats->OnProfileStat(*profile_stat);
     }
   }
+  pending_records_.fetch_sub(num_dequeued, std::memory_order_relaxed);
 
-  if (last_pass) {
+  const bool last_pass = perform_cleanup || !continuous_dump_;
+  const bool roll_over = streaming && !last_pass &&
+                         static_cast<int64_t>(file.tellp()) >= max_file_size_;
+  if (last_pass || roll_over) {
     file << "\n" << std::endl;
     file << "    ]," << std::endl;
     file << R"(    "displayTimeUnit": "ms")" << std::endl;
     file << "}" << std::endl;
   }
+  if (roll_over) {
+    file.close();
+    stream_file_open_ = false;
+    ++stream_file_index_;
+    if (max_files_ > 0 && stream_file_index_ >= static_cast<uint64_t>(max_files_)) {
+      ::unlink(StreamFileName(stream_file_index_ - max_files_).c_str());
+    }
+  }
+  if (last_pass && dropped_records() > 0) {
+    LOG(WARNING) << "Profiler dropped " << dropped_records() << " records because more than "
+                 << max_pending_records_ << " were waiting to be dumped";
+  }
   enable_output_ = continuous_dump_ && !last_pass;  // If we're appending, then continue.
                                                     // Otherwise, profiling stops.
 }
@@ -27,6 +27,7 @@
 
 #include <dmlc/concurrentqueue.h>
 #include <dmlc/thread_group.h>
+#include <atomic>
 #include <vector>
 #include <string>
 #include <cstdint>
@@ -272,17 +273,36 @@ class Profiler {
   inline ProfilerState GetState() const {
     return this->state_;
   }
+  /*!
+   * \brief Settings bounding the memory and disk use of a long running profile
+   */
+  struct StreamConfig {
+    /*!
+     * \brief With continuous dump, close the trace file once it reaches this many
+     *  bytes and continue in the next one of a rolling set of files, each of them
+     *  a complete trace. 0 writes a single file.
+     */
+    int64_t max_file_size = 0;
+    /*! \brief Number of most recent rolled files to keep, 0 keeps all of them */
+    int max_files = 0;
+    /*! \brief Records not yet dumped beyond which new records are dropped, 0 for no limit */
+    int64_t max_pending_records = 0;
+    /*! \brief Record one in this many operator executions */
+    int sample_rate = 1;
+  };
   /*!
    * \brief set profiler configuration
    * \param mode flags, one or more of 'ProfilerMode'
    * \param output_filename profile output file name
    * \param continuous_dump true if profile information should be periodically dumped
    * \param dump_period Period (in seconds) of profile info dumping
+   * \param stream Limits on the memory and files used by the profile
    */
   void SetConfig(int mode, std::string output_filename,
                  bool continuous_dump,
                  float dump_period,
-                 bool aggregate_stats);
+                 bool aggregate_stats,
+                 const StreamConfig &stream = StreamConfig());
 
   /*! \return mode of profiler */
   inline int GetMode() const {
@@ -321,13 +341,30 @@ class Profiler {
    */
   template<typename StatType, typename SetExtraInfoFunction, typename ...Args>
   void AddNewProfileStat(SetExtraInfoFunction set_extra_info_function, Args... args) {
-    if (!paused_) {
+    if (!paused_ && ReserveRecord()) {
       std::unique_ptr<StatType> stat = CreateProfileStat<StatType>(args...);
       set_extra_info_function(stat.get());
       AddProfileStat(&stat);
     }
   }
 
+  /*!
+   * \brief Whether the operator execution about to start is to be recorded
+   * \note Sampling is per thread, each thread records one in 'sample_rate' of its operators
+   */
+  inline bool SampleOperator() const {
+    if (sample_rate_ <= 1) {
+      return true;
+    }
+    static thread_local uint32_t count = 0;
+    return count++ % sample_rate_ == 0;
+  }
+
+  /*! \return number of records dropped because too many were waiting to be dumped */
+  inline uint64_t dropped_records() const {
+    return dropped_records_.load(std::memory_order_relaxed);
+  }
+
   /*!
    * \brief Return aggregate statistic accumulator
    * \return shared pointer to the 'ProfileStats' aggregate statistic accumulator
@@ -434,9 +471,29 @@ class Profiler {
     general_stats_.opr_exec_stats_->enqueue(stat->release());
   }
 
+  /*!
+   * \brief Count a new record as pending, unless the limit of pending records is reached
+   * \return false if the record is to be dropped
+   */
+  inline bool ReserveRecord() {
+    const int64_t pending = pending_records_.fetch_add(1, std::memory_order_relaxed);
+    if (max_pending_records_ > 0 && pending >= max_pending_records_) {
+      pending_records_.fetch_sub(1, std::memory_order_relaxed);
+      dropped_records_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    return true;
+  }
+
   /*! \brief generate device information following chrome profile file format */
   void EmitPid(std::ostream *os, const std::string& name, size_t pid);
 
+  /*!
+   * \brief Name of a file in the rolling set of trace files
+   * \param index Index of the file, "profile.json" becomes "profile.<index>.json"
+   */
+  std::string StreamFileName(uint64_t index) const;
+
   /*!
    * \brief Set continuous asynchronous profile dump
    * \param continuous_dump Whether to continuously dump profile information
@@ -481,6 +538,22 @@ class Profiler {
   std::shared_ptr<dmlc::ThreadGroup> thread_group_ = std::make_shared<dmlc::ThreadGroup>();
   /* !\brief pids */
   std::unordered_set<uint32_t> process_ids_;
+  /*! \brief Size at which a trace file is rolled over, 0 when writing a single file */
+  int64_t max_file_size_ = 0;
+  /*! \brief Number of rolled trace files to keep, 0 to keep all */
+  int max_files_ = 0;
+  /*! \brief Index of the current file in the rolling set */
+  uint64_t stream_file_index_ = 0;
+  /*! \brief Whether the current file of the rolling set has been started */
+  bool stream_file_open_ = false;
+  /*! \brief Limit of records waiting to be dumped, 0 for no limit */
+  volatile int64_t max_pending_records_ = 0;
+  /*! \brief Record one in this many operator executions */
+  volatile uint32_t sample_rate_ = 1;
+  /*! \brief Records added and not yet dumped */
+  std::atomic<int64_t> pending_records_{0};
+  /*! \brief Records dropped because of max_pending_records_ */
+  std::atomic<uint64_t> dropped_records_{0};
 };
 
 #ifdef MXNET_USE_VTUNE
@@ -1186,7 +1259,8 @@ struct ProfileOperator : public ProfileEvent {
   void startForDevice(mxnet::Context::DeviceType dev_type, uint32_t dev_id) {
     dev_type_ = dev_type;
     dev_id_ = dev_id;
-    if (profiling_) {
+    sampled_ = profiling_ && Profiler::Get()->SampleOperator();
+    if (sampled_) {
       ProfileEvent::start();
       as_task_.start();
     }
@@ -1195,7 +1269,7 @@ struct ProfileOperator : public ProfileEvent {
    * \brief Stop the profiling scope
    */
   void stop() override {
-    if (profiling_) {
+    if (sampled_) {
       as_task_.stop();
       ProfileEvent::stop();
     }
@@ -1275,6 +1349,8 @@ struct ProfileOperator : public ProfileEvent {
   std::unique_ptr<Attributes> attributes_;
   /*! \brief Whether to profile or not */
   const bool profiling_;
+  /*! \brief Whether this execution is recorded, see Profiler::SampleOperator() */
+  bool sampled_ = false;
 };
 
 /*
@@ -33,6 +33,16 @@
 namespace mxnet {
 namespace profiler {
 
+DeviceStorageProfiler* DeviceStorageProfiler::Get() {
+  static std::mutex mtx;
+  static std::shared_ptr<DeviceStorageProfiler> dev_storage_profiler = nullptr;
+  std::unique_lock<std::mutex> lk(mtx);
+  if (!dev_storage_profiler) {
+    dev_storage_profiler = std::make_shared<DeviceStorageProfiler>();
+  }
+  return dev_storage_profiler.get();
+}
+
 #if MXNET_USE_CUDA
 
 GpuDeviceStorageProfiler* GpuDeviceStorageProfiler::Get() {
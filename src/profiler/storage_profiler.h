@@ -23,6 +23,7 @@
 #include <mxnet/storage.h>
 #include <string>
 #include <tuple>
+#include <array>
 #include <vector>
 #include <thread>
 #include <unordered_map>
@@ -44,6 +45,9 @@ class DeviceStorageProfiler {
     : domain_(domain_name) {
   }
 
+  /*! \brief get the global instance shared by the storage and its pooled managers */
+  static DeviceStorageProfiler* Get();
+
   /*!
    * \brief Called when memory has been allocated in order to record the allocation size
    * \param handle Handle to the allocated storage
@@ -92,6 +96,28 @@ class DeviceStorageProfiler {
     }
   }
 
+  /*!
+   * \brief Called by the pooled storage manager whenever a per-thread cache
+   *        synchronizes with the shared pool, to record the cache efficiency
+   * \param ctx Context of the pooled storage manager
+   * \param hits Number of requests served by the thread cache since the last call
+   * \param misses Number of requests which needed the shared pool since the last call
+   * \param flushed Number of chunks returned to the shared pool since the last call
+   */
+  void OnThreadCacheSync(const Context &ctx, size_t hits, size_t misses, size_t flushed) {
+    profiler::Profiler *prof = profiler::Profiler::Get();
+    if (prof->IsProfiling(profiler::Profiler::kMemory)) {
+      Init();
+      const size_t idx = prof->DeviceIndex(ctx.dev_type, ctx.dev_id);
+      if (idx >= cache_counters_.size())
+        return;
+      auto &counters = cache_counters_[idx];
+      if (hits) *counters[0] += hits;
+      if (misses) *counters[1] += misses;
+      if (flushed) *counters[2] += flushed;
+    }
+  }
+
  private:
   /*!
    * \brief Lazy initialization.  No locks occur except for on the first pass
@@ -104,6 +130,16 @@ class DeviceStorageProfiler {
       if (mem_counters_.empty()) {
         profiler::Profiler *prof = profiler::Profiler::Get();
         const size_t device_count = prof->DeviceCount();
+        cache_counters_.resize(device_count);
+        for (size_t i = 0, n = device_count; i < n; ++i) {
+          const char *suffixes[] = {"Thread Cache Hits: ", "Thread Cache Misses: ",
+                                    "Thread Cache Flushes: "};
+          for (size_t j = 0; j < cache_counters_[i].size(); ++j) {
+            std::string name = std::string("Memory Pool ") + suffixes[j] + prof->DeviceName(i);
+            cache_counters_[i][j] = std::make_shared<profiler::ProfileCounter>(name.c_str(),
+                                                                              &domain_);
+          }
+        }
         mem_counters_.reserve(device_count);
         for (size_t i = 0, n = device_count; i < n; ++i) {
           std::string name = "Memory: ";
@@ -121,6 +157,8 @@ class DeviceStorageProfiler {
   std::mutex init_mutex_;
   /*! \brief Constant-sized vector of memory profile counters */
   std::vector<std::shared_ptr<profiler::ProfileCounter>> mem_counters_;
+  /*! \brief Per-device thread cache hit/miss/flush counters of the pooled storage managers */
+  std::vector<std::array<std::shared_ptr<profiler::ProfileCounter>, 3>> cache_counters_;
 };
 
 #if MXNET_USE_CUDA
@@ -29,12 +29,18 @@
 #include <mxnet/engine.h>
 #include <mxnet/random_generator.h>
 #include <mxnet/resource.h>
+#include <algorithm>
 #include <limits>
 #include <atomic>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "./common/lazy_alloc_array.h"
 #include "./common/utils.h"
 #include "./common/cuda/utils.h"
+#include "./profiler/profiler.h"
 #include "./profiler/storage_profiler.h"
 
 namespace mxnet {
@@ -88,12 +94,192 @@ struct SpaceAllocator {
   }
 };
 
+/*! \brief temp space taken from the arenas by one operator, reported to the profiler */
+struct TempSpaceStats {
+  profiler::ProfileCounter peak;
+  profiler::ProfileCounter average;
+  std::atomic<uint64_t> max_bytes{0};
+  std::atomic<uint64_t> total_bytes{0};
+  std::atomic<uint64_t> count{0};
+
+  TempSpaceStats(const std::string& name, profiler::ProfileDomain* domain)
+      : peak((name + " Peak (B)").c_str(), domain),
+        average((name + " Average (B)").c_str(), domain) {}
+
+  void Add(size_t size) {
+    uint64_t max = max_bytes.load();
+    while (size > max && !max_bytes.compare_exchange_weak(max, size)) {}
+    if (size > max) peak = size;
+    const uint64_t total = (total_bytes += size);
+    average = total / ++count;
+  }
+
+  /*! \brief the statistics of the operator name, created on first use */
+  static TempSpaceStats* Get(const std::string& name) {
+    // never destroyed, operators may run during static destruction
+    static profiler::ProfileDomain* domain = new profiler::ProfileDomain("TempSpace");
+    static std::mutex* mutex = new std::mutex();
+    static auto* all = new std::unordered_map<std::string, std::unique_ptr<TempSpaceStats>>();
+    // only the first use of a name on a thread takes the lock
+    static thread_local std::unordered_map<std::string, TempSpaceStats*> cache;
+    auto it = cache.find(name);
+    if (it != cache.end()) return it->second;
+    std::lock_guard<std::mutex> lock(*mutex);
+    std::unique_ptr<TempSpaceStats>& stats = (*all)[name];
+    if (!stats) stats.reset(new TempSpaceStats(name, domain));
+    cache.emplace(name, stats.get());
+    return stats.get();
+  }
+};
+
+/*!
+ * \brief Stack-like arena of the CPU temp space of one thread. An operator
+ *  takes its temp space from the top of the arena and gives it back when it
+ *  ends, so operators on different threads never share temp space. The arena
+ *  grows to the peak temp space of the operators of the thread, and shrinks
+ *  again once a spike has passed.
+ */
+class TempSpaceArena {
+ public:
+  /*! \brief whether the CPU temp space is taken from the arenas */
+  static bool Enabled() {
+    static const bool enabled = dmlc::GetEnv("MXNET_CPU_TEMP_ARENA", false);
+    return enabled;
+  }
+
+  static TempSpaceArena* Get() {
+    return dmlc::ThreadLocalStore<TempSpaceArena>::Get();
+  }
+
+  TempSpaceArena() : storage_ref_(Storage::_GetSharedRef()) {}
+
+  ~TempSpaceArena() {
+    Release();
+  }
+
+  /*! \brief begin an operator, which takes no temp space from the arena unless use_arena */
+  void Enter(bool use_arena) {
+    frames_.push_back({regions_.size(), use_arena});
+  }
+
+  /*! \brief end the current operator and give back its temp space */
+  void Leave() {
+    const size_t begin = frames_.back().begin;
+    frames_.pop_back();
+    while (regions_.size() > begin) {
+      // the region is the top of its chunk
+      chunks_[regions_.back().chunk].used -= regions_.back().size;
+      in_use_ -= regions_.back().size;
+      regions_.pop_back();
+    }
+    if (!frames_.empty()) return;
+    // between the operators of the thread, resize to the peak of the last ones
+    window_peak_ = std::max(window_peak_, op_peak_);
+    op_peak_ = 0;
+    if (chunks_.size() > 1) {
+      // merge the chunks of a new peak, allocated on the next request
+      Release();
+      next_capacity_ = window_peak_;
+    }
+    if (++window_size_ == kShrinkInterval) {
+      if (Capacity() > 2 * window_peak_) {
+        Release();
+        next_capacity_ = window_peak_;
+      }
+      window_size_ = 0;
+      window_peak_ = 0;
+    }
+  }
+
+  /*!
+   * \brief Get size bytes of temp space for the resource key.
+   * \return nullptr if the current operator takes no temp space from the arena
+   */
+  void* Alloc(const void* key, size_t size) {
+    if (frames_.empty() || !frames_.back().use_arena) return nullptr;
+    // like a temp space copy, a resource gets the same space again
+    for (size_t i = frames_.back().begin; i < regions_.size(); ++i) {
+      if (regions_[i].key == key && regions_[i].size >= size) return regions_[i].dptr;
+    }
+    size = std::max<size_t>(1, (size + kAlign - 1) / kAlign) * kAlign;
+    if (chunks_.empty() || chunks_.back().handle.size - chunks_.back().used < size) {
+      // a new chunk, the space in the others stays valid until the operator ends
+      const size_t capacity = chunks_.empty() ? next_capacity_ : Capacity();
+      Chunk chunk;
+      chunk.handle = Storage::Get()->Alloc(std::max(size, capacity), Context::CPU());
+      chunk.handle.profiler_scope = "resource:";
+      chunk.handle.name = "temp_space_arena";
+      chunks_.push_back(chunk);
+    }
+    Chunk& chunk = chunks_.back();
+    void* dptr = static_cast<char*>(chunk.handle.dptr) + chunk.used;
+    chunk.used += size;
+    regions_.push_back({key, dptr, size, chunks_.size() - 1});
+    in_use_ += size;
+    op_peak_ = std::max(op_peak_, in_use_);
+    return dptr;
+  }
+
+ private:
+  /*! \brief number of operators after which the arena shrinks to their peak */
+  static constexpr size_t kShrinkInterval = 1024;
+  /*! \brief alignment of the temp space */
+  static constexpr size_t kAlign = 64;
+
+  struct Chunk {
+    Storage::Handle handle;
+    size_t used{0};
+  };
+  /*! \brief temp space of a resource in an operator */
+  struct Region {
+    const void* key;
+    void* dptr;
+    size_t size;
+    size_t chunk;
+  };
+  /*! \brief an operator being executed */
+  struct Frame {
+    size_t begin;
+    bool use_arena;
+  };
+
+  size_t Capacity() const {
+    size_t capacity = 0;
+    for (const Chunk& chunk : chunks_) capacity += chunk.handle.size;
+    return capacity;
+  }
+
+  void Release() {
+    for (Chunk& chunk : chunks_) Storage::Get()->DirectFree(chunk.handle);
+    chunks_.clear();
+  }
+
+  /*! \brief keep the storage alive until the arenas of all threads are freed */
+  std::shared_ptr<Storage> storage_ref_;
+  std::vector<Chunk> chunks_;
+  std::vector<Region> regions_;
+  std::vector<Frame> frames_;
+  /*! \brief bytes of the temp space in use */
+  size_t in_use_{0};
+  /*! \brief peak of in_use_ in the current operator */
+  size_t op_peak_{0};
+  /*! \brief peak of in_use_ in the last operators */
+  size_t window_peak_{0};
+  /*! \brief number of operators since the last shrink */
+  size_t window_size_{0};
+  /*! \brief size of the chunk allocated after a release */
+  size_t next_capacity_{0};
+};
+
 
 // Implements resource manager
 class ResourceManagerImpl : public ResourceManager {
  public:
   ResourceManagerImpl() noexcept(false) {
-    cpu_temp_space_copy_ = dmlc::GetEnv("MXNET_CPU_TEMP_COPY", 4);
+    // with the arenas the copies hold no memory, and more of them let
+    // concurrent operators use temp space without waiting for each other
+    cpu_temp_space_copy_ = dmlc::GetEnv("MXNET_CPU_TEMP_COPY",
+                                        TempSpaceArena::Enabled() ? 16 : 4);
     gpu_temp_space_copy_ = dmlc::GetEnv("MXNET_GPU_TEMP_COPY", 1);
     cpu_native_rand_copy_ = dmlc::GetEnv("MXNET_CPU_PARALLEL_RAND_COPY", 1);
     gpu_native_rand_copy_ = dmlc::GetEnv("MXNET_GPU_PARALLEL_RAND_COPY", 1);
@@ -477,7 +663,15 @@ class ResourceManagerImpl : public ResourceManager {
 
 void* Resource::get_space_internal(size_t size,
     const std::string &name) const {
-  return static_cast<resource::SpaceAllocator*>(ptr_)->GetSpace(size, name);
+  resource::SpaceAllocator* space = static_cast<resource::SpaceAllocator*>(ptr_);
+  if (space->ctx.dev_mask() == Context::kCPU && resource::TempSpaceArena::Enabled()) {
+    void* dptr = resource::TempSpaceArena::Get()->Alloc(space, size);
+    if (dptr != nullptr) {
+      resource::TempSpaceStats::Get(name)->Add(size);
+      return dptr;
+    }
+  }
+  return space->GetSpace(size, name);
 }
 
 void* Resource::get_host_space_internal(size_t size) const {
@@ -514,6 +708,15 @@ void Resource::get_cudnn_dropout_desc(
 }
 #endif  // MXNET_USE_CUDNN == 1
 
+TempSpaceScope::TempSpaceScope(bool use_arena)
+    : entered_(resource::TempSpaceArena::Enabled()) {
+  if (entered_) resource::TempSpaceArena::Get()->Enter(use_arena);
+}
+
+TempSpaceScope::~TempSpaceScope() {
+  if (entered_) resource::TempSpaceArena::Get()->Leave();
+}
+
 ResourceManager* ResourceManager::Get() {
   typedef dmlc::ThreadLocalStore<resource::ResourceManagerImpl> inst;
   return inst::Get();
@@ -33,12 +33,13 @@
 #include <complex>
 #include <numeric>
 #include <limits>
+#include <memory>
 #include <regex>
 #include <tuple>
 #include <set>
 #include <stdexcept>
 #include <typeinfo>
-
+#include "../common/mapped_file.h"
 
 namespace mxnet {
 
@@ -126,7 +127,12 @@ int dtype_descr(const std::string& dtype_descr) {
     return -1;
 }
 
-std::string create_npy_header(const TBlob& blob) {
+/*!
+ * \brief Create the npy header of a blob.
+ * \param offset position of the header in the file. The header is padded so that the data
+ *  following it starts at a multiple of 64 bytes, which lets memory mapped loads alias it.
+ */
+std::string create_npy_header(const TBlob& blob, size_t offset = 0) {
   std::string dict;
   dict += "{'descr': ";
   dict += dtype_descr(blob);
@@ -143,12 +149,12 @@ std::string create_npy_header(const TBlob& blob) {
   }
   dict += "), }";
 
-  // pad with spaces so that preamble+dict is modulo 64 bytes. preamble is
+  // pad with spaces so that offset+preamble+dict is modulo 64 bytes. preamble is
   // 10 bytes. dict needs to end with \n
-  int remainder = 64 - (10 + dict.size() + 1) % 64;
+  int remainder = 64 - (offset + 10 + dict.size() + 1) % 64;
   dict.insert(dict.end(), remainder, ' ');
   dict.push_back('\n');
-  assert((dict.size() + 10) % 64 == 0);
+  assert((offset + dict.size() + 10) % 64 == 0);
 
   std::string header;
   header += static_cast<char>(0x93);
@@ -293,10 +299,93 @@ NDArray load_array(const std::string& fname) {
   return array;
 }
 
+/*!
+ * \brief Parse the npy header at the given offset of a memory mapped file.
+ * \return the offset of the array data, or 0 if the header is malformed.
+ */
+size_t parse_npy_header(const common::MappedFile& file, size_t offset, std::string* header) {
+  if (offset > file.size() || file.size() - offset < 10) return 0;
+  const char* data = file.data() + offset;
+  if (std::memcmp(data, "\x93NUMPY", 6) != 0) return 0;
+  const uint8_t major_version = data[6];
+  if ((major_version != 0x01 && major_version != 0x02) || data[7] != 0x00) return 0;
+  const auto* len = reinterpret_cast<const uint8_t*>(data + 8);
+  size_t header_len = len[0] | (len[1] << 8);
+  size_t header_start = 10;
+  if (major_version == 0x02) {
+    if (file.size() - offset < 12) return 0;
+    header_len |= (static_cast<size_t>(len[2]) << 16) | (static_cast<size_t>(len[3]) << 24);
+    header_start = 12;
+  }
+  if (file.size() - offset - header_start < header_len) return 0;
+  header->assign(data + header_start, header_len);
+  return offset + header_start + header_len;
+}
+
+/*!
+ * \brief Create a dense CPU array aliasing the npy file content at the given offset
+ *  of a memory mapped file.
+ * \return the array, or a none array if the content cannot be aliased.
+ */
+NDArray alias_npy(const std::shared_ptr<common::MappedFile>& file, size_t offset) {
+  std::string header;
+  const size_t data_offset = parse_npy_header(*file, offset, &header);
+  if (data_offset == 0) return NDArray();
+  auto[type_flag, fortran_order, shape] = parse_npy_header_descr(header);
+  if (fortran_order) return NDArray();
+
+  TShape tshape(shape);
+  const size_t type_size = mshadow::mshadow_sizeof(type_flag);
+  const size_t nbytes = tshape.Size() * type_size;
+  if (!file->CanAlias(data_offset, nbytes, type_size)) return NDArray();
+  TBlob blob(file->data() + data_offset, tshape, cpu::kDevMask, type_flag, 0);
+  return NDArray(blob, 0, [file]() {});
+}
+
+NDArray load_array_mapped(const std::string& fname) {
+  auto file = std::make_shared<common::MappedFile>(fname);
+  NDArray array = alias_npy(file, 0);
+  return array.is_none() ? load_array(fname) : array;
+}
+
 }  // namespace npy
 
 namespace npz {
 
+/*!
+ * \brief Create a dense CPU array aliasing an uncompressed npy member of a memory mapped
+ *  zip archive.
+ * \return the array, or a none array if the member cannot be aliased.
+ */
+NDArray alias_stored_npy(mz_zip_archive* archive, const std::shared_ptr<common::MappedFile>& file,
+                         const std::string& path) {
+  const int index = mz_zip_reader_locate_file(archive, path.data(), nullptr, 0);
+  mz_zip_archive_file_stat stat;
+  if (index < 0 || !mz_zip_reader_file_stat(archive, index, &stat)) return NDArray();
+  if (stat.m_method != 0 || stat.m_is_encrypted || stat.m_comp_size != stat.m_uncomp_size) {
+    return NDArray();
+  }
+
+  // The member data follows its local header and the variable length fields
+  constexpr size_t kLocalHeaderSize = 30;
+  const size_t header_offset = stat.m_local_header_ofs;
+  if (header_offset > file->size() || file->size() - header_offset < kLocalHeaderSize) {
+    return NDArray();
+  }
+  const auto* local_header = reinterpret_cast<const uint8_t*>(file->data() + header_offset);
+  if (local_header[0] != 0x50 || local_header[1] != 0x4b ||
+      local_header[2] != 0x03 || local_header[3] != 0x04) {
+    return NDArray();
+  }
+  const size_t filename_len = local_header[26] | (local_header[27] << 8);
+  const size_t extra_len = local_header[28] | (local_header[29] << 8);
+  const size_t data_offset = header_offset + kLocalHeaderSize + filename_len + extra_len;
+  if (data_offset > file->size() || file->size() - data_offset < stat.m_uncomp_size) {
+    return NDArray();
+  }
+  return npy::alias_npy(file, data_offset);
+}
+
 size_t npy_header_blob_read_callback(void *pOpaque, mz_uint64 file_ofs, void *pBuf, size_t n) {
     auto[npy_header, blob] = *static_cast<std::tuple<const std::string*, const TBlob*>*>(pOpaque);
 
@@ -324,9 +413,13 @@ size_t npy_header_blob_read_callback(void *pOpaque, mz_uint64 file_ofs, void *pB
 
 
 void save_blob(mz_zip_archive* archive, const std::string& blob_name, const TBlob& blob) {
-  const std::string npy_header = npy::create_npy_header(blob);
-
   const std::string blob_name_npy = blob_name + ".npy";
+  // The stored member follows its local header and name at the end of the archive.
+  // Aligning its data lets mapped loads alias it, unless zip64 adds an extra field.
+  constexpr size_t kLocalHeaderSize = 30;
+  const std::string npy_header = npy::create_npy_header(
+      blob, archive->m_archive_size + kLocalHeaderSize + blob_name_npy.size());
+
   mz_uint64 size_to_add = npy_header.size();
   size_to_add += blob.Size() * mshadow::mshadow_sizeof(blob.type_flag_);
   auto callback_data = std::tuple(&npy_header, &blob);
@@ -346,12 +439,12 @@ void save_shape_array(mz_zip_archive* archive, const std::string& blob_name,
   dict += "{'descr': '<i8', 'fortran_order': False, 'shape': (";
   dict += std::to_string(shape.ndim());
   dict += ",), }";
-  // pad with spaces so that preamble+dict is modulo 64 bytes. preamble is
+  // pad with spaces so that offset+preamble+dict is modulo 64 bytes. preamble is
   // 10 bytes. dict needs to end with \n
-  int remainder = 64 - (10 + dict.size() + 1) % 64;
+  int remainder = 64 - (offset + 10 + dict.size() + 1) % 64;
   dict.insert(dict.end(), remainder, ' ');
   dict.push_back('\n');
-  assert((dict.size() + 10) % 64 == 0);
+  assert((offset + dict.size() + 10) % 64 == 0);
   std::string npy;
   npy += static_cast<char>(0x93);
   npy += "NUMPY";
@@ -401,12 +494,12 @@ void save_format_array(mz_zip_archive* archive, const std::string& blob_name,
   dict += "{'descr': '|s";
   dict += std::to_string(format.size());
   dict += "{'descr': '<i8', 'fortran_order': False, 'shape': (), }";
-  // pad with spaces so that preamble+dict is modulo 64 bytes. preamble is
+  // pad with spaces so that offset+preamble+dict is modulo 64 bytes. preamble is
   // 10 bytes. dict needs to end with \n
-  int remainder = 64 - (10 + dict.size() + 1) % 64;
+  int remainder = 64 - (offset + 10 + dict.size() + 1) % 64;
   dict.insert(dict.end(), remainder, ' ');
   dict.push_back('\n');
-  assert((dict.size() + 10) % 64 == 0);
+  assert((offset + dict.size() + 10) % 64 == 0);
   std::string npy;
   npy += static_cast<char>(0x93);
   npy += "NUMPY";
@@ -506,11 +599,19 @@ uint32_t parse_npy_header_len(mz_zip_reader_extract_iter_state* state,
 
 
 std::pair<std::vector<NDArray>, std::vector<std::string>>
-load_arrays(const std::string& zip_fname) {
+load_arrays(const std::string& zip_fname, bool mapped) {
   mz_zip_archive archive {};
-  CHECK(mz_zip_reader_init_file(&archive, zip_fname.data(), 0))
-      << "Failed to open archive " << zip_fname << ": "
-      << mz_zip_get_error_string(mz_zip_get_last_error(&archive));
+  std::shared_ptr<common::MappedFile> mapping;
+  if (mapped) {
+    mapping = std::make_shared<common::MappedFile>(zip_fname);
+    CHECK(mz_zip_reader_init_mem(&archive, mapping->data(), mapping->size(), 0))
+        << "Failed to open archive " << zip_fname << ": "
+        << mz_zip_get_error_string(mz_zip_get_last_error(&archive));
+  } else {
+    CHECK(mz_zip_reader_init_file(&archive, zip_fname.data(), 0))
+        << "Failed to open archive " << zip_fname << ": "
+        << mz_zip_get_error_string(mz_zip_get_last_error(&archive));
+  }
 
   // Collect the set of file-names per folder in the zip file. If the set of
   // file names in a folder matches the scipy.sparse.save_npz pattern, the
@@ -852,6 +953,14 @@ load_arrays(const std::string& zip_fname) {
       for (const std::string& fname : dircontents) {
         std::string path(dirname);
         path += fname;
+        if (mapping) {
+          NDArray array = alias_stored_npy(&archive, mapping, path);
+          if (!array.is_none()) {
+            arrays.push_back(array);
+            return_names.emplace_back(path.substr(0, path.size() - 4));
+            continue;
+          }
+        }
         mz_zip_reader_extract_iter_state* file = mz_zip_reader_extract_file_iter_new(
             &archive, path.data(), 0);
         CHECK(nullptr != file) << mz_zip_get_error_string(mz_zip_get_last_error(&archive));
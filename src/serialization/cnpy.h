@@ -37,6 +37,11 @@ namespace npy {
 
 void save_array(const std::string& fname, const NDArray& array);
 NDArray load_array(const std::string& fname);
+/*!
+ * \brief Load a npy file by memory mapping it. The returned array aliases the
+ *  private mapping of the file, unless the data is in fortran order or misaligned.
+ */
+NDArray load_array_mapped(const std::string& fname);
 
 }
 
@@ -44,7 +49,14 @@ namespace npz {
 
 void save_array(mz_zip_archive* archive, const std::string& array_name, const NDArray& array);
 
-std::pair<std::vector<NDArray>, std::vector<std::string>>  load_arrays(const std::string& fname);
+/*!
+ * \brief Load the arrays of a npz file.
+ * \param fname the name of the file.
+ * \param mapped whether to memory map the file. If true, dense arrays stored
+ *  without compression alias the private mapping of the file.
+ */
+std::pair<std::vector<NDArray>, std::vector<std::string>>  load_arrays(const std::string& fname,
+                                                                       bool mapped = false);
 
 }
 }  // namespace mxnet
@@ -26,6 +26,7 @@
 #define MXNET_STORAGE_CPU_DEVICE_STORAGE_H_
 
 #include "mxnet/base.h"
+#include "../common/numa.h"
 
 namespace mxnet {
 namespace storage {
@@ -60,7 +61,8 @@ class CPUDeviceStorage {
 };  // class CPUDeviceStorage
 
 inline void CPUDeviceStorage::Alloc(Storage::Handle* handle) {
-  bool success = mxnet::common::AlignedMemAlloc(&(handle->dptr), handle->size, alignment_);
+  bool success = mxnet::common::NumaTopology::Get()->AlignedMemAlloc(
+      &(handle->dptr), handle->size, alignment_, handle->ctx);
   if (!success) LOG(FATAL) << "Failed to allocate CPU Memory";
 }
 
@@ -28,8 +28,12 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <memory>
 #include <mutex>
 #include <tuple>
+#include <unordered_map>
+#include <utility>
 #include "./storage_manager.h"
 #include "../profiler/storage_profiler.h"
 
@@ -43,6 +47,7 @@ typedef enum {
   large_alloc_size,
   round_linear_cutoff,
   pool_reserve,
+  thread_cache_size,
 } env_var_type;
 
 const std::string env_var_name(const char* dev_type, env_var_type type);
@@ -66,6 +71,39 @@ const std::string env_var_name(const char* dev_type, env_var_type type);
 #define GPU_PROFILER_ON_FREE(prof, ...)
 #endif
 
+/*!
+ * \brief Per-thread cache of free memory chunks, which sits in front of the shared pool.
+ *  Its owner thread serves most Alloc/Free requests from the per-bucket magazines without
+ *  taking the storage mutex. The cache mutex is only contended when ReleaseAll drains
+ *  the caches of all threads.
+ */
+struct PoolThreadCache {
+  std::mutex mutex;
+  // free chunks kept by this thread, indexed by the bucket id
+  std::unordered_map<size_t, std::vector<void*>> magazines;
+  // statistics accumulated since the last synchronization with the shared pool
+  size_t hits = 0;
+  size_t misses = 0;
+  size_t flushed = 0;
+  // set when the owner thread has exited, so the chunks can be reclaimed
+  bool orphaned = false;
+};
+
+/*!
+ * \brief Thread local list of the thread caches owned by the current thread, one for
+ *  each pooled storage manager used by this thread.
+ */
+struct PoolThreadCacheHolder {
+  std::vector<std::pair<uint64_t, std::shared_ptr<PoolThreadCache>>> caches;
+
+  ~PoolThreadCacheHolder() {
+    for (auto &&cache : caches) {
+      std::lock_guard<std::mutex> lock(cache.second->mutex);
+      cache.second->orphaned = true;
+    }
+  }
+};
+
 /*!
  * \brief Storage manager with a memory pool for GPU/CPU/CPUPunned memory chunks
  * memory chunks which reused based on rounded size match.
@@ -111,6 +149,12 @@ class PooledStorageManager : public StorageManager,
       const size_t total = std::get<1>(contextHelper_->getMemoryInfo());
       memory_allocation_limit_ = total * reserve / 100;
     }
+
+    // number of chunks per bucket, which each thread may keep for itself (0 disables caching)
+    if (dev_type && dev_type_ == Context::kCPU) {
+      const auto env_var = env_var_name(dev_type, thread_cache_size);
+      thread_cache_size_ = dmlc::GetEnv(env_var.c_str(), 0);
+    }
   }
   /*!
    * \brief Default destructor.
@@ -120,11 +164,7 @@ class PooledStorageManager : public StorageManager,
   }
 
   void Alloc(Storage::Handle* handle) override;
-  void Free(Storage::Handle handle) override {
-    // Insert returned memory in cache
-    std::lock_guard<std::mutex> lock(Storage::Get()->GetMutex(dev_type_));
-    StoringMethod::InsertInCache(BucketingStrategy::get_bucket(handle.size), handle.dptr);
-  }
+  void Free(Storage::Handle handle) override;
 
   void DirectFree(Storage::Handle handle) override {
     std::lock_guard<std::mutex> lock(Storage::Get()->GetMutex(dev_type_));
@@ -142,12 +182,77 @@ class PooledStorageManager : public StorageManager,
   }
 
  private:
+  void AllocNoLock(Storage::Handle* handle, size_t bucket_id);
+
   void ReleaseAllNoLock(bool set_device = true) {
+    DrainThreadCachesNoLock();
     SET_DEVICE(device_store, contextHelper_, contextHelper_->initilal_context(), set_device);
     used_memory_ -= StoringMethod::ReleaseAllNoLock(contextHelper_.get(), this);
     UNSET_DEVICE(device_store);
   }
 
+  inline bool UseThreadCache(size_t bucket_id) const {
+    return thread_cache_size_ &&
+           BucketingStrategy::RoundAllocSizeForBucket(bucket_id) <= kThreadCacheMaxChunkSize;
+  }
+
+  /*!
+   * \brief Returns the cache of the calling thread, creating it on the first use.
+   */
+  PoolThreadCache *ThreadCache() {
+    static thread_local PoolThreadCacheHolder holder;
+    for (auto &&cache : holder.caches) {
+      if (cache.first == id_)
+        return cache.second.get();
+    }
+
+    auto cache = std::make_shared<PoolThreadCache>();
+    {
+      std::lock_guard<std::mutex> lock(Storage::Get()->GetMutex(dev_type_));
+      // Take this opportunity to reclaim the chunks of the threads which have exited
+      DrainThreadCachesNoLock();
+      thread_caches_.push_back(cache);
+    }
+    holder.caches.emplace_back(id_, cache);
+    return cache.get();
+  }
+
+  /*!
+   * \brief Moves all chunks of the thread cache into the shared pool.
+   *  The storage mutex must be held by the caller.
+   * \return whether the owner of the cache has exited.
+   */
+  bool DrainThreadCacheNoLock(PoolThreadCache *cache) {
+    std::lock_guard<std::mutex> lock(cache->mutex);
+    for (auto &&magazine : cache->magazines) {
+      for (auto dptr : magazine.second)
+        StoringMethod::InsertInCache(magazine.first, dptr);
+      magazine.second.clear();
+    }
+    return cache->orphaned;
+  }
+
+  void DrainThreadCachesNoLock() {
+    auto it = thread_caches_.begin();
+    while (it != thread_caches_.end()) {
+      if (DrainThreadCacheNoLock(it->get()))
+        it = thread_caches_.erase(it);
+      else
+        ++it;
+    }
+  }
+
+  /*!
+   * \brief Reports the statistics accumulated by the thread cache to the profiler.
+   *  The cache mutex must be held by the caller.
+   */
+  void SyncThreadCacheStatsNoLock(PoolThreadCache *cache) {
+    profiler::DeviceStorageProfiler::Get()->OnThreadCacheSync(contextHelper_->initilal_context(),
+                                                              cache->hits, cache->misses,
+                                                              cache->flushed);
+    cache->hits = cache->misses = cache->flushed = 0;
+  }
+
   bool MemoryIsAvalable(size_t roundSize) const {
     const auto free = contextHelper_->freeMemorySize();
     return free > roundSize && memory_allocation_limit_ <= free - roundSize;
@@ -161,12 +266,100 @@ class PooledStorageManager : public StorageManager,
   size_t memory_allocation_limit_ = 0;
   // Pointer to the Helper, supporting some context-specific operations in GPU/CPU/CPUPinned context
   std::unique_ptr<ContextHelper> contextHelper_;
+  // maximal number of chunks of one bucket kept in the cache of each thread
+  size_t thread_cache_size_ = 0;
+  // chunks larger than this are always returned to the shared pool
+  static constexpr size_t kThreadCacheMaxChunkSize = 1 << 20;
+  // caches of all threads which used this storage manager, guarded by the storage mutex
+  std::vector<std::shared_ptr<PoolThreadCache>> thread_caches_;
+  // unique id of this storage manager, used to find its cache in thread local storage
+  const uint64_t id_ = NextId();
+
+  static uint64_t NextId() {
+    static std::atomic<uint64_t> counter(0);
+    return counter++;
+  }
 };
 
 template<typename BucketingStrategy, typename StoringMethod>
 void PooledStorageManager<BucketingStrategy, StoringMethod>::Alloc(Storage::Handle* handle) {
-  std::lock_guard<std::mutex> lock(Storage::Get()->GetMutex(dev_type_));
   const auto bucket_id = BucketingStrategy::get_bucket(handle->size);
+  if (!UseThreadCache(bucket_id)) {
+    std::lock_guard<std::mutex> lock(Storage::Get()->GetMutex(dev_type_));
+    AllocNoLock(handle, bucket_id);
+    return;
+  }
+
+  auto *cache = ThreadCache();
+  {
+    std::lock_guard<std::mutex> lock(cache->mutex);
+    auto &&magazine = cache->magazines[bucket_id];
+    if (!magazine.empty()) {
+      handle->dptr = magazine.back();
+      magazine.pop_back();
+      ++cache->hits;
+      return;
+    }
+    ++cache->misses;
+  }
+
+  // The magazine is empty: serve the request from the shared pool and move
+  // up to half of the magazine capacity of the same bucket into this thread.
+  std::vector<void*> refill;
+  {
+    std::lock_guard<std::mutex> lock(Storage::Get()->GetMutex(dev_type_));
+    AllocNoLock(handle, bucket_id);
+    auto reuse_pool = StoringMethod::GetMemStorage(bucket_id);
+    if (reuse_pool) {
+      const size_t num = std::min(reuse_pool->size(),
+                                  std::max<size_t>(thread_cache_size_ / 2, 1));
+      refill.assign(reuse_pool->end() - num, reuse_pool->end());
+      reuse_pool->resize(reuse_pool->size() - num);
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(cache->mutex);
+  auto &&magazine = cache->magazines[bucket_id];
+  magazine.insert(magazine.end(), refill.begin(), refill.end());
+  SyncThreadCacheStatsNoLock(cache);
+}
+
+template<typename BucketingStrategy, typename StoringMethod>
+void PooledStorageManager<BucketingStrategy, StoringMethod>::Free(Storage::Handle handle) {
+  const auto bucket_id = BucketingStrategy::get_bucket(handle.size);
+  if (!UseThreadCache(bucket_id)) {
+    // Insert returned memory in cache
+    std::lock_guard<std::mutex> lock(Storage::Get()->GetMutex(dev_type_));
+    StoringMethod::InsertInCache(bucket_id, handle.dptr);
+    return;
+  }
+
+  auto *cache = ThreadCache();
+  std::vector<void*> overflow;
+  {
+    std::lock_guard<std::mutex> lock(cache->mutex);
+    auto &&magazine = cache->magazines[bucket_id];
+    if (magazine.size() >= thread_cache_size_) {
+      // Rebalance: the oldest half of the magazine goes back to the shared pool
+      const size_t num = std::max<size_t>(thread_cache_size_ / 2, 1);
+      overflow.assign(magazine.begin(), magazine.begin() + num);
+      magazine.erase(magazine.begin(), magazine.begin() + num);
+      cache->flushed += num;
+      SyncThreadCacheStatsNoLock(cache);
+    }
+    magazine.push_back(handle.dptr);
+  }
+
+  if (!overflow.empty()) {
+    std::lock_guard<std::mutex> lock(Storage::Get()->GetMutex(dev_type_));
+    for (auto dptr : overflow)
+      StoringMethod::InsertInCache(bucket_id, dptr);
+  }
+}
+
+template<typename BucketingStrategy, typename StoringMethod>
+void PooledStorageManager<BucketingStrategy, StoringMethod>::AllocNoLock(Storage::Handle* handle,
+                                                                         size_t bucket_id) {
   size_t roundSize = 0;
   auto reuse_pool = StoringMethod::GetMemStorage(bucket_id);
   if (!reuse_pool) {
@@ -29,6 +29,7 @@
 #include "./gpu_device_storage.h"
 #include "./pinned_memory_storage.h"
 #include "../common/lazy_alloc_array.h"
+#include "../common/numa.h"
 #include "../profiler/storage_profiler.h"
 
 namespace mxnet {
@@ -47,10 +48,17 @@ class StorageImpl : public Storage {
   ~StorageImpl() override = default;
 
  private:
+  // CPU memory has one manager per NUMA node when it is placed on the nodes
+  static int storage_manager_id(const Context &ctx) {
+    const auto numa = common::NumaTopology::Get();
+    if (ctx.dev_type == Context::kCPU && numa->enabled()) return numa->NodeOf(ctx);
+    return ctx.real_dev_id();
+  }
+
   std::shared_ptr<StorageManager> storage_manager(const Context &ctx) {
     auto &&device = storage_managers_.at(ctx.dev_type);
     std::shared_ptr<StorageManager> manager = device.Get(
-      ctx.real_dev_id(), []() {
+      storage_manager_id(ctx), []() {
       LOG(FATAL) << "Cannot Free space to a device you have not allocated";
       return nullptr;
       });
@@ -60,7 +68,7 @@ class StorageImpl : public Storage {
   static constexpr size_t kMaxNumberOfDevices = Context::kMaxDevType + 1;
   // internal storage managers
   std::array<common::LazyAllocArray<StorageManager>, kMaxNumberOfDevices> storage_managers_;
-  profiler::DeviceStorageProfiler profiler_;
+  profiler::DeviceStorageProfiler *profiler_ = profiler::DeviceStorageProfiler::Get();
 };  // struct Storage::Impl
 
 StorageManager *CreateStorageManager(const Context &ctx, const char *context,
@@ -100,7 +108,7 @@ void StorageImpl::Alloc(Storage::Handle *handle) {
   // space already recycled, ignore request
   auto &&device = storage_managers_.at(handle->ctx.dev_type);
   std::shared_ptr<StorageManager> manager = device.Get(
-    handle->ctx.real_dev_id(), [handle]() {
+    storage_manager_id(handle->ctx), [handle]() {
     const auto dev_type = handle->ctx.dev_type;
     int num_gpu_device = 0;
 #if MXNET_USE_CUDA
@@ -202,7 +210,7 @@ void StorageImpl::Alloc(Storage::Handle *handle) {
   });
 
   manager->Alloc(handle);
-  profiler_.OnAlloc(*handle);
+  profiler_->OnAlloc(*handle);
 }
 
 void StorageImpl::Free(Storage::Handle handle) {
@@ -211,7 +219,7 @@ void StorageImpl::Free(Storage::Handle handle) {
   if (handle.dptr == nullptr) return;
 
   storage_manager(handle.ctx)->Free(handle);
-  profiler_.OnFree(handle);
+  profiler_->OnFree(handle);
 }
 
 void StorageImpl::DirectFree(Storage::Handle handle) {
@@ -220,7 +228,7 @@ void StorageImpl::DirectFree(Storage::Handle handle) {
   if (handle.dptr == nullptr) return;
 
   storage_manager(handle.ctx)->DirectFree(handle);
-  profiler_.OnFree(handle);
+  profiler_->OnFree(handle);
 }
 
 void StorageImpl::SharedIncrementRefCount(Storage::Handle handle) {
@@ -238,12 +246,13 @@ void StorageImpl::SharedIncrementRefCount(Storage::Handle handle) {
 }
 
 const std::string env_var_name(const char* dev_type, env_var_type type) {
-  static const std::array<std::string, 5> name = {
+  static const std::array<std::string, 6> name = {
                         "MEM_POOL_TYPE",
                         "POOL_PAGE_SIZE",
                         "MEM_LARGE_ALLOC_ROUND_SIZE",
                         "MEM_POOL_ROUND_LINEAR_CUTOFF",
                         "MEM_POOL_RESERVE",
+                        "MEM_POOL_THREAD_CACHE_SIZE",
                         };
 
   return std::string("MXNET_") + dev_type + "_" + name[type];
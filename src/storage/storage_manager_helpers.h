@@ -42,6 +42,7 @@ typedef  mxnet::common::cuda::DeviceStore CudaDeviceStore;
 #endif  // _WIN32
 
 #include <tuple>
+#include "../common/numa.h"
 #include "../common/utils.h"
 
 namespace mxnet {
@@ -111,7 +112,8 @@ class ContextHelperCPU : public ContextHelper {
   }
 
   int Malloc(void **ppNtr, size_t size) const override {
-    bool success = mxnet::common::AlignedMemAlloc(ppNtr, size, alignment_);
+    bool success = common::NumaTopology::Get()->AlignedMemAlloc(ppNtr, size, alignment_,
+                                                                initilal_context());
     return success ? 0 : -1;
   }
 
@@ -0,0 +1,97 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file object_pool_test.cc
+ * \brief Tests objects created and deleted by different threads
+*/
+#include <gtest/gtest.h>
+#include <dmlc/timer.h>
+#include <set>
+#include <thread>
+#include <vector>
+#include "../../src/common/object_pool.h"
+#include "../include/test_util.h"
+
+namespace {
+
+struct PooledObject {
+  explicit PooledObject(int id) : id(id) {}
+  int id;
+  char payload[60];
+};
+
+using Pool = mxnet::common::ObjectPool<PooledObject>;
+
+}  // namespace
+
+TEST(ObjectPool, CrossThreadDelete) {
+  const int num_threads = 4;
+  const int num_objects = 10000;
+  std::vector<std::vector<PooledObject*>> objects(num_threads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&objects, t]() {
+      for (int i = 0; i < num_objects; ++i) {
+        objects[t].push_back(Pool::Get()->New(t * num_objects + i));
+      }
+    });
+  }
+  for (auto &thread : threads) thread.join();
+  threads.clear();
+
+  std::set<PooledObject*> distinct;
+  for (const auto &list : objects) distinct.insert(list.begin(), list.end());
+  EXPECT_EQ(distinct.size(), static_cast<size_t>(num_threads * num_objects));
+
+  // every thread deletes the objects created by its neighbour
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&objects, t]() {
+      const int owner = (t + 1) % num_threads;
+      for (int i = 0; i < num_objects; ++i) {
+        PooledObject *obj = objects[owner][i];
+        EXPECT_EQ(obj->id, owner * num_objects + i);
+        Pool::Get()->Delete(obj);
+      }
+    });
+  }
+  for (auto &thread : threads) thread.join();
+}
+
+TEST(ObjectPool, Throughput) {
+  const int num_threads = 4;
+  const int num_iters = mxnet::test::performance_run ? 10000000 : 100000;
+  std::vector<std::thread> threads;
+  const double start = dmlc::GetTime();
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([num_iters]() {
+      std::vector<PooledObject*> live(16);
+      for (int i = 0; i < num_iters; ++i) {
+        PooledObject *&slot = live[i % live.size()];
+        if (slot != nullptr) Pool::Get()->Delete(slot);
+        slot = Pool::Get()->New(i);
+      }
+      for (auto obj : live) Pool::Get()->Delete(obj);
+    });
+  }
+  for (auto &thread : threads) thread.join();
+  const double elapsed = dmlc::GetTime() - start;
+  LOG(INFO) << num_threads << " threads: "
+            << num_threads * num_iters / elapsed / 1e6 << "M New/Delete per second";
+}
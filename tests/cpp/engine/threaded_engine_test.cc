@@ -36,6 +36,7 @@
 #include <chrono>
 #include <vector>
 #include <random>
+#include <memory>
 
 #include "../src/engine/engine_impl.h"
 #include "../include/test_util.h"
@@ -180,6 +181,45 @@ TEST(Engine, RandSumExpr) {
   LOG(INFO) << "ThreadedEnginePerDevice\t" << t[3] << " sec";
 }
 
+/**
+ * measure the scheduling overhead per operation of the threaded engine,
+ * with and without work stealing between the CPU workers
+ */
+TEST(Engine, PushAsyncOverhead) {
+  const int num_ops = mxnet::test::performance_run ? 4000000 : 40000;
+  const int num_chains = 64;
+  const char *modes[] = {"0", "1"};
+  for (const char *mode : modes) {
+    setenv("MXNET_CPU_WORKER_WORK_STEALING", mode, 1);
+    std::unique_ptr<mxnet::Engine> engine(mxnet::engine::CreateThreadedEnginePerDevice());
+    std::vector<mxnet::Engine::VarHandle> vars;
+    for (int i = 0; i < num_chains; ++i) {
+      vars.push_back(engine->NewVariable());
+    }
+    std::vector<int> counters(num_chains, 0);
+    double t = dmlc::GetTime();
+    for (int i = 0; i < num_ops; ++i) {
+      const int chain = i % num_chains;
+      int *counter = &counters[chain];
+      engine->PushAsync([counter](mxnet::RunContext, mxnet::Engine::CallbackOnComplete cb) {
+                          ++*counter;
+                          cb();
+                        }, mxnet::Context::CPU(), {}, {vars[chain]});
+    }
+    engine->WaitForAll();
+    t = dmlc::GetTime() - t;
+    for (int i = 0; i < num_chains; ++i) {
+      EXPECT_EQ(counters[i], num_ops / num_chains + (i < num_ops % num_chains ? 1 : 0));
+      engine->DeleteVariable([](mxnet::RunContext) {}, mxnet::Context::CPU(), vars[i]);
+    }
+    engine->WaitForAll();
+    LOG(INFO) << "ThreadedEnginePerDevice, work stealing " << mode << ": "
+              << num_ops << " ops in " << t << " sec, "
+              << t * 1e9 / num_ops << " ns/op";
+  }
+  unsetenv("MXNET_CPU_WORKER_WORK_STEALING");
+}
+
 void Foo(mxnet::RunContext, int i) { printf("The fox says %d\n", i); }
 
 void FooAsyncFunc(void*, void* cb_ptr, void* param) {
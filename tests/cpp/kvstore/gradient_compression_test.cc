@@ -0,0 +1,156 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file gradient_compression_test.cc
+ * \brief cpu quantize and dequantize kernels of gradient compression
+*/
+
+#include <gtest/gtest.h>
+#include <dmlc/timer.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+#include "../src/kvstore/gradient_compression-inl.h"
+#include "test_util.h"
+
+using mxnet::kvstore::CompressionType;
+
+namespace {
+
+mshadow::Stream<mshadow::cpu> *const cpu_stream = nullptr;
+
+struct CompressionBuffers {
+  CompressionBuffers(size_t size, size_t factor)
+      : grad(size), residual(size, 0.f), compressed((size + factor - 1) / factor),
+        dequantized(size) {}
+
+  std::vector<mxnet::TBlob> QuantizeInputs() {
+    return {Blob(&grad), Blob(&residual), Blob(&compressed)};
+  }
+
+  std::vector<mxnet::TBlob> DequantizeInputs() {
+    return {Blob(&compressed), Blob(&dequantized)};
+  }
+
+  static mxnet::TBlob Blob(std::vector<float> *v) {
+    return mxnet::TBlob(v->data(), mxnet::TShape({static_cast<int64_t>(v->size())}),
+                        mshadow::cpu::kDevMask);
+  }
+
+  std::vector<float> grad;
+  std::vector<float> residual;
+  std::vector<float> compressed;
+  std::vector<float> dequantized;
+};
+
+void FillRandom(std::vector<float> *v, unsigned seed) {
+  std::mt19937 gen(seed);
+  std::normal_distribution<float> dist(0.f, 1.f);
+  for (auto &x : *v) x = dist(gen);
+}
+
+// error feedback: nothing is lost, what is not sent stays in the residual
+void CheckErrorFeedback(CompressionType type, size_t size, size_t factor,
+                        float threshold, int block_size) {
+  CompressionBuffers buf(size, factor);
+  for (unsigned step = 0; step < 3; ++step) {
+    FillRandom(&buf.grad, step);
+    const std::vector<float> old_residual = buf.residual;
+    mxnet::kvstore::QuantizeImpl(cpu_stream, buf.QuantizeInputs(), type, threshold, block_size);
+    mxnet::kvstore::DequantizeImpl(cpu_stream, buf.DequantizeInputs(), type, threshold,
+                                   block_size);
+    for (size_t i = 0; i < size; ++i) {
+      EXPECT_NEAR(buf.dequantized[i] + buf.residual[i], buf.grad[i] + old_residual[i], 1e-5);
+    }
+  }
+}
+
+}  // namespace
+
+TEST(GradientCompression, OneBit) {
+  const float threshold = 0.5f;
+  CompressionBuffers buf(100, 32);
+  FillRandom(&buf.grad, 0);
+  mxnet::kvstore::Quantize1BitImpl(cpu_stream, buf.QuantizeInputs(), threshold);
+  mxnet::kvstore::Dequantize1BitImpl(cpu_stream, buf.DequantizeInputs(), threshold);
+  for (size_t i = 0; i < buf.grad.size(); ++i) {
+    EXPECT_EQ(buf.dequantized[i], buf.grad[i] >= 0.f ? threshold : -threshold);
+  }
+  CheckErrorFeedback(CompressionType::kOneBit, 1000, 32, threshold, 0);
+}
+
+TEST(GradientCompression, TopK) {
+  const int block_size = 16;
+  CompressionBuffers buf(100, block_size);
+  FillRandom(&buf.grad, 0);
+  mxnet::kvstore::QuantizeTopKImpl(cpu_stream, buf.QuantizeInputs(), block_size);
+  mxnet::kvstore::DequantizeTopKImpl(cpu_stream, buf.DequantizeInputs(), block_size);
+  for (size_t start = 0; start < buf.grad.size(); start += block_size) {
+    const size_t end = std::min(start + block_size, buf.grad.size());
+    size_t top = start;
+    for (size_t i = start; i < end; ++i) {
+      if (std::fabs(buf.grad[i]) > std::fabs(buf.grad[top])) top = i;
+    }
+    for (size_t i = start; i < end; ++i) {
+      if (i == top) {
+        EXPECT_NEAR(buf.dequantized[i], buf.grad[i], 1e-3 * std::fabs(buf.grad[i]));
+      } else {
+        EXPECT_EQ(buf.dequantized[i], 0.f);
+      }
+    }
+  }
+  CheckErrorFeedback(CompressionType::kTopK, 1000, block_size, 0.f, block_size);
+}
+
+TEST(GradientCompression, Throughput) {
+  const size_t size = mxnet::test::performance_run ? (64 << 20) : (1 << 20);
+  const int block_size = 64;
+  struct Config {
+    std::string name;
+    CompressionType type;
+    size_t factor;
+  };
+  const Config configs[] = {{"2bit", CompressionType::kTwoBit, 16},
+                            {"1bit", CompressionType::kOneBit, 32},
+                            {"topk", CompressionType::kTopK, block_size}};
+  for (const Config &config : configs) {
+    CompressionBuffers buf(size, config.factor);
+    FillRandom(&buf.grad, 0);
+    const int repeat = 5;
+    double t = dmlc::GetTime();
+    for (int i = 0; i < repeat; ++i) {
+      mxnet::kvstore::QuantizeImpl(cpu_stream, buf.QuantizeInputs(), config.type, 0.5f,
+                                   block_size);
+    }
+    const double quantize_time = (dmlc::GetTime() - t) / repeat;
+    t = dmlc::GetTime();
+    for (int i = 0; i < repeat; ++i) {
+      mxnet::kvstore::DequantizeImpl(cpu_stream, buf.DequantizeInputs(), config.type, 0.5f,
+                                     block_size);
+    }
+    const double dequantize_time = (dmlc::GetTime() - t) / repeat;
+    const double gbytes = size * sizeof(float) / 1e9;
+    LOG(INFO) << config.name << " compression of " << size << " floats: quantize "
+              << gbytes / quantize_time << " GB/s, dequantize "
+              << gbytes / dequantize_time << " GB/s";
+  }
+}
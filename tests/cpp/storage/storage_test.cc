@@ -69,7 +69,6 @@ TEST(Storage, CPU_MemAlign) {
   }
 }
 
-
 #if MXNET_USE_CUDA
 TEST(Storage_GPU, Basic_GPU) {
   if (mxnet::test::unitTestsWithCuda) {
@@ -0,0 +1,108 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file storage_thread_cache_test.cc
+ * \brief tests of the per-thread caches of the cpu memory pool
+ * \note The storage manager of a device reads its configuration only once, when the
+ *  device allocates for the first time. These tests are built as a separate executable,
+ *  so that they are the first ones to allocate cpu memory in the process.
+*/
+#include <gtest/gtest.h>
+#include <dmlc/logging.h>
+#include <mxnet/storage.h>
+#include <cstdlib>
+#include <algorithm>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include "test_util.h"
+
+TEST(Storage, CPU_MultiThreaded) {
+  setenv("MXNET_CPU_MEM_POOL_TYPE", "Naive", 1);
+  setenv("MXNET_CPU_MEM_POOL_PAGE_SIZE", "4096", 1);
+  setenv("MXNET_CPU_MEM_POOL_THREAD_CACHE_SIZE", "8", 1);
+
+  // Chunks allocated by one thread and freed by another one must travel
+  // correctly between the per-thread caches and the shared pool.
+  constexpr int kNumThreads = 8;
+  constexpr int kNumIter = 1000;
+  auto&& storage = mxnet::Storage::Get();
+  mxnet::Context context_cpu = mxnet::Context::CPU(0);
+  std::vector<std::vector<mxnet::Storage::Handle>> handles(kNumThreads);
+  std::vector<std::thread> workers;
+  for (int t = 0; t < kNumThreads; ++t) {
+    workers.emplace_back([&, t]() {
+      for (int i = 0; i < kNumIter; ++i) {
+        const size_t size = 64 << (i % 12);
+        auto handle = storage->Alloc(size, context_cpu);
+        EXPECT_EQ(handle.size, size);
+        // touch the whole chunk to catch chunks handed out twice
+        std::fill_n(static_cast<char*>(handle.dptr), size, static_cast<char>(t));
+        EXPECT_EQ(static_cast<char*>(handle.dptr)[size - 1], static_cast<char>(t));
+        if (i % 2) {
+          storage->Free(handle);
+        } else {
+          handles[t].push_back(handle);
+        }
+      }
+    });
+  }
+  for (auto& worker : workers) worker.join();
+  workers.clear();
+
+  // Only the even sizes are kept, so the chunks of this size (16 pages) are
+  // never freed by the threads which allocated them.
+  constexpr size_t kSize = 64 << 10;
+  std::unordered_set<void*> freed;
+  for (auto& thread_handles : handles) {
+    for (auto& handle : thread_handles) {
+      if (handle.size == kSize)
+        EXPECT_TRUE(freed.insert(handle.dptr).second);
+    }
+  }
+  ASSERT_FALSE(freed.empty());
+
+  // free the remaining chunks from other threads
+  for (int t = 0; t < kNumThreads; ++t) {
+    workers.emplace_back([&, t]() {
+      for (auto& handle : handles[(t + 1) % kNumThreads])
+        storage->Free(handle);
+    });
+  }
+  for (auto& worker : workers) worker.join();
+
+  // The threads which freed the chunks have exited: every chunk they kept in their
+  // caches must be back in the shared pool, so that this thread reuses all of them
+  // before any new chunk is allocated.
+  std::vector<mxnet::Storage::Handle> reused;
+  const size_t num_freed = freed.size();
+  for (size_t i = 0; i < num_freed; ++i) {
+    reused.push_back(storage->Alloc(kSize, context_cpu));
+    EXPECT_EQ(freed.erase(reused.back().dptr), 1u);
+  }
+  EXPECT_TRUE(freed.empty());
+  for (auto& handle : reused)
+    storage->Free(handle);
+  storage->ReleaseAll(context_cpu);
+
+  unsetenv("MXNET_CPU_MEM_POOL_TYPE");
+  unsetenv("MXNET_CPU_MEM_POOL_PAGE_SIZE");
+  unsetenv("MXNET_CPU_MEM_POOL_THREAD_CACHE_SIZE");
+}
@@ -199,3 +199,110 @@ def test_adamw():
     for nElem in range(6):
         run_adamw_test(nElem+1)
 
+
+
+def _multi_tensor_update(op, multi_precision, indices, grads, lrs, wds,
+                         weights, states, weights32):
+    """One call of the multi-tensor update op on the weights of indices."""
+    w = [weights[i] for i in indices]
+    arrays = [w, [grads[i] for i in indices]]
+    arrays += [[state[i] for i in indices] for state in states]
+    if multi_precision:
+        arrays.append([weights32[i] for i in indices])
+    lrs = [lrs[i] for i in indices]
+    wds = [wds[i] for i in indices]
+    mp = 'mp_' if multi_precision else ''
+    if op in ('sgd', 'sgd_mom'):
+        flat = [a for group in zip(*arrays) for a in group]
+        kwargs = {'momentum': 0.9} if op == 'sgd_mom' else {}
+        getattr(mx.nd, 'multi_{}{}_update'.format(mp, op))(
+            *flat, out=w, num_weights=len(w), lrs=lrs, wds=wds,
+            rescale_grad=0.5, clip_gradient=0.8, **kwargs)
+    elif op == 'adamw':
+        getattr(mx.nd.contrib, 'multi_{}adamw_update'.format(mp))(
+            *arrays, 0.5, lrs=lrs, wds=wds, etas=[0.9] * len(w), out=w,
+            clip_gradient=0.8)
+    else:
+        getattr(mx.nd.contrib, 'multi_{}lamb_update'.format(mp))(
+            *arrays, step_count=[3] * len(w), lrs=lrs, wds=wds, out=w,
+            rescale_grad=0.5, clip_gradient=0.8, bias_correction=True)
+
+
+@pytest.mark.parametrize('op', ['sgd', 'sgd_mom', 'adamw', 'lamb'])
+@pytest.mark.parametrize('multi_precision', [False, True])
+def test_multi_tensor_update_many_weights(op, multi_precision):
+    # more weights than the GPU kernels take at once, of very different sizes:
+    # one update of all of them must match updates of 4 weights at a time
+    ctx = mx.cpu()
+    shapes = [(1,), (3, 5)] * 30 + [(257, 129), (7, 3, 3), (20000,)] * 4
+    n = len(shapes)
+    dtype = np.float16 if multi_precision else np.float32
+    num_states = {'sgd': 0, 'sgd_mom': 1, 'adamw': 2, 'lamb': 2}[op]
+    lrs = list(np.random.uniform(0.01, 0.1, n))
+    wds = list(np.random.uniform(0, 0.01, n))
+    grads = [mx.nd.random.uniform(-1, 1, shape=s, ctx=ctx).astype(dtype) for s in shapes]
+    weights32 = [mx.nd.random.uniform(-1, 1, shape=s, ctx=ctx) for s in shapes]
+    states = [[mx.nd.random.uniform(0, 1, shape=s, ctx=ctx) for s in shapes]
+              for _ in range(num_states)]
+
+    def copy_arrays():
+        return ([w.astype(dtype) for w in weights32],
+                [[x.copy() for x in state] for state in states],
+                [w.copy() for w in weights32])
+
+    fused = copy_arrays()
+    _multi_tensor_update(op, multi_precision, range(n), grads, lrs, wds, *fused)
+    grouped = copy_arrays()
+    for begin in range(0, n, 4):
+        _multi_tensor_update(op, multi_precision, range(begin, min(begin + 4, n)),
+                             grads, lrs, wds, *grouped)
+
+    rtol, atol = (1e-3, 1e-3) if multi_precision else (1e-5, 1e-6)
+    for w_fused, w_grouped in zip(fused[0], grouped[0]):
+        assert_almost_equal(w_fused, w_grouped, rtol=rtol, atol=atol)
+    for state_fused, state_grouped in zip(fused[1], grouped[1]):
+        for s_fused, s_grouped in zip(state_fused, state_grouped):
+            assert_almost_equal(s_fused, s_grouped, rtol=1e-5, atol=1e-6)
+    if multi_precision:
+        for w_fused, w_grouped in zip(fused[2], grouped[2]):
+            assert_almost_equal(w_fused, w_grouped, rtol=1e-5, atol=1e-6)
+
+
+@pytest.mark.parametrize('optimizer', ['sgd', 'adam'])
+@pytest.mark.parametrize('wd', [0, 0.1])
+@pytest.mark.parametrize('clip_gradient', [-1, 0.05])
+def test_fused_embedding_update(optimizer, wd, clip_gradient):
+    num_rows, dim = 300, 7
+    weight = mx.nd.random.uniform(shape=(num_rows, dim))
+    # repeated indices, including a row referenced many times
+    data = mx.nd.array(np.concatenate([np.random.randint(0, num_rows, size=(40,)),
+                                       np.full((24,), 5)]).reshape((8, 8)))
+    ograd = mx.nd.random.uniform(-1, 1, shape=(8, 8, dim))
+    kwargs = {'lr': 0.1, 'wd': wd, 'rescale_grad': 0.5, 'clip_gradient': clip_gradient}
+
+    # reference: row_sparse gradient of the embedding, then the lazy update
+    ref_weight = weight.copy()
+    ref_weight.attach_grad(stype='row_sparse')
+    with mx.autograd.record():
+        out = mx.nd.Embedding(data, ref_weight, input_dim=num_rows, output_dim=dim,
+                              sparse_grad=True)
+    out.backward(ograd)
+    grad = ref_weight.grad
+    assert grad.stype == 'row_sparse'
+    assert_almost_equal(grad.indices.asnumpy(), np.unique(data.asnumpy()))
+
+    fused_weight = weight.copy()
+    if optimizer == 'sgd':
+        mx.nd.sgd_update(ref_weight, grad, out=ref_weight, lazy_update=True, **kwargs)
+        mx.nd.contrib.embedding_sgd_update(fused_weight, data, ograd, out=fused_weight,
+                                           **kwargs)
+    else:
+        ref_mean, ref_var = mx.nd.zeros_like(weight), mx.nd.ones_like(weight)
+        mean, var = ref_mean.copy(), ref_var.copy()
+        mx.nd.adam_update(ref_weight, grad, ref_mean, ref_var, out=ref_weight,
+                          lazy_update=True, **kwargs)
+        mx.nd.contrib.embedding_adam_update(fused_weight, data, ograd, mean, var,
+                                            out=fused_weight, **kwargs)
+        assert_almost_equal(mean, ref_mean, rtol=1e-5, atol=1e-6)
+        assert_almost_equal(var, ref_var, rtol=1e-5, atol=1e-6)
+    assert_almost_equal(fused_weight, ref_weight, rtol=1e-5, atol=1e-6)
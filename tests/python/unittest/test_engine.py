@@ -17,6 +17,8 @@
 
 import mxnet as mx
 import os
+import subprocess
+import sys
 from mxnet.test_utils import environment
 import pytest
 
@@ -32,6 +34,25 @@ def test_bulk():
             x += 1
     assert (x.asnumpy() == 104).all()
 
+@pytest.mark.parametrize('engine', ['ThreadedEnginePerDevice', 'NaiveEngine'])
+def test_cpu_temp_arena(engine):
+    # the arena is enabled when the library loads, so the operators run in a new process
+    script = """
+import numpy as np
+import mxnet as mx
+x = np.random.uniform(size=(4, 8, 64)).astype('float32')
+a = mx.nd.array(x)
+for _ in range(8):
+    outputs = [mx.nd.sort(a, axis=2), mx.nd.topk(a, axis=2, k=3, ret_typ='value'),
+               mx.nd.sum(a, axis=(0, 2))]
+np.testing.assert_allclose(outputs[0].asnumpy(), np.sort(x, axis=2))
+np.testing.assert_allclose(outputs[1].asnumpy(), -np.sort(-x, axis=2)[:, :, :3])
+np.testing.assert_allclose(outputs[2].asnumpy(), x.sum(axis=(0, 2)), rtol=1e-5)
+"""
+    env = dict(os.environ, MXNET_CPU_TEMP_ARENA='1', MXNET_ENGINE_TYPE=engine,
+               MXNET_CPU_WORKER_NTHREADS='4')
+    subprocess.check_call([sys.executable, '-c', script], env=env)
+
 @pytest.mark.skip(reason="OMP platform dependent")
 def test_engine_openmp_after_fork():
     """
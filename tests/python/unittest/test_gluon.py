@@ -1641,6 +1641,82 @@ def test_hybrid_static_memory_switching(static_alloc, static_shape):
         y.backward()
     mx.nd.waitall()
 
+
+@pytest.mark.parametrize('static_alloc', [False, True])
+def test_hybrid_alternating_shapes(static_alloc):
+    # plans and memory of the shapes seen before are reused when switching back
+    net = nn.HybridSequential()
+    net.add(nn.Dense(16, flatten=False, activation='relu'))
+    net.add(nn.Dense(8, flatten=False))
+    net.initialize()
+    ref_net = nn.HybridSequential()
+    ref_net.add(nn.Dense(16, flatten=False, activation='relu'))
+    ref_net.add(nn.Dense(8, flatten=False))
+    ref_net.initialize()
+    ref_net(mx.nd.ones((1, 1, 4)))
+    net(mx.nd.ones((1, 1, 4)))
+    for param, ref_param in zip(net.collect_params().values(),
+                                ref_net.collect_params().values()):
+        param.set_data(ref_param.data())
+    net.hybridize(static_alloc=static_alloc)
+
+    for length in [5, 9, 5, 9, 3, 9, 5]:
+        x = mx.nd.random.uniform(shape=(2, length, 4))
+        with mx.autograd.record():
+            y = net(x)
+        y.backward()
+        with mx.autograd.record():
+            ref_y = ref_net(x)
+        ref_y.backward()
+        assert_almost_equal(y.asnumpy(), ref_y.asnumpy(), rtol=1e-5, atol=1e-6)
+        for param, ref_param in zip(net.collect_params().values(),
+                                    ref_net.collect_params().values()):
+            assert_almost_equal(param.grad().asnumpy(), ref_param.grad().asnumpy(),
+                                rtol=1e-5, atol=1e-6)
+        assert_almost_equal(net(x).asnumpy(), ref_y.asnumpy(), rtol=1e-5, atol=1e-6)
+
+
+@pytest.mark.parametrize('static_alloc', [False, True])
+def test_hybrid_warmup(static_alloc):
+    net = nn.HybridSequential()
+    net.add(nn.Dense(16, flatten=False, activation='relu'))
+    net.add(nn.Dense(8, flatten=False))
+    net.initialize()
+    with pytest.raises(RuntimeError):
+        net.warmup(mx.nd.empty((2, 3, 4)))
+
+    lengths = [3, 5, 9]
+    xs = [mx.nd.random.uniform(shape=(2, length, 4)) for length in lengths + lengths[::-1]]
+    ref_ys = [net(x) for x in xs]
+    net.hybridize(static_alloc=static_alloc)
+    net(mx.nd.ones((2, 1, 4)))
+    net.warmup(*[mx.nd.empty((2, length, 4)) for length in lengths])
+    stats = net.plan_cache_stats()
+    assert stats['memory_bytes'] > 0
+    for x, ref_y in zip(xs, ref_ys):
+        assert_almost_equal(net(x).asnumpy(), ref_y.asnumpy(), rtol=1e-5, atol=1e-6)
+    # every warmed up signature was planned ahead of time
+    new_stats = net.plan_cache_stats()
+    assert new_stats['misses'] == stats['misses']
+    assert new_stats['hits'] == stats['hits'] + 2 * len(lengths)
+
+
+def test_hybrid_plan_cache_memory_limit():
+    net = nn.HybridSequential()
+    net.add(nn.Dense(1024, flatten=False, activation='relu'))
+    net.add(nn.Dense(8, flatten=False))
+    net.initialize()
+    net.hybridize(plan_cache_max_mb=5)
+    net(mx.nd.ones((2, 1, 4)))
+    # the hidden outputs take 2MB and 4MB, planning the second evicts the first
+    net.warmup(mx.nd.empty((2, 256, 4)), mx.nd.empty((2, 512, 4)))
+    misses = net.plan_cache_stats()['misses']
+    net(mx.nd.ones((2, 512, 4)))
+    assert net.plan_cache_stats()['misses'] == misses
+    net(mx.nd.ones((2, 256, 4)))
+    assert net.plan_cache_stats()['misses'] == misses + 1
+
+
 def test_hook():
     global hook_call_count
     hook_call_count = 0
@@ -22,6 +22,7 @@ import unittest
 import mxnet as mx
 import numpy as np
 import random
+import struct
 from mxnet import gluon
 import platform
 from mxnet.gluon.data import DataLoader
@@ -85,6 +86,24 @@ def test_recordimage_dataset_handle(prepare_record):
         assert x.shape[0] == 1 and x.shape[3] == 3
         assert y.asscalar() == i
 
+def test_record_file_dataset_handle(tmpdir):
+    idx_file = str(tmpdir.join('test.idx'))
+    rec_file = str(tmpdir.join('test.rec'))
+    record = mx.recordio.MXIndexedRecordIO(idx_file, rec_file, 'w')
+    # the magic number inside a record splits it into several parts
+    magic = struct.pack('I', 0xced7230a)
+    payloads = [b'a' * i + magic * (i % 3) + b'b' * (i % 5) for i in range(50)]
+    for i, payload in enumerate(payloads):
+        record.write_idx(i, payload)
+    record.close()
+
+    dataset = gluon.data.RecordFileDataset(rec_file).__mx_handle__()
+    assert len(dataset) == len(payloads)
+    for i in list(range(len(payloads))) + [7, 3, 49, 0]:
+        item = dataset[i]
+        data = item.tobytes() if isinstance(item, np.ndarray) else item.asnumpy().tobytes()
+        assert data == payloads[i]
+
 def _dataset_transform_fn(x, y):
     """Named transform function since lambda function cannot be pickled."""
     return x, y
@@ -550,6 +569,34 @@ def test_mx_data_loader_nopython():
     for _ in dl1:
         pass
 
+@pytest.mark.parametrize('prefetch', [1, 4])
+def test_mx_data_loader_nopython_multi_epoch(prefetch):
+    from mxnet.gluon.data.dataloader import DataLoader
+    data = np.arange(103 * 3).reshape((103, 3)).astype('float32')
+    label = np.arange(103).astype('int32')
+    dataset = gluon.data.ArrayDataset(data, label)
+    dl = DataLoader(dataset, batch_size=10, num_workers=2, last_batch='keep',
+                    shuffle=False, prefetch=prefetch, try_nopython=True)
+
+    def check_epoch(batches, num_batches=11):
+        # the prefetcher recycles its buffers, so copy each batch as it arrives
+        x = np.concatenate([b[0] for b in batches])
+        y = np.concatenate([b[1] for b in batches])
+        assert len(batches) == num_batches
+        assert np.all(x == data[:len(x)])
+        assert np.all(y == label[:len(y)])
+
+    for _ in range(3):
+        batches = [(x.asnumpy(), y.asnumpy()) for x, y in dl]
+        assert len(batches) == len(dl)
+        assert batches[-1][0].shape == (3, 3)
+        check_epoch(batches)
+    # stop in the middle of an epoch, the reset restarts from the first batch
+    it = iter(dl)
+    check_epoch([tuple(a.asnumpy() for a in next(it)) for _ in range(4)], 4)
+    dl._mx_iter._iter.reset()
+    check_epoch([(x.asnumpy(), y.asnumpy()) for x, y in dl])
+
 def test_batchify_stack():
     a = np.array([[1, 2, 3, 4], [5, 6, 7, 8]])
     b = np.array([[5, 6, 7, 8], [1, 2, 3, 4]])
@@ -409,6 +409,135 @@ def test_LibSVMIter(tmpdir):
     assertRaises(MXNetError, check_libSVMIter_exception)
 
 
+def test_LibSVMIter_preprocess_threads(tmpdir):
+    num_rows, num_cols, batch_size = 1000, 50, 64
+    rng = np.random.RandomState(0)
+    dense = np.where(rng.uniform(size=(num_rows, num_cols)) < 0.1,
+                     rng.uniform(-1, 1, size=(num_rows, num_cols)), 0).astype(np.float32)
+    labels = np.arange(num_rows, dtype=np.float32)
+    data_path = os.path.join(str(tmpdir), 'data.t')
+    with open(data_path, 'w') as fout:
+        for i in range(num_rows):
+            features = ['%d:%r' % (j, float(dense[i, j])) for j in np.nonzero(dense[i])[0]]
+            fout.write(' '.join(['%d' % labels[i]] + features) + '\n')
+    # the last batch wraps around to the first rows
+    num_batches = (num_rows + batch_size - 1) // batch_size
+    order = np.arange(num_batches * batch_size) % num_rows
+    for threads in [1, 4]:
+        data_iter = mx.io.LibSVMIter(data_libsvm=data_path, data_shape=(num_cols,),
+                                     batch_size=batch_size, preprocess_threads=threads)
+        num_batch = 0
+        for batch in data_iter:
+            rows = order[num_batch * batch_size:(num_batch + 1) * batch_size]
+            batch.data[0].check_format(True)
+            assert_almost_equal(batch.data[0].asnumpy(), dense[rows])
+            assert_almost_equal(batch.label[0].asnumpy(), labels[rows])
+            num_batch += 1
+        assert num_batch == num_batches
+
+
+def test_CSVIter_preprocess_threads(tmpdir):
+    num_rows, batch_size = 1000, 64
+    data = np.arange(num_rows * 6).reshape(num_rows, 2, 3)
+    label = -np.arange(num_rows).reshape(num_rows, 1)
+    data_path = os.path.join(str(tmpdir), 'data.csv')
+    label_path = os.path.join(str(tmpdir), 'label.csv')
+    np.savetxt(data_path, data.reshape(num_rows, -1), fmt='%d', delimiter=',')
+    np.savetxt(label_path, label, fmt='%d', delimiter=',')
+    num_batches = (num_rows + batch_size - 1) // batch_size
+    for dtype in ['int32', 'int64', 'float32']:
+        for threads in [1, 4]:
+            data_iter = mx.io.CSVIter(data_csv=data_path, data_shape=(2, 3),
+                                      label_csv=label_path, batch_size=batch_size,
+                                      round_batch=False, dtype=dtype,
+                                      preprocess_threads=threads)
+            for epoch in range(2):
+                data_iter.reset()
+                num_batch = 0
+                for batch in data_iter:
+                    begin = num_batch * batch_size
+                    num_valid = batch_size - batch.pad
+                    assert num_valid == min(batch_size, num_rows - begin)
+                    assert batch.data[0].dtype == np.dtype(dtype)
+                    assert_almost_equal(batch.data[0].asnumpy()[:num_valid],
+                                        data[begin:begin + num_valid])
+                    assert_almost_equal(batch.label[0].asnumpy()[:num_valid],
+                                        label[begin:begin + num_valid])
+                    num_batch += 1
+                assert num_batch == num_batches
+
+
+def test_CSVIter_cache(tmpdir):
+    num_rows, batch_size = 100, 16
+    data = np.arange(num_rows * 3, dtype=np.float32).reshape(num_rows, 3)
+    data_path = os.path.join(str(tmpdir), 'data.csv')
+    cache_path = data_path + '.cache'
+    np.savetxt(data_path, data, fmt='%d', delimiter=',')
+
+    def read_rows(data_iter):
+        rows = []
+        for batch in data_iter:
+            rows.append(batch.data[0].asnumpy()[:batch_size - batch.pad])
+        data_iter.reset()
+        return np.concatenate(rows)
+
+    data_iter = mx.io.CSVIter(data_csv=data_path, data_shape=(3,), batch_size=batch_size,
+                              round_batch=False, cache_file=cache_path)
+    # the first pass parses the text and writes the cache, the second reads the cache
+    assert_almost_equal(read_rows(data_iter), data)
+    assert os.path.exists(cache_path)
+    assert_almost_equal(read_rows(data_iter), data)
+    os.remove(data_path)
+    data_iter = mx.io.CSVIter(data_csv=data_path, data_shape=(3,), batch_size=batch_size,
+                              round_batch=False, cache_file=cache_path)
+    assert_almost_equal(read_rows(data_iter), data)
+    # other parameters than those of the cache are rejected
+    assertRaises(MXNetError, mx.io.CSVIter, data_csv=data_path, data_shape=(3,),
+                 batch_size=batch_size, dtype='int32', cache_file=cache_path)
+    # the blocks of the cache are shuffled, the rows of a block keep their order
+    data_iter = mx.io.CSVIter(data_csv=data_path, data_shape=(3,), batch_size=batch_size,
+                              round_batch=False, cache_file=cache_path, cache_shuffle=True)
+    shuffled = False
+    for epoch in range(2):
+        rows = read_rows(data_iter)
+        assert_almost_equal(np.sort(rows, axis=0), data)
+        num_blocks = (num_rows + batch_size - 1) // batch_size
+        assert np.sum(np.diff(rows[:, 0]) != 3) <= num_blocks - 1
+        shuffled = shuffled or not np.array_equal(rows, data)
+    assert shuffled
+
+
+def test_LibSVMIter_cache(tmpdir):
+    data_path = os.path.join(str(tmpdir), 'data.t')
+    cache_path = data_path + '.cache'
+    with open(data_path, 'w') as fout:
+        fout.write('1.0 0:0.5 2:1.2\n')
+        fout.write('-2.0\n')
+        fout.write('-3.0 0:0.6 1:2.4 2:1.2\n')
+        fout.write('4 2:-1.2\n')
+    # the passes over the cache continue the wrapped last batch like those over the text
+    expected = []
+    data_iter = mx.io.LibSVMIter(data_libsvm=data_path, data_shape=(3,), batch_size=3)
+    for epoch in range(3):
+        expected.append([(batch.data[0].asnumpy(), batch.label[0].asnumpy())
+                         for batch in data_iter])
+        data_iter.reset()
+    data_iter = mx.io.LibSVMIter(data_libsvm=data_path, data_shape=(3,), batch_size=3,
+                                 cache_file=cache_path)
+    for epoch in range(3):
+        num_batches = 0
+        for batch, (data, label) in zip(data_iter, expected[epoch]):
+            batch.data[0].check_format(True)
+            assert_almost_equal(batch.data[0].asnumpy(), data)
+            assert_almost_equal(batch.label[0].asnumpy(), label)
+            num_batches += 1
+        assert num_batches == len(expected[epoch])
+        data_iter.reset()
+        if epoch == 0:
+            assert os.path.exists(cache_path)
+            os.remove(data_path)
+
+
 def test_DataBatch():
     from mxnet.io import DataBatch
     import re
@@ -449,6 +578,50 @@ def test_CSVIter(tmpdir):
     for dtype in ['int32', 'int64', 'float32']:
         check_CSVIter_synthetic(dtype=dtype)
 
+def test_ImageRecordIter_normalize_dtypes(cifar10):
+    def make_iter(**kwargs):
+        return mx.io.ImageRecordIter(
+            path_imgrec=os.path.join(cifar10, 'cifar', 'train.rec'),
+            shuffle=False, data_shape=(3, 28, 28), batch_size=16, mirror=True,
+            **kwargs)
+
+    def first_batches(data_iter, num_batches=4):
+        return [batch.data[0].asnumpy().astype(np.float32)
+                for _, batch in zip(range(num_batches), data_iter)]
+
+    norm = dict(mean_r=123.68, mean_g=116.28, mean_b=103.53, std_r=58.4, std_g=57.1, std_b=57.4)
+    # the unnormalized float32 images are the uint8 images
+    for pixels, images in zip(first_batches(make_iter(dtype='uint8')),
+                              first_batches(make_iter(dtype='float32'))):
+        assert_almost_equal(pixels, images)
+    # float16 images are the float32 images up to rounding
+    for images16, images32 in zip(first_batches(make_iter(dtype='float16', **norm)),
+                                  first_batches(make_iter(dtype='float32', **norm))):
+        assert_almost_equal(images16, images32, rtol=1e-3, atol=1e-2)
+    # int8 images are the uint8 images minus the rounded mean
+    mean = np.round([norm['mean_r'], norm['mean_g'], norm['mean_b']]).reshape(1, 3, 1, 1)
+    for pixels, images in zip(first_batches(make_iter(dtype='uint8')),
+                              first_batches(make_iter(dtype='int8', mean_r=norm['mean_r'],
+                                                      mean_g=norm['mean_g'],
+                                                      mean_b=norm['mean_b']))):
+        assert_almost_equal(np.clip(pixels - mean, -128, 127), images)
+
+
+def test_ImageRecordIter_scaled_decode(cifar10):
+    def first_batches(**kwargs):
+        data_iter = mx.io.ImageRecordIter(
+            path_imgrec=os.path.join(cifar10, 'cifar', 'train.rec'),
+            shuffle=False, data_shape=(3, 16, 16), batch_size=16, resize=16, dtype='uint8',
+            **kwargs)
+        return [batch.data[0].asnumpy().astype(np.float32)
+                for _, batch in zip(range(4), data_iter)]
+
+    # decoding at a reduced scale only changes the resampling of the images
+    for scaled, full in zip(first_batches(scaled_decode=True), first_batches()):
+        assert scaled.shape == full.shape
+        assert np.mean(np.abs(scaled - full)) < 16
+
+
 def test_ImageRecordIter_seed_augmentation(cifar10):
     seed_aug = 3
 
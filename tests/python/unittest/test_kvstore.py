@@ -170,6 +170,47 @@ def test_aggregator():
         check_aggregator(init_kv_with_str(), 'a', str_keys, stype)
 
 
+@pytest.mark.parametrize('num_devs', [2, 5, 9, 17])
+@pytest.mark.parametrize('size', [7, 4097, 1000003])
+def test_dense_aggregator(num_devs, size):
+    # more than 4 sources are summed as a tree, big arrays in parallel by blocks
+    devs = [mx.Context('cpu', i) for i in range(num_devs)]
+    vals = [mx.nd.random.uniform(shape=(size,), ctx=d) for d in devs]
+    expected = np.sum([v.asnumpy() for v in vals], axis=0)
+    kv = mx.kv.create()
+    kv.init(3, mx.nd.zeros((size,)))
+    outs = [mx.nd.empty((size,), d) for d in devs]
+    kv.push(3, vals)
+    kv.pull(3, out=outs)
+    for out in outs:
+        assert_almost_equal(out, expected, rtol=1e-5, atol=1e-5)
+
+def test_compressed_aggregator():
+    """aggregate compressed gradients on muliple devices"""
+    num_devs = 4
+    devs = [mx.Context('cpu', i) for i in range(num_devs)]
+
+    kv = init_kv()
+    kv.set_gradient_compression({'type': '1bit', 'threshold': 0.5})
+    # values are sent as 0.5, the rest stays in the residual
+    kv.push(3, [mx.nd.ones(shape, d) for d in devs])
+    out = mx.nd.empty(shape)
+    kv.pull(3, out=out)
+    check_diff_to_scalar(out, num_devs * 0.5)
+    kv.push(3, [mx.nd.ones(shape, d) * -2 for d in devs])
+    kv.pull(3, out=out)
+    check_diff_to_scalar(out, num_devs * -0.5)
+
+    kv = init_kv()
+    kv.set_gradient_compression({'type': 'topk', 'block_size': 4})
+    vals = [mx.nd.array(np.tile([1, -3, 2, 0], shape[0] * shape[1] // 4).reshape(shape), d)
+            for d in devs]
+    kv.push(3, vals)
+    kv.pull(3, out=out)
+    expected = np.tile([0, -3, 0, 0], shape[0] * shape[1] // 4).reshape(shape) * num_devs
+    assert_almost_equal(out.asnumpy(), expected)
+
+
 @pytest.mark.skip(reason='Skipped due to segfault. Tracked in #18098')
 def test_sparse_aggregator():
     """aggregate sparse ndarray on muliple devices"""
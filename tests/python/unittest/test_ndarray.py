@@ -17,17 +17,20 @@
 
 import mxnet as mx
 import numpy as np
+import ctypes
 from distutils.version import LooseVersion
 from itertools import permutations, combinations_with_replacement
 import os
 import pickle as pkl
 import random
 import functools
+import subprocess
+import sys
 import pytest
 from common import assertRaises, TemporaryDirectory
 from mxnet.test_utils import almost_equal
 from mxnet.test_utils import assert_almost_equal, assert_exception
-from mxnet.test_utils import default_context
+from mxnet.test_utils import default_context, environment
 from mxnet.test_utils import np_reduce
 from mxnet.test_utils import same
 from mxnet.test_utils import random_sample, rand_shape_nd, random_arrays
@@ -423,6 +426,43 @@ def test_ndarray_saveload(save_fn):
     os.remove(fname)
 
 
+@pytest.mark.parametrize('save_fn', [mx.nd.save, mx.npx.savez])
+def test_ndarray_saveload_mmap(tmp_path, save_fn):
+    fname = str(tmp_path / 'tmp_mmap')
+    data = {'arr_%d' % i: random_ndarray(np.random.randint(1, 5)) for i in range(10)}
+    data['float16'] = mx.nd.array(np.random.uniform(size=(3, 5)), dtype='float16')
+    if save_fn is mx.nd.save:
+        save_fn(fname, data)
+    else:
+        save_fn(fname, **data)
+    with environment('MXNET_NDARRAY_LOAD_MMAP', '1'):
+        loaded = mx.nd.load(fname)
+    assert len(loaded) == len(data)
+    for k, x in data.items():
+        assert np.sum(x.asnumpy() != loaded[k].asnumpy()) == 0
+    if sys.platform.startswith('linux'):
+        # the loaded arrays must alias the mapped file instead of copies of it
+        mapped = []
+        with open('/proc/self/maps') as maps:
+            for line in maps:
+                fields = line.split(None, 5)
+                if len(fields) == 6 and fields[5].rstrip('\n') == os.path.realpath(fname):
+                    start, end = (int(addr, 16) for addr in fields[0].split('-'))
+                    mapped.append((start, end))
+        assert mapped
+        for k, x in loaded.items():
+            ptr = ctypes.c_void_p()
+            mx.base.check_call(mx.base._LIB.MXNDArrayGetData(x.handle, ctypes.byref(ptr)))
+            nbytes = x.size * np.dtype(x.dtype).itemsize
+            assert any(start <= ptr.value and ptr.value + nbytes <= end
+                       for start, end in mapped), k
+    # writing to a loaded array must not change the file
+    loaded['arr_0'][:] = 0
+    loaded['arr_0'].wait_to_read()
+    reloaded = mx.nd.load(fname)
+    assert np.sum(data['arr_0'].asnumpy() != reloaded['arr_0'].asnumpy()) == 0
+
+
 @mx.util.use_np
 def test_ndarray_load_fortran_order(tmp_path):
     arr = np.arange(20).reshape((2, 10)).T
@@ -684,6 +724,27 @@ def test_reduce():
                       mx.nd.argmin, False, check_dtype=False)
 
 
+@pytest.mark.parametrize('shape,axis', [
+    ((3, 5000), 1), ((300, 700), 1), ((4, 5, 600), (1, 2)),
+    ((5000, 3), 0), ((700, 300), 0), ((6, 50, 70), (0, 1)),
+    ((1, 100000), None)])
+def test_reduce_contiguous_axes(shape, axis):
+    # long rows and columns of the innermost and outermost axes take the vectorized kernels
+    dat = np.random.uniform(-1, 1, size=shape).astype(np.float32)
+    dat.ravel()[np.random.choice(dat.size, 3, replace=False)] = np.nan
+    for np_func, nd_func in [(np.sum, mx.nd.sum), (np.mean, mx.nd.mean),
+                             (np.max, mx.nd.max), (np.min, mx.nd.min)]:
+        numpy_ret = np_func(dat.astype(np.float64), axis=axis)
+        ndarray_ret = nd_func(mx.nd.array(dat), axis=axis).asnumpy()
+        assert_almost_equal(ndarray_ret, numpy_ret.reshape(ndarray_ret.shape),
+                            rtol=1e-4, atol=1e-4, equal_nan=True)
+    if isinstance(axis, int):
+        finite = np.nan_to_num(dat)
+        assert_almost_equal(mx.nd.norm(mx.nd.array(finite), axis=axis).asnumpy(),
+                            np.linalg.norm(finite.astype(np.float64), axis=axis),
+                            rtol=1e-4, atol=1e-4)
+
+
 @pytest.mark.serial
 def test_broadcast():
     sample_num = 1000
@@ -1258,6 +1319,66 @@ def test_cached():
         o.backward()
 
 
+@pytest.mark.parametrize('num_states', [0, 2])
+def test_cached_thread_safe(num_states):
+    import threading
+    sym = mx.sym.FullyConnected(mx.sym.Variable('data'), num_hidden=16, name='fc')
+    sym = mx.sym.relu(sym) + 1
+    flags = [('data_indices', '[0]'), ('param_indices', '[1, 2]'),
+             ('static_alloc', True), ('num_states', num_states)]
+    op = mx.nd.CachedOp(sym, flags, thread_safe=True)
+    weight = mx.nd.random.uniform(shape=(16, 8))
+    bias = mx.nd.random.uniform(shape=(16,))
+    datas = [mx.nd.random.uniform(shape=(4, 8)) for _ in range(8)]
+    outs = [None] * len(datas)
+
+    def run(i):
+        for _ in range(10):
+            outs[i] = op(datas[i], weight, bias)
+        outs[i].wait_to_read()
+
+    threads = [threading.Thread(target=run, args=(i,)) for i in range(len(datas))]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    for data, out in zip(datas, outs):
+        expected = mx.nd.relu(mx.nd.FullyConnected(data, weight, bias, num_hidden=16)) + 1
+        assert_almost_equal(out.asnumpy(), expected.asnumpy(), rtol=1e-5, atol=1e-6)
+
+
+def test_cached_op_batcher():
+    import threading
+    sym = mx.sym.FullyConnected(mx.sym.Variable('data'), num_hidden=4, name='fc')
+    op = mx.nd.CachedOp(sym, [('static_alloc', True)])
+    weight = mx.nd.random.uniform(shape=(4, 3))
+    bias = mx.nd.random.uniform(shape=(4,))
+    batcher = mx.nd.CachedOpBatcher(op, [None, weight, bias], max_batch_size=4,
+                                    max_latency_us=20000, batch_sizes=[2, 4])
+    samples = [mx.nd.random.uniform(shape=(3,)) for _ in range(10)]
+    outs = [None] * len(samples)
+
+    def run(i):
+        outs[i] = batcher(samples[i])
+
+    threads = [threading.Thread(target=run, args=(i,)) for i in range(len(samples))]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    for sample, out in zip(samples, outs):
+        expected = mx.nd.FullyConnected(sample.reshape((1, 3)), weight, bias, num_hidden=4)
+        assert out.shape == (4,)
+        assert_almost_equal(out.asnumpy(), expected[0].asnumpy(), rtol=1e-5, atol=1e-6)
+    stats = batcher.stats()
+    assert stats['num_requests'] == len(samples)
+    assert stats['num_batches'] >= 3
+    # the batches are padded to 2 or 4 rows
+    assert (stats['num_requests'] + stats['num_padded']) % 2 == 0
+    with pytest.raises(mx.MXNetError):
+        batcher(samples[0], samples[1])
+
+
 def test_output():
     shape = (2,2)
     ones = mx.nd.ones(shape)
@@ -2063,3 +2184,89 @@ def test_readable_bfloat16_print():
     arr_float = arr_bfloat16.astype(float)
     assert (arr_bfloat16.__str__() == arr_float.__str__())
     assert (arr_bfloat16.__repr__().find(arr_uint16.__str__()) != -1)
+
+
+def test_imperative_inline():
+    # the inline threshold is read once, so the operators run in a new process
+    script = """
+import threading
+import numpy as np
+import mxnet as mx
+from mxnet.base import MXNetError
+
+# small operators run inline, sgd_mom_update mutates an input and is pushed
+n = 200
+s = mx.nd.zeros((10,))
+g = -mx.nd.ones((10,))
+mom = mx.nd.zeros((10,))
+def push():
+    for _ in range(n):
+        mx.nd.sgd_mom_update(s, g, mom, lr=1, momentum=0, wd=0, out=s)
+thread = threading.Thread(target=push)
+thread.start()
+for _ in range(n):
+    s += 1
+thread.join()
+np.testing.assert_array_equal(s.asnumpy(), 2 * n)
+
+# inline and pushed operators on one thread keep the order of the calls
+x = mx.nd.zeros((10,))
+for i in range(40):
+    if i % 2:
+        mx.nd.sgd_mom_update(x, g, mom, lr=1, momentum=0, wd=0, out=x)
+    else:
+        x = x * 2
+np.testing.assert_array_equal(x.asnumpy(), 2 ** 20 - 1)
+
+# the error of an inline operator is raised when waiting for its output
+y = mx.nd.linalg.potrf(-mx.nd.ones((2, 2)))
+try:
+    y.wait_to_read()
+except MXNetError:
+    pass
+else:
+    raise AssertionError('no error raised')
+z = mx.nd.ones((2, 2)) + 1
+np.testing.assert_array_equal(z.asnumpy(), 2)
+"""
+    env = dict(os.environ, MXNET_IMPERATIVE_INLINE_MAX_SIZE='64',
+               MXNET_ENGINE_TYPE='ThreadedEnginePerDevice')
+    subprocess.check_call([sys.executable, '-c', script], env=env)
+
+def test_dispatch_cache():
+    # calls of an operator alike reuse the inferred attributes, calls that
+    # differ in shapes, dtypes, storage types or attributes must not
+    for shape in [(2, 3), (3, 2), (6,), (2, 3)]:
+        for dtype in ['float32', 'float64', 'int32']:
+            a = np.random.randint(-5, 5, size=shape).astype(dtype)
+            b = np.random.randint(-5, 5, size=shape).astype(dtype)
+            c = mx.nd.add(mx.nd.array(a, dtype=dtype), mx.nd.array(b, dtype=dtype))
+            assert c.shape == shape
+            assert c.dtype == np.dtype(dtype)
+            assert_array_equal(c.asnumpy(), a + b)
+    x = mx.nd.arange(24).reshape((2, 3, 4))
+    for axis in [0, 1, 2, (0, 2), None]:
+        assert_array_equal(mx.nd.sum(x, axis=axis).asnumpy(),
+                           x.asnumpy().sum(axis=axis))
+        assert_array_equal(mx.nd.sum(x, axis=axis, keepdims=True).asnumpy(),
+                           x.asnumpy().sum(axis=axis, keepdims=True))
+    dense = mx.nd.array([[0, 1], [2, 0]])
+    for stype in ['default', 'row_sparse', 'csr', 'default']:
+        y = mx.nd.square(dense.tostype(stype))
+        assert y.stype == stype
+        assert_array_equal(y.asnumpy(), dense.asnumpy() ** 2)
+
+
+@mx.util.use_np
+def test_dispatch_cache_np_default_dtype():
+    # the dtype of the outputs of some operators depends on the default dtype,
+    # so identical calls must not share their inferred attributes across modes
+    a = mx.np.array([1, 2, 3], dtype='int32')
+    b = mx.np.array([2, 2, 2], dtype='int32')
+    for default_dtype in [False, True, False]:
+        with mx.util.np_default_dtype(default_dtype):
+            expected = 'float64' if default_dtype else 'float32'
+            c = mx.np.true_divide(a, b)
+            assert c.dtype == np.dtype(expected)
+            assert_almost_equal(c.asnumpy(), np.array([0.5, 1, 1.5]))
+            assert mx.np.random.uniform(size=(2, 3)).dtype == np.dtype(expected)
@@ -4078,6 +4078,26 @@ def test_order():
                     is_ascend=True)])
 
 
+@pytest.mark.parametrize('dtype', ['float32', 'float64', 'int32'])
+@pytest.mark.parametrize('is_ascend', [True, False])
+@pytest.mark.parametrize('k', [1, 100, 20000])
+@pytest.mark.parametrize('num_rows', [1, 3])
+def test_topk_long_rows(dtype, is_ascend, k, num_rows):
+    # long rows are split among threads on cpu, ties are ordered by position
+    dat = np.random.randint(-1000, 1000, size=(num_rows, 100003)).astype(dtype)
+    order = np.argsort(dat if is_ascend else -dat, axis=1, kind='stable')[:, :k]
+    value, indices = mx.nd.topk(mx.nd.array(dat, dtype=dtype), axis=1, k=k, ret_typ='both',
+                                is_ascend=is_ascend, dtype='int64')
+    assert_almost_equal(indices.asnumpy(), order)
+    assert_almost_equal(value.asnumpy(), np.take_along_axis(dat, order, axis=1))
+    mask = mx.nd.topk(mx.nd.array(dat, dtype=dtype), axis=1, k=k, ret_typ='mask',
+                      is_ascend=is_ascend)
+    assert mask.asnumpy().sum() == num_rows * k
+    sorted_dat = mx.nd.sort(mx.nd.array(dat, dtype=dtype), axis=1, is_ascend=is_ascend)
+    assert_almost_equal(sorted_dat.asnumpy(), np.take_along_axis(
+        dat, np.argsort(dat if is_ascend else -dat, axis=1, kind='stable'), axis=1))
+
+
 def test_blockgrad():
     a = mx.sym.Variable('a')
     b = mx.sym.BlockGrad(a)
@@ -8946,6 +8966,44 @@ def test_multihead_attention_selfatt():
     for dtype in dtypes:
         check_multihead_attention_selfatt(dtype=dtype)
 
+@pytest.mark.parametrize('causal', [False, True])
+@pytest.mark.parametrize('use_valid_length', [False, True])
+@pytest.mark.parametrize('seq_len', [7, 150])
+def test_interleaved_fused_selfatt(causal, use_valid_length, seq_len):
+    # compared with the attention weights computed by interleaved_matmul_selfatt_qk
+    # and applied by interleaved_matmul_selfatt_valatt
+    batch_size, num_heads, head_dim = 3, 4, 16
+    qkv = mx.nd.random.uniform(-1, 1, shape=(seq_len, batch_size, num_heads * head_dim * 3))
+    valid_length = mx.nd.array(np.random.randint(1, seq_len + 1, size=(batch_size,)))
+    mask = np.ones((batch_size, seq_len, seq_len))
+    if use_valid_length:
+        for b, length in enumerate(valid_length.asnumpy().astype(np.int32)):
+            mask[b, :, length:] = 0
+    if causal:
+        mask = mask * np.tril(np.ones((seq_len, seq_len)))
+    mask = mx.nd.array(np.repeat(mask, num_heads, axis=0))
+    out_grad = mx.nd.random.uniform(-1, 1, shape=(seq_len, batch_size, num_heads * head_dim))
+
+    qkv_ref = qkv.copy()
+    qkv_ref.attach_grad()
+    with mx.autograd.record():
+        att = mx.nd.contrib.interleaved_matmul_selfatt_qk(qkv_ref, heads=num_heads)
+        att = mx.nd.where(mask, att, mx.nd.ones_like(att) * -1e18)
+        att = mx.nd.softmax(att, axis=-1)
+        out_ref = mx.nd.contrib.interleaved_matmul_selfatt_valatt(qkv_ref, att, heads=num_heads)
+    out_ref.backward(out_grad)
+
+    qkv.attach_grad()
+    kwargs = {'valid_length': valid_length} if use_valid_length else {}
+    with mx.autograd.record():
+        out = mx.nd.contrib.interleaved_fused_selfatt(qkv, heads=num_heads, causal=causal,
+                                                      use_valid_length=use_valid_length,
+                                                      **kwargs)
+    out.backward(out_grad)
+    assert_almost_equal(out, out_ref, rtol=1e-4, atol=1e-5)
+    assert_almost_equal(qkv.grad, qkv_ref.grad, rtol=1e-4, atol=1e-5)
+
+
 def check_multihead_attention_encdec(dtype):
     def convert_weight(F, k_weight, v_weight, num_heads):
         k_weight = F.reshape(k_weight, shape=(num_heads, -1, 0), reverse=True)
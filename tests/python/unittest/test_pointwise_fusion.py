@@ -0,0 +1,144 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+import json
+import mxnet as mx
+import numpy as np
+import pytest
+from mxnet.gluon import HybridBlock
+from mxnet.test_utils import environment, rand_shape_2d, assert_almost_equal
+
+
+def count_fused_ops(sym):
+    return sum(node['op'] == '_FusedOp' for node in json.loads(sym.tojson())['nodes'])
+
+
+def check_fused_symbol(sym, dtypes=('float16', 'float32', 'float64'), **kwargs):
+    inputs = sym.list_inputs()
+    shapes = {inp : kwargs[inp].shape for inp in inputs}
+    # Double identity so that there is always something to fuse
+    test_sym = mx.sym.Group([mx.sym.identity(mx.sym.identity(s)) for s in sym])
+    rtol = {'float16' : 1e-2,
+            'float32' : 1.5e-6,
+            'float64' : 1.5e-6,
+            }
+    atol = {'float16' : 1e-3,
+            'float32' : 1e-7,
+            'float64' : 1e-7,
+            }
+    for dtype in dtypes:
+        data = {inp : kwargs[inp].astype(dtype) for inp in inputs}
+        for grad_req in ['write', 'add']:
+            type_dict = {inp : dtype for inp in inputs}
+            with environment('MXNET_USE_FUSION', '0'):
+                orig_exec = test_sym._simple_bind(ctx=mx.cpu(), grad_req=grad_req,
+                                                  type_dict=type_dict, **shapes)
+            with environment('MXNET_USE_FUSION', '1'):
+                fused_exec = test_sym._simple_bind(ctx=mx.cpu(), grad_req=grad_req,
+                                                   type_dict=type_dict, **shapes)
+            fwd_orig = orig_exec.forward(is_train=True, **data)
+            out_grads = [mx.nd.ones_like(arr) for arr in fwd_orig]
+            orig_exec.backward(out_grads=out_grads)
+            fwd_fused = fused_exec.forward(is_train=True, **data)
+            fused_exec.backward(out_grads=out_grads)
+            assert count_fused_ops(orig_exec.get_optimized_symbol()) == 0
+            assert count_fused_ops(fused_exec.get_optimized_symbol()) > 0
+            for orig, fused in zip(fwd_orig, fwd_fused):
+                np.testing.assert_allclose(orig.asnumpy(), fused.asnumpy(),
+                                           rtol=rtol[dtype], atol=atol[dtype])
+            for orig, fused in zip(orig_exec.grad_arrays, fused_exec.grad_arrays):
+                if orig is None and fused is None:
+                    continue
+                assert orig is not None
+                assert fused is not None
+                np.testing.assert_allclose(orig.asnumpy(), fused.asnumpy(),
+                                           rtol=rtol[dtype], atol=atol[dtype])
+
+
+@pytest.mark.parametrize('op_name', ['relu', 'sigmoid', 'softsign', 'exp', 'expm1', 'log',
+                                     'log1p', 'sin', 'cos', 'tanh', 'sqrt', 'rsqrt', 'cbrt',
+                                     'square', 'flatten', 'round', 'floor', 'sign',
+                                     'reciprocal', 'abs', 'erf', 'negative', 'zeros_like'])
+def test_fusion_cpu_unary(op_name):
+    a = mx.sym.Variable('a')
+    arr = mx.random.uniform(shape=rand_shape_2d())
+    check_fused_symbol(getattr(mx.sym, op_name)(a), a=arr)
+
+
+def test_fusion_cpu_binary():
+    a = mx.sym.Variable('a')
+    b = mx.sym.Variable('b')
+    shape = rand_shape_2d()
+    arr1 = mx.random.uniform(shape=shape)
+    arr2 = mx.random.uniform(shape=shape)
+
+    check_fused_symbol(a+b, a=arr1, b=arr2)
+    check_fused_symbol(3-a, a=arr1)
+    check_fused_symbol(a*b, a=arr1, b=arr2)
+    check_fused_symbol(a/(b+1), a=arr1, b=arr2)
+    check_fused_symbol(3/a, a=arr1)
+    check_fused_symbol(a**3, a=arr1)
+    check_fused_symbol(mx.sym.maximum(a, b), a=arr1, b=arr2)
+    check_fused_symbol(mx.sym.hypot(a, b), a=arr1, b=arr2)
+    check_fused_symbol(mx.sym.clip(a, a_min=0.3, a_max=0.7), a=arr1)
+    check_fused_symbol(mx.sym.smooth_l1(a, scalar=0.3), a=arr1)
+    check_fused_symbol(mx.sym.add_n(a, b, a*b), a=arr1, b=arr2)
+
+
+def test_fusion_cpu_chains():
+    a = mx.sym.Variable('a')
+    b = mx.sym.Variable('b')
+    shape = rand_shape_2d()
+    arr1 = mx.random.uniform(shape=shape)
+    arr2 = mx.random.uniform(shape=shape)
+
+    # bias add, activation, scaling and cast, with several outputs
+    act = mx.sym.LeakyReLU(a+b, act_type='gelu')
+    check_fused_symbol(mx.sym.Group([mx.sym.Cast(act * 0.5, dtype='float16'), act]),
+                       a=arr1, b=arr2)
+    for act_type in ['relu', 'sigmoid', 'tanh', 'softrelu', 'softsign']:
+        check_fused_symbol(mx.sym.Activation(a*b - 0.5, act_type=act_type) + a,
+                           a=arr1, b=arr2)
+    check_fused_symbol(mx.sym.reshape(mx.sym.sqrt(a) * b, shape=(-1,)), a=arr1, b=arr2)
+    # mixed precision
+    check_fused_symbol(mx.sym.Cast(mx.sym.Cast(a, dtype='float16') + b, dtype='float64'),
+                       dtypes=['float32'], a=arr1, b=arr2)
+
+
+def test_fusion_cpu_non_float():
+    # Integer types are run operator by operator
+    a = mx.sym.Variable('a')
+    b = mx.sym.Variable('b')
+    arr = mx.random.uniform(shape=rand_shape_2d())
+    check_fused_symbol(mx.sym.Cast(mx.sym.Cast(a, dtype='int32') + 1, dtype='float32') * b,
+                       a=arr * 10, b=arr)
+
+
+def test_fusion_cpu_hybridized():
+    class Foo(HybridBlock):
+        def hybrid_forward(self, F, x, bias):
+            return F.Activation(x + bias, act_type='tanh') * 2 + x
+
+    x = mx.nd.random.uniform(shape=(3, 1000))
+    bias = mx.nd.random.uniform(shape=(3, 1000))
+    ref = Foo()(x, bias)
+    with environment('MXNET_USE_FUSION', '1'):
+        foo = Foo()
+        foo.hybridize(static_alloc=True)
+        for _ in range(2):
+            assert_almost_equal(foo(x, bias), ref)
+        assert count_fused_ops(foo._cached_op.get_optimized_symbol()) > 0
@@ -240,6 +240,27 @@ def test_continuous_profile_and_instant_marker():
     profiler.set_state('stop')
 
 
+def test_continuous_profile_rolling_files(tmpdir):
+    prefix = 'test_continuous_profile_rolling_files'
+    profiler.set_config(profile_all=True, filename=os.path.join(str(tmpdir), prefix + '.json'),
+                        continuous_dump=True, max_file_size=4096, max_files=3,
+                        sample_rate=2)
+    profiler.set_state('run')
+    for _ in range(10):
+        test_profile_event(False)
+        test_profile_counter(False)
+        profiler.dump(False)
+    profiler.set_state('stop')
+    profiler.dump(True)
+    files = [f for f in os.listdir(str(tmpdir)) if f.startswith(prefix + '.')]
+    assert 1 < len(files) <= 3
+    # every file of the rolling set is a complete trace
+    for f in files:
+        with open(os.path.join(str(tmpdir), f)) as trace_file:
+            trace = json.load(trace_file)
+        assert len(trace['traceEvents']) > 0
+
+
 def test_aggregate_stats_valid_json_return():
     file_name = 'test_aggregate_stats_json_return.json'
     enable_profiler(file_name, True, True, True)